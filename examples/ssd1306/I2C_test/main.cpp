@@ -61,6 +61,10 @@ void SetupTest()
 	} // Initialize the buffer
 	myOLED.OLEDFillScreen(0xF0, 0); // splash screen bars
 	busy_wait_ms(1000);
+	// find the fastest clock this board runs without errors, re-tune if errors climb
+	if (myOLED.I2CClockTune() == DisplayRet::Success)
+		myOLED.SetI2CClockAutoTune(true);
+	printf("I2C clock tuned to %u kHz\r\n", myOLED.GetI2CClockTuned());
 }
 
 void Test() 
@@ -76,12 +80,14 @@ void Test()
 		myOLED.setCursor(5,25);
 		myOLED.print(testCount);
 		myOLED.OLEDupdate();  
+		myOLED.I2CClockRetune(); // between frames, only runs if errors climbed
 		busy_wait_ms(5000);
 		printf("Library number %u \n",__LibVerNum__); 
 		printf("Debug Mode %s \n",(myOLED.GetDebugMode() ? "true" : "false")); 
 		printf("I2C retry attempts %u \n",myOLED.GetI2CRetryAttemptsNo());
 		printf("I2C retry Delay %u mS\n",myOLED.GetI2CRetryDelay());
 		printf("I2C Timeout %lu uS\n",myOLED.GetI2CTimeout());
+		printf("I2C clock %u kHz, tunings %lu\n", myOLED.GetI2CClockTuned(), myOLED.GetI2CClockTuneRuns());
 		printf("I2C Is connected %s\n", (myOLED.GetIsConnected()  ? "true" : "false"));
 		myOLED.CheckConnection();
 	}
@@ -4,7 +4,8 @@
 	@brief Test file for SSD1306_OLED library, Test file showing a "clock demo" 128X64 screen 
 	Project Name: SSD1306_OLED_PICO
 	
-	@details One possible method you can also use strings objects
+	@details The time and count are numeric fields, each second only the
+		digits that changed are drawn and sent to the display.
 	
 	@test
 		-# Test 401 Clock Demo
@@ -16,6 +17,7 @@
 #include "pico/stdlib.h"
 #include "displaylib/ssd1306.hpp"
 #include "displaylib/bitmap_test_data.hpp"
+#include "displaylib/display_numeric.hpp"
 
 /// @cond
 
@@ -90,29 +92,51 @@ void DisplayClock(void)
 	uint8_t Hour = 10;
 	uint8_t Min = 59;
 	uint16_t count = 0;
-	char strTime[12];
 	unsigned long previousMillis = 0;  // will store last time display was updated
 	const long interval = 1000;  //   interval at which to update display (milliseconds)
-	
-	myOLED.setFont(pFontDefault);
-	printf("OLED Clock Demo 30 seconds.\r\n");
-		
-	while (count < 30)
-	{
-		myOLED.OLEDBitmap(0, 0, 16, 8,  SignalIcon, false);
-		myOLED.OLEDBitmap(20, 0, 16, 8,  MsgIcon, false);
-		myOLED.OLEDBitmap(37, 0, 8, 8,  AlarmIcon, false);
-		myOLED.OLEDBitmap(110, 0, 16, 8,  BatIcon, false);
 
-		myOLED.drawLine(0,10,128,10,myOLED.FG_COLOR);
-		myOLED.drawLine(0,35,128,35,myOLED.FG_COLOR);
-		myOLED.drawLine(0,63,128,63,myOLED.FG_COLOR);
+	// Numeric fields, redraw and send only the digits that change
+	displaylib_numeric_field hourField(myOLED, 0, 16, 2, pFontHallfetica);
+	displaylib_numeric_field minField(myOLED, 48, 16, 2, pFontHallfetica);
+	displaylib_numeric_field secField(myOLED, 96, 16, 2, pFontHallfetica);
+	displaylib_numeric_field countField(myOLED, 49, 44, 3, pFontDefault);
+	hourField.setFormat(0, displaylib_numeric_field::PadZero);
+	minField.setFormat(0, displaylib_numeric_field::PadZero);
+	secField.setFormat(0, displaylib_numeric_field::PadZero);
 
-		myOLED.drawLine(0,35,0,63,myOLED.FG_COLOR);
-		myOLED.drawLine(127,35,127,63,myOLED.FG_COLOR);
+	printf("OLED Clock Demo 30 seconds.\r\n");
+	// Static part of screen, drawn and sent once
+	myOLED.OLEDBitmap(0, 0, 16, 8,  SignalIcon, false);
+	myOLED.OLEDBitmap(20, 0, 16, 8,  MsgIcon, false);
+	myOLED.OLEDBitmap(37, 0, 8, 8,  AlarmIcon, false);
+	myOLED.OLEDBitmap(110, 0, 16, 8,  BatIcon, false);
+
+	myOLED.drawLine(0,10,128,10,myOLED.FG_COLOR);
+	myOLED.drawLine(0,35,128,35,myOLED.FG_COLOR);
+	myOLED.drawLine(0,63,128,63,myOLED.FG_COLOR);
+
+	myOLED.drawLine(0,35,0,63,myOLED.FG_COLOR);
+	myOLED.drawLine(127,35,127,63,myOLED.FG_COLOR);
+
+	myOLED.drawLine(40,35,40,63,myOLED.FG_COLOR);
+	myOLED.drawLine(75,35,75,63,myOLED.FG_COLOR);
+	myOLED.setFont(pFontHallfetica);
+	myOLED.writeChar(32, 16, ':');
+	myOLED.writeChar(80, 16, ':');
+	myOLED.setFont(pFontDefault);
+	myOLED.OLEDBitmap(80, 40, 16, 8,  MsgIcon, false);
+	hourField.setValue(Hour);
+	minField.setValue(Min);
+	secField.setValue(Sec);
+	countField.setValue(count);
+	myOLED.OLEDupdate();
+	hourField.clearDirty();
+	minField.clearDirty();
+	secField.clearDirty();
+	countField.clearDirty();
 
-		myOLED.drawLine(40,35,40,63,myOLED.FG_COLOR);
-		myOLED.drawLine(75,35,75,63,myOLED.FG_COLOR);
+	while (count < 30)
+	{
 		unsigned long currentMillis = to_ms_since_boot(get_absolute_time());
 
 		if (currentMillis - previousMillis >= interval) // rolls over every interval (1 sec)
@@ -134,15 +158,14 @@ void DisplayClock(void)
 					}
 				}
 			}
-			myOLED.setFont(pFontHallfetica);
-			snprintf(strTime, sizeof(strTime), "%02u:%02u:%02u", Hour , Min , Sec);
-			myOLED.writeCharString(0,16, strTime);
-			myOLED.setCursor(55,44);
-			myOLED.setFont(pFontDefault);
-			myOLED.print(count);
-			myOLED.OLEDBitmap(80, 40, 16, 8,  MsgIcon, false); 
-			myOLED.OLEDupdate();
-			myOLED.OLEDclearBuffer();
+			hourField.setValue(Hour);
+			minField.setValue(Min);
+			secField.setValue(Sec);
+			countField.setValue(count);
+			hourField.flushDirty(myOLED);
+			minField.flushDirty(myOLED);
+			secField.flushDirty(myOLED);
+			countField.flushDirty(myOLED);
 		} //sec
 	}
 	busy_wait_ms(5000);
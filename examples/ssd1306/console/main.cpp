@@ -0,0 +1,86 @@
+/*!
+	@file main.cpp
+	@author Gavin Lyons
+	@brief Test file for SSD1306_OLED library, showing the hardware scrolled text console
+	@test
+		1. Test 701 Text console, scrolling log with no screen buffer
+*/
+
+// === Libraries ===
+#include "pico/stdlib.h"
+#include "displaylib/ssd1306.hpp"
+#include "displaylib/display_console.hpp"
+
+/// @cond
+
+// Screen settings
+#define myOLEDwidth  128
+#define myOLEDheight 64
+
+// instantiate an OLED object and a console on it, no buffer needed
+SSD1306 myOLED(myOLEDwidth ,myOLEDheight);
+displaylib_console myConsole(myOLED);
+
+// I2C settings
+const uint16_t SPEED = 100;
+const uint8_t CLK_PIN = 19;
+const uint8_t DATA_PIN = 18;
+
+// =============== Function prototype ================
+void SetupTest(void);
+void Test(void);
+void EndTest(void);
+
+// ======================= Main ===================
+int main() 
+{
+	SetupTest();
+	Test();
+	EndTest();
+}
+// ======================= End of main  ===================
+
+// ===================== Function Space =====================
+void SetupTest() 
+{
+	stdio_init_all(); // Initialize chosen serial port, default 38400 baud
+	busy_wait_ms(500);
+	printf("OLED SSD1306 :: Start!\r\n");
+	while(myOLED.OLEDbegin(SSD1306::SSD1306_ADDR, i2c1,  SPEED, DATA_PIN, CLK_PIN) != DisplayRet::Success)
+	{
+		printf("SetupTest ERROR : Failed to initialize OLED!\r\n");
+		busy_wait_ms(1500);
+	} // initialize the OLED
+	if (myConsole.consoleBegin(pFontDefault) != DisplayRet::Success)
+	{
+		printf("SetupTest : ERROR : consoleBegin Failed!\r\n");
+		while(1){busy_wait_ms(1000);}
+	} // Initialize the console
+}
+
+void Test() 
+{
+	uint32_t start = to_ms_since_boot(get_absolute_time());
+	for (uint16_t line = 0; line < 100; line++)
+	{
+		myConsole.print("Log ");
+		myConsole.print(line);
+		myConsole.print(" t=");
+		myConsole.println(to_ms_since_boot(get_absolute_time()) - start);
+		busy_wait_ms(100);
+	}
+	myConsole.setConsoleInvert(true);
+	myConsole.println("Inverted text");
+	myConsole.setConsoleInvert(false);
+	myConsole.println("End");
+	busy_wait_ms(5000);
+}
+
+void EndTest()
+{
+	myConsole.consoleEnd();
+	myOLED.OLEDPowerDown(); // Switch off display
+	myOLED.OLEDdeI2CInit(); // De-initialize the I2C interface
+	printf("OLED SSD1306 :: End\r\n");
+}
+/// @endcond
@@ -0,0 +1,132 @@
+/*!
+	@file main.cpp
+	@author Gavin Lyons
+	@brief Test file for SSD1306_OLED library, showing temporal dither grayscale
+	@test
+		1. Test 405 Grayscale, 4 level bands, a dithered gradient and a shaded panel,
+			sub-frame rate report, ordered dither fallback
+*/
+
+// === Libraries ===
+#include <cstdio>
+#include "pico/stdlib.h"
+#include "displaylib/ssd1306.hpp"
+#include "displaylib/display_grayscale.hpp"
+
+/// @cond
+
+// Screen settings
+#define myOLEDwidth  128
+#define myOLEDheight 64
+#define myScreenSize (myOLEDwidth * (myOLEDheight/8)) // eg 1024 bytes = 128 * 64/8
+uint8_t screenBuffer[myScreenSize]; // Define a buffer to cover whole screen  128 * 64/8
+uint8_t grayPlanes[myScreenSize * 2]; // the two planes of the grayscale canvas
+
+// I2C settings
+const uint16_t SPEED = 400;
+const uint8_t CLK_PIN = 19;
+const uint8_t DATA_PIN = 18;
+
+// instantiate an OLED object and a grayscale canvas
+SSD1306 myOLED(myOLEDwidth ,myOLEDheight);
+displaylib_grayscale myGray(myOLED);
+
+// a 128x64 plane takes about 10 mS to send at 1 MHz I2C, so the sub-frame period is
+// set just above it, below 80 sub-frames a second, 3 a grey frame, it flickers too much
+const uint32_t SUBFRAME_PERIOD_US = 11000;
+const float MIN_SUBFRAME_RATE = 80.0f;
+
+// =============== Function prototype ================
+void SetupTest(void);
+void Test(void);
+void EndTest(void);
+
+// ======================= Main ===================
+int main()
+{
+	SetupTest();
+	Test();
+	EndTest();
+}
+// ======================= End of main  ===================
+
+// ===================== Function Space =====================
+void SetupTest()
+{
+	stdio_init_all(); // Initialize chosen serial port, default 38400 baud
+	busy_wait_ms(500);
+	printf("OLED SSD1306 :: Start!\r\n");
+	while(myOLED.OLEDbegin(SSD1306::SSD1306_ADDR, i2c1,  SPEED, DATA_PIN, CLK_PIN) != DisplayRet::Success)
+	{
+		printf("SetupTest ERROR : Failed to initialize OLED!\r\n");
+		busy_wait_ms(1500);
+	} // initialize the OLED
+	if (myOLED.OLEDSetBufferPtr(myOLEDwidth, myOLEDheight, screenBuffer) != DisplayRet::Success)
+	{
+		printf("SetupTest : ERROR : OLEDSetBufferPtr Failed!\r\n");
+		while(1){busy_wait_ms(1000);}
+	} // Initialize the buffer
+	myOLED.OLEDclearBuffer();
+	// each sub-frame is a whole frame on a 128x64, so run the bus as fast as it goes
+	if (myOLED.I2CClockTune() == DisplayRet::Success)
+		printf("I2C clock tuned to %u kHz\r\n", myOLED.GetI2CClockTuned());
+}
+
+void Test()
+{
+	printf("OLED Test 405 Grayscale\r\n");
+	if (myGray.grayBegin(grayPlanes) != DisplayRet::Success)
+	{
+		printf("Test : ERROR : grayBegin Failed!\r\n");
+		return;
+	}
+	myGray.setSubframePeriod(SUBFRAME_PERIOD_US);
+	myGray.grayClear(0);
+	// the four levels as bands
+	for (uint8_t level = 0; level < displaylib_grayscale::GRAY_LEVELS; level++)
+		myGray.grayFillRect(level * 32, 0, 32, 16, level);
+	// an 8 bit gradient, Bayer dithered between the levels, a row at a time
+	uint8_t gradient[myOLEDwidth];
+	for (uint8_t column = 0; column < myOLEDwidth; column++)
+		gradient[column] = static_cast<uint8_t>(column * 2);
+	for (uint8_t row = 16; row < 32; row++)
+		myGray.grayDrawImage(0, row, myOLEDwidth, 1, gradient, true);
+	// a shaded panel with bright text, the text is drawn 1 bit in the screen buffer first
+	myGray.grayFillRect(8, 36, 112, 24, 1);
+	myOLED.setFont(pFontDefault);
+	myOLED.setCursor(0, 0);
+	myOLED.print("Grey levels");
+	myGray.grayDrawBitmap(24, 44, myOLEDwidth, 8, screenBuffer, 3); // first page, clipped at the right
+
+	// show it for 10 seconds, the sequencer needs calling at least once per sub-frame period
+	const uint64_t endUs = time_us_64() + 10000000;
+	while (time_us_64() < endUs)
+	{
+		if (myGray.grayStep(0) == displaylib_flush::FlushError)
+			printf("Test : sub-frame bus error\r\n");
+	}
+	const displaylib_grayscale::gray_stats_t &stats = myGray.getGrayStats();
+	const float rate = myGray.getSubframeRate();
+	printf("Sub-frames %lu, %.1f per second, overruns %lu, send %lu uS max %lu uS\r\n",
+		stats.subframes, rate, stats.overruns, stats.sendLastUs, stats.sendMaxUs);
+
+	// too slow to look grey, show the ordered dither instead
+	if (rate < MIN_SUBFRAME_RATE)
+	{
+		printf("Sub-frame rate too low, showing the dithered picture\r\n");
+		myGray.grayEnd();
+		myGray.grayDither(screenBuffer);
+		myOLED.OLEDupdate();
+		busy_wait_ms(5000);
+	}
+	myGray.grayEnd();
+	busy_wait_ms(1000);
+}
+
+void EndTest()
+{
+	myOLED.OLEDPowerDown(); // Switch off display
+	myOLED.OLEDdeI2CInit(); // De-initialize the I2C interface
+	printf("OLED SSD1306 :: End\r\n");
+}
+/// @endcond
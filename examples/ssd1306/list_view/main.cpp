@@ -0,0 +1,130 @@
+/*!
+	@file main.cpp
+	@author Gavin Lyons
+	@brief Test file for SSD1306_OLED library, showing the list view widget
+	@test
+		1. Test 403 List view, a 200 row settings menu, selection moves and smooth scroll
+*/
+
+// === Libraries ===
+#include <cstdio>
+#include "pico/stdlib.h"
+#include "displaylib/ssd1306.hpp"
+#include "displaylib/display_list.hpp"
+
+/// @cond
+
+// Screen settings
+#define myOLEDwidth  128
+#define myOLEDheight 64
+#define myScreenSize (myOLEDwidth * (myOLEDheight/8)) // eg 1024 bytes = 128 * 64/8
+uint8_t screenBuffer[myScreenSize]; // Define a buffer to cover whole screen  128 * 64/8
+
+// I2C settings
+const uint16_t SPEED = 100;
+const uint8_t CLK_PIN = 19;
+const uint8_t DATA_PIN = 18;
+
+// instantiate an OLED object and a list below a title row
+#define myMenuRows 200
+SSD1306 myOLED(myOLEDwidth ,myOLEDheight);
+displaylib_list_view myList(myOLED, 0, 10, myOLEDwidth, 54);
+uint8_t menuLevel[myMenuRows]; // the settings the menu shows
+
+// =============== Function prototype ================
+void SetupTest(void);
+void Test(void);
+void EndTest(void);
+uint8_t MenuRow(uint16_t row, std::span<char> text, void *context);
+
+// ======================= Main ===================
+int main()
+{
+	SetupTest();
+	Test();
+	EndTest();
+}
+// ======================= End of main  ===================
+
+// ===================== Function Space =====================
+void SetupTest()
+{
+	stdio_init_all(); // Initialize chosen serial port, default 38400 baud
+	busy_wait_ms(500);
+	printf("OLED SSD1306 :: Start!\r\n");
+	while(myOLED.OLEDbegin(SSD1306::SSD1306_ADDR, i2c1,  SPEED, DATA_PIN, CLK_PIN) != DisplayRet::Success)
+	{
+		printf("SetupTest ERROR : Failed to initialize OLED!\r\n");
+		busy_wait_ms(1500);
+	} // initialize the OLED
+	if (myOLED.OLEDSetBufferPtr(myOLEDwidth, myOLEDheight, screenBuffer) != DisplayRet::Success)
+	{
+		printf("SetupTest : ERROR : OLEDSetBufferPtr Failed!\r\n");
+		while(1){busy_wait_ms(1000);}
+	} // Initialize the buffer
+	myOLED.OLEDclearBuffer();
+}
+
+// Row provider, only called for rows coming into view
+uint8_t MenuRow(uint16_t row, std::span<char> text, void *context)
+{
+	const uint8_t *level = static_cast<const uint8_t *>(context);
+	int length = snprintf(text.data(), text.size(), "Setting %03u   %3u", row, level[row]);
+	return static_cast<uint8_t>((length < 0) ? 0 : ((static_cast<size_t>(length) < text.size()) ? length : text.size()));
+}
+
+void Test()
+{
+	printf("OLED Test 403 List view\r\n");
+	myOLED.setFont(pFontDefault);
+	myOLED.setCursor(0, 0);
+	myOLED.print("Settings");
+	for (uint16_t row = 0; row < myMenuRows; row++)
+		menuLevel[row] = static_cast<uint8_t>(row % 101);
+	myList.setRowSpacing(1); // 9 pixel rows, 6 rows in view
+	myList.setScrollSpeed(3);
+	if (myList.listBegin(MenuRow, menuLevel, myMenuRows) != DisplayRet::Success)
+	{
+		printf("Test : ERROR : listBegin Failed!\r\n");
+		return;
+	}
+	myOLED.OLEDupdate(); // whole screen once
+	myList.clearDirty();
+
+	// each press only inverts two row bands, leaving the view scrolls a few pixels a frame
+	for (uint16_t press = 0; press < 40; press++)
+	{
+		myList.moveSelection(1);
+		do
+		{
+			myList.flushDirty(myOLED);
+			busy_wait_ms(16);
+		} while (myList.listScrollStep() || myList.getDirty());
+		busy_wait_ms(150);
+	}
+	// change a setting, one row is drawn again
+	menuLevel[myList.getSelected()] = 100;
+	myList.invalidateRow(myList.getSelected());
+	myList.flushDirty(myOLED);
+	busy_wait_ms(1000);
+	// page back to the top
+	for (uint8_t page = 0; page < 10; page++)
+	{
+		myList.moveSelection(-6);
+		do
+		{
+			myList.flushDirty(myOLED);
+			busy_wait_ms(16);
+		} while (myList.listScrollStep() || myList.getDirty());
+		busy_wait_ms(300);
+	}
+	busy_wait_ms(5000);
+}
+
+void EndTest()
+{
+	myOLED.OLEDPowerDown(); // Switch off display
+	myOLED.OLEDdeI2CInit(); // De-initialize the I2C interface
+	printf("OLED SSD1306 :: End\r\n");
+}
+/// @endcond
@@ -0,0 +1,168 @@
+/*!
+	@file main.cpp
+	@author Gavin Lyons
+	@brief Test file for SSD1306_OLED library, three displays driven by the
+		multi panel manager, two SSD1306 sharing i2c1 and a Nokia 5110 on spi0.
+	@test
+		-# Test 603 Multi panel manager, shared bus flush scheduling
+*/
+
+// === Libraries ===
+#include <cstdio>
+
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+#include "displaylib/ssd1306.hpp"
+#include "displaylib/nokia5110.hpp"
+#include "displaylib/display_manager.hpp"
+
+/// @cond
+
+// Screen settings
+#define myOLEDwidth  128
+#define myOLEDheight 64
+#define myOLEDSize (myOLEDwidth * (myOLEDheight/8)) // eg 1024 bytes = 128 * 64/8
+#define myLCDwidth 84
+#define myLCDheight 48
+#define myLCDSize (myLCDwidth * (myLCDheight/8))
+uint8_t bufferA[myOLEDSize];
+uint8_t bufferB[myOLEDSize];
+uint8_t bufferC[myLCDSize];
+
+// I2C settings, both OLEDs on i2c1, second one strapped to the alt address
+const uint16_t I2C_Speed = 400;
+const uint8_t I2C_GPIO_CLK = 19;
+const uint8_t I2C_GPIO_DATA = 18;
+const uint8_t OLED_B_ADDR = 0x3D;
+
+// SPI settings
+const uint mosi_pin = 3;
+const uint sck_pin = 2;
+const uint cs_pin = 5;
+const uint res_pin = 6;
+const uint dc_pin = 7;
+uint32_t mySPIBaudRate = 8000;
+
+// Bus numbers for the manager
+const uint8_t BUS_I2C1 = 0;
+const uint8_t BUS_SPI0 = 1;
+
+SSD1306 myOLEDA(myOLEDwidth, myOLEDheight);
+SSD1306 myOLEDB(myOLEDwidth, myOLEDheight);
+NOKIA_5110 myLCD(myLCDwidth, myLCDheight);
+displaylib_manager myManager(displaylib_manager::PolicyPriority);
+
+// =============== Function prototype ================
+
+bool SetupTest(void);
+void MultiPanel(void);
+void EndTests(void);
+
+// ======================= Main ===================
+int main()
+{
+	if (SetupTest()) MultiPanel();
+	EndTests();
+}
+// ======================= End of main  ===================
+
+void EndTests()
+{
+	while (myManager.managerBusy())
+		myManager.managerStep();
+	for (uint8_t panel = 0; panel < myManager.getPanelCount(); panel++)
+	{
+		const displaylib_manager::panel_stats_t &stats = myManager.getPanelStats(panel);
+		printf("Panel %u: fps %.1f Flushed %lu Merged %lu Skipped %lu Errors %lu\r\n",
+			panel, myManager.getPanelFps(panel), stats.framesFlushed, stats.framesMerged,
+			stats.stepsSkipped, stats.flushErrors);
+		printf("  Latency uS: Avg %lu Max %lu, bus %lu uS\r\n",
+			stats.latencyAvgUs, stats.latencyMaxUs, stats.busUs);
+	}
+	myOLEDA.OLEDPowerDown();
+	myOLEDB.OLEDPowerDown();
+	myOLEDA.OLEDdeI2CInit();
+	myLCD.LCDPowerDown();
+	myLCD.LCDSPIoff();
+	printf("Multi panel :: End\r\n");
+}
+
+bool SetupTest()
+{
+	stdio_init_all(); // Initialize chosen serial port, default 38400 baud
+	busy_wait_ms(500);
+	printf("Multi panel :: Start!\r\n");
+	while(myOLEDA.OLEDbegin(SSD1306::SSD1306_ADDR, i2c1, I2C_Speed, I2C_GPIO_DATA, I2C_GPIO_CLK) != DisplayRet::Success ||
+		myOLEDB.OLEDbegin(OLED_B_ADDR, i2c1, I2C_Speed, I2C_GPIO_DATA, I2C_GPIO_CLK) != DisplayRet::Success)
+	{
+		printf("SetupTest ERROR : Failed to initialize OLEDs!\r\n");
+		busy_wait_ms(1500);
+	}
+	myLCD.LCDSPISetup(spi0, mySPIBaudRate, dc_pin, res_pin, cs_pin, sck_pin, mosi_pin);
+	myLCD.LCDInit(false, 0xB2, 0x13);
+	if (myOLEDA.OLEDSetBufferPtr(myOLEDwidth, myOLEDheight, bufferA) != DisplayRet::Success ||
+		myOLEDB.OLEDSetBufferPtr(myOLEDwidth, myOLEDheight, bufferB) != DisplayRet::Success ||
+		myLCD.LCDSetBufferPtr(myLCDwidth, myLCDheight, bufferC) != DisplayRet::Success)
+	{
+		printf("SetupTest : ERROR : SetBufferPtr Failed!\r\n");
+		return false;
+	}
+	// panel A redraws every pass so gets three times the i2c1 time of panel B
+	myManager.panelAdd(myOLEDA, BUS_I2C1, 3);
+	myManager.panelAdd(myOLEDB, BUS_I2C1, 1);
+	myManager.panelAdd(myLCD, BUS_SPI0, 1);
+	myManager.setBusBudget(BUS_I2C1, 3000);
+	myManager.setBusBudget(BUS_SPI0, 1000);
+	return true;
+}
+
+// Test 603 three panels, the main loop never waits for a whole frame to be sent
+void MultiPanel()
+{
+	printf("Multi panel :: Manager test, ends at 2000\r\n");
+	myOLEDA.setFont(pFontDefault);
+	myOLEDB.setFont(pFontDefault);
+	myLCD.setFont(pFontDefault);
+	uint32_t lastSecond = 0;
+
+	for (uint16_t count = 0; count < 2000; count++)
+	{
+		const uint32_t seconds = to_ms_since_boot(get_absolute_time()) / 1000;
+
+		// panel A, a busy animation, redrawn and submitted every pass
+		myOLEDA.OLEDclearBuffer();
+		myOLEDA.fillCircle(count % myOLEDwidth, 32, 10, myOLEDA.FG_COLOR);
+		myOLEDA.setCursor(0, 0);
+		myOLEDA.print(count);
+		myManager.panelSubmit(0);
+
+		// panel B, a status page, redrawn once a second
+		if (seconds != lastSecond)
+		{
+			lastSecond = seconds;
+			myOLEDB.OLEDclearBuffer();
+			myOLEDB.setCursor(0, 0);
+			myOLEDB.print("Up ");
+			myOLEDB.print(seconds);
+			myOLEDB.print(" s");
+			myOLEDB.setCursor(0, 10);
+			myOLEDB.print("A fps ");
+			myOLEDB.print(myManager.getPanelFps(0));
+			myManager.panelSubmit(1);
+		}
+
+		// panel C, on its own bus, redrawn when its last frame is on screen
+		if (!myManager.panelBusy(2))
+		{
+			myLCD.LCDclearBuffer();
+			myLCD.setCursor(0, 0);
+			myLCD.print("Skip ");
+			myLCD.print(myManager.getPanelStats(1).stepsSkipped);
+			myLCD.drawRect(0, 20, (count % myLCDwidth) + 1, 10, myLCD.FG_COLOR);
+			myManager.panelSubmit(2);
+		}
+
+		myManager.managerStep(); // at most about 3mS of i2c1 and 1mS of spi0
+	}
+}
+/// @endcond
@@ -0,0 +1,137 @@
+/*!
+	@file main.cpp
+	@author Gavin Lyons
+	@brief Test file for SSD1306_OLED library, showing frame rate per second
+		of the dual core pipeline, core0 renders while core1 updates the display.
+	@test
+		-# Test 602 Pipeline FPS test frame rate per second
+*/
+
+// === Libraries ===
+#include <cstdio>
+
+#include "pico/stdlib.h"
+#include "displaylib/ssd1306.hpp"
+#include "displaylib/display_pipeline.hpp"
+
+/// @cond
+
+// Screen settings
+#define myOLEDwidth  128
+#define myOLEDheight 64
+#define myScreenSize (myOLEDwidth * (myOLEDheight/8)) // eg 1024 bytes = 128 * 64/8
+#define mySlots 3 // frame slots in pipeline
+uint8_t slotBuffer[myScreenSize * mySlots]; // Define a buffer to cover the frame slots
+
+// I2C settings
+const uint16_t I2C_Speed = 400;
+const uint8_t I2C_GPIO_CLK = 19;
+const uint8_t I2C_GPIO_DATA = 18;
+
+// instantiate an OLED object and a pipeline for it
+SSD1306 myOLED(myOLEDwidth ,myOLEDheight);
+displaylib_pipeline myPipeline(myOLED);
+
+// =============== Function prototype ================
+
+void SetupTest(void);
+void DisplayFPS(void);
+void EndTests(void);
+
+// ======================= Main ===================
+int main()
+{
+	SetupTest();
+	DisplayFPS();
+	EndTests();
+}
+// ======================= End of main  ===================
+
+void EndTests()
+{
+	myPipeline.pipelineStop();
+	displaylib_pipeline::pipeline_stats_t stats = myPipeline.getStats();
+	printf("Submitted %lu Flushed %lu Dropped %lu Errors %lu\r\n",
+		stats.framesSubmitted, stats.framesFlushed, stats.framesDropped, stats.flushErrors);
+	printf("Latency uS: Avg %lu Max %lu, core0 waited %lu uS\r\n",
+		stats.latencyAvgUs, stats.latencyMaxUs, stats.acquireWaitUs);
+	myOLED.OLEDPowerDown(); // Switch off display
+	myOLED.OLEDdeI2CInit(); 
+	printf("OLED SSD1306 :: End\r\n");
+}
+
+void SetupTest() 
+{
+	stdio_init_all(); // Initialize chosen serial port, default 38400 baud
+	busy_wait_ms(500);
+	printf("OLED SSD1306 :: Start!\r\n");
+	while(myOLED.OLEDbegin(SSD1306::SSD1306_ADDR, i2c1,  I2C_Speed, I2C_GPIO_DATA, I2C_GPIO_CLK) != DisplayRet::Success)
+	{
+		printf("SetupTest ERROR : Failed to initialize OLED!\r\n");
+		busy_wait_ms(1500);
+	} // initialize the OLED
+	myOLED.OLEDFillScreen(0xF0, 0); // splash screen bars
+	busy_wait_ms(1000);
+	if (myPipeline.pipelineStart(slotBuffer, mySlots, displaylib_pipeline::PolicyDropOldest) != DisplayRet::Success)
+	{
+		printf("SetupTest : ERROR : pipelineStart Failed!\r\n");
+		while(1){busy_wait_ms(1000);}
+	} // start core1 flush worker
+}
+
+// Test 602 pipeline FPS frames per second test
+void DisplayFPS()
+{
+	printf("OLED SSD1306 :: Pipeline Frame rate per second test , ends at 1000\r\n");
+	myOLED.setFont(pFontDefault);
+
+	// Values to count frame rate per second
+	long previousMillis = 0;
+	uint32_t lastFlushed = 0;
+	uint16_t count = 0;
+	uint16_t fps = 0;
+	bool colour = 1;
+
+	while (1)
+	{
+		unsigned long currentMillis = to_ms_since_boot(get_absolute_time());
+
+		if (currentMillis - previousMillis >= 1000) // every second
+		{
+			uint32_t flushed = myPipeline.getStats().framesFlushed;
+			fps = flushed - lastFlushed; // frames that reached the display
+			lastFlushed = flushed;
+			previousMillis = currentMillis;
+			colour = !colour;
+			if (count >= 1000)
+				return; // end if count gets to 1000
+		}
+		count++;
+
+		// render next frame into a free slot
+		myOLED.OLEDSetBufferPtr(myOLEDwidth, myOLEDheight, myPipeline.frameAcquire());
+		myOLED.OLEDclearBuffer();
+		myOLED.setCursor(0, 10);
+		myOLED.print("Pipeline");
+
+		myOLED.setCursor(0, 20);
+		myOLED.print("G Lyons");
+
+		myOLED.setCursor(0, 30);
+		myOLED.print(count);
+
+		myOLED.setCursor(0, 40);
+		myOLED.print(fps);
+		myOLED.print(" fps");
+		myOLED.setCursor(0, 50);
+		myOLED.print(__LibVerNum__);
+		myOLED.drawFastVLine(64, 0, 63, myOLED.FG_COLOR);
+
+		myOLED.fillRect(70, 10, 20, 20, colour);
+		myOLED.fillCircle(110, 20, 10, !colour);
+		myOLED.drawRoundRect(80, 40, 40, 20, 10, myOLED.FG_COLOR);
+
+		myPipeline.frameSubmit(); // core1 sends it, core0 carries on
+	}
+}
+/// @endcond
@@ -0,0 +1,144 @@
+/*!
+	@file main.cpp
+	@author Gavin Lyons
+	@brief Test file for SSD1306_OLED library, showing the sprite layer
+	@test
+		1. Test 404 Sprites, balls bouncing over a text background, z-order and collisions
+*/
+
+// === Libraries ===
+#include <cstdio>
+#include "pico/stdlib.h"
+#include "displaylib/ssd1306.hpp"
+#include "displaylib/display_sprite.hpp"
+
+/// @cond
+
+// Screen settings
+#define myOLEDwidth  128
+#define myOLEDheight 64
+#define myScreenSize (myOLEDwidth * (myOLEDheight/8)) // eg 1024 bytes = 128 * 64/8
+uint8_t screenBuffer[myScreenSize]; // Define a buffer to cover whole screen  128 * 64/8
+
+// I2C settings
+const uint16_t SPEED = 100;
+const uint8_t CLK_PIN = 19;
+const uint8_t DATA_PIN = 18;
+
+// instantiate an OLED object and a sprite layer
+#define myBalls 4
+SSD1306 myOLED(myOLEDwidth ,myOLEDheight);
+displaylib_sprite_layer myLayer(myOLED);
+uint8_t spriteSave[myBalls * 16 * 3]; // 16x16 sprites, 16 * (16/8 + 1) bytes each
+
+// 16x16 ball, page layout, a ring with a lit centre
+const uint8_t ballBitmap[32] = {
+	0xE0, 0x18, 0x04, 0x02, 0x02, 0x01, 0xC1, 0xE1, 0xE1, 0xC1, 0x01, 0x02, 0x02, 0x04, 0x18, 0xE0,
+	0x07, 0x18, 0x20, 0x40, 0x40, 0x80, 0x83, 0x87, 0x87, 0x83, 0x80, 0x40, 0x40, 0x20, 0x18, 0x07
+};
+// the mask is the filled disc, so a ball hides what is behind it
+const uint8_t ballMask[32] = {
+	0xE0, 0xF8, 0xFC, 0xFE, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE, 0xFE, 0xFC, 0xF8, 0xE0,
+	0x07, 0x1F, 0x3F, 0x7F, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0x7F, 0x3F, 0x1F, 0x07
+};
+
+// =============== Function prototype ================
+void SetupTest(void);
+void Test(void);
+void EndTest(void);
+
+// ======================= Main ===================
+int main()
+{
+	SetupTest();
+	Test();
+	EndTest();
+}
+// ======================= End of main  ===================
+
+// ===================== Function Space =====================
+void SetupTest()
+{
+	stdio_init_all(); // Initialize chosen serial port, default 38400 baud
+	busy_wait_ms(500);
+	printf("OLED SSD1306 :: Start!\r\n");
+	while(myOLED.OLEDbegin(SSD1306::SSD1306_ADDR, i2c1,  SPEED, DATA_PIN, CLK_PIN) != DisplayRet::Success)
+	{
+		printf("SetupTest ERROR : Failed to initialize OLED!\r\n");
+		busy_wait_ms(1500);
+	} // initialize the OLED
+	if (myOLED.OLEDSetBufferPtr(myOLEDwidth, myOLEDheight, screenBuffer) != DisplayRet::Success)
+	{
+		printf("SetupTest : ERROR : OLEDSetBufferPtr Failed!\r\n");
+		while(1){busy_wait_ms(1000);}
+	} // Initialize the buffer
+	myOLED.OLEDclearBuffer();
+}
+
+void Test()
+{
+	printf("OLED Test 404 Sprites\r\n");
+	// background, drawn once, the sprites never redraw it
+	myOLED.setFont(pFontDefault);
+	for (uint8_t line = 0; line < 8; line++)
+	{
+		myOLED.setCursor(0, line * 8);
+		myOLED.print("Sprites over text ");
+	}
+	myOLED.drawRect(0, 0, myOLEDwidth, myOLEDheight, myOLED.FG_COLOR);
+	if (myLayer.layerBegin(spriteSave) != DisplayRet::Success)
+	{
+		printf("Test : ERROR : layerBegin Failed!\r\n");
+		return;
+	}
+	int8_t speeds[myBalls][2] = {{2, 1}, {-1, 2}, {3, -1}, {-2, -2}};
+	uint8_t balls[myBalls];
+	for (uint8_t ball = 0; ball < myBalls; ball++)
+	{
+		// ball 0 is drawn without a mask, its ring is see through
+		balls[ball] = myLayer.spriteAdd(ballBitmap, (ball == 0) ? std::span<const uint8_t>() : std::span<const uint8_t>(ballMask),
+			16, 16, 10 + ball * 28, 8 + ball * 10, ball);
+		myLayer.spriteSetVelocity(balls[ball], speeds[ball][0], speeds[ball][1]);
+	}
+	myLayer.layerUpdate();
+	myOLED.OLEDupdate(); // whole screen once
+	myLayer.clearDirty();
+
+	uint16_t collisions = 0;
+	for (uint16_t frame = 0; frame < 600; frame++)
+	{
+		// bounce off the edges
+		for (uint8_t ball = 0; ball < myBalls; ball++)
+		{
+			displaylib_flush::flush_rect_t rect = myLayer.getSpriteRect(balls[ball]);
+			int8_t &vx = speeds[ball][0];
+			int8_t &vy = speeds[ball][1];
+			if (rect.x + vx < 0 || rect.x + rect.w + vx > myOLEDwidth)
+				vx = -vx;
+			if (rect.y + vy < 0 || rect.y + rect.h + vy > myOLEDheight)
+				vy = -vy;
+			myLayer.spriteSetVelocity(balls[ball], vx, vy);
+		}
+		// every 100 frames the back ball comes to the front
+		if (frame % 100 == 99)
+			myLayer.spriteSetZ(balls[frame / 100 % myBalls], static_cast<uint8_t>(myBalls + frame / 100));
+		myLayer.layerUpdate();
+		if (myLayer.spriteCollideAny(balls[0]) != displaylib_sprite_layer::SPRITE_NONE)
+			collisions++;
+		myLayer.flushDirty(myOLED); // only the rectangles the balls touched
+		busy_wait_ms(16);
+	}
+	printf("Frames with ball 0 touching another : %u\r\n", collisions);
+	// take the balls off, the text is back as it was
+	myLayer.layerErase();
+	myLayer.flushDirty(myOLED);
+	busy_wait_ms(5000);
+}
+
+void EndTest()
+{
+	myOLED.OLEDPowerDown(); // Switch off display
+	myOLED.OLEDdeI2CInit(); // De-initialize the I2C interface
+	printf("OLED SSD1306 :: End\r\n");
+}
+/// @endcond
@@ -0,0 +1,103 @@
+/*!
+	@file main.cpp
+	@author Gavin Lyons
+	@brief Test file for SSD1306_OLED library, showing the strip chart widget
+	@test
+		1. Test 402 Strip chart, two series, autoscale and a threshold line
+*/
+
+// === Libraries ===
+#include <cmath>
+#include "pico/stdlib.h"
+#include "displaylib/ssd1306.hpp"
+#include "displaylib/display_chart.hpp"
+
+/// @cond
+
+// Screen settings
+#define myOLEDwidth  128
+#define myOLEDheight 64
+#define myScreenSize (myOLEDwidth * (myOLEDheight/8)) // eg 1024 bytes = 128 * 64/8
+uint8_t screenBuffer[myScreenSize]; // Define a buffer to cover whole screen  128 * 64/8
+
+// I2C settings
+const uint16_t SPEED = 100;
+const uint8_t CLK_PIN = 19;
+const uint8_t DATA_PIN = 18;
+
+// instantiate an OLED object and a chart below a title row
+#define myChartWidth 128
+#define myChartSeries 2
+SSD1306 myOLED(myOLEDwidth ,myOLEDheight);
+displaylib_strip_chart myChart(myOLED, 0, 10, myChartWidth, 54);
+int16_t chartHistory[(myChartWidth + 1) * myChartSeries]; // sample history for the chart
+
+// =============== Function prototype ================
+void SetupTest(void);
+void Test(void);
+void EndTest(void);
+
+// ======================= Main ===================
+int main()
+{
+	SetupTest();
+	Test();
+	EndTest();
+}
+// ======================= End of main  ===================
+
+// ===================== Function Space =====================
+void SetupTest()
+{
+	stdio_init_all(); // Initialize chosen serial port, default 38400 baud
+	busy_wait_ms(500);
+	printf("OLED SSD1306 :: Start!\r\n");
+	while(myOLED.OLEDbegin(SSD1306::SSD1306_ADDR, i2c1,  SPEED, DATA_PIN, CLK_PIN) != DisplayRet::Success)
+	{
+		printf("SetupTest ERROR : Failed to initialize OLED!\r\n");
+		busy_wait_ms(1500);
+	} // initialize the OLED
+	if (myOLED.OLEDSetBufferPtr(myOLEDwidth, myOLEDheight, screenBuffer) != DisplayRet::Success)
+	{
+		printf("SetupTest : ERROR : OLEDSetBufferPtr Failed!\r\n");
+		while(1){busy_wait_ms(1000);}
+	} // Initialize the buffer
+	myOLED.OLEDclearBuffer();
+}
+
+void Test()
+{
+	printf("OLED Test 402 Strip chart\r\n");
+	myOLED.setFont(pFontDefault);
+	myOLED.setCursor(0, 0);
+	myOLED.print("Strip chart");
+	if (myChart.chartBegin(chartHistory, myChartSeries) != DisplayRet::Success)
+	{
+		printf("Test : ERROR : chartBegin Failed!\r\n");
+		return;
+	}
+	myChart.setSeriesStyle(1, displaylib_strip_chart::StyleDots);
+	myChart.setThreshold(0, 0);
+	myOLED.OLEDupdate(); // whole screen once
+	myChart.clearDirty();
+
+	// each sample only scrolls the chart and sends the chart rectangle
+	for (uint16_t sample = 0; sample < 500; sample++)
+	{
+		int16_t values[myChartSeries];
+		values[0] = static_cast<int16_t>(100.0f * sinf(sample * 0.1f));
+		values[1] = static_cast<int16_t>(60.0f * cosf(sample * 0.037f));
+		myChart.chartPush(values);
+		myChart.flushDirty(myOLED);
+		busy_wait_ms(20);
+	}
+	busy_wait_ms(5000);
+}
+
+void EndTest()
+{
+	myOLED.OLEDPowerDown(); // Switch off display
+	myOLED.OLEDdeI2CInit(); // De-initialize the I2C interface
+	printf("OLED SSD1306 :: End\r\n");
+}
+/// @endcond
@@ -33,6 +33,7 @@
 #include "pico/stdlib.h"
 #include <vector> // for test 808 and 902 only
 #include "displaylib/ssd1306.hpp"
+#include "displaylib/display_diag.hpp"
 
 /// @cond
 
@@ -570,6 +571,8 @@ void Test808(void)
 	returnValues.push_back(myOLED.writeCharString(5, 5, nullptr)); //throw error 
 	
 	//== SUMMARY SECTION===
+	printf("\nLibrary diagnostics recorded.\n");
+	displaylib_diag::drain();
 	printf("\nError Checking Summary.\n");
 	// Check return values against expected errors
 	for (size_t i = 0; i < returnValues.size(); ++i) {
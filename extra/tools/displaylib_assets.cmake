@@ -0,0 +1,62 @@
+# Bitmap asset pipeline, converts PBM/XBM/PGM images at build time into a header of
+# constexpr arrays in the display page layout, see extra/tools/displaylib_assets.py
+# displaylib_add_assets(<target> <image files>... [HEADER <name.hpp>] [ROTATE <90|180|270>...]
+#   [THRESHOLD <0-255>] [DITHER] [INVERT] [COMPRESS] [GRAY] [ANIMATION <name> [KEYFRAME <n>]])
+# COMPRESS adds run length containers name_rle for displaylib_animation::drawCompressed,
+# left out when larger than the array.
+# ANIMATION makes the files, in order, the frames of one displaylib_animation container.
+# GRAY writes 4 level planes for displaylib_grayscale::grayDrawPlanes instead of 1 bit arrays.
+# The header is generated in the build tree and added to the target include path.
+function(displaylib_add_assets target)
+  cmake_parse_arguments(ASSETS "DITHER;INVERT;COMPRESS;GRAY" "HEADER;THRESHOLD;ANIMATION;KEYFRAME" "ROTATE" ${ARGN})
+  if(NOT ASSETS_UNPARSED_ARGUMENTS)
+    message(FATAL_ERROR "displaylib_add_assets: no image files given")
+  endif()
+  if(NOT ASSETS_HEADER)
+    set(ASSETS_HEADER displaylib_assets.hpp)
+  endif()
+  find_package(Python3 REQUIRED COMPONENTS Interpreter)
+  set(tool ${CMAKE_CURRENT_FUNCTION_LIST_DIR}/displaylib_assets.py)
+  set(outdir ${CMAKE_CURRENT_BINARY_DIR}/displaylib_assets/${target})
+  set(output ${outdir}/${ASSETS_HEADER})
+  set(options)
+  foreach(degrees IN LISTS ASSETS_ROTATE)
+    list(APPEND options --rotate ${degrees})
+  endforeach()
+  if(DEFINED ASSETS_THRESHOLD)
+    list(APPEND options --threshold ${ASSETS_THRESHOLD})
+  endif()
+  if(ASSETS_DITHER)
+    list(APPEND options --dither)
+  endif()
+  if(ASSETS_INVERT)
+    list(APPEND options --invert)
+  endif()
+  if(ASSETS_COMPRESS)
+    list(APPEND options --compress)
+  endif()
+  if(ASSETS_GRAY)
+    list(APPEND options --gray)
+  endif()
+  if(ASSETS_ANIMATION)
+    list(APPEND options --animation ${ASSETS_ANIMATION})
+  endif()
+  if(DEFINED ASSETS_KEYFRAME)
+    list(APPEND options --keyframe ${ASSETS_KEYFRAME})
+  endif()
+  set(files)
+  foreach(file IN LISTS ASSETS_UNPARSED_ARGUMENTS)
+    get_filename_component(file ${file} ABSOLUTE)
+    list(APPEND files ${file})
+  endforeach()
+  file(MAKE_DIRECTORY ${outdir})
+  add_custom_command(OUTPUT ${output}
+    COMMAND ${Python3_EXECUTABLE} ${tool} -o ${output} ${options} ${files}
+    DEPENDS ${tool} ${files}
+    COMMENT "Converting bitmap assets to ${ASSETS_HEADER}"
+    VERBATIM)
+  string(MAKE_C_IDENTIFIER "${target}_${ASSETS_HEADER}" assetsTarget)
+  add_custom_target(${assetsTarget} DEPENDS ${output})
+  add_dependencies(${target} ${assetsTarget})
+  target_include_directories(${target} PRIVATE ${outdir})
+endfunction()
@@ -0,0 +1,382 @@
+#!/usr/bin/env python3
+"""
+@file displaylib_assets.py
+@brief Converts PBM, XBM and PGM images into a C++ header of constexpr
+    std::arrays in the display page layout (vertical addressing), ready
+    for drawBitmap with setDrawBitmapAddr(true).
+@author Gavin Lyons.
+@details Layout: byte index x + (y/8) * width, bit 0 is the top row of the
+    page, the same as the screen buffer of all the drivers. The height is
+    padded to a multiple of 8 with background pixels.
+    Pixel on (foreground): PBM and XBM bit 1, PGM values at or above the
+    threshold (bright is on, the display emits light). --invert swaps this.
+    --compress adds name_rle, the run length container read by displaylib_animation,
+    next to each array, see display_animation.hpp for the format. It is left out,
+    with a warning, when larger than the array, noisy images do not compress.
+    --animation writes only the container of all the files.
+    --gray writes 4 level images for displaylib_grayscale::grayDrawPlanes,
+    two planes one after the other, the low bit of the level then the high bit.
+    Delta frames are the XOR of the last frame, so unchanged bytes become
+    runs of zero that the decoder skips.
+    Used by the CMake function displaylib_add_assets, can be run by hand:
+    python3 displaylib_assets.py -o assets.hpp --rotate 90 icon.pbm photo.pgm
+    python3 displaylib_assets.py -o walk.hpp --animation walk --keyframe 8 walk*.pbm
+    python3 displaylib_assets.py -o splash.hpp --gray --dither splash.pgm
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+ANIMATION_VERSION = 1
+FRAME_KEY = 0
+FRAME_DELTA = 1
+
+
+def read_tokens(data, count, pos):
+    """Reads count whitespace separated header tokens of a netpbm file, skips comments."""
+    tokens = []
+    while len(tokens) < count:
+        while pos < len(data) and chr(data[pos]).isspace():
+            pos += 1
+        if pos < len(data) and data[pos] == ord('#'):
+            while pos < len(data) and data[pos] not in (0x0A, 0x0D):
+                pos += 1
+            continue
+        start = pos
+        while pos < len(data) and not chr(data[pos]).isspace() and data[pos] != ord('#'):
+            pos += 1
+        if start == pos:
+            raise ValueError("truncated header")
+        tokens.append(data[start:pos].decode("ascii"))
+    return tokens, pos
+
+
+def load_pbm(data):
+    """PBM P1 or P4, returns width, height and rows of 0/1, 1 is on."""
+    (magic, width, height), pos = read_tokens(data, 3, 0)
+    width, height = int(width), int(height)
+    if magic == "P1":
+        bits = [int(c) for c in data[pos:].decode("ascii") if c in "01"]
+        if len(bits) < width * height:
+            raise ValueError("truncated P1 data")
+        return width, height, [bits[y * width:(y + 1) * width] for y in range(height)]
+    pos += 1  # single whitespace before raster
+    stride = (width + 7) // 8
+    rows = []
+    for y in range(height):
+        line = data[pos + y * stride:pos + (y + 1) * stride]
+        if len(line) < stride:
+            raise ValueError("truncated P4 data")
+        rows.append([(line[x // 8] >> (7 - (x & 7))) & 1 for x in range(width)])
+    return width, height, rows
+
+
+def load_pgm(data):
+    """PGM P2 or P5, returns width, height and rows of 0-255 grey."""
+    (magic, width, height, maxval), pos = read_tokens(data, 4, 0)
+    width, height, maxval = int(width), int(height), int(maxval)
+    if magic == "P2":
+        values = [int(v) for v in data[pos:].decode("ascii").split()]
+    else:
+        pos += 1
+        size = 2 if maxval > 255 else 1
+        raster = data[pos:pos + width * height * size]
+        if size == 2:
+            values = [(raster[i] << 8) | raster[i + 1] for i in range(0, len(raster), 2)]
+        else:
+            values = list(raster)
+    if len(values) < width * height:
+        raise ValueError("truncated PGM data")
+    scaled = [(v * 255) // maxval for v in values[:width * height]]
+    return width, height, [scaled[y * width:(y + 1) * width] for y in range(height)]
+
+
+def load_xbm(data):
+    """XBM, returns width, height and rows of 0/1, 1 is on."""
+    text = data.decode("ascii", errors="replace")
+    width = re.search(r"#define\s+\w*_width\s+(\d+)", text)
+    height = re.search(r"#define\s+\w*_height\s+(\d+)", text)
+    if not width or not height:
+        raise ValueError("no _width/_height defines")
+    width, height = int(width.group(1)), int(height.group(1))
+    body = text[text.index("{") + 1:text.rindex("}")]
+    values = [int(v, 16) for v in re.findall(r"0[xX]([0-9a-fA-F]+)", body)]
+    stride = (width + 7) // 8
+    if len(values) < stride * height:
+        raise ValueError("truncated XBM data")
+    return width, height, [[(values[y * stride + x // 8] >> (x & 7)) & 1 for x in range(width)]
+                           for y in range(height)]
+
+
+def threshold(rows, level):
+    """Grey to 0/1, on at or above level."""
+    return [[1 if v >= level else 0 for v in row] for row in rows]
+
+
+def dither(rows):
+    """Grey to 0/1, Floyd-Steinberg error diffusion."""
+    height, width = len(rows), len(rows[0])
+    work = [list(map(float, row)) for row in rows]
+    out = [[0] * width for _ in range(height)]
+    for y in range(height):
+        for x in range(width):
+            old = work[y][x]
+            new = 255.0 if old >= 128.0 else 0.0
+            out[y][x] = 1 if new else 0
+            err = old - new
+            if x + 1 < width:
+                work[y][x + 1] += err * 7 / 16
+            if y + 1 < height:
+                if x > 0:
+                    work[y + 1][x - 1] += err * 3 / 16
+                work[y + 1][x] += err * 5 / 16
+                if x + 1 < width:
+                    work[y + 1][x + 1] += err * 1 / 16
+    return out
+
+
+def quantize(rows, dither_rows):
+    """Grey to levels 0-3, rounded to the nearest or Floyd-Steinberg dithered."""
+    if not dither_rows:
+        return [[(v * 3 + 127) // 255 for v in row] for row in rows]
+    height, width = len(rows), len(rows[0])
+    work = [list(map(float, row)) for row in rows]
+    out = [[0] * width for _ in range(height)]
+    for y in range(height):
+        for x in range(width):
+            old = min(max(work[y][x], 0.0), 255.0)
+            level = int(old * 3 / 255 + 0.5)
+            out[y][x] = level
+            err = old - level * 85.0
+            if x + 1 < width:
+                work[y][x + 1] += err * 7 / 16
+            if y + 1 < height:
+                if x > 0:
+                    work[y + 1][x - 1] += err * 3 / 16
+                work[y + 1][x] += err * 5 / 16
+                if x + 1 < width:
+                    work[y + 1][x + 1] += err * 1 / 16
+    return out
+
+
+def rotate(rows, degrees):
+    """Rotates clockwise, the same direction as setRotation."""
+    for _ in range((degrees // 90) % 4):
+        rows = [list(col) for col in zip(*rows[::-1])]
+    return rows
+
+
+def to_pages(rows):
+    """0/1 rows to page layout bytes, height padded to a multiple of 8."""
+    height, width = len(rows), len(rows[0])
+    pages = (height + 7) // 8
+    out = bytearray(width * pages)
+    for y in range(height):
+        for x in range(width):
+            if rows[y][x]:
+                out[x + (y // 8) * width] |= 1 << (y & 7)
+    return out, pages * 8
+
+
+def to_planes(rows):
+    """Level 0-3 rows to two page layout planes, low bit then high bit."""
+    low, padded = to_pages([[v & 1 for v in row] for row in rows])
+    high = to_pages([[v >> 1 for v in row] for row in rows])[0]
+    return low + high, padded
+
+
+def pack_runs(data):
+    """PackBits style runs: 0x00-0x7F literal of n+1 bytes, 0x80-0xFF repeat next byte n-0x80+2 times."""
+    out = bytearray()
+    literal = bytearray()
+    pos = 0
+    while pos < len(data):
+        run = 1
+        while pos + run < len(data) and run < 129 and data[pos + run] == data[pos]:
+            run += 1
+        if run >= 2:
+            if literal:
+                out += bytes([len(literal) - 1]) + literal
+                literal = bytearray()
+            out += bytes([0x80 + run - 2, data[pos]])
+            pos += run
+            continue
+        literal.append(data[pos])
+        pos += 1
+        if len(literal) == 128:
+            out += bytes([127]) + literal
+            literal = bytearray()
+    if literal:
+        out += bytes([len(literal) - 1]) + literal
+    return out
+
+
+def pack_frames(frames, width, pages, height, keyframe):
+    """Container of page layout frames, a delta frame is used when smaller than a key frame."""
+    packed = []
+    last = None
+    for index, data in enumerate(frames):
+        key = bytes([FRAME_KEY]) + pack_runs(data)
+        if last is not None and not (keyframe and index % keyframe == 0):
+            delta = bytes([FRAME_DELTA]) + pack_runs(bytes(a ^ b for a, b in zip(data, last)))
+            if len(delta) < len(key):
+                key = delta
+        packed.append(key)
+        last = data
+    out = bytearray(struct.pack("<HBBHH", width, pages, ANIMATION_VERSION, len(frames), height))
+    offset = len(out) + 4 * len(frames)
+    for frame in packed:
+        out += struct.pack("<I", offset)
+        offset += len(frame)
+    for frame in packed:
+        out += frame
+    return out
+
+
+def c_name(path):
+    """Identifier from the file name."""
+    name = re.sub(r"\W", "_", os.path.splitext(os.path.basename(path))[0])
+    return ("_" + name) if name[0].isdigit() else name
+
+
+def load(path, args):
+    """Loads an image as rows of 0/1, or of levels 0-3 with --gray."""
+    gray = getattr(args, "gray", False)  # the args of other tools have no --gray
+    with open(path, "rb") as handle:
+        data = handle.read()
+    if data[:2] in (b"P1", b"P4"):
+        width, height, rows = load_pbm(data)
+    elif data[:2] in (b"P2", b"P5"):
+        width, height, rows = load_pgm(data)
+        if gray:
+            rows = quantize(rows, args.dither)
+        else:
+            rows = dither(rows) if args.dither else threshold(rows, args.threshold)
+    elif b"#define" in data:
+        width, height, rows = load_xbm(data)
+    else:
+        raise ValueError("not a PBM, PGM or XBM file")
+    top = 1
+    if gray:
+        top = 3
+        if data[:2] not in (b"P2", b"P5"):
+            rows = [[v * 3 for v in row] for row in rows]
+    if args.invert:
+        rows = [[top - v for v in row] for row in rows]
+    return width, height, rows
+
+
+def emit(out, name, note, rows, keyframe=None, frames=None, gray=False):
+    """Writes one array and its size constants, keyframe not None writes the compressed container.
+    Returns the bytes written, None if the container of one image is larger than its array and left out."""
+    data, padded = to_planes(rows) if gray else to_pages(rows)
+    width, height = len(rows[0]), padded
+    if gray:
+        note += ", 2 bit planes for displaylib_grayscale"
+    if keyframe is not None:
+        raw = len(data) * len(frames or [rows])
+        height = len(rows)
+        data = pack_frames([to_pages(frame)[0] for frame in (frames or [rows])], width, padded // 8, height, keyframe)
+        print("displaylib_assets: %s %d -> %d bytes, %.1f%%" % (name, raw, len(data), 100.0 * len(data) / raw),
+              file=sys.stderr)
+        if len(data) > raw:
+            if frames is None:
+                print("displaylib_assets: warning: %s left out, larger than the %d byte array" % (name, raw),
+                      file=sys.stderr)
+                return None
+            print("displaylib_assets: warning: %s is larger than the %d bytes of the frames" % (name, raw),
+                  file=sys.stderr)
+        note += ", compressed for displaylib_animation"
+    out.append("// '%s' %dx%d px, VERTICAL page addressing, %s" % (name, width, height, note))
+    out.append("inline constexpr int16_t %s_width = %d;" % (name, width))
+    out.append("inline constexpr int16_t %s_height = %d;" % (name, height))
+    out.append("inline constexpr std::array<uint8_t, %d> %s = {" % (len(data), name))
+    for start in range(0, len(data), 16):
+        out.append("\t" + ", ".join("0x%02x" % b for b in data[start:start + 16]) + ",")
+    out.append("};")
+    out.append("")
+    return len(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert PBM/XBM/PGM images to page layout C++ arrays")
+    parser.add_argument("files", nargs="+", help="image files, the array is named after the file")
+    parser.add_argument("-o", "--output", required=True, help="header file to write")
+    parser.add_argument("--rotate", type=int, action="append", default=[], choices=[90, 180, 270],
+                        help="also emit a variant rotated clockwise, name_r90 etc, may repeat")
+    parser.add_argument("--threshold", type=int, default=128, help="PGM on level 0-255, default 128")
+    parser.add_argument("--dither", action="store_true", help="PGM Floyd-Steinberg dither instead of threshold")
+    parser.add_argument("--invert", action="store_true", help="swap on and off pixels")
+    parser.add_argument("--gray", action="store_true",
+                        help="write 4 level planes name_gray for grayDrawPlanes, PGM rounded or --dither")
+    parser.add_argument("--compress", action="store_true",
+                        help="also write run length containers name_rle for drawCompressed, "
+                        "left out when larger than the array")
+    parser.add_argument("--animation", metavar="NAME",
+                        help="write all files, same size, as the frames of one animation container NAME")
+    parser.add_argument("--keyframe", type=int, default=0, metavar="N",
+                        help="animation key frame every N frames, default only the first")
+    args = parser.parse_args()
+    if args.animation and args.rotate:
+        parser.error("--rotate can not be used with --animation")
+    if args.gray and (args.compress or args.animation):
+        parser.error("--gray can not be used with --compress or --animation")
+
+    guard = os.path.basename(args.output)
+    out = ["/*!",
+           "\t@file %s" % guard,
+           "\t@brief Bitmaps generated by displaylib_assets.py, do not edit.",
+           "\t@details Page layout, draw with setDrawBitmapAddr(true) and drawBitmap,",
+           "\t\tcompressed containers with displaylib_animation, 4 level planes with",
+           "\t\tdisplaylib_grayscale::grayDrawPlanes.",
+           "*/",
+           "",
+           "#pragma once",
+           "",
+           "#include <array>",
+           "#include <cstdint>",
+           ""]
+    total = 0
+    frames = []
+    for path in args.files:
+        try:
+            width, height, rows = load(path, args)
+        except (OSError, ValueError) as error:
+            sys.exit("displaylib_assets: %s: %s" % (path, error))
+        if args.animation:
+            if frames and (width != len(frames[0][0]) or height != len(frames[0])):
+                sys.exit("displaylib_assets: %s: frame size %dx%d differs from the first frame" % (path, width, height))
+            frames.append(rows)
+            continue
+        name = c_name(path)
+        suffix = "_gray" if args.gray else ""
+        variants = [(name + suffix, "from " + os.path.basename(path), rows)]
+        for degrees in args.rotate:
+            variants.append(("%s_r%d%s" % (name, degrees, suffix), "rotated %d clockwise" % degrees,
+                             rotate(rows, degrees)))
+        written = []
+        for variant, note, image in variants:
+            total += emit(out, variant, note, image, gray=args.gray)
+            written.append(variant)
+            if args.compress:
+                size = emit(out, variant + "_rle", note, image, args.keyframe)
+                if size is not None:
+                    total += size
+                    written.append(variant + "_rle")
+        print("displaylib_assets: %s %dx%d -> %s" % (path, width, height, ", ".join(written)), file=sys.stderr)
+    if frames:
+        name = c_name(args.animation)
+        total += emit(out, name, "%d frames" % len(frames), frames[0], args.keyframe, frames)
+        print("displaylib_assets: %d frames %dx%d -> %s" % (len(frames), len(frames[0][0]), len(frames[0]), name),
+              file=sys.stderr)
+
+    with open(args.output, "w") as handle:
+        handle.write("\n".join(out))
+    print("displaylib_assets: %s, %d bytes of bitmap data" % (args.output, total), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
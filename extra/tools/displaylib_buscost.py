@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+"""
+@file displaylib_buscost.py
+@brief Bus cost model, predicts frame times from a bus trace recorded with
+    busTraceDump (_BUS_TRACE_ENABLE in display_flush.hpp), for I2C at
+    100/400/1000 kHz and SPI at any baud, and checks bytes on the wire
+    against a baseline trace.
+@author Gavin Lyons.
+@details Trace lines are time_us,event,value: W write of value bytes, F failed
+    write, D DC line, C CS line, R frame end, lines starting # are comments.
+    A trace with D or C records is taken as SPI, else I2C, --bus overrides.
+    I2C write: START, address byte and each byte 9 clocks with the ACK, STOP,
+    so 9 * (bytes + 1) + 2 clocks, plus a per write software overhead.
+    A failed write costs the address byte. SPI write: 8 clocks a byte plus
+    a per write overhead, each DC or CS toggle adds a GPIO cost.
+    The overheads are CPU time on an RP2040 at 125 MHz, measure your own by
+    recording a trace at a known clock and passing --measured.
+    Can be imported, load_trace, frames, predict_i2c and predict_spi.
+    python3 displaylib_buscost.py trace.csv
+    python3 displaylib_buscost.py --spi 4000000,8000000 trace.csv
+    python3 displaylib_buscost.py --baseline main_trace.csv --tolerance 2 trace.csv
+"""
+
+import argparse
+import sys
+
+I2C_KHZ_DEFAULT = "100,400,1000"
+SPI_BAUD_DEFAULT = "1000000,4000000,8000000"
+I2C_OVERHEAD_US = 6.0   # i2c_write_timeout_us call, FIFO start and wait for STOP
+SPI_OVERHEAD_US = 1.5   # spi_write_blocking call and drain of the FIFO
+GPIO_US = 0.05          # gpio_put
+
+
+def load_trace(path):
+    """Returns a list of (time_us, event, value)."""
+    records = []
+    with open(path, "r", encoding="latin-1") as handle:
+        for number, line in enumerate(handle, 1):
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            parts = line.split(",")
+            if len(parts) != 3 or parts[1] not in "WFDCR" or len(parts[1]) != 1:
+                raise ValueError("line %d: not a trace record: %r" % (number, line))
+            records.append((int(parts[0]), parts[1], int(parts[2])))
+    return records
+
+
+def frames(records):
+    """Splits the records at frame ends, records after the last frame end are
+    returned as a last partial frame if there are writes in them."""
+    result, current = [], []
+    for record in records:
+        if record[1] == "R":
+            result.append(current)
+            current = []
+        else:
+            current.append(record)
+    if any(record[1] in "WF" for record in current):
+        result.append(current)
+    return result
+
+
+def counts(records):
+    """Writes, bytes and GPIO toggles of a list of records."""
+    writes = sum(1 for r in records if r[1] in "WF")
+    data = sum(r[2] for r in records if r[1] == "W")
+    toggles = sum(1 for r in records if r[1] in "DC")
+    return writes, data, toggles
+
+
+def predict_i2c(records, khz, overhead_us=I2C_OVERHEAD_US):
+    """Predicted bus time in uS at an I2C clock of khz."""
+    clock_us = 1000.0 / khz
+    total = 0.0
+    for _, event, value in records:
+        if event == "W":
+            total += (9 * (value + 1) + 2) * clock_us + overhead_us
+        elif event == "F":
+            total += (9 + 2) * clock_us + overhead_us
+    return total
+
+
+def predict_spi(records, baud, overhead_us=SPI_OVERHEAD_US, gpio_us=GPIO_US):
+    """Predicted bus time in uS at an SPI baud rate."""
+    clock_us = 1000000.0 / baud
+    total = 0.0
+    for _, event, value in records:
+        if event == "W":
+            total += 8 * value * clock_us + overhead_us
+        elif event in "DC":
+            total += gpio_us
+    return total
+
+
+def parse_list(text, scale=1):
+    return [int(float(v) * scale) for v in text.split(",") if v]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Predict display bus time from a displaylib bus trace")
+    parser.add_argument("trace", help="trace file, busTraceDump output")
+    parser.add_argument("--bus", choices=["i2c", "spi"], help="bus of the trace, default from the records")
+    parser.add_argument("--i2c", default=I2C_KHZ_DEFAULT, help="I2C clocks, kHz, default " + I2C_KHZ_DEFAULT)
+    parser.add_argument("--spi", default=SPI_BAUD_DEFAULT, help="SPI baud rates, default " + SPI_BAUD_DEFAULT)
+    parser.add_argument("--i2c-overhead", type=float, default=I2C_OVERHEAD_US, help="uS per I2C write")
+    parser.add_argument("--spi-overhead", type=float, default=SPI_OVERHEAD_US, help="uS per SPI write")
+    parser.add_argument("--gpio", type=float, default=GPIO_US, help="uS per DC/CS toggle")
+    parser.add_argument("--measured", type=float, metavar="CLOCK",
+                        help="clock of the recording, kHz for I2C or baud for SPI, prints recorded against predicted")
+    parser.add_argument("--baseline", help="trace to compare bytes and writes per frame against")
+    parser.add_argument("--tolerance", type=float, default=0.0, help="percent increase allowed over the baseline")
+    args = parser.parse_args()
+
+    try:
+        records = load_trace(args.trace)
+        baseline = load_trace(args.baseline) if args.baseline else None
+    except (OSError, ValueError) as error:
+        sys.exit("displaylib_buscost: %s" % error)
+    if not any(r[1] in "WF" for r in records):
+        sys.exit("displaylib_buscost: %s: no writes in trace" % args.trace)
+    bus = args.bus or ("spi" if any(r[1] in "DC" for r in records) else "i2c")
+    if bus == "i2c":
+        configs = [("I2C %4d kHz" % khz, lambda recs, khz=khz: predict_i2c(recs, khz, args.i2c_overhead))
+                   for khz in parse_list(args.i2c)]
+    else:
+        configs = [("SPI %5.2f MHz" % (baud / 1e6), lambda recs, baud=baud: predict_spi(recs, baud, args.spi_overhead, args.gpio))
+                   for baud in parse_list(args.spi)]
+
+    frame_list = frames(records)
+    writes, data, toggles = counts(records)
+    print("%s: %s trace, %d frames, %d writes, %d bytes, %d DC/CS toggles"
+          % (args.trace, bus.upper(), len(frame_list), writes, data, toggles))
+    print("%-14s %12s %12s %10s" % ("bus", "avg frame uS", "max frame uS", "max fps"))
+    for name, predict in configs:
+        times = [predict(frame) for frame in frame_list]
+        average = sum(times) / len(times)
+        print("%-14s %12.0f %12.0f %10.1f" % (name, average, max(times), 1e6 / average if average else 0.0))
+
+    if args.measured:
+        predict = (lambda recs: predict_i2c(recs, args.measured, args.i2c_overhead)) if bus == "i2c" else \
+            (lambda recs: predict_spi(recs, args.measured, args.spi_overhead, args.gpio))
+        print("recorded at %g: frame, recorded uS, predicted uS" % args.measured)
+        for number, frame in enumerate(frame_list):
+            writes_at = [r[0] for r in frame if r[1] in "WF"]
+            if len(writes_at) > 1:
+                # time stamps are taken after each write, so the first write is not in the span
+                first = next(i for i, r in enumerate(frame) if r[1] in "WF")
+                print("%5d %12d %12.0f" % (number, writes_at[-1] - writes_at[0], predict(frame[first + 1:])))
+
+    if baseline is not None:
+        base_frames = frames(baseline)
+        if not base_frames:
+            sys.exit("displaylib_buscost: %s: no frames in baseline" % args.baseline)
+        failed = False
+        for label, now, then in (("bytes/frame", data / len(frame_list), counts(baseline)[1] / len(base_frames)),
+                                 ("writes/frame", writes / len(frame_list), counts(baseline)[0] / len(base_frames)),
+                                 ("toggles/frame", toggles / len(frame_list), counts(baseline)[2] / len(base_frames))):
+            change = ((now - then) * 100.0 / then) if then else (100.0 if now else 0.0)
+            over = change > args.tolerance
+            failed = failed or over
+            print("%-14s baseline %10.1f now %10.1f change %+7.2f%%%s" % (label, then, now, change, "  REGRESSION" if over else ""))
+        if failed:
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,544 @@
+#!/usr/bin/env python3
+"""
+@file displaylib_capture.py
+@brief Bus capture decoder, reads a capture recorded with busCaptureDump
+    (_BUS_CAPTURE_ENABLE in display_flush.hpp), decodes it against the
+    command set of the controller and exports it as CSV or VCD, rebuilds
+    the display RAM, and reports redundant command traffic.
+@author Gavin Lyons.
+@details Capture lines are time_us,context,hex bytes: C SPI command (DC low),
+    D SPI data (DC high), I I2C with the control byte first, lower case if the
+    write failed. Lines starting # are comments. The time is taken at the end
+    of the write. Failed writes are listed but not applied to the RAM.
+    The RAM model: SSD1306 horizontal, vertical and page addressing, SH1106,
+    SH1107 and CH1115 page addressing, UC1609 column first with wrap, as the
+    driver sets it, PCD8544 horizontal and vertical addressing.
+    Can be imported, load_capture, decode, Controller and CONTROLLERS.
+    python3 displaylib_capture.py --controller ssd1306 capture.txt
+    python3 displaylib_capture.py --controller pcd8544 --csv out.csv --vcd out.vcd capture.txt
+    python3 displaylib_capture.py --controller ssd1306 --ram new.pbm --compare main_capture.txt capture.txt
+"""
+
+import argparse
+import sys
+
+# Command tables, (first opcode, last opcode, name, argument bytes, group).
+# Commands in a group set one setting, re-sending the last value is redundant.
+# Group "addr" commands move the RAM pointer, they are checked against it.
+
+SSD1306_COMMANDS = [
+    (0x00, 0x0F, "SSD1306_SET_LOWER_COLUMN", 0, "addr"),
+    (0x10, 0x1F, "SSD1306_SET_HIGHER_COLUMN", 0, "addr"),
+    (0x20, 0x20, "SSD1306_MEMORY_ADDR_MODE", 1, "addrmode"),
+    (0x21, 0x21, "SSD1306_SET_COLUMN_ADDR", 2, "addr"),
+    (0x22, 0x22, "SSD1306_SET_PAGE_ADDR", 2, "addr"),
+    (0x26, 0x26, "SSD1306_RIGHT_HORIZONTAL_SCROLL", 6, "scrollsetup"),
+    (0x27, 0x27, "SSD1306_LEFT_HORIZONTAL_SCROLL", 6, "scrollsetup"),
+    (0x29, 0x29, "SSD1306_VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL", 5, "scrollsetup"),
+    (0x2A, 0x2A, "SSD1306_VERTICAL_AND_LEFT_HORIZONTAL_SCROLL", 5, "scrollsetup"),
+    (0x2E, 0x2E, "SSD1306_DEACTIVATE_SCROLL", 0, "scroll"),
+    (0x2F, 0x2F, "SSD1306_ACTIVATE_SCROLL", 0, None),
+    (0x40, 0x7F, "SSD1306_SET_START_LINE", 0, "startline"),
+    (0x81, 0x81, "SSD1306_SET_CONTRAST_CONTROL", 1, "contrast"),
+    (0x8D, 0x8D, "SSD1306_CHARGE_PUMP", 1, "pump"),
+    (0xA0, 0xA1, "SSD1306_SET_SEGMENT_REMAP", 0, "remap"),
+    (0xA3, 0xA3, "SSD1306_SET_VERTICAL_SCROLL_AREA", 2, "scrollarea"),
+    (0xA4, 0xA4, "SSD1306_DISPLAY_ALL_ON_RESUME", 0, "allon"),
+    (0xA5, 0xA5, "SSD1306_DISPLAY_ALL_ON", 0, "allon"),
+    (0xA6, 0xA6, "SSD1306_NORMAL_DISPLAY", 0, "invert"),
+    (0xA7, 0xA7, "SSD1306_INVERT_DISPLAY", 0, "invert"),
+    (0xA8, 0xA8, "SSD1306_SET_MULTIPLEX_RATIO", 1, "mux"),
+    (0xAE, 0xAE, "SSD1306_DISPLAY_OFF", 0, "display"),
+    (0xAF, 0xAF, "SSD1306_DISPLAY_ON", 0, "display"),
+    (0xB0, 0xB7, "SSD1306_SET_PAGE_START", 0, "addr"),
+    (0xC0, 0xC0, "SSD1306_COM_SCAN_DIR_INC", 0, "comscan"),
+    (0xC8, 0xC8, "SSD1306_COM_SCAN_DIR_DEC", 0, "comscan"),
+    (0xD3, 0xD3, "SSD1306_SET_DISPLAY_OFFSET", 1, "offset"),
+    (0xD5, 0xD5, "SSD1306_SET_DISPLAY_CLOCK_DIV_RATIO", 1, "clockdiv"),
+    (0xD9, 0xD9, "SSD1306_SET_PRECHARGE_PERIOD", 1, "precharge"),
+    (0xDA, 0xDA, "SSD1306_SET_COM_PINS", 1, "compins"),
+    (0xDB, 0xDB, "SSD1306_SET_VCOM_DESELECT", 1, "vcom"),
+    (0xE3, 0xE3, "SSD1306_NOP", 0, None),
+]
+
+SH110X_COMMON = [
+    (0x00, 0x0F, "SH110X_SETLOWCOLUMN", 0, "addr"),
+    (0x10, 0x1F, "SH110X_SETHIGHCOLUMN", 0, "addr"),
+    (0x81, 0x81, "SH110X_SETCONTRAST", 1, "contrast"),
+    (0x8D, 0x8D, "SH110X_CHARGEPUMP", 1, "pump"),
+    (0xA0, 0xA1, "SH110X_SEGREMAP", 0, "remap"),
+    (0xA4, 0xA4, "SH110X_DISPLAYALLON_RESUME", 0, "allon"),
+    (0xA5, 0xA5, "SH110X_DISPLAYALLON", 0, "allon"),
+    (0xA6, 0xA6, "SH110X_NORMALDISPLAY", 0, "invert"),
+    (0xA7, 0xA7, "SH110X_INVERTDISPLAY", 0, "invert"),
+    (0xA8, 0xA8, "SH110X_SETMULTIPLEX", 1, "mux"),
+    (0xAD, 0xAD, "SH110X_DCDC", 1, "dcdc"),
+    (0xAE, 0xAE, "SH110X_DISPLAYOFF", 0, "display"),
+    (0xAF, 0xAF, "SH110X_DISPLAYON", 0, "display"),
+    (0xC0, 0xC7, "SH110X_COMSCANINC", 0, "comscan"),
+    (0xC8, 0xCF, "SH110X_COMSCANDEC", 0, "comscan"),
+    (0xD3, 0xD3, "SH110X_SETDISPLAYOFFSET", 1, "offset"),
+    (0xD5, 0xD5, "SH110X_SETDISPLAYCLOCKDIV", 1, "clockdiv"),
+    (0xD9, 0xD9, "SH110X_SETPRECHARGE", 1, "precharge"),
+    (0xDA, 0xDA, "SH110X_SETCOMPINS", 1, "compins"),
+    (0xDB, 0xDB, "SH110X_SETVCOMDETECT", 1, "vcom"),
+    (0xE0, 0xE0, "SH110X_READMODIFYWRITE", 0, None),
+    (0xE3, 0xE3, "SH110X_NOP", 0, None),
+    (0xEE, 0xEE, "SH110X_END", 0, None),
+]
+
+# The driver sends SH110X_MEMORYMODE with an argument to the SH1106, as the SSD1306
+SH1106_COMMANDS = SH110X_COMMON + [
+    (0x20, 0x20, "SH110X_MEMORYMODE", 1, "addrmode"),
+    (0x30, 0x33, "SH1106_SETPUMPVOLTAGE", 0, "pumpvolt"),
+    (0x40, 0x7F, "SH110X_SETSTARTLINE", 0, "startline"),
+    (0xB0, 0xB7, "SH110X_SETPAGEADDR", 0, "addr"),
+]
+
+SH1107_COMMANDS = SH110X_COMMON + [
+    (0x20, 0x21, "SH110X_MEMORYMODE", 0, "addrmode"),
+    (0xB0, 0xBF, "SH110X_SETPAGEADDR", 0, "addr"),
+    (0xDC, 0xDC, "SH110X_SETDISPSTARTLINE", 1, "startline"),
+]
+
+CH1115_COMMANDS = [
+    (0x00, 0x0F, "ERMCH1115_SET_COLADD_LSB", 0, "addr"),
+    (0x10, 0x1F, "ERMCH1115_SET_COLADD_MSB", 0, "addr"),
+    (0x23, 0x23, "ERMCH1115_BREATHEFFECT_SET", 1, "breath"),
+    (0x24, 0x24, "ERMCH1115_HORIZONTAL_A_SCROLL_SETUP", 2, "scrollcols"),
+    (0x26, 0x27, "ERMCH1115_SCROLL_SETUP", 3, "scrollsetup"),
+    (0x28, 0x2B, "ERMCH1115_SET_SCROLL_MODE", 0, "scrollmode"),
+    (0x2E, 0x2E, "ERMCH1115_DEACTIVATE_SCROLL", 0, "scroll"),
+    (0x2F, 0x2F, "ERMCH1115_ACTIVATE_SCROLL", 0, None),
+    (0x30, 0x33, "ERMCH1115_SET_PUMP_REG", 0, "pumpvolt"),
+    (0x40, 0x7F, "ERMCH1115_SET_DISPLAY_START_LINE", 0, "startline"),
+    (0x81, 0x81, "ERMCH1115_CONTRAST_CONTROL", 1, "contrast"),
+    (0x82, 0x82, "ERMCH1115_IREF_REG", 1, "iref"),
+    (0xA0, 0xA1, "ERMCH1115_SEG_SET_REMAP", 0, "remap"),
+    (0xA2, 0xA3, "ERMCH1115_SEG_SET_PADS", 0, "pads"),
+    (0xA4, 0xA4, "ERMCH1115_ENTIRE_DISPLAY_ON", 0, "allon"),
+    (0xA5, 0xA5, "ERMCH1115_ENTIRE_DISPLAY_OFF", 0, "allon"),
+    (0xA6, 0xA6, "ERMCH1115_DISPLAY_NORMAL", 0, "invert"),
+    (0xA7, 0xA7, "ERMCH1115_DISPLAY_INVERT", 0, "invert"),
+    (0xA8, 0xA8, "ERMCH1115_MULTIPLEX_MODE_SET", 1, "mux"),
+    (0xAD, 0xAD, "ERMCH1115_DC_MODE_SET", 1, "dcdc"),
+    (0xAE, 0xAE, "ERMCH1115_DISPLAY_OFF", 0, "display"),
+    (0xAF, 0xAF, "ERMCH1115_DISPLAY_ON", 0, "display"),
+    (0xB0, 0xB7, "ERMCH1115_SET_PAGEADD", 0, "addr"),
+    (0xC0, 0xCF, "ERMCH1115_COMMON_SCAN_DIR", 0, "comscan"),
+    (0xD3, 0xD3, "ERMCH1115_OFFSET_MODE_SET", 1, "offset"),
+    (0xD5, 0xD5, "ERMCH1115_OSC_FREQ_MODE_SET", 1, "clockdiv"),
+    (0xD9, 0xD9, "ERMCH1115_PRECHARGE_MODE_SET", 1, "precharge"),
+    (0xDB, 0xDB, "ERMCH1115_COM_LEVEL_MODE_SET", 1, "vcom"),
+    (0xE3, 0xE3, "ERMCH1115_NOP", 0, None),
+]
+
+UC1609_COMMANDS = [
+    (0x00, 0x0F, "UC1609_SET_COLADD_LSB", 0, "addr"),
+    (0x10, 0x1F, "UC1609_SET_COLADD_MSB", 0, "addr"),
+    (0x24, 0x27, "UC1609_TEMP_COMP_REG", 0, "tempcomp"),
+    (0x28, 0x2F, "UC1609_POWER_CONTROL", 0, "power"),
+    (0x40, 0x7F, "UC1609_SCROLL", 0, "startline"),
+    (0x81, 0x81, "UC1609_GN_PM", 1, "contrast"),
+    (0x88, 0x8F, "UC1609_ADDRESS_CONTROL", 0, "addrmode"),
+    (0xA0, 0xA3, "UC1609_FRAMERATE_REG", 0, "framerate"),
+    (0xA4, 0xA5, "UC1609_ALL_PIXEL_ON", 0, "allon"),
+    (0xA6, 0xA7, "UC1609_INVERSE_DISPLAY", 0, "invert"),
+    (0xAE, 0xAF, "UC1609_DISPLAY_ON", 0, "display"),
+    (0xB0, 0xB7, "UC1609_SET_PAGEADD", 0, "addr"),
+    (0xC0, 0xC7, "UC1609_LCD_CONTROL", 0, "mapping"),
+    (0xE2, 0xE2, "UC1609_SYSTEM_RESET", 0, None),
+    (0xE3, 0xE3, "UC1609_NOP", 0, None),
+    (0xE8, 0xEB, "UC1609_BIAS_RATIO", 0, "bias"),
+]
+
+# PCD8544, the H bit of function set selects the instruction set
+PCD8544_BASIC = [
+    (0x08, 0x0F, "LCD_DISPLAYCONTROL", 0, "displaycontrol"),
+    (0x40, 0x47, "LCD_SETYADDR", 0, "addr"),
+    (0x80, 0xFF, "LCD_SETXADDR", 0, "addr"),
+]
+PCD8544_EXTENDED = [
+    (0x04, 0x07, "LCD_SETTEMP", 0, "tempcomp"),
+    (0x10, 0x17, "LCD_BIAS", 0, "bias"),
+    (0x80, 0xFF, "LCD_CONTRAST", 0, "contrast"),
+]
+PCD8544_FUNCTIONSET = (0x20, 0x27, "LCD_FUNCTIONSET", 0, "functionset")
+
+# name: command table, RAM columns, RAM pages, visible width, height, column offset
+CONTROLLERS = {
+    "ssd1306": (SSD1306_COMMANDS, 128, 8, 128, 64, 0),
+    "sh1106": (SH1106_COMMANDS, 132, 8, 128, 64, 2),
+    "sh1107": (SH1107_COMMANDS, 128, 16, 128, 128, 0),
+    "ch1115": (CH1115_COMMANDS, 128, 8, 128, 64, 0),
+    "uc1609": (UC1609_COMMANDS, 192, 8, 192, 64, 0),
+    "pcd8544": (None, 84, 6, 84, 48, 0),
+}
+
+
+def load_capture(path):
+    """Returns a list of (time_us, context, bytes)."""
+    writes = []
+    with open(path, "r", encoding="latin-1") as handle:
+        for number, line in enumerate(handle, 1):
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            parts = line.split(",")
+            if len(parts) != 3 or len(parts[1]) != 1 or parts[1] not in "CDIcdi":
+                raise ValueError("line %d: not a capture record: %r" % (number, line))
+            try:
+                writes.append((int(parts[0]), parts[1], bytes.fromhex(parts[2])))
+            except ValueError:
+                raise ValueError("line %d: bad hex bytes" % number)
+    return writes
+
+
+def split_write(context, data):
+    """Splits a write into (role, byte) pairs, role is c command, d data or
+    k I2C control byte, the I2C control byte Co bit is followed."""
+    if context in "Cc":
+        return [("c", value) for value in data]
+    if context in "Dd":
+        return [("d", value) for value in data]
+    result = []
+    index = 0
+    while index < len(data):
+        control = data[index]
+        result.append(("k", control))
+        index += 1
+        role = "d" if control & 0x40 else "c"
+        if control & 0x80:
+            if index < len(data):
+                result.append((role, data[index]))
+                index += 1
+        else:
+            result.extend((role, value) for value in data[index:])
+            break
+    return result
+
+
+class Controller:
+    """Decodes the byte stream of one controller and keeps a model of its RAM."""
+
+    def __init__(self, name):
+        self.name = name
+        table, self.columns, self.pages, self.width, self.height, self.offset = CONTROLLERS[name]
+        self.table = table
+        self.ram = [None] * (self.columns * self.pages)
+        self.column = 0
+        self.page = 0
+        self.window = (0, self.columns - 1, 0, self.pages - 1)
+        self.mode = 2 if name == "ssd1306" else 0   # SSD1306 resets to page addressing
+        self.extended = False                       # PCD8544 H bit
+        self.vertical = False                       # PCD8544 V bit
+        self.settings = {}
+        self.pending = None
+        self.run = None
+        self.stats = {"commands": 0, "data": 0, "address": 0, "redundant_address": 0,
+                      "redundant_setting": 0, "redundant_data": 0, "unknown": 0, "failed": 0}
+        self.redundant = {}
+
+    def lookup(self, value):
+        if self.name == "pcd8544":
+            if PCD8544_FUNCTIONSET[0] <= value <= PCD8544_FUNCTIONSET[1]:
+                return PCD8544_FUNCTIONSET
+            table = PCD8544_EXTENDED if self.extended else PCD8544_BASIC
+        else:
+            table = self.table
+        for entry in table:
+            if entry[0] <= value <= entry[1]:
+                return entry
+        return None
+
+    def state(self):
+        return (self.column, self.page, self.window)
+
+    def command(self, value):
+        """Feeds a command byte, returns a finished (name, opcode, args, note) or None."""
+        if self.pending is not None:
+            entry, opcode, args = self.pending
+            args.append(value)
+            if len(args) < entry[3]:
+                return None
+            self.pending = None
+            return self.execute(entry, opcode, args)
+        entry = self.lookup(value)
+        if entry is None:
+            self.stats["unknown"] += 1
+            return ("UNKNOWN", value, [], "not in command table")
+        if entry[3]:
+            self.pending = (entry, value, [])
+            return None
+        return self.execute(entry, value, [])
+
+    def execute(self, entry, opcode, args):
+        name, group = entry[2], entry[4]
+        self.stats["commands"] += 1
+        note = ""
+        if group == "addr":
+            self.stats["address"] += 1
+            if self.run is None:
+                self.run = (self.state(), [])
+            self.run[1].append(name)
+            self.address(name, opcode, args)
+            return (name, opcode, args, note)
+        self.end_run()
+        if group is not None:
+            if name == "LCD_FUNCTIONSET":
+                self.extended = bool(opcode & 0x01)
+                self.vertical = bool(opcode & 0x02)
+            elif name == "SSD1306_MEMORY_ADDR_MODE" and args:
+                self.mode = args[0] & 0x03
+            setting = (opcode, tuple(args))
+            if self.settings.get(group) == setting:
+                self.stats["redundant_setting"] += 1
+                note = "redundant, setting unchanged"
+            self.settings[group] = setting
+        if note:
+            self.redundant[name] = self.redundant.get(name, 0) + 1
+        return (name, opcode, args, note)
+
+    def end_run(self):
+        """Ends a run of address commands, the run is redundant if the
+        pointer and window are where they were before it.
+        Returns the number of commands in a redundant run, else 0."""
+        if self.run is None:
+            return 0
+        before, names = self.run
+        self.run = None
+        if self.state() != before:
+            return 0
+        self.stats["redundant_address"] += len(names)
+        for name in names:
+            self.redundant[name] = self.redundant.get(name, 0) + 1
+        return len(names)
+
+    def address(self, name, opcode, args):
+        if name.endswith(("LOWER_COLUMN", "LOWCOLUMN", "COLADD_LSB")):
+            self.column = (self.column & 0xF0) | (opcode & 0x0F)
+        elif name.endswith(("HIGHER_COLUMN", "HIGHCOLUMN", "COLADD_MSB")):
+            self.column = (self.column & 0x0F) | ((opcode & 0x0F) << 4)
+        elif name == "SSD1306_SET_COLUMN_ADDR":
+            self.window = (args[0] & 0x7F, args[1] & 0x7F) + self.window[2:]
+            self.column = self.window[0]
+        elif name == "SSD1306_SET_PAGE_ADDR":
+            self.window = self.window[:2] + (args[0] & 0x07, args[1] & 0x07)
+            self.page = self.window[2]
+        elif name == "LCD_SETYADDR":
+            self.page = opcode & 0x07
+        elif name == "LCD_SETXADDR":
+            self.column = opcode & 0x7F
+        else:
+            self.page = opcode & 0x0F
+        self.column %= self.columns
+        self.page %= self.pages
+
+    def data(self, value):
+        """Writes a data byte at the RAM pointer, returns True if RAM held it already."""
+        self.stats["data"] += 1
+        self.end_run()
+        index = self.page * self.columns + self.column
+        same = self.ram[index] == value
+        if same:
+            self.stats["redundant_data"] += 1
+        self.ram[index] = value
+        self.advance()
+        return same
+
+    def advance(self):
+        if self.name == "ssd1306" and self.mode != 2:
+            first, last, top, bottom = self.window
+            if self.mode == 0:
+                self.column += 1
+                if self.column > last:
+                    self.column = first
+                    self.page = top if self.page >= bottom else self.page + 1
+            else:
+                self.page += 1
+                if self.page > bottom:
+                    self.page = top
+                    self.column = first if self.column >= last else self.column + 1
+        elif self.name == "pcd8544" and self.vertical:
+            self.page += 1
+            if self.page >= self.pages:
+                self.page = 0
+                self.column = (self.column + 1) % self.columns
+        elif self.name in ("pcd8544", "uc1609"):
+            self.column += 1
+            if self.column >= self.columns:
+                self.column = 0
+                self.page = (self.page + 1) % self.pages
+        else:
+            self.column = (self.column + 1) % self.columns
+
+    def pixels(self):
+        """Visible area as rows of 0/1, None bytes never written are 0."""
+        rows = []
+        for y in range(self.height):
+            row = []
+            for x in range(self.width):
+                value = self.ram[(y // 8) * self.columns + x + self.offset] or 0
+                row.append((value >> (y % 8)) & 1)
+            rows.append(row)
+        return rows
+
+
+def decode(writes, controller):
+    """Runs the writes through the controller, returns a list of
+    (time_us, context, kind, detail) with kind command, data or failed."""
+    events = []
+    run_event = None
+
+    def close_run():
+        count = controller.end_run()
+        if count and run_event is not None:
+            time_us, context, kind, detail = events[run_event]
+            events[run_event] = (time_us, context, kind, detail + "  # redundant, last %d address commands left the pointer where it was" % count)
+
+    for time_us, context, data in writes:
+        if context.islower():
+            controller.stats["failed"] += 1
+            events.append((time_us, context, "failed", "%d bytes not applied" % len(data)))
+            continue
+        run = []
+        for role, value in split_write(context, data):
+            if role == "c":
+                result = controller.command(value)
+                if result is not None:
+                    name, opcode, args, note = result
+                    text = "%s 0x%02X%s" % (name, opcode, "".join(" 0x%02X" % a for a in args))
+                    if controller.run is None:
+                        close_run()
+                    events.append((time_us, context, "command", text + ("  # " + note if note else "")))
+                    if controller.run is not None:
+                        run_event = len(events) - 1
+            elif role == "d":
+                if controller.pending is not None:
+                    events.append((time_us, context, "command", "%s cut short by data" % controller.pending[0][2]))
+                    controller.pending = None
+                if not run:
+                    close_run()
+                    run = [controller.page, controller.column, 0, 0]
+                run[2] += 1
+                run[3] += controller.data(value)
+        if run:
+            events.append((time_us, context, "data", "%d bytes at page %d column %d, %d unchanged"
+                           % (run[2], run[0], run[1], run[3])))
+    close_run()
+    return events
+
+
+def write_csv(path, events):
+    with open(path, "w", encoding="ascii") as handle:
+        handle.write("time_us,context,kind,detail\n")
+        for time_us, context, kind, detail in events:
+            handle.write('%d,%s,%s,"%s"\n' % (time_us, context, kind, detail.replace('"', "'")))
+
+
+def write_vcd(path, writes, clock_hz):
+    """Writes a VCD with dc (x for I2C control bytes), byte, strobe and failed
+    signals. Bytes are spaced back from the end of write time stamp at 8 clocks
+    a byte on SPI, 9 on I2C plus the address byte."""
+    bus_i2c = any(context in "Ii" for _, context, _ in writes)
+    byte_ns = (9 if bus_i2c else 8) * 1e9 / clock_hz
+    with open(path, "w", encoding="ascii") as handle:
+        handle.write("$timescale 1ns $end\n$scope module display $end\n")
+        handle.write("$var wire 1 d dc $end\n$var wire 8 b byte [7:0] $end\n")
+        handle.write("$var wire 1 s strobe $end\n$var wire 1 f failed $end\n")
+        handle.write("$upscope $end\n$enddefinitions $end\n#0\n$dumpvars\nxd\nbx b\n0s\n0f\n$end\n")
+        last_ns = 0
+        for time_us, context, data in writes:
+            roles = split_write(context.upper(), data)
+            count = len(roles) + (1 if bus_i2c else 0)
+            start = max(last_ns, int(time_us * 1000 - count * byte_ns))
+            if bus_i2c:
+                start += int(byte_ns)
+            failed = "1" if context.islower() else "0"
+            for number, (role, value) in enumerate(roles):
+                at = int(start + number * byte_ns)
+                handle.write("#%d\n%sd\nb%s b\n1s\n%sf\n" % (at, {"c": "0", "d": "1"}.get(role, "x"),
+                                                          format(value, "08b"), failed))
+                handle.write("#%d\n0s\n" % (at + max(1, int(byte_ns / 2))))
+            last_ns = int(start + len(roles) * byte_ns)
+
+
+def write_pbm(path, rows):
+    with open(path, "wb") as handle:
+        handle.write(b"P4\n%d %d\n" % (len(rows[0]), len(rows)))
+        for row in rows:
+            packed = bytearray((len(row) + 7) // 8)
+            for x, bit in enumerate(row):
+                if bit:
+                    packed[x // 8] |= 0x80 >> (x % 8)
+            handle.write(bytes(packed))
+
+
+def run(path, name, size, offset):
+    controller = Controller(name)
+    if size:
+        controller.width, controller.height = size
+    if offset is not None:
+        controller.offset = offset
+    writes = load_capture(path)
+    return controller, writes, decode(writes, controller)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode a displaylib bus capture")
+    parser.add_argument("capture", help="capture file, busCaptureDump output")
+    parser.add_argument("--controller", required=True, choices=sorted(CONTROLLERS), help="display controller")
+    parser.add_argument("--csv", help="write the decoded commands and data to a CSV file")
+    parser.add_argument("--vcd", help="write the bytes to a VCD file for a waveform viewer")
+    parser.add_argument("--clock", type=float, help="bus clock for the VCD, Hz, default 400000 I2C, 8000000 SPI")
+    parser.add_argument("--ram", help="write the visible display RAM to a PBM file")
+    parser.add_argument("--size", help="visible area WxH, default from the controller")
+    parser.add_argument("--offset", type=int, help="RAM column of the first visible column")
+    parser.add_argument("--compare", help="second capture, exit 1 if its display RAM differs")
+    parser.add_argument("--list", action="store_true", help="print every decoded command")
+    args = parser.parse_args()
+
+    size = None
+    if args.size:
+        try:
+            size = tuple(int(v) for v in args.size.lower().split("x"))
+        except ValueError:
+            size = ()
+        if len(size) != 2:
+            sys.exit("displaylib_capture: --size must be WxH")
+    try:
+        controller, writes, events = run(args.capture, args.controller, size, args.offset)
+        other = run(args.compare, args.controller, size, args.offset)[0] if args.compare else None
+    except (OSError, ValueError) as error:
+        sys.exit("displaylib_capture: %s" % error)
+    if not writes:
+        sys.exit("displaylib_capture: %s: no writes in capture" % args.capture)
+
+    if args.list:
+        for time_us, context, kind, detail in events:
+            print("%10d %s %-7s %s" % (time_us, context, kind, detail))
+    stats = controller.stats
+    print("%s: %s, %d writes, %d failed, %d commands, %d data bytes, %d unknown"
+          % (args.capture, args.controller, len(writes), stats["failed"], stats["commands"], stats["data"], stats["unknown"]))
+    print("redundant: %d of %d address commands, %d settings re-sent unchanged, %d data bytes RAM already held"
+          % (stats["redundant_address"], stats["address"], stats["redundant_setting"], stats["redundant_data"]))
+    for name, count in sorted(controller.redundant.items(), key=lambda item: -item[1]):
+        print("  %-44s %6d" % (name, count))
+
+    if args.csv:
+        write_csv(args.csv, events)
+    if args.vcd:
+        bus_i2c = any(context in "Ii" for _, context, _ in writes)
+        write_vcd(args.vcd, writes, args.clock or (400000 if bus_i2c else 8000000))
+    if args.ram:
+        write_pbm(args.ram, controller.pixels())
+    if other is not None:
+        mine, theirs = controller.pixels(), other.pixels()
+        differ = sum(1 for a, b in zip(mine, theirs) for p, q in zip(a, b) if p != q)
+        print("compare %s: %s" % (args.compare, "%d pixels differ" % differ if differ else "display RAM identical"))
+        if differ:
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
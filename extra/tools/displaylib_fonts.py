@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+"""
+@file displaylib_fonts.py
+@brief Converts a BDF font into a C++ header holding a remapped font for
+    setFont, only the glyphs the application uses, fixed or proportional.
+@author Gavin Lyons.
+@details Format, see display_fonts.hpp: an 8 byte header starting 0, an index
+    table from each code of the first to last code to its glyph number (0xFF
+    not in the font), so a lookup is one table read however sparse the subset,
+    then a width table if proportional, then the glyphs in page layout.
+    Codes above 0xFF, a fallback glyph, or a subset whose range table is
+    smaller than the index table, give a range font instead: a sorted table of
+    runs of consecutive code points, found by binary search.
+    The cell is the font ascent plus descent, padded to a multiple of 8,
+    the baseline is row ascent. Codes are BDF ENCODING, Unicode for
+    iso10646-1 fonts, 0x80-0xFF Latin-1.
+    Used by the CMake function displaylib_add_font, can be run by hand:
+    python3 displaylib_fonts.py -o clock_font.hpp --subset "0123456789:.-" ter-u32b.bdf
+    python3 displaylib_fonts.py -o ui_font.hpp --range 0x20-0x7e --subset "°µΩ" --fallback "?" ter-u16n.bdf
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+FLAG_PROPORTIONAL = 0x01
+FLAG_RANGES = 0x02
+GLYPH_NONE = 0xFF
+RANGE_GLYPHS_MAX = 0x7FFF
+
+
+def load_bdf(path):
+    """Returns ascent, descent and a dict of code to (dwidth, w, h, xoff, yoff, rows of ints)."""
+    ascent = descent = None
+    bbox = None
+    glyphs = {}
+    with open(path, "r", encoding="latin-1") as handle:
+        lines = iter(handle.read().splitlines())
+    for line in lines:
+        words = line.split()
+        if not words:
+            continue
+        if words[0] == "FONTBOUNDINGBOX":
+            bbox = [int(v) for v in words[1:5]]
+        elif words[0] == "FONT_ASCENT":
+            ascent = int(words[1])
+        elif words[0] == "FONT_DESCENT":
+            descent = int(words[1])
+        elif words[0] == "STARTCHAR":
+            code, dwidth, box, rows = -1, None, None, []
+            for line in lines:
+                words = line.split()
+                if not words:
+                    continue
+                if words[0] == "ENCODING":
+                    code = int(words[-1])
+                elif words[0] == "DWIDTH":
+                    dwidth = int(words[1])
+                elif words[0] == "BBX":
+                    box = [int(v) for v in words[1:5]]
+                elif words[0] == "BITMAP":
+                    for line in lines:
+                        if line.strip() == "ENDCHAR":
+                            break
+                        rows.append(int(line.strip(), 16))
+                    break
+            if code < 0 or box is None:
+                continue
+            width = box[0]
+            shift = ((width + 7) // 8) * 8 - width  # rows are left aligned hex bytes
+            rows = [[(row >> (shift + width - 1 - x)) & 1 for x in range(width)] for row in rows[:box[1]]]
+            glyphs[code] = (dwidth if dwidth is not None else width, box[0], box[1], box[2], box[3], rows)
+    if bbox is None:
+        raise ValueError("no FONTBOUNDINGBOX, not a BDF font")
+    if ascent is None or descent is None:
+        ascent, descent = bbox[1] + bbox[3], -bbox[3]
+    return ascent, descent, glyphs
+
+
+def parse_ranges(ranges):
+    """'0x20-0x7e' or '65' to a list of codes."""
+    codes = []
+    for text in ranges:
+        for part in text.split(","):
+            first, _, last = part.partition("-")
+            first = int(first, 0)
+            codes.extend(range(first, int(last, 0) + 1 if last else first + 1))
+    return codes
+
+
+def code_runs(codes):
+    """Sorted codes to (first, count) runs of consecutive codes."""
+    runs = []
+    for code in codes:
+        if runs and runs[-1][0] + runs[-1][1] == code and runs[-1][1] < 0xFFFF:
+            runs[-1][1] += 1
+        else:
+            runs.append([code, 1])
+    return runs
+
+
+def render(glyph, ascent, left, width, height):
+    """Places a glyph in a width x height cell, returns page layout bytes."""
+    _, gwidth, gheight, xoff, yoff, rows = glyph
+    out = bytearray(width * (height // 8))
+    top = ascent - yoff - gheight
+    for row, bits in enumerate(rows):
+        y = top + row
+        if y < 0 or y >= height:
+            continue
+        for col, bit in enumerate(bits):
+            x = left + xoff + col
+            if bit and 0 <= x < width:
+                out[x + (y // 8) * width] |= 1 << (y & 7)
+    return out
+
+
+def c_name(path):
+    """Identifier from the file name."""
+    name = re.sub(r"\W", "_", os.path.splitext(os.path.basename(path))[0])
+    return ("_" + name) if name[0].isdigit() else name
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert a BDF font to a remapped displaylib font")
+    parser.add_argument("bdf", help="BDF font file")
+    parser.add_argument("-o", "--output", required=True, help="header file to write")
+    parser.add_argument("--name", help="array name, default from the file name")
+    parser.add_argument("--subset", default="", help="characters to keep, e.g. \"0123456789:.-\"")
+    parser.add_argument("--range", action="append", default=[], help="codes to keep, e.g. 0x20-0x7e, may repeat")
+    parser.add_argument("--proportional", action="store_true", help="keep each glyph width, default fixed cell")
+    parser.add_argument("--fallback", help="character drawn for characters not in the font, e.g. \"?\"")
+    args = parser.parse_args()
+
+    try:
+        ascent, descent, glyphs = load_bdf(args.bdf)
+        wanted = [ord(c) for c in args.subset + (args.fallback or "")] + parse_ranges(args.range)
+    except (OSError, ValueError) as error:
+        sys.exit("displaylib_fonts: %s: %s" % (args.bdf, error))
+    if args.fallback is not None and len(args.fallback) != 1:
+        sys.exit("displaylib_fonts: --fallback must be one character")
+    if not wanted:
+        wanted = [code for code in glyphs if 0x20 <= code <= 0xFF]
+    codes = []
+    for code in sorted(set(wanted)):
+        if code not in glyphs:
+            print("displaylib_fonts: warning, 0x%02x %r not in %s" % (code, chr(code), args.bdf), file=sys.stderr)
+            continue
+        codes.append(code)
+    if not codes:
+        sys.exit("displaylib_fonts: no glyphs selected")
+    if args.fallback is not None and ord(args.fallback) not in codes:
+        sys.exit("displaylib_fonts: fallback %r not in %s" % (args.fallback, args.bdf))
+    runs = code_runs(codes)
+    ranges = (codes[-1] > 0xFF or args.fallback is not None or len(codes) >= GLYPH_NONE or
+              12 + 8 * len(runs) < 8 + codes[-1] - codes[0] + 1)
+    if len(codes) > RANGE_GLYPHS_MAX:
+        sys.exit("displaylib_fonts: %d glyphs, max %d" % (len(codes), RANGE_GLYPHS_MAX))
+
+    left = max([0] + [-glyphs[code][3] for code in codes])  # negative left bearings
+    width = max(max(glyphs[code][0], left + glyphs[code][3] + glyphs[code][1]) for code in codes)
+    height = ((ascent + descent + 7) // 8) * 8
+    if width > 255 or height > 248:
+        sys.exit("displaylib_fonts: cell %dx%d too big" % (width, height))
+    first, last = codes[0], codes[-1]
+    flags = FLAG_PROPORTIONAL if args.proportional else 0
+    if ranges:
+        fallback = codes.index(ord(args.fallback)) if args.fallback is not None else 0xFFFF
+        data = bytearray([0, width, height, flags | FLAG_RANGES])
+        data += struct.pack("<HHHH", len(codes), fallback, len(runs), 0)
+        glyph = 0
+        for code, count in runs:
+            data += struct.pack("<IHH", code, count, glyph)
+            glyph += count
+    else:
+        data = bytearray([0, width, height, flags, first, last, len(codes), 0])
+        index = bytearray([GLYPH_NONE]) * (last - first + 1)
+        for number, code in enumerate(codes):
+            index[code - first] = number
+        data += index
+    if args.proportional:
+        data += bytearray(min(glyphs[code][0], width) for code in codes)
+    for code in codes:
+        data += render(glyphs[code], ascent, left, width, height)
+
+    name = args.name or c_name(args.bdf)
+    full = 4 + (last - first + 1) * width * (height // 8)
+    shown = "".join(chr(code) if 0x20 < code < 0x7F else "\\x%02x" % code if code < 0x100 else "\\u%04x" % code if code < 0x10000
+                    else "\\U%08x" % code for code in codes)
+    out = ["/*!",
+           "\t@file %s" % os.path.basename(args.output),
+           "\t@brief Font generated by displaylib_fonts.py from %s, do not edit." % os.path.basename(args.bdf),
+           "\t@details %d by %d%s%s, %d glyphs: %s" % (width, height, " proportional" if args.proportional else "",
+                                                    ", %d ranges" % len(runs) if ranges else "",
+                                                    len(codes), shown.replace("*/", "*\\/")),
+           "*/",
+           "",
+           "#pragma once",
+           "",
+           "#include <array>",
+           "#include <cstdint>",
+           "",
+           "inline constexpr std::array<uint8_t, %d> %s = {" % (len(data), name)]
+    for start in range(0, len(data), 16):
+        out.append("\t" + ", ".join("0x%02x" % b for b in data[start:start + 16]) + ",")
+    out.append("};")
+    out.append("")
+    with open(args.output, "w") as handle:
+        handle.write("\n".join(out))
+    if last <= 0xFF:
+        print("displaylib_fonts: %s %dx%d, %d glyphs, %d bytes (a built in style font of codes 0x%02x-0x%02x is %d)"
+              % (name, width, height, len(codes), len(data), first, last, full), file=sys.stderr)
+    else:
+        print("displaylib_fonts: %s %dx%d, %d glyphs, %d bytes" % (name, width, height, len(codes), len(data)),
+              file=sys.stderr)
+    if ranges:
+        print("displaylib_fonts: %s range font, %d ranges" % (name, len(runs)), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,267 @@
+#!/usr/bin/env python3
+"""
+@file displaylib_remote.py
+@brief Remote framebuffer sender, drives a display running displaylib_remote
+    from the host PC, over USB CDC or a pipe to a process.
+@author Gavin Lyons.
+@details Each frame is sent as the smallest of a RemoteFull, a RemotePages
+    rectangle of the changed bytes, or a RemoteXorRle delta of the last frame,
+    unchanged frames are not sent. Up to --window frames are sent before an
+    answer is waited for. After an E answer the next frame is a RemoteFull.
+    A 128x64 full frame is 1030 bytes on the wire, 30 fps of full frames is
+    about 31 KB/S, well under what USB full speed CDC carries, deltas of a
+    moving image are usually under 100 bytes.
+    Frames come from PBM/PGM/XBM images (cycled) or a built in moving test
+    pattern. Exit status 1 if the display rejected a frame. --corrupt N flips
+    a payload byte of the Nth frame sent (from 0) to test the CRC check and the
+    recovery, then the exit status is 1 only if the rejected frames are not
+    exactly the corrupted ones. Can be imported, RemoteSender, frame, crc16
+    and the encoders.
+    python3 displaylib_remote.py --port /dev/ttyACM0 --demo --fps 30
+    python3 displaylib_remote.py --port /dev/ttyACM0 --fps 2 splash.pbm menu.pbm
+    python3 displaylib_remote.py --exec ./host_receiver --demo --frames 300 --last last.pbm
+    python3 displaylib_remote.py --exec ./host_receiver --demo --frames 300 --corrupt 100
+"""
+
+import argparse
+import math
+import os
+import subprocess
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from displaylib_assets import load, pack_runs, to_pages  # noqa: E402
+
+SYNC = b"\xA5\x5A"
+HELLO, FULL, PAGES, XOR_RLE = 0, 1, 2, 3
+TYPE_NAMES = {FULL: "full", PAGES: "pages", XOR_RLE: "xor-rle"}
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE."""
+    for value in data:
+        crc ^= value << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def frame(kind, sequence, payload):
+    """One frame on the wire."""
+    body = bytes([kind, sequence & 0xFF, len(payload) & 0xFF, len(payload) >> 8]) + bytes(payload)
+    crc = crc16(body)
+    return SYNC + body + bytes([crc & 0xFF, crc >> 8])
+
+
+def encode_pages(old, new, width):
+    """RemotePages payload of the rectangle of changed bytes, None if nothing changed."""
+    changed = [index for index in range(len(new)) if old[index] != new[index]]
+    if not changed:
+        return None
+    pages = [index // width for index in changed]
+    columns = [index % width for index in changed]
+    page, column = min(pages), min(columns)
+    page_count, column_count = max(pages) - page + 1, max(columns) - column + 1
+    payload = bytearray([page, page_count, column, column_count])
+    for row in range(page, page + page_count):
+        payload += new[row * width + column:row * width + column + column_count]
+    return payload
+
+
+def encode_xor_rle(old, new):
+    """RemoteXorRle payload, runs of the XOR of the two frames."""
+    return pack_runs(bytes(a ^ b for a, b in zip(old, new)))
+
+
+class RemoteSender:
+    """Sends frames to a displaylib_remote receiver.
+    write(bytes) sends, readline() returns the next answer line as str."""
+
+    def __init__(self, write, readline, window=4):
+        self.write = write
+        self.readline = readline
+        self.window = window
+        self.sequence = 0
+        self.in_flight = 0
+        self.last = None
+        self.need_full = True
+        self.width = self.height = self.staging = 0
+        self.corrupt = set()
+        self.stats = {"frames": 0, "skipped": 0, "bytes": 0, "errors": 0, "corrupted": 0,
+                      "full": 0, "pages": 0, "xor-rle": 0}
+
+    def answer(self):
+        """Reads answers until one for a frame, returns the line."""
+        while True:
+            line = self.readline()
+            if not line:
+                raise EOFError("receiver closed")
+            parts = line.split()
+            if parts and parts[0] in ("K", "E", "I"):
+                return parts
+
+    def hello(self):
+        """Asks the display size, returns (width, height, staging bytes)."""
+        self.drain()
+        self.write(frame(HELLO, 0, b""))
+        while True:
+            parts = self.answer()
+            if parts[0] == "I":
+                self.width, self.height, self.staging = (int(v) for v in parts[1:4])
+                return self.width, self.height, self.staging
+
+    def drain(self):
+        while self.in_flight:
+            parts = self.answer()
+            if parts[0] in ("K", "E"):
+                self.in_flight -= 1
+                if parts[0] == "E":
+                    self.stats["errors"] += 1
+                    self.need_full = True
+
+    def send(self, data):
+        """Sends a frame, page layout bytes, width * pages, returns the encoding or None if unchanged."""
+        while self.in_flight >= self.window:
+            parts = self.answer()
+            if parts[0] in ("K", "E"):
+                self.in_flight -= 1
+                if parts[0] == "E":
+                    self.stats["errors"] += 1
+                    self.need_full = True
+        data = bytes(data)
+        choices = [(len(data), FULL, data)]
+        if not self.need_full and self.last is not None:
+            pages = encode_pages(self.last, data, self.width)
+            if pages is None:
+                self.stats["skipped"] += 1
+                return None
+            choices.append((len(pages), PAGES, pages))
+            packed = encode_xor_rle(self.last, data)
+            choices.append((len(packed), XOR_RLE, packed))
+        _, kind, payload = min((c for c in choices if c[0] <= self.staging), key=lambda c: c[0])
+        wire = frame(kind, self.sequence, payload)
+        if self.stats["frames"] in self.corrupt:
+            wire = bytearray(wire)
+            wire[len(SYNC) + 4] ^= 0xFF  # first payload byte, the CRC no longer matches
+            self.stats["corrupted"] += 1
+        self.write(wire)
+        self.sequence = (self.sequence + 1) & 0xFF
+        self.in_flight += 1
+        self.last = data
+        self.need_full = False
+        self.stats["frames"] += 1
+        self.stats["bytes"] += len(wire)
+        self.stats[TYPE_NAMES[kind]] += 1
+        return TYPE_NAMES[kind]
+
+
+def demo_frame(number, width, height):
+    """Moving test pattern, a ball, a bar and a frame counter stripe, as rows."""
+    rows = [[0] * width for _ in range(height)]
+    cx = int((width - 12) * (0.5 + 0.5 * math.sin(number / 15.0))) + 6
+    cy = int((height - 12) * (0.5 + 0.5 * math.cos(number / 11.0))) + 6
+    for y in range(height):
+        for x in range(width):
+            if (x - cx) ** 2 + (y - cy) ** 2 <= 25 or x in (0, width - 1) or y in (0, height - 1):
+                rows[y][x] = 1
+    for x in range(number % width):
+        rows[height - 3][x] = 1
+    return rows
+
+
+def write_pbm(path, data, width, height):
+    with open(path, "wb") as handle:
+        handle.write(b"P4\n%d %d\n" % (width, height))
+        for y in range(height):
+            packed = bytearray((width + 7) // 8)
+            for x in range(width):
+                if (data[(y // 8) * width + x] >> (y % 8)) & 1:
+                    packed[x // 8] |= 0x80 >> (x % 8)
+            handle.write(bytes(packed))
+
+
+def open_transport(args):
+    if args.exec:
+        process = subprocess.Popen(args.exec, shell=True, stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+
+        def write(data):
+            process.stdin.write(data)
+            process.stdin.flush()
+        return write, lambda: process.stdout.readline().decode("latin-1"), process
+    try:
+        import serial  # pyserial
+    except ImportError:
+        sys.exit("displaylib_remote: --port needs pyserial, pip install pyserial")
+    port = serial.Serial(args.port, timeout=2)
+    return port.write, lambda: port.readline().decode("latin-1"), port
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Drive a display running displaylib_remote")
+    transport = parser.add_mutually_exclusive_group(required=True)
+    transport.add_argument("--port", help="serial port of the board, e.g. /dev/ttyACM0")
+    transport.add_argument("--exec", help="command to run, its stdin and stdout are the link, for loopback tests")
+    parser.add_argument("images", nargs="*", help="PBM/PGM/XBM images to send in turn")
+    parser.add_argument("--demo", action="store_true", help="send a moving test pattern")
+    parser.add_argument("--fps", type=float, default=30.0, help="frames per second, 0 as fast as the link goes")
+    parser.add_argument("--frames", type=int, default=0, help="frames to send, 0 for the images once or the demo forever")
+    parser.add_argument("--window", type=int, default=4, help="frames sent before an answer is waited for")
+    parser.add_argument("--last", help="write the last frame sent as PBM, to check the display in a test")
+    parser.add_argument("--corrupt", type=int, action="append", default=[], metavar="N",
+                        help="flip a payload byte of the Nth frame sent, from 0, can be repeated")
+    parser.add_argument("--threshold", type=int, default=128, help="grey level of a lit pixel, PGM images")
+    parser.add_argument("--invert", action="store_true", help="swap on and off pixels of the images")
+    parser.add_argument("--dither", action="store_true", help="dither PGM images")
+    args = parser.parse_args()
+    if not args.images and not args.demo:
+        sys.exit("displaylib_remote: give images or --demo")
+
+    write, readline, handle = open_transport(args)
+    sender = RemoteSender(write, readline, max(1, args.window))
+    sender.corrupt = set(args.corrupt)
+    try:
+        width, height, staging = sender.hello()
+        print("display %dx%d, staging %d bytes" % (width, height, staging))
+        frames = []
+        for path in args.images:
+            rows = load(path, args)
+            if len(rows) != height or len(rows[0]) != width:
+                sys.exit("displaylib_remote: %s is %dx%d, display is %dx%d" % (path, len(rows[0]), len(rows), width, height))
+            frames.append(bytes(to_pages(rows)[0]))
+        count = args.frames or (len(frames) if not args.demo else 0)
+        start = time.monotonic()
+        number = 0
+        data = None
+        while count == 0 or number < count:
+            data = frames[number % len(frames)] if frames else bytes(to_pages(demo_frame(number, width, height))[0])
+            sender.send(data)
+            number += 1
+            if args.fps > 0:
+                delay = start + number / args.fps - time.monotonic()
+                if delay > 0:
+                    time.sleep(delay)
+        sender.drain()
+    except (EOFError, OSError, ValueError) as error:
+        sys.exit("displaylib_remote: %s" % error)
+    except KeyboardInterrupt:
+        pass
+    elapsed = max(time.monotonic() - start, 1e-6)
+    stats = sender.stats
+    print("%d frames in %.2f S, %.1f fps, %d sent, %d unchanged, %d errors, %d corrupted" % (
+        number, elapsed, number / elapsed, stats["frames"], stats["skipped"], stats["errors"], stats["corrupted"]))
+    print("%d bytes, %.0f bytes/frame, %.1f KB/S, full %d, pages %d, xor-rle %d" % (
+        stats["bytes"], stats["bytes"] / max(stats["frames"], 1), stats["bytes"] / elapsed / 1024.0,
+        stats["full"], stats["pages"], stats["xor-rle"]))
+    if args.last and data is not None:
+        write_pbm(args.last, data, width, height)
+    if args.exec:
+        handle.stdin.close()
+        handle.wait()
+    if stats["errors"] != stats["corrupted"] or stats["corrupted"] != len(sender.corrupt):
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
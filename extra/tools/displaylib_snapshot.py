@@ -0,0 +1,193 @@
+#!/usr/bin/env python3
+"""
+@file displaylib_snapshot.py
+@brief Snapshot decoder, reads screen buffer snapshots sent by
+    displaylib_snapshot and writes them as PGM images, and compares them
+    with a golden image for tests.
+@author Gavin Lyons.
+@details Input is a binary PBM (SnapshotPBM) or a text log holding one or more
+    SnapshotRLE snapshots, other lines in the log are skipped, so the serial
+    monitor output can be used as it is. A SnapshotRLE snapshot is checked
+    against its byte count and checksum, a cut short or corrupt one is an error.
+    In the PGM a lit pixel is white, 255, as on the display, --invert swaps.
+    Can be imported, read_snapshots, read_image and write_pgm.
+    python3 displaylib_snapshot.py serial.log screen.pgm
+    python3 displaylib_snapshot.py --scale 4 serial.log screen.pgm
+    python3 displaylib_snapshot.py --compare golden.pbm --diff diff.pgm serial.log screen.pgm
+"""
+
+import argparse
+import re
+import sys
+
+HEADER = re.compile(r"# displaylib snapshot v1 rle (\d+) (\d+)")
+END = re.compile(r"# end ([0-9A-Fa-f]{4})")
+TOKEN = re.compile(r"\*([0-9A-Fa-f]{2})([0-9A-Fa-f]{2})|([0-9A-Fa-f]{2})")
+
+
+def fletcher16(data):
+    sum1 = sum2 = 0
+    for value in data:
+        sum1 = (sum1 + value) % 255
+        sum2 = (sum2 + sum1) % 255
+    return (sum2 << 8) | sum1
+
+
+def pages_to_rows(data, width, height):
+    """Display page layout, x + (y / 8) * width, bit y % 8, to rows of 0/1."""
+    return [[(data[(y // 8) * width + x] >> (y % 8)) & 1 for x in range(width)] for y in range(height)]
+
+
+def decode_rle(lines, width, height):
+    data = bytearray()
+    for line in lines:
+        line = line.strip()
+        position = 0
+        while position < len(line):
+            match = TOKEN.match(line, position)
+            if match is None:
+                raise ValueError("bad token at %r" % line[position:position + 8])
+            if match.group(3):
+                data.append(int(match.group(3), 16))
+            else:
+                data.extend([int(match.group(2), 16)] * int(match.group(1), 16))
+            position = match.end()
+    if len(data) != width * height // 8:
+        raise ValueError("snapshot has %d bytes, %dx%d needs %d, cut short?" % (len(data), width, height, width * height // 8))
+    return data
+
+
+def read_snapshots(path):
+    """Returns a list of (width, height, rows of 0/1), in the order found."""
+    with open(path, "rb") as handle:
+        raw = handle.read()
+    if raw[:2] in (b"P1", b"P4"):
+        return [read_pbm(raw)]
+    snapshots = []
+    text = raw.decode("latin-1").splitlines()
+    index = 0
+    while index < len(text):
+        header = HEADER.search(text[index])
+        index += 1
+        if header is None:
+            continue
+        width, height = int(header.group(1)), int(header.group(2))
+        body = []
+        while index < len(text) and END.search(text[index]) is None:
+            if HEADER.search(text[index]):
+                raise ValueError("snapshot %d has no end line" % (len(snapshots) + 1))
+            body.append(text[index])
+            index += 1
+        if index >= len(text):
+            raise ValueError("snapshot %d has no end line" % (len(snapshots) + 1))
+        data = decode_rle(body, width, height)
+        expected = int(END.search(text[index]).group(1), 16)
+        index += 1
+        if fletcher16(data) != expected:
+            raise ValueError("snapshot %d checksum %04X, expected %04X" % (len(snapshots) + 1, fletcher16(data), expected))
+        snapshots.append((width, height, pages_to_rows(data, width, height)))
+    if not snapshots:
+        raise ValueError("%s: no snapshot found" % path)
+    return snapshots
+
+
+def header_tokens(raw, count):
+    """The first count whitespace separated header fields of a PNM and the data offset."""
+    tokens, position = [], 2
+    while len(tokens) < count:
+        while raw[position:position + 1].isspace():
+            position += 1
+        if raw[position:position + 1] == b"#":
+            position = raw.index(b"\n", position)
+            continue
+        start = position
+        while position < len(raw) and not raw[position:position + 1].isspace():
+            position += 1
+        tokens.append(int(raw[start:position]))
+    return tokens, position + 1
+
+
+def read_pbm(raw):
+    """PBM P1 or P4, 1 is a lit pixel."""
+    (width, height), offset = header_tokens(raw, 2)
+    if raw[:2] == b"P1":
+        bits = [int(c) for c in raw[offset:].decode("ascii") if c in "01"]
+        return width, height, [bits[y * width:(y + 1) * width] for y in range(height)]
+    row_bytes = (width + 7) // 8
+    if len(raw) - offset < row_bytes * height:
+        raise ValueError("truncated P4 data")
+    rows = []
+    for y in range(height):
+        row = raw[offset + y * row_bytes:offset + (y + 1) * row_bytes]
+        rows.append([(row[x // 8] >> (7 - x % 8)) & 1 for x in range(width)])
+    return width, height, rows
+
+
+def read_image(path):
+    """Golden image, PBM, PGM (over half scale is lit) or a snapshot, the last one in the file."""
+    with open(path, "rb") as handle:
+        raw = handle.read()
+    if raw[:2] == b"P5":
+        (width, height, maxval), offset = header_tokens(raw, 3)
+        pixels = raw[offset:offset + width * height]
+        return width, height, [[1 if pixels[y * width + x] * 2 > maxval else 0 for x in range(width)] for y in range(height)]
+    return read_snapshots(path)[-1]
+
+
+def write_pgm(path, rows, scale=1, invert=False, diff=None):
+    """Writes rows of 0/1 as a P5 PGM, pixels set in diff are grey."""
+    height, width = len(rows), len(rows[0])
+    on, off = (0, 255) if invert else (255, 0)
+    with open(path, "wb") as handle:
+        handle.write(b"P5\n%d %d\n255\n" % (width * scale, height * scale))
+        for y in range(height):
+            line = bytearray()
+            for x in range(width):
+                value = 128 if diff and diff[y][x] else (on if rows[y][x] else off)
+                line.extend([value] * scale)
+            handle.write(bytes(line) * scale)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode displaylib screen snapshots to PGM")
+    parser.add_argument("input", help="binary PBM snapshot or a log with SnapshotRLE snapshots")
+    parser.add_argument("output", nargs="?", help="PGM file, with more than one snapshot -1, -2 ... is added to the name")
+    parser.add_argument("--scale", type=int, default=1, help="pixel size in the PGM, 1 to 16")
+    parser.add_argument("--invert", action="store_true", help="lit pixels black")
+    parser.add_argument("--compare", help="golden PBM, PGM or snapshot, exit 1 if the last snapshot differs")
+    parser.add_argument("--diff", help="write the last snapshot with differing pixels grey")
+    args = parser.parse_args()
+    if not 1 <= args.scale <= 16:
+        sys.exit("displaylib_snapshot: --scale must be 1 to 16")
+
+    try:
+        snapshots = read_snapshots(args.input)
+        golden = read_image(args.compare) if args.compare else None
+    except (OSError, ValueError) as error:
+        sys.exit("displaylib_snapshot: %s" % error)
+
+    for number, (width, height, rows) in enumerate(snapshots, 1):
+        print("%s: snapshot %d, %dx%d, %d pixels lit" % (args.input, number, width, height, sum(map(sum, rows))))
+        if args.output:
+            name = args.output
+            if len(snapshots) > 1:
+                stem, dot, extension = args.output.rpartition(".")
+                name = "%s-%d.%s" % (stem, number, extension) if dot else "%s-%d" % (args.output, number)
+            write_pgm(name, rows, args.scale, args.invert)
+
+    if golden is not None:
+        width, height, rows = snapshots[-1]
+        if (golden[0], golden[1]) != (width, height):
+            print("compare %s: size %dx%d, snapshot %dx%d" % (args.compare, golden[0], golden[1], width, height))
+            sys.exit(1)
+        diff = [[p != q for p, q in zip(a, b)] for a, b in zip(rows, golden[2])]
+        count = sum(map(sum, diff))
+        print("compare %s: %s" % (args.compare, "%d pixels differ" % count if count else "identical"))
+        if args.diff:
+            write_pgm(args.diff, rows, args.scale, args.invert, diff)
+        if count:
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
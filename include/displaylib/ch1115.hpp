@@ -8,14 +8,17 @@
 #pragma once
 
 // ** INCLUDES **
+#include <array>
 #include "hardware/spi.h"
 #include "displaylib/display_graphics.hpp"
+#include "displaylib/display_flush.hpp"
+#include "displaylib/display_suspend.hpp"
 
 
 // ** CLASS SECTION **
 
 /*! @brief class to drive the ERMCh1115 OLED */
-class ERMCH1115 : public displaylib_graphics
+class ERMCH1115 : public displaylib_graphics, public displaylib_flush, public displaylib_suspend
 {
 private:
 	/* CH1115 Command Set*/
@@ -70,6 +73,42 @@ private:
 
 	void send_data(uint8_t data);
 	void send_command(uint8_t command, uint8_t value);
+	void send_commands(std::span<const uint8_t> commands);
+
+	static constexpr uint8_t SUSPEND_RETAINED = StateAll; /**< Display off keeps RAM and registers */
+
+	// Power up timing
+	static constexpr uint32_t ERMCH1115_RESET_LOW_US = 10;     /**< uS reset pulse, datasheet min 10uS */
+	static constexpr uint32_t ERMCH1115_RESET_WAIT_US = 10;    /**< uS after reset before first command */
+	static constexpr uint32_t ERMCH1115_DCDC_WAIT_US = 100000; /**< uS DC-DC settle before display on, 100mS */
+
+	/*!
+		@brief Init command table, sent in one burst by bootStage
+		@param contrast contrast data 0x00 to 0xFE
+		@return the commands
+	*/
+	static constexpr std::array<uint8_t, 27> InitCommands(uint8_t contrast)
+	{
+		return {ERMCH1115_DISPLAY_OFF,
+			ERMCH1115_SET_COLADD_LSB,
+			ERMCH1115_SET_COLADD_MSB,
+			ERMCH1115_SET_PAGEADD,
+			ERMCH1115_SET_DISPLAY_START_LINE,
+			ERMCH1115_CONTRAST_CONTROL, contrast,
+			ERMCH1115_IREF_REG, ERMCH1115_IREF_SET,
+			ERMCH1115_SEG_SET_REMAP,
+			ERMCH1115_SEG_SET_PADS,
+			ERMCH1115_ENTIRE_DISPLAY_ON,
+			ERMCH1115_DISPLAY_NORMAL,
+			ERMCH1115_MULTIPLEX_MODE_SET, ERMCH1115_MULTIPLEX_DATA_SET,
+			ERMCH1115_COMMON_SCAN_DIR,
+			ERMCH1115_OFFSET_MODE_SET, ERMCH1115_OFFSET_DATA_SET,
+			ERMCH1115_OSC_FREQ_MODE_SET, ERMCH1115_OSC_FREQ_DATA_SET,
+			ERMCH1115_PRECHARGE_MODE_SET, ERMCH1115_PRECHARGE_DATA_SET,
+			ERMCH1115_COM_LEVEL_MODE_SET, ERMCH1115_COM_LEVEL_DATA_SET,
+			ERMCH1115_SET_PUMP_REG | ERMCH1115_SET_PUMP_SET,
+			ERMCH1115_DC_MODE_SET, ERMCH1115_DC_ONOFF_SET};
+	}
 
 	int8_t _display_CS;   /**< GPIO Chip select line*/
 	int8_t _display_CD;   /**< GPIO Data or command line */
@@ -79,6 +118,7 @@ private:
 
 	bool _sleep = true;		  /**< False awake/ON , true sleep/OFF */
 	uint8_t _OLEDcontrast;	  /**< Contrast default 0x80 datasheet 00-FF */
+	uint8_t _scrollSetup[8] = {0}; /**< Last scroll setup commands, for suspend replay */
 	spi_inst_t *spiInterface; /**< SPI interface instance */
 
 	int16_t _OLED_WIDTH = 128;					/**< Width of OLED Screen in pixels */
@@ -98,6 +138,7 @@ public:
 
 	void OLEDSPISetup(spi_inst_t *spi, uint32_t spiBaudRate, int8_t cd, int8_t rst, int8_t cs, int8_t sclk, int8_t din);
 	void OLEDinit(uint8_t OLEDcontrast);
+	void OLEDinitAsync(uint8_t OLEDcontrast = ERMCH1115_CONTRAST_DATA_DEFAULT);
 	void OLEDReset(void);
 
 	void OLEDFillScreen(uint8_t pixel, uint8_t mircodelay);
@@ -113,4 +154,15 @@ public:
 	void OLEDfadeEffect(uint8_t bits = ERMCH1115_BREATHEFFECT_DATA);
 	bool OLEDIssleeping(void);
 	void OLEDPowerDown(void);
+	DisplayRet::Ret_Codes_e OLEDSuspend(void);
+	DisplayRet::Ret_Codes_e OLEDResume(bool powerLost = false);
+
+protected:
+	virtual std::span<const uint8_t> flushBuffer(void) override;
+	virtual std::span<uint8_t> graphicsBuffer(void) override;
+	virtual DisplayRet::Ret_Codes_e flushSetAddress(uint8_t page, uint8_t column, uint8_t columnEnd) override;
+	virtual DisplayRet::Ret_Codes_e flushWriteData(std::span<const uint8_t> data) override;
+	virtual DisplayRet::Ret_Codes_e flushStartLine(uint8_t line) override;
+	virtual uint32_t bootStage(uint8_t stage) override;
+	virtual DisplayRet::Ret_Codes_e suspendSendCommands(std::span<const uint8_t> commands) override;
 };// end of class
@@ -0,0 +1,99 @@
+/*!
+	@file display_animation.hpp
+	@brief Compressed bitmaps and animations, decoded straight into the
+		screen buffer, animation frames stored as XOR deltas of the last frame.
+	@author Gavin Lyons.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include "display_data.hpp"
+#include "display_graphics.hpp"
+#include "display_flush.hpp"
+
+/*!
+	@brief Player for compressed bitmaps and animations made by extra/tools/displaylib_assets.py
+	@details Data format, all numbers little endian:
+		-# Header, 8 bytes: width (2), pages (1), version (1), frame count (2), height (2)
+		-# Frame table: frame count offsets (4 each), from the start of the data
+		-# Frames: type (1), 0 key frame or 1 delta frame, then the packed bytes
+		The height is the image rows, the last page holds height%8 rows if not
+		0, the rows below are never drawn. 0 is pages*8, data before the height.
+		Packed bytes are the page layout image, width * pages bytes, as runs:
+		control 0x00-0x7F is a literal run of control+1 bytes that follow,
+		0x80-0xFF is a repeat of the next byte control-0x80+2 times.
+		A key frame is written over the image rectangle. A delta frame is
+		XORed onto the last frame, a repeat of 0x00 skips bytes that did not
+		change without touching them. Decoding is a byte loop straight into the
+		screen buffer, no full frame is unpacked anywhere, and the rectangle of
+		bytes actually changed is kept for flushDirty.
+	@note A compressed bitmap is a one frame animation, see drawCompressed.
+		The display must not be rotated.
+*/
+class displaylib_animation
+{
+public:
+	displaylib_animation(displaylib_graphics &display);
+
+	static constexpr uint8_t ANIMATION_VERSION = 1;      /**< Data format version */
+	static constexpr uint8_t ANIMATION_HEADER_SIZE = 8;  /**< Bytes in the header */
+
+	/*! Enum to define the frame type byte */
+	enum frame_type_e : uint8_t
+	{
+		FrameKey = 0,   /**< Whole image */
+		FrameDelta = 1  /**< XOR of the last frame */
+	};
+
+	DisplayRet::Ret_Codes_e animationBegin(std::span<const uint8_t> data, int16_t x, int16_t y);
+	DisplayRet::Ret_Codes_e animationNext(void);
+	DisplayRet::Ret_Codes_e animationSeek(uint16_t frame);
+	static DisplayRet::Ret_Codes_e drawCompressed(displaylib_graphics &display, int16_t x, int16_t y,
+		std::span<const uint8_t> data);
+
+	uint16_t getFrameCount(void) const;
+	uint16_t getFrame(void) const;
+	int16_t getAnimationWidth(void) const;
+	int16_t getAnimationHeight(void) const;
+
+	bool getDirty(void) const;
+	displaylib_flush::flush_rect_t getDirtyRect(void) const;
+	void clearDirty(void);
+	DisplayRet::Ret_Codes_e flushDirty(displaylib_flush &display);
+
+private:
+	/*! Target of a decode, the screen buffer and where the image goes */
+	struct decode_target_t
+	{
+		std::span<uint8_t> buffer; /**< Screen buffer */
+		int16_t screenWidth = 0;   /**< Screen buffer width */
+		int16_t screenPages = 0;   /**< Screen buffer pages */
+		int16_t x = 0;             /**< Left of image */
+		int16_t y = 0;             /**< Top of image */
+		int16_t width = 0;         /**< Image width */
+		int16_t pages = 0;         /**< Image pages */
+		int16_t height = 0;        /**< Image rows, the last page may be part drawn */
+		int16_t colMin = 0;        /**< Changed bytes, first image column */
+		int16_t colMax = -1;       /**< Changed bytes, last image column, less than colMin if none */
+		int16_t pageMin = 0;       /**< Changed bytes, first image page */
+		int16_t pageMax = -1;      /**< Changed bytes, last image page */
+	};
+
+	static DisplayRet::Ret_Codes_e checkData(std::span<const uint8_t> data);
+	static int16_t imageHeight(std::span<const uint8_t> data);
+	static DisplayRet::Ret_Codes_e targetBuffer(displaylib_graphics &display, decode_target_t &target);
+	static DisplayRet::Ret_Codes_e decodeFrame(std::span<const uint8_t> data, uint16_t frame, decode_target_t &target);
+	static void putByte(decode_target_t &target, int16_t col, int16_t page, uint8_t value, bool delta);
+	static uint16_t frameType(std::span<const uint8_t> data, uint16_t frame);
+	DisplayRet::Ret_Codes_e showFrame(uint16_t frame);
+
+	displaylib_graphics &_display; /**< Display drawn to */
+	std::span<const uint8_t> _data; /**< Animation data, empty if animationBegin not called */
+	int16_t _x = 0;            /**< Left of animation */
+	int16_t _y = 0;            /**< Top of animation */
+	uint16_t _frame = 0;       /**< Frame on screen */
+	bool _shown = false;       /**< A frame has been drawn since animationBegin */
+	displaylib_flush::flush_rect_t _dirtyRect; /**< Bytes changed since the last flush, empty if clean */
+};
@@ -0,0 +1,55 @@
+/*!
+	@file display_breaker.hpp
+	@brief Circuit breaker for the I2C displays, stops a disconnected
+		display from stalling the main loop with retries.
+	@author Gavin Lyons.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+/*!
+	@brief Circuit breaker used by the I2C display drivers.
+	@details When a bus write still fails after the retry attempts the breaker
+		opens (trips). While open the driver skips the bus and returns at once.
+		The driver probes the display with CheckConnection at intervals that
+		double from the minimum to the maximum backoff. When the display
+		answers, the driver closes the breaker and starts its power up sequence
+		again without blocking, the stages run from isReady and updateStep.
+		Writes of a flush never wait: a failed one is tried again on the next
+		updateStep, the breaker opens when the retry attempts have failed too.
+*/
+class displaylib_breaker
+{
+public:
+	displaylib_breaker() = default;
+	virtual ~displaylib_breaker() = default;
+
+	bool GetBreakerOpen(void) const;
+	uint32_t GetBreakerTrips(void) const;
+	void SetBreakerBackoff(uint16_t minMs, uint16_t maxMs);
+	void BreakerReset(void);
+
+	static constexpr uint16_t BREAKER_BACKOFF_MIN = 100;  /**< Default first probe delay mS */
+	static constexpr uint16_t BREAKER_BACKOFF_MAX = 5000; /**< Default longest probe delay mS */
+	static constexpr uint16_t BREAKER_FLUSH_MARGIN_US = 500; /**< Timeout of a flush write over its transfer time, uS */
+
+protected:
+	void breakerTrip(void);
+	bool breakerProbeDue(void) const;
+	void breakerProbeFailed(void);
+	bool breakerFlushFailed(uint8_t attempts);
+	void breakerFlushOk(void);
+
+	bool _breakerReplay = false;     /**< Reconnected, user state to be sent again once the power up sequence is done */
+
+private:
+	bool _breakerOpen = false;       /**< true, bus writes skipped */
+	uint32_t _breakerTrips = 0;      /**< Number of times the breaker opened */
+	uint16_t _backoffMinMs = BREAKER_BACKOFF_MIN; /**< First probe delay mS */
+	uint16_t _backoffMaxMs = BREAKER_BACKOFF_MAX; /**< Longest probe delay mS */
+	uint16_t _backoffMs = BREAKER_BACKOFF_MIN;    /**< Current probe delay mS */
+	uint64_t _nextProbeUs = 0;       /**< time_us_64 of next probe */
+	uint8_t _flushFailures = 0;      /**< Flush writes failed in a row */
+};
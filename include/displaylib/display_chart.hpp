@@ -0,0 +1,90 @@
+/*!
+	@file display_chart.hpp
+	@brief Strip chart widget, a rolling trace that scrolls the screen buffer
+		one column per sample instead of redrawing every line.
+	@author Gavin Lyons.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include "display_data.hpp"
+#include "display_graphics.hpp"
+#include "display_flush.hpp"
+
+/*!
+	@brief Strip chart (sparkline) over a rectangle of the screen buffer.
+	@details On each sample the bytes of the rectangle are moved one column
+		left, page by page with memmove, and only the new right hand column
+		is drawn. A sample costs about (h/8) * w byte moves plus one column,
+		rather than clearing and drawing w lines. Up to CHART_SERIES_MAX series
+		are plotted, each as a line, dots or a filled area, with up to
+		CHART_THRESHOLD_MAX dotted threshold lines. With autoscale on, the
+		range follows the min and max of the samples in the window, when it
+		changes the chart is redrawn once from the sample history.
+	@note Writes the screen buffer directly, so the display must not be rotated.
+		The sample history is supplied by the user, (width + 1) * series int16_t.
+*/
+class displaylib_strip_chart
+{
+public:
+	/*! Enum to define how a series is drawn */
+	enum chart_style_e : uint8_t
+	{
+		StyleLine = 0, /**< Samples joined by a line */
+		StyleDots = 1, /**< One pixel per sample */
+		StyleFill = 2  /**< Filled from the sample to the bottom */
+	};
+
+	static constexpr uint8_t CHART_SERIES_MAX = 4;    /**< Max series in a chart */
+	static constexpr uint8_t CHART_THRESHOLD_MAX = 4; /**< Max threshold lines */
+
+	displaylib_strip_chart(displaylib_graphics &display, int16_t x, int16_t y, int16_t w, int16_t h);
+
+	DisplayRet::Ret_Codes_e chartBegin(std::span<int16_t> history, uint8_t series = 1);
+	void setChartRange(int16_t minValue, int16_t maxValue);
+	void setChartAutoscale(bool autoscale);
+	void setSeriesStyle(uint8_t series, chart_style_e style);
+	void setThreshold(uint8_t index, int16_t value, bool on = true);
+
+	DisplayRet::Ret_Codes_e chartPush(int16_t sample);
+	DisplayRet::Ret_Codes_e chartPush(std::span<const int16_t> samples);
+	DisplayRet::Ret_Codes_e chartRedraw(void);
+	DisplayRet::Ret_Codes_e chartClear(void);
+
+	int16_t getChartMin(void) const;
+	int16_t getChartMax(void) const;
+	bool getDirty(void) const;
+	displaylib_flush::flush_rect_t getDirtyRect(void) const;
+	void clearDirty(void);
+	DisplayRet::Ret_Codes_e flushDirty(displaylib_flush &display);
+
+private:
+	uint8_t pageMask(int16_t page) const;
+	void clearColumns(std::span<uint8_t> buffer, int16_t column, int16_t count);
+	void shiftLeft(std::span<uint8_t> buffer);
+	void drawColumn(std::span<uint8_t> buffer, int16_t column, uint16_t age);
+	void drawRun(std::span<uint8_t> buffer, int16_t column, int16_t rowStart, int16_t rowEnd);
+	int16_t valueRow(int16_t value) const;
+	int16_t sampleAt(uint16_t age, uint8_t series) const;
+	bool rescale(void);
+
+	displaylib_graphics &_display; /**< Display drawn to */
+	int16_t _x;  /**< Left of chart */
+	int16_t _y;  /**< Top of chart */
+	int16_t _w;  /**< Width of chart, also samples shown */
+	int16_t _h;  /**< Height of chart */
+	std::span<int16_t> _history; /**< Ring of samples, _w + 1 columns of _series values */
+	uint8_t _series = 0;   /**< Number of series, 0 chartBegin not called */
+	uint16_t _head = 0;    /**< History column of the newest sample */
+	uint16_t _count = 0;   /**< Samples in history, up to _w + 1 */
+	uint32_t _pushed = 0;  /**< Samples pushed, phase of the dotted threshold lines */
+	int16_t _min = 0;      /**< Value at the bottom row */
+	int16_t _max = 100;    /**< Value at the top row */
+	bool _autoscale = true; /**< Range follows the samples in the window */
+	bool _dirty = false;   /**< Chart drawn but not yet flushed */
+	chart_style_e _style[CHART_SERIES_MAX] = {StyleLine, StyleLine, StyleLine, StyleLine}; /**< Style of each series */
+	int16_t _threshold[CHART_THRESHOLD_MAX] = {0}; /**< Threshold values */
+	uint8_t _thresholdOn = 0; /**< Threshold lines shown, bit mask */
+};
@@ -0,0 +1,81 @@
+/*!
+	@file display_clocktune.hpp
+	@brief I2C clock auto tuning for the I2C displays, finds the fastest
+		bus clock the board wiring can take without errors.
+	@author Gavin Lyons.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include "display_data.hpp"
+
+/*!
+	@brief I2C clock tuning used by the I2C display drivers.
+	@details I2CClockTune steps the bus clock up through CLOCK_TUNE_STEPS. At
+		each step the driver writes test patterns to display RAM and reads the
+		status byte back, CLOCK_TUNE_PASSES times, with no retries. The first step
+		with a NACK or timeout ends the search. The clock is set to the fastest
+		step that passed less the safety margin. The SSD1306 and SH110X can not
+		read display RAM back over I2C, so the check is ACK and timeout based.
+		With auto tune on, the driver counts failed writes over windows of
+		CLOCK_TUNE_WINDOW writes, when a window reaches the error limit a re-tune
+		is due, run by I2CClockRetune from the main loop between frames, never
+		from inside an update.
+*/
+class displaylib_clocktune
+{
+public:
+	displaylib_clocktune() = default;
+	virtual ~displaylib_clocktune() = default;
+
+	DisplayRet::Ret_Codes_e I2CClockTune(uint16_t maxKHz = CLOCK_TUNE_MAX, uint8_t marginPercent = CLOCK_TUNE_MARGIN);
+	uint16_t GetI2CClockTuned(void) const;
+	uint32_t GetI2CClockTuneRuns(void) const;
+	void SetI2CClockAutoTune(bool on, uint8_t errorLimit = CLOCK_TUNE_ERROR_LIMIT);
+	bool GetI2CClockRetuneDue(void) const;
+	DisplayRet::Ret_Codes_e I2CClockRetune(void);
+
+	static constexpr uint16_t CLOCK_TUNE_STEPS[] = {100, 200, 400, 600, 800, 1000}; /**< Clocks tried, kHz */
+	static constexpr uint16_t CLOCK_TUNE_MAX = 1000;       /**< Default highest clock tried, kHz, Fast-mode Plus */
+	static constexpr uint8_t CLOCK_TUNE_MARGIN = 10;       /**< Default margin below the fastest clock passed, percent */
+	static constexpr uint8_t CLOCK_TUNE_PASSES = 2;        /**< Probes per step */
+	static constexpr uint32_t CLOCK_TUNE_TIMEOUT_US = 2000; /**< Timeout of a probe write, uS */
+	static constexpr uint16_t CLOCK_TUNE_WINDOW = 256;     /**< Writes per error counting window */
+	static constexpr uint8_t CLOCK_TUNE_ERROR_LIMIT = 2;   /**< Default failed writes per window that trigger a re-tune */
+	static constexpr uint16_t CLOCK_RETUNE_HOLDOFF_MS = 5000; /**< Least time between automatic re-tunes, mS */
+
+protected:
+	void clockTuneNote(bool ok);
+	void clockTuneFallback(void);
+
+	/*!
+		@brief Sets the bus clock
+		@param kHz the clock, kHz
+		@return the clock before, kHz
+	*/
+	virtual uint16_t clockTuneSet(uint16_t kHz) = 0;
+	/*!
+		@brief Writes the test patterns and reads the status back, one attempt
+			per transaction, then restores the display RAM written
+		@return true if every transaction was acknowledged
+	*/
+	virtual bool clockTuneProbe(void) = 0;
+	/*!
+		@brief Re-sends the controller init and user state after a failed
+			probe, a corrupted write may have been taken as a command
+	*/
+	virtual void clockTuneRecover(void) = 0;
+
+private:
+	uint16_t _tunedKHz = 0;          /**< Clock chosen by the last tuning, 0 if not tuned */
+	uint16_t _tuneMaxKHz = CLOCK_TUNE_MAX;      /**< Highest clock of the last tuning, used by re-tunes */
+	uint8_t _tuneMargin = CLOCK_TUNE_MARGIN;    /**< Margin of the last tuning, used by re-tunes */
+	bool _autoTune = false;          /**< Re-tune when the error rate climbs */
+	bool _retuneDue = false;         /**< Error limit reached, re-tune on the next I2CClockRetune */
+	uint8_t _errorLimit = CLOCK_TUNE_ERROR_LIMIT; /**< Failed writes per window that trigger a re-tune */
+	uint16_t _windowWrites = 0;      /**< Writes in the current window */
+	uint16_t _windowErrors = 0;      /**< Failed writes in the current window */
+	uint32_t _tuneRuns = 0;          /**< Tunings run */
+	uint64_t _lastTuneUs = 0;        /**< time_us_64 of the last tuning */
+};
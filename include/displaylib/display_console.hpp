@@ -0,0 +1,62 @@
+/*!
+	@file display_console.hpp
+	@brief Scrolling text console, uses the display start line register
+		to scroll so a new line only writes one text row of display RAM.
+	@author Gavin Lyons.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include "display_data.hpp"
+#include "display_print.hpp"
+#include "display_fonts.hpp"
+#include "display_flush.hpp"
+
+/*!
+	@brief Text console that prints straight to display RAM with hardware scroll.
+	@details Display RAM is used as a ring of pages, one text row per page.
+		When the bottom row is full, the page that scrolls off the top is
+		cleared and reused as the new bottom row, then the start line register
+		is moved down one page. No screen buffer is used or needed.
+		Supported: SSD1306, ERMCH1115, ERM19264.
+	@note Fonts must be 8 pixels high, e.g. pFontDefault, pFontWide, pFontSinclairS.
+		Rotation is not applied. While the console is in use the driver update
+		functions should not be called, call consoleEnd first.
+*/
+class displaylib_console : public Print
+{
+public:
+	displaylib_console(displaylib_flush &display);
+
+	DisplayRet::Ret_Codes_e consoleBegin(std::span<const uint8_t> font = pFontDefault);
+	DisplayRet::Ret_Codes_e consoleEnd(void);
+	DisplayRet::Ret_Codes_e consoleClear(void);
+	void setConsoleInvert(bool invert);
+
+	uint8_t getConsoleRows(void) const;
+	uint8_t getConsoleColumns(void) const;
+
+	virtual size_t write(uint8_t character) override;
+	using Print::write;
+
+private:
+	DisplayRet::Ret_Codes_e newLine(void);
+	DisplayRet::Ret_Codes_e clearPage(uint8_t ramPage);
+	DisplayRet::Ret_Codes_e drawGlyph(uint8_t character);
+	uint8_t cursorPage(void) const;
+
+	displaylib_flush &_display; /**< Display driver written to */
+	std::span<const uint8_t> _font; /**< Font, 8 pixel high only */
+	uint8_t _fontWidth = 0;    /**< Width of a character in pixels */
+	uint8_t _fontOffset = 0;   /**< First ASCII character in font */
+	uint8_t _fontNumChars = 0; /**< Number of characters in font */
+	uint8_t _ramPages = 0;     /**< Pages of display RAM in ring */
+	uint8_t _rows = 0;         /**< Text rows shown on screen */
+	uint8_t _topPage = 0;      /**< RAM page at top of screen */
+	uint8_t _row = 0;          /**< Cursor row 0 to _rows-1 */
+	uint8_t _column = 0;       /**< Cursor column in pixels */
+	bool _invert = false;      /**< Print white on black if false */
+	bool _active = false;      /**< consoleBegin succeeded */
+};
@@ -10,10 +10,11 @@
 
 ///@cond
 // GPIO Abstraction , makes it easy to  port to other platforms
-#define display_CS_SetHigh gpio_put(_display_CS, true)
-#define display_CS_SetLow gpio_put(_display_CS, false)
-#define display_CD_SetHigh gpio_put(_display_CD, true)
-#define display_CD_SetLow gpio_put(_display_CD, false)
+// CS and CD are also noted in the bus trace and capture, see _BUS_TRACE_ENABLE and _BUS_CAPTURE_ENABLE in display_flush.hpp
+#define display_CS_SetHigh do { gpio_put(_display_CS, true); busLineSet(TraceCS, 1); } while (0)
+#define display_CS_SetLow do { gpio_put(_display_CS, false); busLineSet(TraceCS, 0); } while (0)
+#define display_CD_SetHigh do { gpio_put(_display_CD, true); busLineSet(TraceDC, 1); } while (0)
+#define display_CD_SetLow do { gpio_put(_display_CD, false); busLineSet(TraceDC, 0); } while (0)
 #define display_RST_SetHigh gpio_put(_display_RST, true)
 #define display_RST_SetLow gpio_put(_display_RST, false)
 #define display_SCLK_SetHigh gpio_put(_display_SCLK, true)
@@ -22,7 +23,7 @@
 #define display_SDA_SetLow gpio_put(_display_DIN, false)
 ///@endcond
 
-const uint16_t __LibVerNum__ = 200; /**< Library version number 133 = 1.3.3*/
+const uint16_t __LibVerNum__ = 210; /**< Library version number 133 = 1.3.3*/
 
 /*! namespace for the return code enum*/
 namespace DisplayRet{
@@ -48,6 +49,8 @@ namespace DisplayRet{
 		I2CbeginFail = 15,          /**< Failed to open I2C*/
 		I2CNotConnected = 16,       /**< I2C not connected as per checkConnection() tests */
 		GenericError = 17,          /**< Generic Error message */
-		ShapeScreenBounds = 18      /**< Shape out of screen bounds  */
+		ShapeScreenBounds = 18,     /**< Shape out of screen bounds  */
+		PipelineState = 19,         /**< Pipeline not running or no frame acquired */
+		BusRetry = 20               /**< Flush write failed, updateStep tries it again on the next call */
 	};
 }
@@ -0,0 +1,166 @@
+/*!
+	@file display_diag.hpp
+	@brief Diagnostics for the library, errors and warnings are recorded as
+		small entries in a ring buffer and printed later, off the hot path.
+	@author Gavin Lyons.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include "display_data.hpp"
+
+/*!
+	@brief Diagnostics level compiled in.
+	@details 0 off, nothing is recorded and no ring buffer is compiled in.
+		1 errors, 2 errors and warnings, 3 errors warnings and info.
+		Can be overridden from the build, e.g. target_compile_definitions.
+*/
+#ifndef _DIAG_LEVEL
+#define _DIAG_LEVEL 2
+#endif
+
+/*!
+	@brief Library diagnostics, records errors as (level, function, code, args)
+		entries and formats them only when drained.
+	@details An error in a draw or bus function used to call printf, which over
+		USB CDC costs about a millisecond a line, per character for text that
+		runs off screen. Now the function records a 12 byte entry and carries on.
+		The user calls drain() from the main loop, or wherever stdio is cheap,
+		to print what was recorded. There is one lock free ring per core so both
+		cores can record without locks. When a ring is full new entries are
+		dropped and counted.
+	@note drain and pop should only be called from one core.
+*/
+class displaylib_diag
+{
+public:
+	/*! Enum to define the level of an entry */
+	enum diag_level_e : uint8_t
+	{
+		LevelOff = 0,     /**< Nothing recorded */
+		LevelError = 1,   /**< Function failed */
+		LevelWarning = 2, /**< Bad parameter corrected, function carried on */
+		LevelInfo = 3     /**< Status information */
+	};
+
+	/*! Enum to define the function that recorded an entry */
+	enum diag_func_e : uint8_t
+	{
+		FuncWriteChar = 0,      /**< displaylib_graphics::writeChar */
+		FuncDrawBitmap,         /**< displaylib_graphics::drawBitmap */
+		FuncDrawPolygon,        /**< displaylib_graphics::drawPolygon */
+		FuncDrawDotGrid,        /**< displaylib_graphics::drawDotGrid */
+		FuncSetFont,            /**< displaylib_fonts::setFont */
+		FuncUpdateBegin,        /**< displaylib_flush::updateBegin */
+		FuncSetUpdateChunkSize, /**< displaylib_flush::setUpdateChunkSize */
+		FuncFlushStartLine,     /**< displaylib_flush::flushStartLine */
+		FuncPipelineStart,      /**< displaylib_pipeline::pipelineStart */
+		FuncFrameSubmit,        /**< displaylib_pipeline::frameSubmit */
+		FuncConsoleBegin,       /**< displaylib_console::consoleBegin */
+		FuncConsoleClear,       /**< displaylib_console::consoleClear */
+		FuncConsoleWrite,       /**< displaylib_console::write */
+		FuncSetBufferPtr,       /**< driver OLEDSetBufferPtr / LCDSetBufferPtr */
+		FuncUpdate,             /**< driver OLEDupdate / LCDupdate */
+		FuncClearBuffer,        /**< driver OLEDclearBuffer / LCDclearBuffer */
+		FuncFillPage,           /**< driver OLEDFillPage */
+		FuncDriverBitmap,       /**< driver OLEDBitmap */
+		FuncBegin,              /**< driver OLEDbegin, I2C connection check */
+		FuncInit,               /**< driver OLEDinit */
+		FuncSPISetup,           /**< driver LCDSPISetup */
+		FuncI2CWriteByte,       /**< driver I2CWriteByte, args attempt and SDK return code */
+		FuncI2CWriteBlock,      /**< driver I2CWriteBlock, args attempt and SDK return code */
+		FuncI2CReconnect,       /**< driver breaker reconnect */
+		FuncSetTextScale,       /**< displaylib_graphics::setTextScale */
+		FuncUpdateRegion,       /**< displaylib_flush::updateRegion */
+		FuncNumericField,       /**< displaylib_numeric_field::setValue / setText */
+		FuncStripChart,         /**< displaylib_strip_chart */
+		FuncAnimation,          /**< displaylib_animation */
+		FuncManager,            /**< displaylib_manager */
+		FuncClockTune,          /**< displaylib_clocktune::I2CClockTune, args clock set and fastest step passed kHz */
+		FuncSnapshot,           /**< displaylib_snapshot::snapshotBegin */
+		FuncRemote,             /**< displaylib_remote, args frame type and payload length of a bad frame */
+		FuncListView,           /**< displaylib_list_view */
+		FuncSprite,             /**< displaylib_sprite_layer */
+		FuncGrayscale,          /**< displaylib_grayscale */
+		FuncCheckConnection,    /**< driver CheckConnection, args SDK return code and byte read */
+		FuncCount               /**< Number of functions, not a function */
+	};
+
+	/*! One recorded diagnostic, 12 bytes */
+	struct diag_entry_t
+	{
+		uint32_t timeUs = 0; /**< time_us_32 when recorded */
+		int16_t arg0 = 0;    /**< First argument, meaning depends on function */
+		int16_t arg1 = 0;    /**< Second argument */
+		uint8_t level = 0;   /**< diag_level_e */
+		uint8_t func = 0;    /**< diag_func_e */
+		uint8_t code = 0;    /**< DisplayRet::Ret_Codes_e */
+		uint8_t core = 0;    /**< Core that recorded it */
+	};
+
+	static constexpr uint8_t DIAG_RING_SIZE = 16; /**< Entries per core, power of 2 */
+	static constexpr uint8_t DIAG_CORES = 2;      /**< One ring per core */
+
+	/*!
+		@brief Record an error
+		@param func function recording
+		@param code return code of the function
+		@param arg0 first argument
+		@param arg1 second argument
+	*/
+	static inline void error(diag_func_e func, DisplayRet::Ret_Codes_e code, int16_t arg0 = 0, int16_t arg1 = 0)
+	{
+		if constexpr (_DIAG_LEVEL >= LevelError)
+			record(LevelError, func, code, arg0, arg1);
+	}
+	/*!
+		@brief Record a warning
+		@param func function recording
+		@param code related return code
+		@param arg0 first argument
+		@param arg1 second argument
+	*/
+	static inline void warning(diag_func_e func, DisplayRet::Ret_Codes_e code, int16_t arg0 = 0, int16_t arg1 = 0)
+	{
+		if constexpr (_DIAG_LEVEL >= LevelWarning)
+			record(LevelWarning, func, code, arg0, arg1);
+	}
+	/*!
+		@brief Record an info entry
+		@param func function recording
+		@param code related return code
+		@param arg0 first argument
+		@param arg1 second argument
+	*/
+	static inline void info(diag_func_e func, DisplayRet::Ret_Codes_e code, int16_t arg0 = 0, int16_t arg1 = 0)
+	{
+		if constexpr (_DIAG_LEVEL >= LevelInfo)
+			record(LevelInfo, func, code, arg0, arg1);
+	}
+
+	static uint16_t drain(uint16_t maxEntries = 0xFFFF);
+	static bool pop(diag_entry_t &entry);
+	static uint32_t getDropped(void);
+	static uint16_t pending(void);
+	static const char *funcName(uint8_t func);
+	static const char *codeName(uint8_t code);
+
+private:
+	static void record(diag_level_e level, diag_func_e func, DisplayRet::Ret_Codes_e code, int16_t arg0, int16_t arg1);
+	static uint8_t coreNumber(void);
+
+#if _DIAG_LEVEL > 0
+	/*! Single producer, single consumer ring of entries, one per core */
+	struct diag_ring_t
+	{
+		diag_entry_t entries[DIAG_RING_SIZE]; /**< The entries */
+		std::atomic<uint8_t> head{0};   /**< Next write, recording core only */
+		std::atomic<uint8_t> tail{0};   /**< Next read, draining core only */
+		std::atomic<uint32_t> dropped{0}; /**< Entries lost to a full ring, recording core only */
+	};
+	static diag_ring_t _rings[DIAG_CORES]; /**< One ring per core */
+	static uint32_t _droppedReported; /**< Dropped count already printed by drain */
+#endif
+};
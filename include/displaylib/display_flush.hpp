@@ -0,0 +1,247 @@
+/*!
+	@file display_flush.hpp
+	@brief Base class for the incremental, time sliced flush of a screen buffer
+		to the display, shared by all the drivers.
+	@author Gavin Lyons.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include "display_data.hpp"
+
+#define _BUS_STATS_ENABLE
+// #define _BUS_TRACE_ENABLE // records bus writes and DC/CS toggles for extra/tools/displaylib_buscost.py
+// #define _BUS_CAPTURE_ENABLE // records the bytes of each bus write for extra/tools/displaylib_capture.py
+
+class displaylib_console;
+class displaylib_snapshot;
+class displaylib_grayscale;
+
+/*!
+	@brief Base class that transmits a screen buffer to the display in
+		small chunks, so the user can spread a frame over several calls
+		and keep each call within a time budget.
+	@details The buffer is sent page by page (8 pixel rows), each page is
+		cut into chunks of setUpdateChunkSize() bytes. The driver sub-class
+		supplies the bus specific parts by overriding the flush hooks.
+*/
+class displaylib_flush
+{
+	friend class displaylib_console;
+	friend class displaylib_snapshot;
+	friend class displaylib_grayscale;
+public:
+	displaylib_flush(int16_t w, int16_t h);
+	virtual ~displaylib_flush() = default;
+
+	/*! Enum to define the state returned by updateStep */
+	enum flush_state_e : uint8_t
+	{
+		FlushIdle = 0,  /**< No flush in progress, nothing was sent */
+		FlushBusy = 1,  /**< Flush in progress, more data still to send */
+		FlushDone = 2,  /**< The last of the frame was sent during this call */
+		FlushError = 3  /**< Flush aborted due to a bus error */
+	};
+
+	/*! A rectangle of the screen buffer, e.g. the pixels a widget changed, empty when w or h is 0 */
+	struct flush_rect_t
+	{
+		int16_t x = 0; /**< Left */
+		int16_t y = 0; /**< Top */
+		int16_t w = 0; /**< Width in pixels */
+		int16_t h = 0; /**< Height in pixels */
+	};
+
+	DisplayRet::Ret_Codes_e updateBegin(void);
+	DisplayRet::Ret_Codes_e updateBegin(std::span<const uint8_t> frame);
+	DisplayRet::Ret_Codes_e updateBegin(const flush_rect_t &rect);
+	flush_state_e updateStep(uint32_t budgetUs);
+	void updateCancel(void);
+	DisplayRet::Ret_Codes_e updateRegion(int16_t x, int16_t y, int16_t w, int16_t h);
+	DisplayRet::Ret_Codes_e updateRegion(const flush_rect_t &rect);
+	static flush_rect_t rectMerge(const flush_rect_t &a, const flush_rect_t &b);
+
+	bool updateBusy(void) const;
+	uint8_t updateProgress(void) const;
+	uint16_t updateBytesSent(void) const;
+	uint16_t updateBytesTotal(void) const;
+	flush_rect_t updateFrameRect(void) const;
+	uint8_t getUpdateChunkSize(void) const;
+	void setUpdateChunkSize(uint8_t chunkSize);
+	bool isReady(void);
+
+	static constexpr uint8_t UPDATE_CHUNK_DEFAULT = 16; /**< default bytes sent per chunk */
+	static constexpr uint8_t UPDATE_CHUNK_MAX = 64; /**< largest chunk size allowed */
+
+#ifdef _BUS_STATS_ENABLE
+	static constexpr uint8_t BUS_STATS_BINS = 20; /**< Histogram bins, bin n counts frames of 2^n to 2^(n+1)-1 uS, last bin is the overflow */
+
+	/*! Bus counters of the display, SPI writes can not fail so only the first two are counted on SPI */
+	struct bus_stats_t
+	{
+		uint32_t transactions = 0;  /**< Bus writes attempted */
+		uint32_t bytes = 0;         /**< Bytes written successfully, including I2C control bytes */
+		uint32_t retries = 0;       /**< I2C writes retried */
+		uint32_t timeouts = 0;      /**< I2C writes failed with timeout */
+		uint32_t nacks = 0;         /**< I2C writes failed with address or data not acknowledged */
+		uint32_t frames = 0;        /**< Frames sent by update or updateStep */
+		uint64_t frameTotalUs = 0;  /**< Total bus time of frames, uS */
+		uint32_t frameMaxUs = 0;    /**< Longest frame bus time, uS */
+		uint32_t frameHistogram[BUS_STATS_BINS] = {0}; /**< log2 histogram of frame bus time */
+	};
+
+	const bus_stats_t &getBusStats(void) const;
+	void resetBusStats(void);
+#endif
+
+	/*! Enum to define the event of a bus trace record */
+	enum trace_event_e : uint8_t
+	{
+		TraceWrite = 0,       /**< Bus write, value is bytes including I2C control byte */
+		TraceWriteFailed = 1, /**< I2C write not acknowledged or timed out, value is bytes */
+		TraceDC = 2,          /**< SPI DC line set, value is level */
+		TraceCS = 3,          /**< SPI CS line set, value is level */
+		TraceFrame = 4        /**< Frame sent by update or updateStep, value 0 */
+	};
+
+#ifdef _BUS_TRACE_ENABLE
+	/*! One bus trace record, 8 bytes */
+	struct bus_trace_t
+	{
+		uint32_t timeUs = 0; /**< time_us_32 when recorded */
+		uint16_t value = 0;  /**< Meaning depends on event */
+		uint8_t event = 0;   /**< trace_event_e */
+		uint8_t reserved = 0; /**< Padding */
+	};
+
+	void busTraceStart(std::span<bus_trace_t> records);
+	void busTraceStop(void);
+	uint32_t getBusTraceCount(void) const;
+	uint32_t getBusTraceDropped(void) const;
+	void busTraceDump(void);
+#endif
+
+#ifdef _BUS_CAPTURE_ENABLE
+	static constexpr uint8_t BUS_CAPTURE_HEADER = 7; /**< Bytes of capture buffer used per write besides the data */
+
+	void busCaptureStart(std::span<uint8_t> buffer);
+	void busCaptureStop(void);
+	uint32_t getBusCaptureWrites(void) const;
+	uint32_t getBusCaptureDropped(void) const;
+	void busCaptureDump(void);
+#endif
+
+protected:
+	DisplayRet::Ret_Codes_e updateComplete(void);
+	void flushAddressLost(void);
+
+	static constexpr uint32_t BOOT_DONE = 0xFFFFFFFF; /**< Returned by bootStage when the power up sequence is finished */
+	void bootBegin(void);
+	void bootComplete(void);
+	void bootRamReady(void);
+	virtual uint32_t bootStage(uint8_t stage);
+#ifdef _BUS_STATS_ENABLE
+	void statsBusWrite(int returnCode, std::span<const uint8_t> data);
+	/*! @brief Counts an I2C write retry */
+	void statsRetry(void) { _busStats.retries++; }
+	void statsFrame(uint32_t frameUs);
+#else
+	/*! @brief Bus counters compiled out, the write is still traced and captured */
+	void statsBusWrite(int returnCode, std::span<const uint8_t> data)
+	{
+		traceRecord((returnCode < 0) ? TraceWriteFailed : TraceWrite, data.size());
+		captureRecord(returnCode, data);
+	}
+	void statsRetry(void) {}
+	/*! @brief Bus counters compiled out, the frame is still traced */
+	void statsFrame(uint32_t) { traceRecord(TraceFrame, 0); }
+#endif
+#ifdef _BUS_TRACE_ENABLE
+	void traceRecord(trace_event_e event, size_t value);
+#else
+	void traceRecord(trace_event_e, size_t) {}
+#endif
+#ifdef _BUS_CAPTURE_ENABLE
+	void captureRecord(int returnCode, std::span<const uint8_t> data);
+#else
+	void captureRecord(int, std::span<const uint8_t>) {}
+#endif
+	/*!
+		@brief Notes a DC or CS line change, called by the display_CD and display_CS macros
+		@param event TraceDC or TraceCS
+		@param level the line level
+	*/
+	void busLineSet(trace_event_e event, uint8_t level)
+	{
+		traceRecord(event, level);
+#ifdef _BUS_CAPTURE_ENABLE
+		if (event == TraceDC)
+			_captureDC = static_cast<int8_t>(level);
+#endif
+	}
+
+	/*!
+		@brief Returns the drivers own screen buffer, the default frame for updateBegin()
+		@return span of the screen buffer, empty if not yet assigned
+	*/
+	virtual std::span<const uint8_t> flushBuffer(void) = 0;
+	/*!
+		@brief Sets the display RAM write pointer for the next flush data
+		@param page the page (8 pixel row) to write
+		@param column first column to write
+		@param columnEnd last column to be written in this page
+		@return Success or a bus error code
+	*/
+	virtual DisplayRet::Ret_Codes_e flushSetAddress(uint8_t page, uint8_t column, uint8_t columnEnd) = 0;
+	/*!
+		@brief Writes a chunk of frame data to the display RAM at the current write pointer
+		@param data the data to write, never larger than UPDATE_CHUNK_MAX
+		@return Success or a bus error code
+	*/
+	virtual DisplayRet::Ret_Codes_e flushWriteData(std::span<const uint8_t> data) = 0;
+	virtual DisplayRet::Ret_Codes_e flushStartLine(uint8_t line);
+	virtual uint8_t flushRamPages(void);
+
+	uint8_t _flushWidth;  /**< Width of frame in pixels (columns) */
+	uint8_t _flushPages;  /**< Number of pages (8 pixel rows) in frame */
+
+private:
+	std::span<const uint8_t> _flushFrame; /**< Frame being sent */
+	bool _flushActive = false;  /**< Is a flush in progress */
+	bool _flushAddressValid = false; /**< Is display RAM pointer at the resume position */
+	uint8_t _flushChunkSize = UPDATE_CHUNK_DEFAULT; /**< Bytes sent per chunk */
+	uint8_t _flushPage = 0;  /**< Current page of flush */
+	uint8_t _flushColumn = 0; /**< Current column in page of flush */
+	uint16_t _flushSent = 0;  /**< Bytes of frame sent so far */
+	uint16_t _flushTotal = 0; /**< Bytes to send, the whole frame or the rectangle */
+	uint8_t _flushColumnStart = 0; /**< First column of each page sent */
+	uint8_t _flushColumnEnd = 0;   /**< Column after the last sent in each page */
+	uint8_t _flushPageEnd = 0;     /**< Page after the last sent */
+	uint32_t _flushChunkUs = 0; /**< Time taken by last chunk in uS, used to predict the next */
+	DisplayRet::Ret_Codes_e _flushResult = DisplayRet::Success; /**< Bus error that aborted the last flush */
+	uint32_t _flushFrameUs = 0; /**< Bus time of frame in progress, uS */
+	bool _bootActive = false;   /**< Power up sequence in progress */
+	bool _bootRamReady = true;  /**< Display RAM can be written, power up may still be in progress */
+	uint8_t _bootStage = 0;     /**< Next stage of the power up sequence */
+	uint64_t _bootDeadlineUs = 0; /**< time_us_64 when the next stage is due */
+#ifdef _BUS_STATS_ENABLE
+	bus_stats_t _busStats; /**< Bus counters */
+#endif
+#ifdef _BUS_TRACE_ENABLE
+	std::span<bus_trace_t> _traceRecords; /**< Trace buffer supplied by the user */
+	bool _traceActive = false;  /**< Recording */
+	uint32_t _traceCount = 0;   /**< Records in the buffer */
+	uint32_t _traceDropped = 0; /**< Records lost as the buffer was full */
+#endif
+#ifdef _BUS_CAPTURE_ENABLE
+	std::span<uint8_t> _captureBuffer; /**< Capture buffer supplied by the user */
+	bool _captureActive = false;   /**< Recording */
+	bool _captureFull = false;     /**< A write did not fit, the rest are dropped so the capture has no gaps */
+	int8_t _captureDC = -1;        /**< Last SPI DC level, -1 if never set, i.e. an I2C display */
+	uint32_t _captureUsed = 0;     /**< Bytes of the buffer used */
+	uint32_t _captureWrites = 0;   /**< Writes in the buffer */
+	uint32_t _captureDropped = 0;  /**< Writes lost as the buffer was full */
+#endif
+};
@@ -2,7 +2,22 @@
 	@file display_fonts.hpp
 	@brief font data file 10 fonts. Data Vertical addressed 1-bit color displays.
 	@author Gavin Lyons.
-	@details 
+	@details Remapped fonts, made from BDF fonts by extra/tools/displaylib_fonts.py,
+		hold only the glyphs an application uses. Format:
+		-# Header 8 bytes: 0 (marks the format), x size, y size (multiple of 8),
+			flags, first code, last code, glyph count, 0
+		-# Index table, last - first + 1 bytes, glyph number of each code or 0xFF
+		-# Width table, glyph count bytes, if flags FONT_FLAG_PROPORTIONAL
+		-# Glyphs, x size * y size / 8 bytes each, page layout as the fonts below,
+			a proportional glyph uses its first width columns
+		Range fonts, flags FONT_FLAG_RANGES, hold any Unicode code points:
+		-# Header 12 bytes: 0, x size, y size, flags, glyph count (2),
+			fallback glyph (2, 0xFFFF none), range count (2), 0 (2)
+		-# Range table, 8 bytes each, sorted: first code point (4), count (2),
+			glyph of the first code point (2). Found by binary search.
+		-# Width table and glyphs as above
+		Numbers are little endian.
+		Built in fonts:
 		-#  1. pFontDefault  6 by 8
 		-#  2. pFontWide  9 by 8 (NO LOWERCASE)
 		-#  3. pFontpico 3 by 6
@@ -43,16 +58,45 @@ class displaylib_fonts
 		~displaylib_fonts() = default;
 
 		DisplayRet::Ret_Codes_e setFont(std::span<const uint8_t> font);
+		std::span<const uint8_t> getFont(void) const;
 		void setInvertFont(bool invertStatus);
 		bool getInvertFont(void);
+		uint8_t getCharWidth(char value) const;
+		uint8_t getCodePointWidth(char32_t codePoint) const;
+		DisplayRet::Ret_Codes_e setFontFallback(char32_t codePoint);
+
+		static constexpr uint8_t FONT_REMAP_HEADER_SIZE = 8; /**< Header bytes of a remapped font */
+		static constexpr uint8_t FONT_RANGE_HEADER_SIZE = 12; /**< Header bytes of a range font */
+		static constexpr uint8_t FONT_RANGE_ENTRY_SIZE = 8; /**< Bytes per range of a range font */
+		static constexpr uint8_t FONT_FLAG_PROPORTIONAL = 0x01; /**< Remapped font flag, width table present */
+		static constexpr uint8_t FONT_FLAG_RANGES = 0x02; /**< Remapped font flag, range table instead of index table */
+		static constexpr uint8_t FONT_GLYPH_NONE = 0xFF; /**< Remapped font index entry, character not in font */
 
 	protected:
+		int16_t fontGlyphLookup(char32_t codePoint) const;
+		int16_t fontGlyph(char32_t codePoint) const;
+		uint32_t fontGlyphIndex(uint16_t glyph) const;
+		uint8_t fontGlyphWidth(uint16_t glyph) const;
+
 		std::span<const uint8_t> _FontSelect = pFontDefault; /**< span to the active font,  Fonts Stored are Const */
 		uint8_t _Font_X_Size = 0x06; /**< Width Size of a Font character */
 		uint8_t _Font_Y_Size = 0x08; /**< Height Size of a Font character */
 		uint8_t _FontOffset = 0x00; /**< Offset in the ASCII table 0x00 to 0xFF, where font begins */
 		uint8_t _FontNumChars = 0xFE; /**< Number of characters in font 0x00 to 0xFE */
+		bool _FontRemapped = false; /**< Font has an index table, made by extra/tools/displaylib_fonts.py */
+		bool _FontProportional = false; /**< Font has a width table */
+		uint16_t _FontRangeCount = 0; /**< Entries in the range table, 0 if not a range font */
+		uint16_t _FontGlyphCount = 0xFF; /**< Glyphs in the font data */
+		uint16_t _FontGlyphBytes = 6; /**< Bytes per glyph */
+		int16_t _FontFallback = -1; /**< Glyph drawn for characters not in the font, -1 none */
+		uint32_t _FontGlyphStart = 4; /**< Index of the first glyph */
+		uint32_t _FontWidthStart = 0; /**< Index of the width table of a proportional font */
 	private:
+		DisplayRet::Ret_Codes_e selectFont(std::span<const uint8_t> font);
+		DisplayRet::Ret_Codes_e setFontRanges(std::span<const uint8_t> font);
+
 		bool _FontInverted = false; /**< Is the font inverted , False = normal , true = inverted*/
+		const uint8_t *_FontFallbackFont = nullptr; /**< Font the user fallback was set for, nullptr none */
+		char32_t _FontFallbackCode = 0; /**< Character of the user fallback, 0 none */
 };
 
@@ -10,16 +10,24 @@
 #include <cmath> // for "abs"
 #include "display_fonts.hpp"
 #include "display_print.hpp"
+#include "display_diag.hpp"
 
 #define _ADVANCED_GRAPHICS_ENABLE
 
 #ifdef _ADVANCED_GRAPHICS_ENABLE
-#include <vector>
+#include <array>
+#include <span>
+#include <string_view>
 #endif
 
 /*! @brief Graphics class to hold graphic related functions */
 class displaylib_graphics : public displaylib_fonts , public Print 
 {
+	friend class displaylib_strip_chart;
+	friend class displaylib_animation;
+	friend class displaylib_remote;
+	friend class displaylib_list_view;
+	friend class displaylib_sprite_layer;
 
  public:
 
@@ -65,8 +73,17 @@ class displaylib_graphics : public displaylib_fonts , public Print
 	// Text related functions 
 	virtual size_t write(uint8_t);
 	DisplayRet::Ret_Codes_e writeChar( int16_t x, int16_t y, char value );
+	DisplayRet::Ret_Codes_e writeCodePoint(int16_t x, int16_t y, char32_t codePoint);
 	DisplayRet::Ret_Codes_e writeCharString( int16_t x, int16_t y, char *text);
+	int16_t getTextWidth(std::string_view text) const;
 	void setTextWrap(bool w);
+	void setTextUTF8(bool utf8);
+	bool getTextUTF8(void) const;
+	void setTextScale(uint8_t scaleX, uint8_t scaleY);
+	uint8_t getTextScaleX(void) const;
+	uint8_t getTextScaleY(void) const;
+
+	static constexpr uint8_t TEXT_SCALE_MAX = 4; /**< Max text scale factor, each axis */
 
 	void setDrawBitmapAddr(bool mode);
 	DisplayRet::Ret_Codes_e  drawBitmap(int16_t x, int16_t y, std::span<const uint8_t> bitmap,
@@ -87,6 +104,8 @@ class displaylib_graphics : public displaylib_fonts , public Print
 		int16_t x2, int16_t y2, int16_t x3, int16_t y3, uint8_t color);
 	DisplayRet::Ret_Codes_e drawPolygon(int16_t x, int16_t y, uint8_t sides, 
 		int16_t diameter, float rotation, bool fill , uint8_t color);
+	DisplayRet::Ret_Codes_e drawPolygon(std::span<const int16_t> vx, std::span<const int16_t> vy,
+		bool fill, uint8_t color);
 	void drawArc(uint16_t cx, uint16_t cy, uint16_t radius, uint16_t thickness, 
 		float startAngle, float endAngle, uint8_t color);
 	void drawSimpleArc(int16_t cx, int16_t cy, int16_t radius, float startAngle, 
@@ -100,6 +119,7 @@ class displaylib_graphics : public displaylib_fonts , public Print
 	int getArcAngleOffset() const;
 	void setArcAngleOffset(int arcAngleOffset);
 
+	static constexpr uint8_t POLYGON_SIDES_MAX = 32; /**< Max polygon sides, sets the stack scratch size of drawPolygon */
 #endif
 
  protected:
@@ -113,6 +133,16 @@ class displaylib_graphics : public displaylib_fonts , public Print
 	int16_t _cursor_y = 0;  /**< Current Y co-ord cursor position */
 	bool _drawBitmapAddr; /**< data addressing mode for method drawBitmap, True-vertical , false-horizontal */
 	bool _textwrap = true;  /**< If set, text at right edge of display will wrap, print method*/
+	bool _textUTF8 = false; /**< Text is decoded as UTF-8, else one Latin-1 character per byte */
+	uint8_t _textScaleX = 1; /**< Text scale factor x-axis, 1 to TEXT_SCALE_MAX */
+	uint8_t _textScaleY = 1; /**< Text scale factor y-axis, 1 to TEXT_SCALE_MAX */
+	/*!
+		@brief The screen buffer for direct byte writes, page layout, bit 0 top of page
+		@return the buffer, or empty span, the default, to draw with drawPixel only
+	*/
+	virtual std::span<uint8_t> graphicsBuffer(void) { return {}; }
+	DisplayRet::Ret_Codes_e pageBuffer(std::span<uint8_t> &buffer, displaylib_diag::diag_func_e func,
+		bool physical = false);
 #ifdef _ADVANCED_GRAPHICS_ENABLE
 	float _arcAngleMax = 360.0f; /**< Maximum angle of Arc , used by drawArc*/
 	int _arcAngleOffset= 0; /**< used by drawArc, offset for adjusting the starting angle of arc. default positive X-axis (0°)*/
@@ -127,6 +157,13 @@ class displaylib_graphics : public displaylib_fonts , public Print
 		void fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername,
 								int16_t delta, uint8_t color);
 	private:
+	DisplayRet::Ret_Codes_e writeCharScaled(int16_t x, int16_t y, uint16_t glyph);
+	void writeCode(char32_t codePoint);
+	static char32_t decodeUTF8(std::string_view text, size_t &pos);
+	char32_t textDecode(std::string_view text, size_t &pos) const;
+	void writeColumnBits(int16_t x, int16_t y, uint32_t bits, uint8_t count, std::span<uint8_t> buffer);
+	bool blitPages(int16_t x, int16_t y, std::span<const uint8_t> bitmap,
+		int16_t w, int16_t h, uint8_t color, uint8_t bg);
 	/*!
 		@brief Swaps the values of two int16_t variables.
 		@param a Reference to the first integer.
@@ -138,5 +175,9 @@ class displaylib_graphics : public displaylib_fonts , public Print
 		a = b;
 		b = t;
 	}
+
+	uint8_t _utf8Bytes[4] = {0}; /**< print, bytes of a UTF-8 sequence not yet complete */
+	uint8_t _utf8Count = 0; /**< print, bytes held in _utf8Bytes */
+	uint8_t _utf8Need = 0; /**< print, length of the sequence in _utf8Bytes, 0 none */
 };
 
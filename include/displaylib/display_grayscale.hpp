@@ -0,0 +1,109 @@
+/*!
+	@file display_grayscale.hpp
+	@brief Temporal dither grayscale, a 4 level canvas shown on a 1 bit display
+		by sending its two bit planes in a weighted sequence at a fixed cadence.
+	@author Gavin Lyons.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include "display_data.hpp"
+#include "display_flush.hpp"
+
+/*!
+	@brief 2 bits per pixel canvas and the sub-frame sequencer that shows it.
+	@details The canvas is two planes in the layout of the screen buffer, plane 0
+		the low bit of the level and plane 1 the high bit. The sequencer sends one
+		plane per sub-frame, the default sequence 1 0 1 shows plane 1 for two
+		sub-frames and plane 0 for one, so levels 0 to 3 are lit 0, 1, 2 and 3
+		sub-frames of 3. A sub-frame starts only once the last one is on the
+		display, at the next tick of the sub-frame period, so every plane is
+		shown for the same time. How sub-frames are sent is picked by grayBegin:
+		-# GrayRamFlip the display RAM holds both planes, e.g. SSD1306 128x32,
+			they are written once and a sub-frame is one start line command.
+		-# GrayStream each sub-frame is a flush of the plane, sent in chunks of
+			UPDATE_CHUNK_MAX bytes, the fewest bus transactions. The bus must send
+			a frame within the period for the levels to hold, raise the I2C clock,
+			see I2CClockTune, and check getSubframeRate.
+		grayDither writes an ordered dither of the canvas into a 1 bit frame,
+		for a static picture when the bus is too slow or the sequencer stops.
+	@note Do not call the driver update functions while the sequencer runs.
+*/
+class displaylib_grayscale
+{
+public:
+	/*! Enum to define how sub-frames are sent, picked by grayBegin */
+	enum gray_mode_e : uint8_t
+	{
+		GrayStream = 0,  /**< Each sub-frame flushes a plane */
+		GrayRamFlip = 1  /**< Both planes in display RAM, each sub-frame sets the start line */
+	};
+
+	/*! Sequencer counters, since grayBegin or resetStats */
+	struct gray_stats_t
+	{
+		uint32_t subframes = 0;   /**< Sub-frames shown */
+		uint32_t cycles = 0;      /**< Whole sequences shown */
+		uint32_t overruns = 0;    /**< Sub-frames started a period or more late, the bus was too slow */
+		uint32_t flushErrors = 0; /**< Sub-frames aborted by a bus error */
+		uint32_t sendLastUs = 0;  /**< Time to send the last sub-frame, uS */
+		uint32_t sendMaxUs = 0;   /**< Longest time to send a sub-frame, uS */
+		uint32_t uploadPages = 0; /**< Pages written to display RAM, GrayRamFlip only */
+	};
+
+	static constexpr uint8_t GRAY_LEVELS = 4;                 /**< Levels, 0 black to 3 white */
+	static constexpr uint8_t GRAY_SEQUENCE_MAX = 8;           /**< Max sub-frames in a sequence */
+	static constexpr uint32_t GRAY_PERIOD_DEFAULT = 5000;     /**< Default sub-frame period, uS, 200 Hz */
+
+	explicit displaylib_grayscale(displaylib_flush &display);
+
+	DisplayRet::Ret_Codes_e grayBegin(std::span<uint8_t> planes);
+	DisplayRet::Ret_Codes_e grayEnd(void);
+	DisplayRet::Ret_Codes_e setGraySequence(std::span<const uint8_t> sequence);
+	void setSubframePeriod(uint32_t periodUs);
+	gray_mode_e getGrayMode(void) const;
+
+	void grayClear(uint8_t level = 0);
+	void grayDrawPixel(int16_t x, int16_t y, uint8_t level);
+	uint8_t grayGetPixel(int16_t x, int16_t y) const;
+	void grayFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t level);
+	DisplayRet::Ret_Codes_e grayDrawBitmap(int16_t x, int16_t y, int16_t w, int16_t h,
+		std::span<const uint8_t> bitmap, uint8_t level);
+	DisplayRet::Ret_Codes_e grayDrawImage(int16_t x, int16_t y, int16_t w, int16_t h,
+		std::span<const uint8_t> pixels, bool dither);
+	DisplayRet::Ret_Codes_e grayDrawPlanes(int16_t x, int16_t y, int16_t w, int16_t h,
+		std::span<const uint8_t> planes);
+	DisplayRet::Ret_Codes_e grayDither(std::span<uint8_t> frame) const;
+
+	displaylib_flush::flush_state_e grayStep(uint32_t budgetUs);
+
+	const gray_stats_t &getGrayStats(void) const;
+	float getSubframeRate(void) const;
+	void resetStats(void);
+
+private:
+	std::span<uint8_t> plane(uint8_t number) const;
+	displaylib_flush::flush_state_e subframeStart(void);
+	displaylib_flush::flush_state_e subframeDone(uint64_t nowUs);
+	DisplayRet::Ret_Codes_e uploadStep(uint32_t budgetUs, bool force);
+	void planesChanged(int16_t y, int16_t h);
+
+	displaylib_flush &_display;        /**< Display the planes are sent to */
+	std::span<uint8_t> _planes;        /**< Plane 0 then plane 1, supplied by the user */
+	bool _active = false;              /**< Sequencer running */
+	gray_mode_e _mode = GrayStream;    /**< How sub-frames are sent */
+	uint8_t _savedChunkSize = displaylib_flush::UPDATE_CHUNK_DEFAULT; /**< Chunk size put back by grayEnd */
+	uint8_t _sequence[GRAY_SEQUENCE_MAX] = {1, 0, 1}; /**< Plane of each sub-frame */
+	uint8_t _sequenceLength = 3;       /**< Sub-frames in the sequence */
+	uint8_t _sequencePos = 0;          /**< Next sub-frame */
+	uint32_t _periodUs = GRAY_PERIOD_DEFAULT; /**< Sub-frame period */
+	uint64_t _tickUs = 0;              /**< When the next sub-frame is due */
+	uint64_t _sendStartUs = 0;         /**< When the sub-frame being sent started */
+	bool _sending = false;             /**< A GrayStream sub-frame is being flushed */
+	uint16_t _uploadPending = 0;       /**< GrayRamFlip, bit per RAM page still to write */
+	uint32_t _uploadPageUs = 0;        /**< GrayRamFlip, time the last page took to write */
+	gray_stats_t _stats;               /**< Counters */
+	uint64_t _statsStartUs = 0;        /**< Start of the stats period */
+};
@@ -0,0 +1,103 @@
+/*!
+	@file display_list.hpp
+	@brief List view widget, a scrolling menu of rows that draws only the
+		rows on screen, for lists of any length.
+	@author Gavin Lyons.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include "display_data.hpp"
+#include "display_graphics.hpp"
+#include "display_flush.hpp"
+
+/*!
+	@brief Virtual list over a rectangle of the screen buffer.
+	@details The text of a row is asked for from a row provider function only
+		when the row comes on screen, the list holds no rows itself. The row
+		height is the font height plus the row spacing. Glyphs are written
+		straight into the screen buffer clipped to the rectangle, so a row cut
+		by the top or bottom edge is drawn in part, with no writeChar errors.
+		The selected row is shown by inverting its band of bytes, moving the
+		selection inverts the old and the new band and draws no text. When the
+		selection leaves the rectangle the list scrolls: the bytes of the
+		rectangle are shifted up or down by the scroll, page by page, and only
+		the rows moved into view are drawn. With a scroll speed set the scroll
+		is spread over listScrollStep calls, a few pixels a frame. Changed rows
+		are kept as a rectangle for flushDirty.
+	@note Writes the screen buffer directly, so the display must not be rotated.
+		Text scale and font invert do not apply.
+*/
+class displaylib_list_view
+{
+public:
+	/*!
+		@brief Row provider, writes the text of a row
+		@param row the row, 0 to row count - 1
+		@param text where to write the text, not terminated, UTF-8 if setTextUTF8 is on
+		@param context the pointer given to listBegin
+		@return characters written, up to text.size()
+	*/
+	typedef uint8_t (*list_row_t)(uint16_t row, std::span<char> text, void *context);
+
+	static constexpr uint8_t LIST_TEXT_MAX = 32;   /**< Most bytes of text in a row */
+	static constexpr uint8_t LIST_TEXT_INSET = 1;  /**< Pixels left of the text */
+
+	displaylib_list_view(displaylib_graphics &display, int16_t x, int16_t y, int16_t w, int16_t h,
+		std::span<const uint8_t> font = pFontDefault);
+
+	DisplayRet::Ret_Codes_e listBegin(list_row_t provider, void *context, uint16_t rows);
+	DisplayRet::Ret_Codes_e setRowCount(uint16_t rows);
+	void setRowSpacing(uint8_t pixels);
+	void setScrollSpeed(uint8_t pixels);
+
+	DisplayRet::Ret_Codes_e listRedraw(void);
+	DisplayRet::Ret_Codes_e invalidateRow(uint16_t row);
+	DisplayRet::Ret_Codes_e setSelected(uint16_t row);
+	DisplayRet::Ret_Codes_e moveSelection(int16_t rows);
+	DisplayRet::Ret_Codes_e listScrollTo(int32_t pixels);
+	bool listScrollStep(void);
+
+	uint16_t getSelected(void) const;
+	uint16_t getRowCount(void) const;
+	int16_t getRowHeight(void) const;
+	int32_t getScroll(void) const;
+	bool getScrolling(void) const;
+
+	bool getDirty(void) const;
+	displaylib_flush::flush_rect_t getDirtyRect(void) const;
+	void clearDirty(void);
+	DisplayRet::Ret_Codes_e flushDirty(displaylib_flush &display);
+
+private:
+	DisplayRet::Ret_Codes_e listBuffer(std::span<uint8_t> &buffer);
+	int32_t scrollMax(void) const;
+	int32_t scrollFor(uint16_t row) const;
+	uint8_t bandMask(int16_t page, int16_t top, int16_t bottom) const;
+	void bandInvert(std::span<uint8_t> buffer, uint16_t row, int16_t top, int16_t bottom);
+	void scrollBy(std::span<uint8_t> buffer, int32_t pixels);
+	DisplayRet::Ret_Codes_e drawBand(std::span<uint8_t> buffer, int16_t top, int16_t bottom);
+	void drawRow(std::span<uint8_t> buffer, uint16_t row, int16_t top, int16_t bottom);
+	uint64_t glyphColumn(uint32_t index, uint8_t column) const;
+	void markDirty(int16_t top, int16_t bottom);
+
+	displaylib_graphics &_display;   /**< Display drawn to */
+	std::span<const uint8_t> _font;  /**< Font of the rows */
+	int16_t _x;                      /**< Left of the list */
+	int16_t _y;                      /**< Top of the list */
+	int16_t _w;                      /**< Width of the list */
+	int16_t _h;                      /**< Height of the list */
+	list_row_t _provider = nullptr;  /**< Row provider, nullptr listBegin not called */
+	void *_context = nullptr;        /**< Passed to the row provider */
+	uint16_t _rows = 0;              /**< Rows in the list */
+	uint16_t _selected = 0;          /**< Selected row */
+	uint8_t _spacing = 0;            /**< Pixels below the text of a row */
+	uint8_t _speed = 0;              /**< Scroll pixels per listScrollStep, 0 jumps */
+	int16_t _rowHeight = 8;          /**< Font height plus spacing */
+	int32_t _scroll = 0;             /**< List pixel at the top of the rectangle */
+	int32_t _target = 0;             /**< Scroll listScrollStep moves to */
+	int16_t _dirtyTop = 0;           /**< Changed rows, top screen row */
+	int16_t _dirtyBottom = 0;        /**< Changed rows, screen row below, equal to _dirtyTop if clean */
+};
@@ -0,0 +1,101 @@
+/*!
+	@file display_manager.hpp
+	@brief Multi panel manager, shares the bus time of each bus between the
+		displays on it so one large update can not hold up the others.
+	@author Gavin Lyons.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include "display_data.hpp"
+#include "display_flush.hpp"
+
+/*!
+	@brief Schedules the incremental flushes of several displays, some sharing a bus.
+	@details Each display is added with a bus number chosen by the user, e.g. 0 for
+		i2c1 and 1 for spi0, displays with the same number share that bus.
+		panelSubmit starts a frame, or a rectangle of it such as the getDirtyRect
+		of a widget, managerStep, called once per main loop pass, sends some of
+		each pending frame with updateStep. Each bus has a budget
+		of bus time per managerStep, shared between its pending panels, equally
+		in turn (PolicyRoundRobin) or in proportion to panel priority
+		(PolicyPriority). A panel that got no time in one step goes first in the
+		next, so no panel is starved. A frame submitted while the last one is
+		still being sent is merged, rectangles are joined, and the panel is sent
+		again when the frame in progress is done.
+	@note Do not call the driver update functions of a managed display while a
+		frame it was given is pending.
+*/
+class displaylib_manager
+{
+public:
+	/*! Enum to define how the bus budget is shared between panels on one bus */
+	enum manager_policy_e : uint8_t
+	{
+		PolicyRoundRobin = 0, /**< Equal shares, the first panel served moves round each step */
+		PolicyPriority = 1    /**< Shares in proportion to priority, highest first */
+	};
+
+	/*! Panel counters, latency is from panelSubmit to frame on display */
+	struct panel_stats_t
+	{
+		uint32_t framesSubmitted = 0; /**< Frames started */
+		uint32_t framesFlushed = 0;   /**< Frames sent to display */
+		uint32_t framesMerged = 0;    /**< Submits merged into a frame in progress */
+		uint32_t flushErrors = 0;     /**< Frames aborted by a bus error */
+		uint32_t latencyLastUs = 0;   /**< Latency of last frame sent, uS */
+		uint32_t latencyMaxUs = 0;    /**< Largest latency seen, uS */
+		uint32_t latencyAvgUs = 0;    /**< Running average latency, uS */
+		uint32_t busUs = 0;           /**< Total time spent sending, uS */
+		uint32_t stepsSkipped = 0;    /**< managerStep calls where the bus budget ran out before this panel */
+	};
+
+	static constexpr uint8_t MANAGER_PANELS_MAX = 4; /**< Max panels */
+	static constexpr uint8_t MANAGER_BUSES_MAX = 4;  /**< Bus numbers 0 to MANAGER_BUSES_MAX-1 */
+	static constexpr uint32_t MANAGER_BUDGET_DEFAULT = 2000; /**< Default bus time per managerStep, uS */
+
+	displaylib_manager(manager_policy_e policy = PolicyRoundRobin);
+
+	DisplayRet::Ret_Codes_e panelAdd(displaylib_flush &display, uint8_t bus, uint8_t priority = 1);
+	uint8_t getPanelCount(void) const;
+	DisplayRet::Ret_Codes_e panelSubmit(uint8_t panel);
+	DisplayRet::Ret_Codes_e panelSubmit(uint8_t panel, const displaylib_flush::flush_rect_t &rect);
+	void panelCancel(uint8_t panel);
+	bool panelBusy(uint8_t panel) const;
+
+	uint8_t managerStep(void);
+	bool managerBusy(void) const;
+	void setPolicy(manager_policy_e policy);
+	void setBusBudget(uint8_t bus, uint32_t budgetUs);
+
+	const panel_stats_t &getPanelStats(uint8_t panel) const;
+	float getPanelFps(uint8_t panel) const;
+	void resetStats(void);
+
+private:
+	/*! One managed display */
+	struct manager_panel_t
+	{
+		displaylib_flush *display = nullptr; /**< The driver */
+		uint8_t bus = 0;          /**< Bus number */
+		uint8_t priority = 1;     /**< Weight for PolicyPriority, 1 to 255 */
+		bool pending = false;     /**< Frame in progress */
+		bool again = false;       /**< Submitted while in progress, send again when done */
+		bool skipped = false;     /**< Got no time last step, goes first next step */
+		uint64_t submitUs = 0;    /**< Submit time of frame in progress */
+		uint64_t againUs = 0;     /**< Submit time of the merged frame */
+		displaylib_flush::flush_rect_t againRect; /**< Rectangle of the merged submits */
+		panel_stats_t stats;      /**< Counters */
+	};
+
+	void stepPanel(manager_panel_t &panel, uint32_t budgetUs);
+
+	manager_panel_t _panels[MANAGER_PANELS_MAX]; /**< Panels, in the order added */
+	uint8_t _panelCount = 0;  /**< Panels added */
+	manager_policy_e _policy; /**< How a bus budget is shared */
+	uint32_t _busBudgetUs[MANAGER_BUSES_MAX] = {MANAGER_BUDGET_DEFAULT, MANAGER_BUDGET_DEFAULT,
+		MANAGER_BUDGET_DEFAULT, MANAGER_BUDGET_DEFAULT}; /**< Bus time per step, 0 unlimited */
+	uint8_t _busTurn[MANAGER_BUSES_MAX] = {0}; /**< Round robin position of each bus */
+	uint64_t _statsStartUs = 0; /**< Start of stats period */
+};
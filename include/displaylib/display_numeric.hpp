@@ -0,0 +1,79 @@
+/*!
+	@file display_numeric.hpp
+	@brief Numeric readout widget, caches the characters on screen and only
+		redraws the character cells that changed.
+	@author Gavin Lyons.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include "display_data.hpp"
+#include "display_graphics.hpp"
+#include "display_flush.hpp"
+
+/*!
+	@brief Fixed width numeric field bound to a position and font.
+	@details The field remembers the characters it last drew. setValue formats
+		the new value, fixed point with sign and padding, without printf or heap,
+		compares it with the cache, and redraws only the cells whose character
+		changed. The changed cells are kept as a dirty mask until sent with
+		flushDirty, so a counter ticking 1234 to 1235 draws and sends one glyph
+		instead of the whole frame.
+	@note Values are right aligned. A cell holding a space is cleared with
+		fillRect, so fonts without a space, e.g. pFontSixteenSeg, can be used.
+		A value too wide for the field is shown as all '-'.
+*/
+class displaylib_numeric_field
+{
+public:
+	/*! Enum to define the padding left of the digits */
+	enum numeric_pad_e : uint8_t
+	{
+		PadSpace = 0, /**< Spaces, sign next to the digits */
+		PadZero = 1   /**< Leading zeros, sign in the leftmost cell */
+	};
+
+	static constexpr uint8_t FIELD_WIDTH_MAX = 16; /**< Max characters in a field */
+	static constexpr uint8_t FIELD_DECIMALS_MAX = 9; /**< Max digits after the decimal point */
+
+	displaylib_numeric_field(displaylib_graphics &display, int16_t x, int16_t y,
+		uint8_t width, std::span<const uint8_t> font = pFontDefault);
+
+	void setFormat(uint8_t decimals, numeric_pad_e pad = PadSpace, bool plusSign = false);
+	void setFieldScale(uint8_t scaleX, uint8_t scaleY);
+	DisplayRet::Ret_Codes_e setValue(int32_t value);
+	DisplayRet::Ret_Codes_e setText(std::string_view text);
+	void invalidate(void);
+
+	bool getDirty(void) const;
+	uint16_t getDirtyCells(void) const;
+	displaylib_flush::flush_rect_t getDirtyRect(void) const;
+	void clearDirty(void);
+	DisplayRet::Ret_Codes_e flushDirty(displaylib_flush &display);
+
+	uint8_t getFieldWidth(void) const;
+	int16_t getCellWidth(void) const;
+	int16_t getCellHeight(void) const;
+
+private:
+	uint8_t formatValue(int32_t value, char *text) const;
+	DisplayRet::Ret_Codes_e render(const char *text);
+	DisplayRet::Ret_Codes_e drawCell(uint8_t cell, char character);
+
+	displaylib_graphics &_display; /**< Display drawn to */
+	std::span<const uint8_t> _font; /**< Font of the field */
+	int16_t _x;              /**< Left of the field */
+	int16_t _y;              /**< Top of the field */
+	uint8_t _width;          /**< Characters in the field */
+	uint8_t _decimals = 0;   /**< Digits after the decimal point */
+	numeric_pad_e _pad = PadSpace; /**< Padding left of the digits */
+	bool _plusSign = false;  /**< Show + for positive values */
+	uint8_t _scaleX = 1;     /**< Text scale x-axis */
+	uint8_t _scaleY = 1;     /**< Text scale y-axis */
+	bool _valid = false;     /**< Cache matches the screen buffer */
+	uint16_t _dirty = 0;     /**< Cells drawn but not yet flushed, bit 0 leftmost */
+	char _last[FIELD_WIDTH_MAX] = {0}; /**< Characters last drawn */
+};
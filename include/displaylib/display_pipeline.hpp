@@ -0,0 +1,133 @@
+/*!
+	@file display_pipeline.hpp
+	@brief Dual core render and flush pipeline. Core0 renders frames into
+		frame slots, core1 sends them to the display.
+	@author Gavin Lyons.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <atomic>
+#include "display_data.hpp"
+#include "display_flush.hpp"
+
+#if !PICO_ON_DEVICE
+#include <thread>
+#endif
+
+/*!
+	@brief Single producer, single consumer queue of frame slot numbers.
+	@details Lock free, one core only pushes and the other only pops, so only
+		atomic loads and stores are needed, the RP2040 cores have no compare
+		and swap.
+*/
+class displaylib_slot_queue
+{
+public:
+	static constexpr uint8_t CAPACITY = 4; /**< Max entries, power of 2 */
+
+	bool push(uint8_t slot);
+	bool pop(uint8_t &slot);
+	uint8_t count(void) const;
+	void clear(void);
+
+private:
+	uint8_t _entries[CAPACITY] = {0}; /**< Slot numbers */
+	std::atomic<uint8_t> _head{0};   /**< Next write, producer only */
+	std::atomic<uint8_t> _tail{0};   /**< Next read, consumer only */
+};
+
+/*!
+	@brief Dual core pipeline, core0 renders into one of N frame slots while
+		core1 flushes finished frames to the display.
+	@details The user gets a free slot with frameAcquire, points the driver
+		buffer at it (OLEDSetBufferPtr/LCDSetBufferPtr), draws, then hands it to
+		core1 with frameSubmit. Core1 sends it with the incremental update of
+		displaylib_flush. On the host build a std::thread replaces core1.
+	@note While the pipeline runs do not call the driver update functions or
+		functions that write directly to the display from core0.
+*/
+class displaylib_pipeline
+{
+public:
+	/*! Enum to define what happens when core0 renders faster than core1 can flush */
+	enum pipeline_policy_e : uint8_t
+	{
+		PolicyBlock = 0,     /**< Every frame is shown, frameAcquire waits for a free slot */
+		PolicyDropOldest = 1 /**< Only the newest queued frame is shown, older ones are dropped */
+	};
+
+	/*! Pipeline counters, latency is from frameSubmit to frame on display */
+	struct pipeline_stats_t
+	{
+		uint32_t framesSubmitted = 0; /**< Frames handed to core1 */
+		uint32_t framesFlushed = 0;   /**< Frames sent to display */
+		uint32_t framesDropped = 0;   /**< Frames replaced by a newer frame before being sent */
+		uint32_t flushErrors = 0;     /**< Frames aborted by a bus error */
+		uint32_t latencyLastUs = 0;   /**< Latency of last frame sent, uS */
+		uint32_t latencyMaxUs = 0;    /**< Largest latency seen, uS */
+		uint32_t latencyAvgUs = 0;    /**< Running average latency, uS */
+		uint32_t acquireWaitUs = 0;   /**< Total time core0 waited for a free slot, uS */
+		uint32_t elapsedUs = 0;       /**< Time since pipelineStart or resetStats, uS */
+	};
+
+	static constexpr uint8_t PIPELINE_SLOTS_MIN = 2; /**< Min frame slots */
+	static constexpr uint8_t PIPELINE_SLOTS_MAX = displaylib_slot_queue::CAPACITY; /**< Max frame slots */
+	static constexpr uint32_t PIPELINE_STEP_DEFAULT = 1000; /**< Default core1 updateStep budget uS */
+
+	displaylib_pipeline(displaylib_flush &display);
+	~displaylib_pipeline();
+
+	DisplayRet::Ret_Codes_e pipelineStart(std::span<uint8_t> slotStorage, uint8_t slots, pipeline_policy_e policy = PolicyDropOldest);
+	void pipelineStop(void);
+	bool pipelineRunning(void) const;
+
+	std::span<uint8_t> frameAcquire(void);
+	DisplayRet::Ret_Codes_e frameSubmit(void);
+	bool pipelineIdle(void) const;
+
+	void setStepBudget(uint32_t budgetUs);
+	pipeline_stats_t getStats(void) const;
+	void resetStats(void);
+
+private:
+	void worker(void);
+	void recycleStale(void);
+	void workerWait(void);
+	void wakeWorker(void);
+#if PICO_ON_DEVICE
+	static void core1Entry(void);
+	static displaylib_pipeline *_core1Pipeline; /**< Instance run by core1 */
+#else
+	std::thread _workerThread; /**< Host stand in for core1 */
+#endif
+
+	displaylib_flush &_display; /**< Display driver frames are sent to */
+	std::span<uint8_t> _slotStorage; /**< User storage for all the slots */
+	uint16_t _frameSize = 0; /**< Bytes per slot, width * (height/8) */
+	uint8_t _slots = 0;      /**< Number of slots in use */
+	pipeline_policy_e _policy = PolicyDropOldest; /**< Policy when core1 falls behind */
+
+	displaylib_slot_queue _readyQueue; /**< Rendered frames, core0 to core1 */
+	displaylib_slot_queue _freeQueue;  /**< Free slots, core1 to core0 */
+	int16_t _renderSlot = -1; /**< Slot owned by core0, -1 none */
+	uint64_t _slotSubmitUs[PIPELINE_SLOTS_MAX] = {0}; /**< Submit time of each slot */
+	std::atomic<bool> _running{false}; /**< Worker loop runs while set */
+	std::atomic<bool> _workerBusy{false}; /**< Worker is sending a frame */
+	std::atomic<bool> _workerActive{false}; /**< Worker loop has not yet exited */
+	std::atomic<uint32_t> _stepBudgetUs{PIPELINE_STEP_DEFAULT}; /**< Budget per updateStep on core1 */
+
+	// counters, each written by one core only, so load then store, no read-modify-write
+	uint32_t _framesSubmitted = 0; /**< core0 */
+	uint32_t _acquireWaitUs = 0;   /**< core0 */
+	std::atomic<uint32_t> _framesFlushed{0}; /**< core1 */
+	std::atomic<uint32_t> _framesDropped{0}; /**< core1 */
+	std::atomic<uint32_t> _flushErrors{0};   /**< core1 */
+	std::atomic<uint32_t> _latencyLastUs{0}; /**< core1 */
+	std::atomic<uint32_t> _latencyMaxUs{0};  /**< core1 */
+	std::atomic<uint32_t> _latencyAvgUs{0};  /**< core1 */
+	uint64_t _statsStartUs = 0;    /**< core0, start of stats period */
+	std::atomic<bool> _resetRequest{false}; /**< core0 asks core1 to clear its counters */
+};
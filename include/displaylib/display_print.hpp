@@ -2,7 +2,7 @@
 	@file  display_print.hpp
 	@brief Base class that provides print() and println() for 1-bit color displays. library
 	@details supports integers with base number formatting, floats with precision formatting
-		character array and std::string
+		character array, std::string and std::string_view
 	@note  Port of arduino built-in print class, G Lyons 2022.
 */
 
@@ -14,6 +14,7 @@
 #include <cstdlib>
 #include <cmath>
 #include <string>
+#include <string_view>
 #include <array>
 #include "display_data.hpp"
 
@@ -77,6 +78,7 @@ class Print
 		size_t print(unsigned long, int = DEC);
 		size_t print(double, int = 2);
 		size_t print(const std::string &);
+		size_t print(std::string_view);
 
 		size_t println(const char[]);
 		size_t println(char);
@@ -87,4 +89,5 @@ class Print
 		size_t println(double, int = 2);
 		size_t println(void);
 		size_t println(const std::string &s);
+		size_t println(std::string_view s);
 };
@@ -0,0 +1,119 @@
+/*!
+	@file display_remote.hpp
+	@brief Remote framebuffer receiver, a host PC sends screen updates over
+		stdio, e.g. USB CDC, and they are written to the screen buffer.
+	@author Gavin Lyons.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include "display_data.hpp"
+#include "display_graphics.hpp"
+#include "display_flush.hpp"
+
+/*!
+	@brief Receiver of the remote framebuffer protocol, the sender is
+		extra/tools/displaylib_remote.py.
+	@details Frame, numbers little endian:
+		-# Sync, 2 bytes: REMOTE_SYNC0 REMOTE_SYNC1
+		-# Type (1), sequence number (1), payload length (2)
+		-# Payload
+		-# CRC-16/CCITT-FALSE (2) of type, sequence, length and payload
+		Types, payloads in the display page layout, x + page * width:
+		-# RemoteHello, no payload, answered with the display size
+		-# RemoteFull, the whole buffer, width * pages bytes
+		-# RemotePages, a rectangle of bytes: first page (1), pages (1),
+			first column (1), columns (1), then pages * columns bytes
+		-# RemoteXorRle, XOR of the last frame over the whole buffer as runs,
+			the packing of displaylib_animation: control 0x00-0x7F is a
+			literal run of control+1 bytes, 0x80-0xFF a repeat of the next byte
+			control-0x80+2 times, a repeat of 0x00 skips bytes that did not change
+		The frame is kept in the staging buffer until its CRC is checked, a
+		bad frame never reaches the screen buffer. Each frame is answered
+		with a text line on stdout, K seq applied, E seq code rejected (1 CRC,
+		2 too long for the staging buffer, 3 bad payload), I width height
+		staging for RemoteHello. The sender re-sends a RemoteFull after an E.
+		Changed bytes are kept as a rectangle for flushDirty.
+	@note The buffer is written in the physical layout, rotation does not apply.
+*/
+class displaylib_remote
+{
+public:
+	/*! Enum to define the frame type */
+	enum remote_type_e : uint8_t
+	{
+		RemoteHello = 0,  /**< Asks for the display size */
+		RemoteFull = 1,   /**< Whole buffer */
+		RemotePages = 2,  /**< Rectangle of pages and columns */
+		RemoteXorRle = 3  /**< XOR of the last frame, run length packed */
+	};
+
+	/*! Enum to define the error code of an E reply */
+	enum remote_error_e : uint8_t
+	{
+		RemoteErrorCrc = 1,    /**< CRC did not match */
+		RemoteErrorLength = 2, /**< Payload longer than the staging buffer */
+		RemoteErrorFormat = 3  /**< Payload does not fit the display */
+	};
+
+	/*! Frame counters */
+	struct remote_stats_t
+	{
+		uint32_t frames = 0;       /**< Frames applied */
+		uint32_t bytes = 0;        /**< Bytes received */
+		uint32_t crcErrors = 0;    /**< Frames with a bad CRC */
+		uint32_t lengthErrors = 0; /**< Frames too long for the staging buffer */
+		uint32_t formatErrors = 0; /**< Frames with a bad payload */
+	};
+
+	static constexpr uint8_t REMOTE_SYNC0 = 0xA5;       /**< First sync byte */
+	static constexpr uint8_t REMOTE_SYNC1 = 0x5A;       /**< Second sync byte */
+	static constexpr uint8_t REMOTE_PAGES_HEADER = 4;   /**< Bytes before the data of a RemotePages payload */
+
+	explicit displaylib_remote(displaylib_graphics &display);
+
+	DisplayRet::Ret_Codes_e remoteBegin(std::span<uint8_t> staging);
+	uint16_t remoteFeed(std::span<const uint8_t> bytes);
+	uint16_t remotePoll(uint32_t budgetUs);
+	const remote_stats_t &getRemoteStats(void) const;
+
+	bool getDirty(void) const;
+	displaylib_flush::flush_rect_t getDirtyRect(void) const;
+	void clearDirty(void);
+	DisplayRet::Ret_Codes_e flushDirty(displaylib_flush &display);
+
+private:
+	/*! Enum to define the state of the frame parser */
+	enum parse_state_e : uint8_t
+	{
+		ParseSync0 = 0,  /**< Looking for REMOTE_SYNC0 */
+		ParseSync1 = 1,  /**< Looking for REMOTE_SYNC1 */
+		ParseHeader = 2, /**< Type, sequence and length */
+		ParsePayload = 3, /**< Payload into the staging buffer */
+		ParseCrc = 4     /**< CRC bytes */
+	};
+
+	bool remoteByte(uint8_t value);
+	bool remoteApply(void);
+	bool remoteXorRle(std::span<const uint8_t> payload, bool apply);
+	void remoteReply(char code, uint8_t detail);
+	void remoteMark(uint16_t column, uint16_t page);
+	static uint16_t crcUpdate(uint16_t crc, uint8_t value);
+
+	displaylib_graphics &_display;   /**< Display whose buffer is written */
+	std::span<uint8_t> _staging;      /**< Payload buffer supplied by the user */
+	remote_stats_t _stats;            /**< Frame counters */
+	parse_state_e _state = ParseSync0; /**< Parser state */
+	uint8_t _header[4] = {0};         /**< Type, sequence and length of the frame */
+	uint8_t _count = 0;               /**< Header or CRC bytes received */
+	uint16_t _length = 0;             /**< Payload length */
+	uint16_t _received = 0;           /**< Payload bytes received */
+	uint16_t _crc = 0;                /**< CRC of the frame so far */
+	uint16_t _crcSent = 0;            /**< CRC sent with the frame */
+	int16_t _dirtyX = 0;              /**< Changed rectangle, left column */
+	int16_t _dirtyX2 = -1;            /**< Changed rectangle, right column, less than _dirtyX if clean */
+	int16_t _dirtyPage = 0;           /**< Changed rectangle, top page */
+	int16_t _dirtyPage2 = -1;         /**< Changed rectangle, bottom page */
+};
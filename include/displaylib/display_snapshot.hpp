@@ -0,0 +1,84 @@
+/*!
+	@file display_snapshot.hpp
+	@brief Screen buffer snapshot, streams the buffer of a display as a PBM
+		image or run length text for the host, in chunks between frames.
+	@author Gavin Lyons.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include "display_data.hpp"
+#include "display_flush.hpp"
+#include "display_print.hpp"
+
+/*!
+	@brief Snapshot of the screen buffer of a display, for debugging and
+		golden image tests, decoded on the host by extra/tools/displaylib_snapshot.py.
+	@details Two formats. SnapshotPBM is a binary P4 PBM, 1 is a lit pixel, for
+		a Print object or FILE opened in binary mode. SnapshotRLE is text safe
+		for stdio and USB CDC, which may add a CR to each LF: a header line, the
+		buffer bytes in display page order as hex, runs of 4 to 255 equal bytes
+		as *CCVV (count, value), SNAPSHOT_LINE characters a line, and an end line
+		with the Fletcher-16 checksum of the bytes. snapshotStep sends at most
+		maxBytes per call and resumes where it stopped, so a snapshot can be
+		spread over the main loop, nothing is allocated and the stack use is
+		one chunk of SNAPSHOT_CHUNK bytes.
+	@note The buffer is read as it is sent, steps taken while a frame is drawn
+		give a mix of two frames, take them between frames.
+*/
+class displaylib_snapshot
+{
+public:
+	/*! Enum to define the snapshot format */
+	enum snapshot_format_e : uint8_t
+	{
+		SnapshotPBM = 0, /**< Binary PBM P4 */
+		SnapshotRLE = 1  /**< Run length hex text */
+	};
+
+	static constexpr uint16_t SNAPSHOT_CHUNK = 64; /**< Bytes written to the output per write, default step size */
+	static constexpr uint8_t SNAPSHOT_LINE = 64;   /**< Characters of hex per line of SnapshotRLE */
+
+	explicit displaylib_snapshot(displaylib_flush &display);
+
+	DisplayRet::Ret_Codes_e snapshotBegin(snapshot_format_e format = SnapshotRLE);
+	bool snapshotStep(Print &out, uint16_t maxBytes = SNAPSHOT_CHUNK);
+	bool snapshotStep(FILE *out, uint16_t maxBytes = SNAPSHOT_CHUNK);
+	DisplayRet::Ret_Codes_e snapshot(Print &out, snapshot_format_e format = SnapshotRLE);
+	DisplayRet::Ret_Codes_e snapshot(FILE *out, snapshot_format_e format = SnapshotRLE);
+	void snapshotCancel(void);
+	bool snapshotBusy(void) const;
+	uint8_t snapshotProgress(void) const;
+
+private:
+	/*! Enum to define the part of the snapshot being sent */
+	enum snapshot_stage_e : uint8_t
+	{
+		StageIdle = 0,   /**< No snapshot in progress */
+		StageHeader = 1, /**< Header line */
+		StageBody = 2,   /**< Image data */
+		StageEnd = 3,    /**< RLE end line */
+		StageDone = 4    /**< Last token being sent */
+	};
+
+	size_t snapshotFill(uint8_t *out, size_t space);
+	void snapshotToken(void);
+	void snapshotChecksum(uint8_t value);
+
+	displaylib_flush &_display;   /**< Display whose buffer is sent */
+	std::span<const uint8_t> _frame; /**< Buffer being sent */
+	uint16_t _width = 0;          /**< Width in pixels */
+	uint16_t _height = 0;         /**< Height in pixels */
+	snapshot_format_e _format = SnapshotRLE; /**< Format being sent */
+	snapshot_stage_e _stage = StageIdle;     /**< Part being sent */
+	uint32_t _position = 0;       /**< Next PBM byte or buffer byte of the body */
+	uint8_t _lineChars = 0;       /**< Characters on the current RLE line */
+	uint16_t _sum1 = 0;           /**< Fletcher-16 first sum of the buffer bytes sent */
+	uint16_t _sum2 = 0;           /**< Fletcher-16 second sum */
+	char _token[48] = {0};        /**< Text or bytes of the current token */
+	uint8_t _tokenLength = 0;     /**< Bytes in _token */
+	uint8_t _tokenSent = 0;       /**< Bytes of _token already sent */
+};
@@ -0,0 +1,110 @@
+/*!
+	@file display_sprite.hpp
+	@brief Sprite layer, masked page layout bitmaps in z-order over the screen
+		buffer, moved without redrawing the background.
+	@author Gavin Lyons.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include "display_data.hpp"
+#include "display_graphics.hpp"
+#include "display_flush.hpp"
+
+/*!
+	@brief Sprites drawn over whatever is in the screen buffer.
+	@details A sprite is a page layout bitmap, the layout of drawBitmap with
+		setDrawBitmapAddr(true), and an optional mask in the same layout, 1
+		where the sprite is opaque. Without a mask the lit pixels of the bitmap
+		are drawn and the others are transparent. When a sprite is drawn the
+		bytes under it are saved in its part of a save area supplied by the
+		user, and put back when it moves. layerUpdate erases and redraws only
+		the sprites that changed, and the sprites above them that overlap,
+		erased in the reverse of the order they were drawn and drawn in
+		z-order, so each puts back what was under it. Every
+		rectangle erased or drawn is kept in a short list for flushDirty, so
+		only the regions the sprites touched are sent.
+		Collisions are tested on the masks: for each column both sprites share
+		the two mask columns are shifted to the same rows and ANDed as 64 bit words.
+	@note Writes the screen buffer directly, so the display must not be rotated.
+		Draw the background under the sprites between layerErase and layerUpdate,
+		or call layerInvalidate after redrawing the whole screen.
+*/
+class displaylib_sprite_layer
+{
+public:
+	static constexpr uint8_t SPRITE_MAX = 16;        /**< Max sprites in a layer */
+	static constexpr uint8_t SPRITE_HEIGHT_MAX = 64; /**< Max sprite height, a mask column fits a 64 bit word */
+	static constexpr uint8_t SPRITE_DIRTY_MAX = 8;   /**< Dirty rectangles kept, more are merged */
+	static constexpr uint8_t SPRITE_NONE = 0xFF;     /**< No sprite, spriteAdd failed or no collision */
+
+	explicit displaylib_sprite_layer(displaylib_graphics &display);
+
+	DisplayRet::Ret_Codes_e layerBegin(std::span<uint8_t> saveArea);
+	uint8_t spriteAdd(std::span<const uint8_t> bitmap, std::span<const uint8_t> mask,
+		int16_t w, int16_t h, int16_t x, int16_t y, uint8_t z = 0);
+	DisplayRet::Ret_Codes_e spriteSetFrame(uint8_t sprite, std::span<const uint8_t> bitmap,
+		std::span<const uint8_t> mask = {});
+	void spriteMoveTo(uint8_t sprite, int16_t x, int16_t y);
+	void spriteMove(uint8_t sprite, int16_t dx, int16_t dy);
+	void spriteSetVelocity(uint8_t sprite, int8_t vx, int8_t vy);
+	void spriteShow(uint8_t sprite, bool show);
+	void spriteSetZ(uint8_t sprite, uint8_t z);
+	displaylib_flush::flush_rect_t getSpriteRect(uint8_t sprite) const;
+	uint8_t getSpriteCount(void) const;
+
+	bool spriteCollide(uint8_t first, uint8_t second) const;
+	uint8_t spriteCollideAny(uint8_t sprite, uint8_t start = 0) const;
+
+	DisplayRet::Ret_Codes_e layerUpdate(void);
+	DisplayRet::Ret_Codes_e layerErase(void);
+	void layerInvalidate(void);
+
+	bool getDirty(void) const;
+	uint8_t getDirtyCount(void) const;
+	displaylib_flush::flush_rect_t getDirtyRect(uint8_t index) const;
+	void clearDirty(void);
+	DisplayRet::Ret_Codes_e flushDirty(displaylib_flush &display);
+
+private:
+	/*! One sprite */
+	struct sprite_t
+	{
+		std::span<const uint8_t> bitmap; /**< Page layout image */
+		std::span<const uint8_t> mask;   /**< Page layout mask, empty the bitmap is the mask */
+		int16_t x = 0;                   /**< Left */
+		int16_t y = 0;                   /**< Top */
+		int16_t w = 0;                   /**< Width */
+		int16_t h = 0;                   /**< Height, 1 to SPRITE_HEIGHT_MAX */
+		int8_t vx = 0;                   /**< Pixels moved right each layerUpdate */
+		int8_t vy = 0;                   /**< Pixels moved down each layerUpdate */
+		uint8_t z = 0;                   /**< Z-order, higher is in front, then the later added */
+		bool visible = true;             /**< Shown */
+		bool changed = true;             /**< Needs drawing by the next layerUpdate */
+		bool drawn = false;              /**< In the screen buffer, save holds what is under it */
+		displaylib_flush::flush_rect_t drawnRect;       /**< Screen pixels covered when drawn, clipped */
+		uint32_t serial = 0;             /**< When drawn, a later sprite is on top of it */
+		uint16_t save = 0;               /**< Offset of its save area */
+	};
+
+	bool checkFrame(std::span<const uint8_t> bitmap, std::span<const uint8_t> mask, int16_t w, int16_t h) const;
+	displaylib_flush::flush_rect_t screenRect(const sprite_t &sprite) const;
+	uint8_t sortLayer(uint8_t *order) const;
+	uint8_t sortDrawn(uint8_t *order) const;
+	void spriteErase(std::span<uint8_t> buffer, sprite_t &sprite);
+	void spriteDraw(std::span<uint8_t> buffer, sprite_t &sprite);
+	uint64_t maskColumn(const sprite_t &sprite, int16_t column) const;
+	void markDirty(displaylib_flush::flush_rect_t rect);
+	static bool overlap(const displaylib_flush::flush_rect_t &a, const displaylib_flush::flush_rect_t &b);
+
+	displaylib_graphics &_display;         /**< Display drawn to */
+	std::span<uint8_t> _saveArea;          /**< Bytes under the sprites, supplied by the user */
+	uint16_t _saveUsed = 0;                /**< Save area given to sprites */
+	sprite_t _sprites[SPRITE_MAX];         /**< Sprites, in the order added */
+	uint8_t _count = 0;                    /**< Sprites added */
+	uint32_t _serial = 0;                  /**< Sprites drawn, sets sprite_t::serial */
+	displaylib_flush::flush_rect_t _dirty[SPRITE_DIRTY_MAX]; /**< Rectangles erased or drawn since the last flush */
+	uint8_t _dirtyCount = 0;               /**< Dirty rectangles */
+};
@@ -0,0 +1,66 @@
+/*!
+	@file display_suspend.hpp
+	@brief Suspend and resume for the display drivers, a resume only restores
+		the controller state and display RAM that were lost while asleep.
+	@author Gavin Lyons.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include "display_data.hpp"
+
+/*!
+	@brief Suspend and resume bookkeeping used by the display drivers.
+	@details Each driver records the command bytes it last sent for the user
+		settable state (contrast, invert, scroll, start line). On suspend a
+		fingerprint of the screen buffer is taken. On resume the driver works
+		out what was lost: the state its sleep mode does not retain, or
+		everything if the display lost power, plus display RAM if the buffer
+		changed while suspended. Only that is sent again.
+*/
+class displaylib_suspend
+{
+public:
+	/*! Controller state a resume may need to restore, bit mask */
+	enum suspend_state_e : uint8_t
+	{
+		StateContrast = 0x01,  /**< Contrast */
+		StateInvert = 0x02,    /**< Invert display */
+		StateScroll = 0x04,    /**< Hardware scroll setup and on/off */
+		StateStartLine = 0x08, /**< Display start line */
+		StateRAM = 0x10,       /**< Display RAM, the frame on screen */
+		StateAll = 0x1F        /**< All of the above */
+	};
+
+	displaylib_suspend(uint8_t retained);
+	virtual ~displaylib_suspend() = default;
+
+	bool GetSuspended(void) const;
+	uint8_t GetSuspendRetained(void) const;
+
+	static constexpr uint8_t SUSPEND_CMD_MAX = 12; /**< Max command bytes recorded per state */
+
+protected:
+	void suspendNote(suspend_state_e state, std::span<const uint8_t> commands);
+	void suspendRecord(std::span<const uint8_t> frame);
+	uint8_t suspendLost(std::span<const uint8_t> frame, bool powerLost);
+	DisplayRet::Ret_Codes_e suspendReplay(uint8_t lost);
+	/*!
+		@brief Sends a block of command bytes to the display
+		@param commands the command bytes
+		@return Success or a bus error code
+	*/
+	virtual DisplayRet::Ret_Codes_e suspendSendCommands(std::span<const uint8_t> commands) = 0;
+
+private:
+	static uint32_t frameHash(std::span<const uint8_t> frame);
+	static constexpr uint8_t SUSPEND_STATES = 4; /**< States recorded as commands, contrast to start line */
+
+	uint8_t _suspendRetained; /**< State the sleep mode of the controller keeps, suspend_state_e mask */
+	bool _suspended = false;  /**< Suspend called, resume not yet called */
+	uint32_t _suspendHash = 0; /**< Fingerprint of the screen buffer at suspend */
+	uint8_t _stateCmds[SUSPEND_STATES][SUSPEND_CMD_MAX] = {{0}}; /**< Last commands sent for each state */
+	uint8_t _stateCmdLength[SUSPEND_STATES] = {0}; /**< Bytes recorded for each state, 0 not set by user */
+};
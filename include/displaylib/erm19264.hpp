@@ -7,12 +7,15 @@
 #pragma once
 
 // ** INCLUDES **
+#include <array>
 #include "display_graphics.hpp"
+#include "display_flush.hpp"
+#include "display_suspend.hpp"
 #include "hardware/spi.h"
 #include "pico/stdlib.h"
 
 // class
-class ERM19264 : public displaylib_graphics
+class ERM19264 : public displaylib_graphics, public displaylib_flush, public displaylib_suspend
 {
 
 public:
@@ -36,6 +39,7 @@ public:
 
 	void LCDSPISetup(spi_inst_t *spi, uint32_t spiBaudRate, int8_t cd, int8_t rst, int8_t cs, int8_t sclk, int8_t din);
 	void LCDinit(uint8_t VbiasPot = UC1609_DEFAULT_GN_PM, uint8_t AddressSet = UC1609_ADDRESS_SET);
+	void LCDinitAsync(uint8_t VbiasPot = UC1609_DEFAULT_GN_PM, uint8_t AddressSet = UC1609_ADDRESS_SET);
 	void LCDEnable(uint8_t on);
 	void LCDFillScreen(uint8_t pixel, uint8_t mircodelay);
 	void LCDFillPage(uint8_t pixels);
@@ -46,11 +50,23 @@ public:
 	void LCDscroll(uint8_t bits);
 	void LCDReset(void);
 	void LCDPowerDown(void);
+	DisplayRet::Ret_Codes_e LCDSuspend(void);
+	DisplayRet::Ret_Codes_e LCDResume(bool powerLost = false);
 	void LCDSPIoff(void);
 
+protected:
+	virtual std::span<const uint8_t> flushBuffer(void) override;
+	virtual std::span<uint8_t> graphicsBuffer(void) override;
+	virtual DisplayRet::Ret_Codes_e flushSetAddress(uint8_t page, uint8_t column, uint8_t columnEnd) override;
+	virtual DisplayRet::Ret_Codes_e flushWriteData(std::span<const uint8_t> data) override;
+	virtual DisplayRet::Ret_Codes_e flushStartLine(uint8_t line) override;
+	virtual uint32_t bootStage(uint8_t stage) override;
+	virtual DisplayRet::Ret_Codes_e suspendSendCommands(std::span<const uint8_t> commands) override;
+
 private:
 	void SendData(uint8_t data);
 	void SendCommand(uint8_t command, uint8_t value);
+	void SendCommands(std::span<const uint8_t> commands);
 
 	// GPIO & SPI
 	int8_t _display_CS;		  /**< GPIO Chip select  line */
@@ -91,9 +107,41 @@ private:
 	static constexpr uint8_t UC1609_INVERSE_DISPLAY = 0xA6; /**< Inverts display*/
 	static constexpr uint8_t UC1609_SCROLL = 0x40; /**< Scrolls, Set the scroll line number. 0-64 */
 
+	static constexpr uint8_t SUSPEND_RETAINED = StateAll; /**< Display off keeps RAM and registers */
+
 	// Delays
 	static constexpr uint8_t UC1609_RESET_DELAY =  3;  /**< ms Delay ,datasheet >3uS*/
 	static constexpr uint8_t UC1609_RESET_DELAY2 = 0; /**< mS delay datasheet says > 5mS, does not work?*/
 	static constexpr uint8_t UC1609_INIT_DELAY = 100; /**<  mS delay ,after init*/
 	static constexpr uint8_t UC1609_INIT_DELAY2 =  3;  /**< mS delay,  before reset called datasheet <3mS*/
+	static constexpr uint32_t UC1609_RESET_LOW_US = 5;       /**< uS reset pulse, datasheet >3uS */
+	static constexpr uint32_t UC1609_RESET_WAIT_US = 5000;   /**< uS after reset before first command, datasheet >5mS */
+	static constexpr uint32_t UC1609_POWER_WAIT_US = 100000; /**< uS charge pump settle after power control */
+
+	/*!
+		@brief Power control command table, first burst of bootStage
+		@param addressCtrl AC [2:0] RAM address control
+		@return the commands
+	*/
+	static constexpr std::array<uint8_t, 5> PowerCommands(uint8_t addressCtrl)
+	{
+		return {UC1609_TEMP_COMP_REG | UC1609_TEMP_COMP_SET,
+			static_cast<uint8_t>(UC1609_ADDRESS_CONTROL | addressCtrl),
+			UC1609_FRAMERATE_REG | UC1609_FRAMERATE_SET,
+			UC1609_BIAS_RATIO | UC1609_BIAS_RATIO_SET,
+			UC1609_POWER_CONTROL | UC1609_PC_SET};
+	}
+
+	/*!
+		@brief Bias and display on command table, last burst of bootStage
+		@param vbias V BIAS potentiometer, contrast
+		@return the commands
+	*/
+	static constexpr std::array<uint8_t, 4> EnableCommands(uint8_t vbias)
+	{
+		return {UC1609_GN_PM,
+			static_cast<uint8_t>(UC1609_GN_PM | vbias),
+			UC1609_DISPLAY_ON | 0x01, // turn on display
+			UC1609_LCD_CONTROL | ROTATION_NORMAL}; // rotate to normal
+	}
 };
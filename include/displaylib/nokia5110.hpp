@@ -10,14 +10,17 @@
 #include <cstdint>
 #include <cstdbool>
 #include <cstdio>
+#include <array>
 #include "hardware/spi.h"
 #include "pico/stdlib.h"
 #include "display_graphics.hpp"
+#include "display_flush.hpp"
+#include "display_suspend.hpp"
 
 /*!
 	@brief Class Controls SPI comms and LCD functionality
 */
-class NOKIA_5110 : public displaylib_graphics
+class NOKIA_5110 : public displaylib_graphics, public displaylib_flush, public displaylib_suspend
 {
 
 public:
@@ -29,6 +32,7 @@ public:
 
 	DisplayRet::Ret_Codes_e LCDSPISetup(spi_inst_t *spi, uint32_t spiBaudRate, int8_t cd, int8_t rst, int8_t cs, int8_t sclk, int8_t din);
 	void LCDInit(bool Inverse, uint8_t Contrast,uint8_t Bias);
+	void LCDInitAsync(bool Inverse, uint8_t Contrast,uint8_t Bias);
 	DisplayRet::Ret_Codes_e LCDSetBufferPtr(uint8_t width, uint8_t height, std::span<uint8_t> buffer);
 	
 	DisplayRet::Ret_Codes_e LCDupdate(void);
@@ -38,6 +42,8 @@ public:
 	void LCDenableSleep(void);
 	void LCDdisableSleep(void);
 	bool LCDIsSleeping(void);
+	DisplayRet::Ret_Codes_e LCDSuspend(void);
+	DisplayRet::Ret_Codes_e LCDResume(bool powerLost = false);
 
 	void LCDSPIoff(void);
 	void LCDPowerDown(void);
@@ -48,6 +54,14 @@ public:
 	void LCDgotoXY(uint8_t x, uint8_t y);
 	void LCDfillBlock(uint8_t FillData = 0xFF , uint8_t RowBlockNum = 0);
 
+protected:
+	virtual std::span<const uint8_t> flushBuffer(void) override;
+	virtual std::span<uint8_t> graphicsBuffer(void) override;
+	virtual DisplayRet::Ret_Codes_e flushSetAddress(uint8_t page, uint8_t column, uint8_t columnEnd) override;
+	virtual DisplayRet::Ret_Codes_e flushWriteData(std::span<const uint8_t> data) override;
+	virtual uint32_t bootStage(uint8_t stage) override;
+	virtual DisplayRet::Ret_Codes_e suspendSendCommands(std::span<const uint8_t> commands) override;
+
 private:
 
 	void LCDWriteData(uint8_t data);
@@ -72,6 +86,26 @@ private:
 	static constexpr uint8_t LCD_CONTRAST  = 0xB0; /**<default value set LCD VOP contrast range 0xB1-BF */
 	static constexpr uint8_t LCD_BIAS      = 0x13; /**<LCD Bias mode 1:48 0x12 to 0x14 */
 
+	static constexpr uint32_t LCD_RESET_LOW_US = 1; /**< uS reset pulse, datasheet min 100nS */
+	static constexpr uint8_t SUSPEND_RETAINED = StateRAM; /**< Power down keeps RAM only, registers are resent */
+
+	/*!
+		@brief Init command table, sent in one burst by bootStage
+		@param inverse display inverted
+		@param contrast LCD VOP contrast
+		@param bias LCD bias mode
+		@return the commands
+	*/
+	static constexpr std::array<uint8_t, 6> InitCommands(bool inverse, uint8_t contrast, uint8_t bias)
+	{
+		return {LCD_FUNCTIONSET | LCD_EXTENDEDINSTRUCTION, // get into the EXTENDED mode
+			bias,
+			LCD_SETTEMP,
+			contrast,
+			LCD_FUNCTIONSET, // We must send 0x20 before modifying the display control mode
+			static_cast<uint8_t>(LCD_DISPLAYCONTROL | (inverse ? LCD_DISPLAYINVERTED : LCD_DISPLAYNORMAL))};
+	}
+
 	// SPI
 	int8_t _display_CS;		  /**< GPIO Chip select  line */
 	int8_t _display_CD;		  /**< GPIO Data or command line */
@@ -10,14 +10,19 @@
 #include <cstdio>
 #include <cstdint>
 #include <cstdbool>
+#include <array>
 #include <span> // C++ 20
 #include "display_graphics.hpp"
+#include "display_flush.hpp"
+#include "display_breaker.hpp"
+#include "display_clocktune.hpp"
+#include "display_suspend.hpp"
 #include "hardware/i2c.h"
 
 /*!
 	@brief class to control OLED and define buffer
 */
-class SH110X : public displaylib_graphics  {
+class SH110X : public displaylib_graphics, public displaylib_flush, public displaylib_breaker, public displaylib_clocktune, public displaylib_suspend  {
   public:
 	SH110X(int16_t oledwidth, int16_t oledheight);
 	~SH110X(){};
@@ -43,8 +48,12 @@ class SH110X : public displaylib_graphics  {
 	void OLEDFillPage(uint8_t page_num, uint8_t pixels,uint8_t delay);
 	DisplayRet::Ret_Codes_e OLEDbegin(OLED_IC_type_e OLEDtype = SH1106_IC, int8_t resetPin = -1, uint8_t I2Caddress = 0x3C, 
 					i2c_inst_t* i2c_type = i2c1, uint16_t CLKspeed = 100, uint8_t SDApin = 18, uint8_t SCLKpin = 19);
+	DisplayRet::Ret_Codes_e OLEDbeginAsync(OLED_IC_type_e OLEDtype = SH1106_IC, int8_t resetPin = -1, uint8_t I2Caddress = 0x3C, 
+					i2c_inst_t* i2c_type = i2c1, uint16_t CLKspeed = 100, uint8_t SDApin = 18, uint8_t SCLKpin = 19);
 	void OLEDinit(void);
 	void OLEDPowerDown(void);
+	DisplayRet::Ret_Codes_e OLEDSuspend(void);
+	DisplayRet::Ret_Codes_e OLEDResume(bool powerLost = false);
 	void OLEDReset(void);
 
 	void OLEDEnable(uint8_t on);
@@ -64,11 +73,24 @@ class SH110X : public displaylib_graphics  {
 	uint32_t GetI2CTimeout(void);
 	void SetI2CTimeout(uint32_t);
 
+  protected:
+	virtual std::span<const uint8_t> flushBuffer(void) override;
+	virtual std::span<uint8_t> graphicsBuffer(void) override;
+	virtual DisplayRet::Ret_Codes_e flushSetAddress(uint8_t page, uint8_t column, uint8_t columnEnd) override;
+	virtual DisplayRet::Ret_Codes_e flushWriteData(std::span<const uint8_t> data) override;
+	virtual uint32_t bootStage(uint8_t stage) override;
+	virtual DisplayRet::Ret_Codes_e suspendSendCommands(std::span<const uint8_t> commands) override;
+	virtual uint16_t clockTuneSet(uint16_t kHz) override;
+	virtual bool clockTuneProbe(void) override;
+	virtual void clockTuneRecover(void) override;
+
   private:
 
 	void I2CWriteByte(uint8_t value = 0x00, uint8_t DataOrCmd = SH110X_COMMAND_BYTE);
-	void SH1106_begin(void);
-	void SH1107_begin(void);
+	DisplayRet::Ret_Codes_e I2CWriteBlock(std::span<const uint8_t> data, uint8_t DataOrCmd = SH110X_DATA_BYTE);
+	DisplayRet::Ret_Codes_e I2CWriteFlush(std::span<const uint8_t> data, uint8_t DataOrCmd);
+	bool I2CBreakerCheck(void);
+	bool I2CProbeWrite(std::span<const uint8_t> data);
 
 	// I2C
 	uint8_t _I2CRetryAttempts = 3; /**< Maximum number of Retry attempts in event of I2C write error*/
@@ -130,4 +152,53 @@ class SH110X : public displaylib_graphics  {
 	static constexpr uint8_t SH110X_COMMAND_BYTE    =  0x00 ; /**< Command byte command */
 	static constexpr uint8_t SH110X_DATA_BYTE       =  0x40 ; /**< Data byte command */
 
+	static constexpr uint8_t SUSPEND_RETAINED = StateAll; /**< Display off keeps RAM and registers */
+
+	// Power up timing
+	static constexpr uint32_t SH110X_RESET_LOW_US = 10;      /**< uS reset pulse, datasheet min 10uS */
+	static constexpr uint32_t SH110X_RESET_WAIT_US = 10;     /**< uS after reset before first command */
+	static constexpr uint32_t SH110X_DCDC_WAIT_US = 100000;  /**< uS DC-DC settle before display on, datasheet 100mS */
+
+	/*! Init command table for the SH1106, sent in one burst by bootStage */
+	static constexpr std::array<uint8_t, 25> SH1106_INIT_COMMANDS = {
+		SH110X_DISPLAYOFF,
+		SH110X_SETDISPLAYCLOCKDIV, 0x80,
+		SH110X_SETMULTIPLEX, 0x3F,
+		SH110X_SETDISPLAYOFFSET, 0x00,
+		SH110X_SETSTARTLINE,
+		SH110X_DCDC, 0x8B,
+		SH110X_SEGREMAP + 1, // Left rotation +1
+		SH110X_COMSCANDEC,
+		SH110X_SETCOMPINS, 0x12, // Alternative (POR)
+		SH110X_SETCONTRAST, 0xFF,
+		SH110X_SETPRECHARGE, 0x1F,
+		SH110X_SETVCOMDETECT, 0x40,
+		0x33,
+		SH110X_NORMALDISPLAY,
+		SH110X_MEMORYMODE, 0x10,
+		SH110X_DISPLAYALLON_RESUME};
+
+	/*!
+		@brief Init command table for the SH1107, sent in one burst by bootStage
+		@param square true for 128x128 display, false for 128x64
+		@return the commands
+	*/
+	static constexpr std::array<uint8_t, 22> SH1107InitCommands(bool square)
+	{
+		return {SH110X_DISPLAYOFF,
+			SH110X_SETDISPLAYCLOCKDIV, 0x51,
+			SH110X_MEMORYMODE,
+			SH110X_SETCONTRAST, 0x4F,
+			SH110X_DCDC, 0x8A,
+			SH110X_SEGREMAP,
+			SH110X_COMSCANINC,
+			SH110X_SETDISPSTARTLINE, 0x0,
+			SH110X_SETDISPLAYOFFSET, static_cast<uint8_t>(square ? 0x00 : 0x60),
+			SH110X_SETPRECHARGE, 0x22,
+			SH110X_SETVCOMDETECT, 0x35,
+			SH110X_SETMULTIPLEX, static_cast<uint8_t>(square ? 0x7F : 0x3F),
+			SH110X_DISPLAYALLON_RESUME,
+			SH110X_NORMALDISPLAY};
+	}
+
 };
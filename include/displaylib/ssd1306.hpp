@@ -8,14 +8,19 @@
 
 // Library includes
 #include <cstdbool>
+#include <array>
 #include <span> // C++ 20
 #include "display_graphics.hpp"
+#include "display_flush.hpp"
+#include "display_breaker.hpp"
+#include "display_clocktune.hpp"
+#include "display_suspend.hpp"
 #include "hardware/i2c.h"
 
 /*! 
 	@brief class to control OLED and define buffer
 */
-class SSD1306 : public displaylib_graphics  {
+class SSD1306 : public displaylib_graphics, public displaylib_flush, public displaylib_breaker, public displaylib_clocktune, public displaylib_suspend  {
   public:
 	SSD1306(int16_t , int16_t );
 	~SSD1306(){};
@@ -31,9 +36,12 @@ class SSD1306 : public displaylib_graphics  {
 	void OLEDFillPage(uint8_t page_num, uint8_t pixels,uint8_t delay);
 	DisplayRet::Ret_Codes_e OLEDBitmap(int16_t x, int16_t y, int16_t w, int16_t h, std::span<const uint8_t> bitmap, bool invert);
 	DisplayRet::Ret_Codes_e OLEDbegin(uint8_t I2c_address= SSD1306_ADDR , i2c_inst_t* i2c_type = i2c1 , uint16_t CLKspeed = 100, uint8_t SDApin = 18, uint8_t SCLKpin = 19);
+	DisplayRet::Ret_Codes_e OLEDbeginAsync(uint8_t I2c_address= SSD1306_ADDR , i2c_inst_t* i2c_type = i2c1 , uint16_t CLKspeed = 100, uint8_t SDApin = 18, uint8_t SCLKpin = 19);
 	void OLEDinit();
 	void OLEDdeI2CInit(void);
 	void OLEDPowerDown(void);
+	DisplayRet::Ret_Codes_e OLEDSuspend(void);
+	DisplayRet::Ret_Codes_e OLEDResume(bool powerLost = false);
 	
 	void OLEDEnable(uint8_t on);
 	void OLEDContrast(uint8_t OLEDcontrast);
@@ -57,9 +65,26 @@ class SSD1306 : public displaylib_graphics  {
 	uint32_t GetI2CTimeout(void);
 	void SetI2CTimeout(uint32_t);
 	
+  protected:
+	virtual std::span<const uint8_t> flushBuffer(void) override;
+	virtual std::span<uint8_t> graphicsBuffer(void) override;
+	virtual DisplayRet::Ret_Codes_e flushSetAddress(uint8_t page, uint8_t column, uint8_t columnEnd) override;
+	virtual DisplayRet::Ret_Codes_e flushWriteData(std::span<const uint8_t> data) override;
+	virtual DisplayRet::Ret_Codes_e flushStartLine(uint8_t line) override;
+	virtual uint8_t flushRamPages(void) override;
+	virtual uint32_t bootStage(uint8_t stage) override;
+	virtual DisplayRet::Ret_Codes_e suspendSendCommands(std::span<const uint8_t> commands) override;
+	virtual uint16_t clockTuneSet(uint16_t kHz) override;
+	virtual bool clockTuneProbe(void) override;
+	virtual void clockTuneRecover(void) override;
+
   private:
 	
 	void I2CWriteByte(uint8_t value = 0x00, uint8_t DataOrCmd =  SSD1306_COMMAND);
+	DisplayRet::Ret_Codes_e I2CWriteBlock(std::span<const uint8_t> data, uint8_t DataOrCmd = SSD1306_DATA_CONTINUE);
+	DisplayRet::Ret_Codes_e I2CWriteFlush(std::span<const uint8_t> data, uint8_t DataOrCmd);
+	bool I2CBreakerCheck(void);
+	bool I2CProbeWrite(std::span<const uint8_t> data);
   //  === SSD1306 Command Set  ===
 	// Fundamental Commands
 	static constexpr uint8_t SSD1306_SET_CONTRAST_CONTROL = 0x81;
@@ -107,6 +132,36 @@ class SSD1306 : public displaylib_graphics  {
 	static constexpr uint8_t SSD1306_DATA           = 0xC0;
 	static constexpr uint8_t SSD1306_DATA_CONTINUE  = 0x40;
 	//  === SSD1306 Command Set END ===
+
+	static constexpr uint8_t SUSPEND_RETAINED = StateAll; /**< Sleep mode keeps GDDRAM and registers */
+
+	/*!
+		@brief Init command table, sent in one burst by bootStage
+		@param height screen height in pixels, 64 32 or 16
+		@return the commands
+	*/
+	static constexpr std::array<uint8_t, 26> InitCommands(uint8_t height)
+	{
+		const uint8_t comPins = (height == 64) ? 0x12 : 0x02;
+		const uint8_t contrast = (height == 32) ? 0x8F : (height == 16) ? 0xAF : 0xCF;
+		return {SSD1306_DISPLAY_OFF,
+			SSD1306_SET_DISPLAY_CLOCK_DIV_RATIO, 0x80,
+			SSD1306_SET_MULTIPLEX_RATIO, static_cast<uint8_t>(height - 1),
+			SSD1306_SET_DISPLAY_OFFSET, 0x00,
+			SSD1306_SET_START_LINE | 0x00,
+			SSD1306_CHARGE_PUMP, 0x14,
+			SSD1306_MEMORY_ADDR_MODE, 0x00, // Horizontal Addressing Mode is Used
+			SSD1306_SET_SEGMENT_REMAP | 0x01,
+			SSD1306_COM_SCAN_DIR_DEC,
+			SSD1306_SET_COM_PINS, comPins,
+			SSD1306_SET_CONTRAST_CONTROL, contrast,
+			SSD1306_SET_PRECHARGE_PERIOD, 0xF1,
+			SSD1306_SET_VCOM_DESELECT, 0x40,
+			SSD1306_DISPLAY_ALL_ON_RESUME,
+			SSD1306_NORMAL_DISPLAY,
+			SSD1306_DEACTIVATE_SCROLL,
+			SSD1306_DISPLAY_ON};
+	}
 	
 	// I2C
 	uint8_t _I2CRetryAttempts = 3; /**< Maximum number of Retry attempts in event of I2C write error*/
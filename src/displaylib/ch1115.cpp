@@ -4,16 +4,18 @@
 	@author  Gavin Lyons
 */
 
+#include <algorithm>
 #include "pico/stdlib.h"
 #include "../include/displaylib/ch1115.hpp"
 #include "../include/displaylib/display_graphics.hpp"
+#include "../include/displaylib/display_diag.hpp"
 
 /*!
 	@brief init the OLED class object
 	@param oledwidth width of oled in pixels
 	@param oledheight height of oled in pixels
  */
-ERMCH1115::ERMCH1115(int16_t oledwidth, int16_t oledheight) : displaylib_graphics(oledwidth, oledheight)
+ERMCH1115::ERMCH1115(int16_t oledwidth, int16_t oledheight) : displaylib_graphics(oledwidth, oledheight), displaylib_flush(oledwidth, oledheight), displaylib_suspend(SUSPEND_RETAINED)
 {
 	_OLED_HEIGHT = oledheight;
 	_OLED_WIDTH = oledwidth;
@@ -66,61 +68,60 @@ void ERMCH1115::OLEDSPISetup(spi_inst_t *spiType, uint32_t spiSpeedKhz, int8_t c
 }
 
 /*!
-	@brief Called from OLEDbegin carries out Power on sequence and register init
+	@brief Carries out Power on sequence and register init, blocking
 	@param OLEDcontrast Contrast of the OLED display default = 0x80 , range 0x00 to 0xFE
 */
 void ERMCH1115::OLEDinit(uint8_t OLEDcontrast = ERMCH1115_CONTRAST_DATA_DEFAULT)
 {
-	const uint8_t ERMCH1115_INITDELAY = 100;/**< Init delay mS */
-	_OLEDcontrast = OLEDcontrast;
-	display_CS_SetLow;
-
-	OLEDReset();
-
-	send_command(ERMCH1115_DISPLAY_OFF, 0);
-
-	send_command(ERMCH1115_SET_COLADD_LSB, 0);
-	send_command(ERMCH1115_SET_COLADD_MSB, 0);
-	send_command(ERMCH1115_SET_PAGEADD, 0);
-	send_command(ERMCH1115_SET_DISPLAY_START_LINE, 0);
-
-	send_command(ERMCH1115_CONTRAST_CONTROL, 0);
-	send_command(_OLEDcontrast, 0);
-
-	send_command(ERMCH1115_IREF_REG, 0);
-	send_command(ERMCH1115_IREF_SET, 0);
-
-	send_command(ERMCH1115_SEG_SET_REMAP, 0);
-	send_command(ERMCH1115_SEG_SET_PADS, 0);
-	send_command(ERMCH1115_ENTIRE_DISPLAY_ON, 0);
-	send_command(ERMCH1115_DISPLAY_NORMAL, 0);
-
-	send_command(ERMCH1115_MULTIPLEX_MODE_SET, 0);
-	send_command(ERMCH1115_MULTIPLEX_DATA_SET, 0);
-
-	send_command(ERMCH1115_COMMON_SCAN_DIR, 0);
-
-	send_command(ERMCH1115_OFFSET_MODE_SET, 0);
-	send_command(ERMCH1115_OFFSET_DATA_SET, 0);
-
-	send_command(ERMCH1115_OSC_FREQ_MODE_SET, 0);
-	send_command(ERMCH1115_OSC_FREQ_DATA_SET, 0);
-
-	send_command(ERMCH1115_PRECHARGE_MODE_SET, 0);
-	send_command(ERMCH1115_PRECHARGE_DATA_SET, 0);
-
-	send_command(ERMCH1115_COM_LEVEL_MODE_SET, 0);
-	send_command(ERMCH1115_COM_LEVEL_DATA_SET, 0);
-
-	send_command(ERMCH1115_SET_PUMP_REG, ERMCH1115_SET_PUMP_SET);
+	OLEDinitAsync(OLEDcontrast);
+	bootComplete();
+}
 
-	send_command(ERMCH1115_DC_MODE_SET, 0);
-	send_command(ERMCH1115_DC_ONOFF_SET, 0);
+/*!
+	@brief Starts the Power on sequence and register init, does not wait
+	@param OLEDcontrast Contrast of the OLED display default = 0x80 , range 0x00 to 0xFE
+	@note Poll isReady to finish the power up sequence while doing other work,
+		the buffer can be sent once the init commands are sent.
+*/
+void ERMCH1115::OLEDinitAsync(uint8_t OLEDcontrast)
+{
+	_OLEDcontrast = OLEDcontrast;
+	bootBegin();
+}
 
-	send_command(ERMCH1115_DISPLAY_ON, 0);
-	_sleep = false;
-	display_CS_SetHigh;
-	busy_wait_ms(ERMCH1115_INITDELAY);
+/*!
+	@brief Power up sequence, hardware reset, init command table in one SPI
+		burst, then display on after the DC-DC converter settles.
+	@param stage stage number
+	@return wait in uS before the next stage, or BOOT_DONE
+	@note Display RAM can be written during the DC-DC wait.
+*/
+uint32_t ERMCH1115::bootStage(uint8_t stage)
+{
+	switch (stage)
+	{
+		case 0:
+			display_RST_SetLow;
+			return ERMCH1115_RESET_LOW_US;
+		case 1:
+			display_RST_SetHigh;
+			return ERMCH1115_RESET_WAIT_US;
+		case 2:
+		{
+			const auto initCmds = InitCommands(_OLEDcontrast);
+			display_CS_SetLow;
+			send_commands(initCmds);
+			display_CS_SetHigh;
+			bootRamReady();
+			return ERMCH1115_DCDC_WAIT_US;
+		}
+		default:
+			display_CS_SetLow;
+			send_command(ERMCH1115_DISPLAY_ON, 0);
+			display_CS_SetHigh;
+			_sleep = false;
+			return BOOT_DONE;
+	}
 }
 
 /*!
@@ -136,13 +137,24 @@ void ERMCH1115::send_command(uint8_t command, uint8_t value)
 	display_CD_SetHigh;
 }
 
+/*!
+	@brief Sends a block of commands to the display in one SPI write
+	@param commands the command bytes
+*/
+void ERMCH1115::send_commands(std::span<const uint8_t> commands)
+{
+	display_CD_SetLow;
+	statsBusWrite(spi_write_blocking(spiInterface, commands.data(), commands.size()), commands);
+	display_CD_SetHigh;
+}
+
 /*!
 	 @brief Send data byte with SPI to ERMCH1115
 	 @param data the data byte to send
 */
 void ERMCH1115::send_data(uint8_t data)
 {
-	spi_write_blocking(spiInterface, &data, 1);
+	statsBusWrite(spi_write_blocking(spiInterface, &data, 1), std::span<const uint8_t>(&data, 1));
 }
 
 /*!
@@ -196,21 +208,15 @@ bool ERMCH1115::OLEDIssleeping() { return _sleep; }
 */
 void ERMCH1115::OLEDscrollSetup(uint8_t Timeinterval, uint8_t Direction, uint8_t mode)
 {
-
+	const uint8_t setupCmds[8] = {ERMCH1115_HORIZONTAL_A_SCROLL_SETUP,
+		ERMCH1115_HORIZONTAL_A_SCROLL_SET_SCOL, ERMCH1115_HORIZONTAL_A_SCROLL_SET_ECOL,
+		Direction, ERMCH1115_SPAGE_ADR_SET, Timeinterval, ERMCH1115_EPAGE_ADR_SET,
+		mode};
+	std::copy(std::begin(setupCmds), std::end(setupCmds), _scrollSetup);
 	display_CS_SetLow;
-
-	send_command(ERMCH1115_HORIZONTAL_A_SCROLL_SETUP, 0);
-	send_command(ERMCH1115_HORIZONTAL_A_SCROLL_SET_SCOL, 0);
-	send_command(ERMCH1115_HORIZONTAL_A_SCROLL_SET_ECOL, 0);
-
-	send_command(Direction, 0);
-	send_command(ERMCH1115_SPAGE_ADR_SET, 0);
-	send_command(Timeinterval, 0);
-	send_command(ERMCH1115_EPAGE_ADR_SET, 0);
-
-	send_command(mode, 0);
-
+	send_commands(setupCmds);
 	display_CS_SetHigh;
+	suspendNote(StateScroll, setupCmds);
 }
 
 /*!
@@ -224,6 +230,13 @@ void ERMCH1115::OLEDscroll(uint8_t bits)
 	display_CS_SetLow;
 	bits ? send_command(ERMCH1115_ACTIVATE_SCROLL, 0) : send_command(ERMCH1115_DEACTIVATE_SCROLL, 0);
 	display_CS_SetHigh;
+	uint8_t scrollCmds[9];
+	std::copy(std::begin(_scrollSetup), std::end(_scrollSetup), scrollCmds);
+	scrollCmds[8] = ERMCH1115_ACTIVATE_SCROLL;
+	if (bits)
+		suspendNote(StateScroll, scrollCmds);
+	else
+		suspendNote(StateScroll, std::span<const uint8_t>(&ERMCH1115_DEACTIVATE_SCROLL, 1));
 }
 
 /*!
@@ -233,10 +246,11 @@ void ERMCH1115::OLEDscroll(uint8_t bits)
 void ERMCH1115::OLEDContrast(uint8_t contrast)
 {
 
+	const uint8_t contrastCmds[2] = {ERMCH1115_CONTRAST_CONTROL, contrast};
 	display_CS_SetLow;
-	send_command(ERMCH1115_CONTRAST_CONTROL, 0);
-	send_command(contrast, 0);
+	send_commands(contrastCmds);
 	display_CS_SetHigh;
+	suspendNote(StateContrast, contrastCmds);
 }
 
 /*!
@@ -287,6 +301,57 @@ void ERMCH1115::OLEDPowerDown(void)
 	_sleep = true;
 }
 
+/*!
+	@brief Puts the OLED to sleep, display off.
+	@return Success
+	@note Display RAM and all registers are retained while VDD stays on,
+		resume with OLEDResume.
+*/
+DisplayRet::Ret_Codes_e ERMCH1115::OLEDSuspend(void)
+{
+	if (GetSuspended())
+		return DisplayRet::Success;
+	suspendRecord(flushBuffer());
+	OLEDEnable(0);
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Wakes the OLED from OLEDSuspend, restores only what was lost.
+	@param powerLost set true if the OLED supply was switched off while suspended,
+		the OLED is then re-initialised and all user state restored.
+	@return Success
+	@details The screen buffer is only sent if it changed since OLEDSuspend,
+		or power was lost. It is sent before the display is turned on.
+*/
+DisplayRet::Ret_Codes_e ERMCH1115::OLEDResume(bool powerLost)
+{
+	if (!GetSuspended())
+		return DisplayRet::Success;
+	const uint8_t lost = suspendLost(flushBuffer(), powerLost);
+	if (powerLost)
+		OLEDinit(_OLEDcontrast);
+	if (lost & StateRAM)
+		OLEDupdate();
+	suspendReplay(lost);
+	if (!powerLost)
+		OLEDEnable(1);
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Sends a block of commands, used by the suspend replay
+	@param commands the command bytes
+	@return Success
+*/
+DisplayRet::Ret_Codes_e ERMCH1115::suspendSendCommands(std::span<const uint8_t> commands)
+{
+	display_CS_SetLow;
+	send_commands(commands);
+	display_CS_SetHigh;
+	return DisplayRet::Success;
+}
+
 /*!
 	@brief invert the display
 	@param bits 1 invert , 0 normal
@@ -294,9 +359,11 @@ void ERMCH1115::OLEDPowerDown(void)
 void ERMCH1115::OLEDInvert(uint8_t bits)
 {
 
+	const uint8_t invertCmd[1] = {bits ? ERMCH1115_DISPLAY_INVERT : ERMCH1115_DISPLAY_NORMAL};
 	display_CS_SetLow;
-	bits ? send_command(ERMCH1115_DISPLAY_INVERT, 0) : send_command(ERMCH1115_DISPLAY_NORMAL, 0);
+	send_commands(invertCmd);
 	display_CS_SetHigh;
+	suspendNote(StateInvert, invertCmd);
 }
 
 /*!
@@ -322,10 +389,11 @@ void ERMCH1115::OLEDFillPage(uint8_t pageNum, uint8_t dataPattern, uint8_t mydel
 {
 	if (pageNum >= 8)
 	{
-		printf("Error OLEDFillPage 1 :page number must be between 0 and 7 \n");
+		displaylib_diag::error(displaylib_diag::FuncFillPage, DisplayRet::GenericError, pageNum);
 		return;
 	}
 
+	flushAddressLost();
 	display_CS_SetLow;
 	send_command(ERMCH1115_SET_COLADD_LSB, 0);
 	send_command(ERMCH1115_SET_COLADD_MSB, 0);
@@ -353,6 +421,7 @@ void ERMCH1115::OLEDFillPage(uint8_t pageNum, uint8_t dataPattern, uint8_t mydel
 */
 void ERMCH1115::OLEDBitmap(int16_t x, int16_t y, uint8_t w, uint8_t h, const uint8_t *data)
 {
+	flushAddressLost();
 	display_CS_SetLow;
 
 	uint8_t tx, ty;
@@ -385,14 +454,81 @@ void ERMCH1115::OLEDBitmap(int16_t x, int16_t y, uint8_t w, uint8_t h, const uin
 
 /*!
 	 @brief updates the OLED i.e. writes  buffer to the screen
+	 @note Blocking, see updateBegin and updateStep to spread the update over several calls.
 */
 void ERMCH1115::OLEDupdate()
 {
-	uint8_t x = 0;
-	uint8_t y = 0;
-	uint8_t w = this->_OLED_WIDTH;
-	uint8_t h = this->_OLED_HEIGHT;
-	OLEDBufferScreen(x, y, w, h, this->_OLEDbuffer);
+	if (updateBegin() != DisplayRet::Success)
+		return;
+	updateComplete();
+}
+
+/*!
+	@brief Returns the screen buffer, the default frame for updateBegin
+	@return span of the screen buffer, empty if not yet assigned
+*/
+std::span<const uint8_t> ERMCH1115::flushBuffer(void)
+{
+	if (_OLEDbuffer == nullptr)
+		return {};
+	return std::span<const uint8_t>(_OLEDbuffer, _OLED_WIDTH * _OLED_PAGE_NUM);
+}
+
+/*!
+	@brief The screen buffer for the graphics byte writes
+	@return the buffer, empty if not set
+*/
+std::span<uint8_t> ERMCH1115::graphicsBuffer(void)
+{
+	if (_OLEDbuffer == nullptr)
+		return {};
+	return std::span<uint8_t>(_OLEDbuffer, _OLED_WIDTH * _OLED_PAGE_NUM);
+}
+
+/*!
+	@brief Sets the page and column address for the flush
+	@param page page to write
+	@param column first column to write
+	@param columnEnd unused, the CH1115 has no column window
+	@return Success
+*/
+DisplayRet::Ret_Codes_e ERMCH1115::flushSetAddress(uint8_t page, uint8_t column, uint8_t columnEnd)
+{
+	(void)columnEnd;
+	display_CS_SetLow;
+	send_command(ERMCH1115_SET_COLADD_LSB, (column & 0x0F));
+	send_command(ERMCH1115_SET_COLADD_MSB, (column & 0xF0) >> 4);
+	send_command(ERMCH1115_SET_PAGEADD, page);
+	display_CS_SetHigh;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Writes a chunk of the flush to display RAM in one SPI transfer
+	@param data the data to write
+	@return Success
+*/
+DisplayRet::Ret_Codes_e ERMCH1115::flushWriteData(std::span<const uint8_t> data)
+{
+	display_CS_SetLow;
+	statsBusWrite(spi_write_blocking(spiInterface, data.data(), data.size()), data);
+	display_CS_SetHigh;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Sets the RAM line shown at top of screen, hardware scroll
+	@param line RAM line 0-63
+	@return Success
+*/
+DisplayRet::Ret_Codes_e ERMCH1115::flushStartLine(uint8_t line)
+{
+	const uint8_t startLineCmd[1] = {static_cast<uint8_t>(ERMCH1115_SET_DISPLAY_START_LINE | (line & 0x3F))};
+	display_CS_SetLow;
+	send_commands(startLineCmd);
+	display_CS_SetHigh;
+	suspendNote(StateStartLine, startLineCmd);
+	return DisplayRet::Success;
 }
 
 /*!
@@ -414,6 +550,7 @@ void ERMCH1115::OLEDclearBuffer()
 */
 void ERMCH1115::OLEDBufferScreen(int16_t x, int16_t y, uint8_t w, uint8_t h, uint8_t *data)
 {
+	flushAddressLost();
 	display_CS_SetLow;
 
 	uint8_t tx, ty;
@@ -506,13 +643,13 @@ uint8_t ERMCH1115::OLEDSetBufferPtr(uint8_t width, uint8_t height, uint8_t *pBuf
 {
 	if (sizeOfBuffer != width * (height / 8))
 	{
-		printf("ERMCH1115::::OLEDSetBufferPtr Error 2: buffer size does not equal: w * (h/8))\r\n");
+		displaylib_diag::error(displaylib_diag::FuncSetBufferPtr, DisplayRet::BufferSize, width, height);
 		return 2;
 	}
 	_OLEDbuffer = pBuffer;
 	if (_OLEDbuffer == nullptr)
 	{
-		printf("ERMCH1115::::OLEDSetBufferPtr Error 3: Problem assigning buffer pointer\r\n");
+		displaylib_diag::error(displaylib_diag::FuncSetBufferPtr, DisplayRet::BufferEmpty);
 		return 3;
 	}
 	return 0;
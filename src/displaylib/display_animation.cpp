@@ -0,0 +1,430 @@
+/*!
+	@file display_animation.cpp
+	@brief Source file for the compressed bitmap and animation player
+	@author Gavin Lyons.
+*/
+
+#include <algorithm>
+#include "pico/stdlib.h"
+#include "../../include/displaylib/display_animation.hpp"
+#include "../../include/displaylib/display_diag.hpp"
+
+/*!
+	@brief Reads a little endian 16 bit number from the data
+	@param data the data
+	@param offset offset of the low byte
+	@return the number
+*/
+static inline uint16_t readLE16(std::span<const uint8_t> data, size_t offset)
+{
+	return static_cast<uint16_t>(data[offset] | (data[offset + 1] << 8));
+}
+
+/*!
+	@brief Reads a little endian 32 bit number from the data
+	@param data the data
+	@param offset offset of the low byte
+	@return the number
+*/
+static inline uint32_t readLE32(std::span<const uint8_t> data, size_t offset)
+{
+	return static_cast<uint32_t>(readLE16(data, offset)) | (static_cast<uint32_t>(readLE16(data, offset + 2)) << 16);
+}
+
+/*!
+	@brief init the animation object
+	@param display the display driver object to draw to
+*/
+displaylib_animation::displaylib_animation(displaylib_graphics &display) : _display(display)
+{
+}
+
+/*!
+	@brief Starts an animation and draws its first frame
+	@param data the animation data, must stay in scope
+	@param x left of the animation
+	@param y top of the animation, any row, page aligned is fastest
+	@return Will return
+		-# Success
+		-# BitmapDataEmpty or BitmapSize bad data
+		-# GenericError the display is rotated
+		-# BufferEmpty the screen buffer has not been assigned
+*/
+DisplayRet::Ret_Codes_e displaylib_animation::animationBegin(std::span<const uint8_t> data, int16_t x, int16_t y)
+{
+	_data = {};
+	DisplayRet::Ret_Codes_e result = checkData(data);
+	if (result != DisplayRet::Success)
+		return result;
+	_data = data;
+	_x = x;
+	_y = y;
+	_frame = 0;
+	_shown = false;
+	return showFrame(0);
+}
+
+/*!
+	@brief Draws the next frame, after the last frame the first is drawn again
+	@return Success or the error codes of animationBegin
+	@note A delta frame only changes the bytes that differ from the frame on
+		screen, so the animation rectangle must not be drawn over between frames.
+*/
+DisplayRet::Ret_Codes_e displaylib_animation::animationNext(void)
+{
+	if (_data.empty())
+	{
+		displaylib_diag::error(displaylib_diag::FuncAnimation, DisplayRet::BitmapDataEmpty);
+		return DisplayRet::BitmapDataEmpty;
+	}
+	return showFrame(_shown ? static_cast<uint16_t>((_frame + 1) % getFrameCount()) : 0);
+}
+
+/*!
+	@brief Draws a frame, from the key frame before it, or from the frame on screen if nearer
+	@param frame the frame 0 to getFrameCount()-1
+	@return Success, GenericError frame out of range, or the error codes of animationBegin
+*/
+DisplayRet::Ret_Codes_e displaylib_animation::animationSeek(uint16_t frame)
+{
+	if (_data.empty() || frame >= getFrameCount())
+	{
+		displaylib_diag::error(displaylib_diag::FuncAnimation, DisplayRet::GenericError, frame);
+		return DisplayRet::GenericError;
+	}
+	if (_shown && frame == _frame)
+		return DisplayRet::Success;
+	uint16_t start = frame;
+	while (start > 0 && frameType(_data, start) != FrameKey)
+		start--;
+	if (_shown && _frame < frame && start <= _frame)
+		start = _frame + 1; // carry on from the frame on screen
+	for (uint16_t next = start; next <= frame; next++)
+	{
+		DisplayRet::Ret_Codes_e result = showFrame(next);
+		if (result != DisplayRet::Success)
+			return result;
+	}
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Draws a compressed bitmap, the first frame of the data
+	@param display the display driver object to draw to
+	@param x left of the bitmap
+	@param y top of the bitmap
+	@param data the compressed bitmap
+	@return Success or the error codes of animationBegin
+*/
+DisplayRet::Ret_Codes_e displaylib_animation::drawCompressed(displaylib_graphics &display, int16_t x, int16_t y,
+	std::span<const uint8_t> data)
+{
+	DisplayRet::Ret_Codes_e result = checkData(data);
+	if (result != DisplayRet::Success)
+		return result;
+	decode_target_t target;
+	target.x = x;
+	target.y = y;
+	target.width = static_cast<int16_t>(readLE16(data, 0));
+	target.pages = data[2];
+	target.height = imageHeight(data);
+	result = targetBuffer(display, target);
+	if (result != DisplayRet::Success)
+		return result;
+	return decodeFrame(data, 0, target);
+}
+
+/*!
+	@brief Number of frames in the animation
+	@return frames, 0 if animationBegin not called
+*/
+uint16_t displaylib_animation::getFrameCount(void) const
+{
+	return _data.empty() ? 0 : readLE16(_data, 4);
+}
+
+/*!
+	@brief Frame on screen
+	@return frame number
+*/
+uint16_t displaylib_animation::getFrame(void) const
+{
+	return _frame;
+}
+
+/*!
+	@brief Width of the animation
+	@return pixels
+*/
+int16_t displaylib_animation::getAnimationWidth(void) const
+{
+	return _data.empty() ? 0 : static_cast<int16_t>(readLE16(_data, 0));
+}
+
+/*!
+	@brief Height of the animation
+	@return pixels
+*/
+int16_t displaylib_animation::getAnimationHeight(void) const
+{
+	return _data.empty() ? 0 : imageHeight(_data);
+}
+
+/*!
+	@brief Have bytes changed since the last flushDirty or clearDirty
+	@return true if the dirty rectangle needs sending
+*/
+bool displaylib_animation::getDirty(void) const
+{
+	return _dirtyRect.w > 0;
+}
+
+/*!
+	@brief Rectangle of the screen buffer changed by the frames drawn since the last flush
+	@return the rectangle, buffer co-ordinates, empty if nothing changed
+*/
+displaylib_flush::flush_rect_t displaylib_animation::getDirtyRect(void) const
+{
+	return _dirtyRect;
+}
+
+/*!
+	@brief Forgets the changed bytes, e.g. when the frame is sent with the rest of the screen
+*/
+void displaylib_animation::clearDirty(void)
+{
+	_dirtyRect = displaylib_flush::flush_rect_t{};
+}
+
+/*!
+	@brief Sends the dirty rectangle from the screen buffer to the display
+	@param display the display driver object, the same object drawn to
+	@return Success, or the error code of displaylib_flush::updateRegion
+*/
+DisplayRet::Ret_Codes_e displaylib_animation::flushDirty(displaylib_flush &display)
+{
+	if (!getDirty())
+		return DisplayRet::Success;
+	DisplayRet::Ret_Codes_e result = display.updateRegion(_dirtyRect);
+	if (result == DisplayRet::Success)
+		clearDirty();
+	return result;
+}
+
+/*!
+	@brief Checks the header and frame table of animation data
+	@param data the data
+	@return Success, BitmapDataEmpty or BitmapSize
+*/
+DisplayRet::Ret_Codes_e displaylib_animation::checkData(std::span<const uint8_t> data)
+{
+	if (data.empty())
+	{
+		displaylib_diag::error(displaylib_diag::FuncAnimation, DisplayRet::BitmapDataEmpty);
+		return DisplayRet::BitmapDataEmpty;
+	}
+	if (data.size() < ANIMATION_HEADER_SIZE || data[3] != ANIMATION_VERSION ||
+		readLE16(data, 0) == 0 || data[2] == 0 || readLE16(data, 4) == 0 ||
+		readLE16(data, 6) > data[2] * 8U || (readLE16(data, 6) != 0 && readLE16(data, 6) <= (data[2] - 1) * 8U) ||
+		data.size() < ANIMATION_HEADER_SIZE + (4U * readLE16(data, 4)) ||
+		frameType(data, 0) != FrameKey)
+	{
+		displaylib_diag::error(displaylib_diag::FuncAnimation, DisplayRet::BitmapSize, static_cast<int16_t>(data.size()));
+		return DisplayRet::BitmapSize;
+	}
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Image height of animation data
+	@param data the data, header checked
+	@return rows, pages*8 if the header height is 0
+*/
+int16_t displaylib_animation::imageHeight(std::span<const uint8_t> data)
+{
+	const uint16_t height = readLE16(data, 6);
+	return static_cast<int16_t>(height != 0 ? height : data[2] * 8);
+}
+
+/*!
+	@brief Gets the screen buffer to decode into
+	@param display the display driver object
+	@param target returns the buffer and its size
+	@return Success, or the errors of displaylib_graphics::pageBuffer
+*/
+DisplayRet::Ret_Codes_e displaylib_animation::targetBuffer(displaylib_graphics &display, decode_target_t &target)
+{
+	target.screenWidth = display.WIDTH;
+	target.screenPages = (display.HEIGHT + 7) / 8;
+	return display.pageBuffer(target.buffer, displaylib_diag::FuncAnimation);
+}
+
+/*!
+	@brief Unpacks one frame into the screen buffer
+	@param data the animation data, checked
+	@param frame the frame
+	@param target where to draw, returns the changed bytes
+	@return Success, or BitmapSize if the frame data is corrupt
+*/
+DisplayRet::Ret_Codes_e displaylib_animation::decodeFrame(std::span<const uint8_t> data, uint16_t frame, decode_target_t &target)
+{
+	const uint16_t frames = readLE16(data, 4);
+	const uint32_t start = readLE32(data, ANIMATION_HEADER_SIZE + (4U * frame));
+	const uint32_t end = (frame + 1U < frames) ? readLE32(data, ANIMATION_HEADER_SIZE + (4U * (frame + 1))) : data.size();
+	if (start >= end || end > data.size() || data[start] > FrameDelta)
+	{
+		displaylib_diag::error(displaylib_diag::FuncAnimation, DisplayRet::BitmapSize, frame);
+		return DisplayRet::BitmapSize;
+	}
+	const bool delta = (data[start] == FrameDelta);
+	uint32_t pos = start + 1;
+	uint32_t remaining = static_cast<uint32_t>(target.width) * target.pages;
+	int16_t col = 0;
+	int16_t page = 0;
+	while (remaining > 0)
+	{
+		if (pos >= end)
+			break;
+		const uint8_t control = data[pos++];
+		uint16_t count = (control < 0x80) ? control + 1 : control - 0x80 + 2;
+		if (count > remaining || (control < 0x80 && pos + count > end) || (control >= 0x80 && pos >= end))
+			break;
+		remaining -= count;
+		if (control < 0x80)
+		{
+			while (count-- > 0)
+			{
+				putByte(target, col, page, data[pos++], delta);
+				if (++col == target.width)
+				{
+					col = 0;
+					page++;
+				}
+			}
+			continue;
+		}
+		const uint8_t value = data[pos++];
+		if (delta && value == 0) // unchanged bytes
+		{
+			col += count;
+			while (col >= target.width)
+			{
+				col -= target.width;
+				page++;
+			}
+			continue;
+		}
+		while (count-- > 0)
+		{
+			putByte(target, col, page, value, delta);
+			if (++col == target.width)
+			{
+				col = 0;
+				page++;
+			}
+		}
+	}
+	if (remaining > 0)
+	{
+		displaylib_diag::error(displaylib_diag::FuncAnimation, DisplayRet::BitmapSize, frame);
+		return DisplayRet::BitmapSize;
+	}
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Writes or XORs one image byte into the screen buffer, clipped
+	@param target where to draw, returns the changed bytes
+	@param col image column
+	@param page image page
+	@param value the byte
+	@param delta true XOR, false write
+	@details If the image top is not on a page boundary the byte is split over two pages.
+		The rows of the last page below the image height are left as they are.
+*/
+void displaylib_animation::putByte(decode_target_t &target, int16_t col, int16_t page, uint8_t value, bool delta)
+{
+	const int16_t screenX = target.x + col;
+	if (screenX < 0 || screenX >= target.screenWidth)
+		return;
+	const int16_t rows = target.height - (page * 8);
+	const uint8_t keep = (rows >= 8) ? 0xFF : static_cast<uint8_t>(0xFF >> (8 - rows));
+	value &= keep; // pad rows
+	const uint8_t shift = target.y & 7;
+	const int16_t upper = (target.y >> 3) + page; // floor, y may be negative
+	bool changed = false;
+	if (upper >= 0 && upper < target.screenPages)
+	{
+		uint8_t &dest = target.buffer[(upper * target.screenWidth) + screenX];
+		const uint8_t mask = static_cast<uint8_t>(keep << shift);
+		const uint8_t bits = static_cast<uint8_t>(value << shift);
+		const uint8_t result = delta ? (dest ^ bits) : ((dest & ~mask) | bits);
+		changed = (result != dest);
+		dest = result;
+	}
+	if (shift != 0 && upper + 1 >= 0 && upper + 1 < target.screenPages)
+	{
+		uint8_t &dest = target.buffer[((upper + 1) * target.screenWidth) + screenX];
+		const uint8_t mask = static_cast<uint8_t>(keep >> (8 - shift));
+		const uint8_t bits = static_cast<uint8_t>(value >> (8 - shift));
+		const uint8_t result = delta ? (dest ^ bits) : ((dest & ~mask) | bits);
+		changed = changed || (result != dest);
+		dest = result;
+	}
+	if (!changed)
+		return;
+	if (target.colMax < target.colMin)
+	{
+		target.colMin = target.colMax = col;
+		target.pageMin = target.pageMax = page;
+		return;
+	}
+	if (col < target.colMin) target.colMin = col;
+	if (col > target.colMax) target.colMax = col;
+	if (page < target.pageMin) target.pageMin = page;
+	if (page > target.pageMax) target.pageMax = page;
+}
+
+/*!
+	@brief Type of a frame
+	@param data the animation data, header and frame table checked
+	@param frame the frame
+	@return FrameKey, FrameDelta, or 0xFF if the offset is out of range
+*/
+uint16_t displaylib_animation::frameType(std::span<const uint8_t> data, uint16_t frame)
+{
+	const uint32_t offset = readLE32(data, ANIMATION_HEADER_SIZE + (4U * frame));
+	return (offset < data.size()) ? data[offset] : 0xFF;
+}
+
+/*!
+	@brief Decodes a frame into the screen buffer and adds the changed bytes to the dirty rectangle
+	@param frame the frame, a key frame or the frame after the one on screen
+	@return Success or the error codes of animationBegin
+*/
+DisplayRet::Ret_Codes_e displaylib_animation::showFrame(uint16_t frame)
+{
+	decode_target_t target;
+	target.x = _x;
+	target.y = _y;
+	target.width = getAnimationWidth();
+	target.pages = _data[2];
+	target.height = getAnimationHeight();
+	DisplayRet::Ret_Codes_e result = targetBuffer(_display, target);
+	if (result != DisplayRet::Success)
+		return result;
+	result = decodeFrame(_data, frame, target);
+	_frame = frame;
+	_shown = (result == DisplayRet::Success);
+	if (target.colMax >= target.colMin)
+	{
+		const int16_t bottom = std::min<int16_t>((target.pageMax + 1) * 8, target.height);
+		const displaylib_flush::flush_rect_t changed{
+			static_cast<int16_t>(_x + target.colMin),
+			static_cast<int16_t>(_y + (target.pageMin * 8)),
+			static_cast<int16_t>(target.colMax - target.colMin + 1),
+			static_cast<int16_t>(bottom - (target.pageMin * 8))};
+		_dirtyRect = displaylib_flush::rectMerge(_dirtyRect, changed);
+	}
+	return result;
+}
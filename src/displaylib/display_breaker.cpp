@@ -0,0 +1,105 @@
+/*!
+	@file display_breaker.cpp
+	@brief Source file for the I2C display circuit breaker
+	@author Gavin Lyons.
+*/
+
+#include "pico/stdlib.h"
+#include "../../include/displaylib/display_breaker.hpp"
+
+/*!
+	@brief Is the breaker open, i.e. display treated as disconnected
+	@return true if open, bus writes are skipped
+*/
+bool displaylib_breaker::GetBreakerOpen(void) const
+{
+	return _breakerOpen;
+}
+
+/*!
+	@brief Number of times the breaker has opened
+	@return trips
+*/
+uint32_t displaylib_breaker::GetBreakerTrips(void) const
+{
+	return _breakerTrips;
+}
+
+/*!
+	@brief Sets the reconnect probe schedule
+	@param minMs delay before the first probe after the breaker opens, mS
+	@param maxMs longest delay between probes, mS, the delay doubles each failed probe
+*/
+void displaylib_breaker::SetBreakerBackoff(uint16_t minMs, uint16_t maxMs)
+{
+	if (minMs == 0)
+		minMs = 1;
+	if (maxMs < minMs)
+		maxMs = minMs;
+	_backoffMinMs = minMs;
+	_backoffMaxMs = maxMs;
+	_backoffMs = minMs;
+}
+
+/*!
+	@brief Closes the breaker, bus writes are attempted again
+	@note Called by the driver when a probe succeeds, the user can call it
+		to force a retry at once.
+*/
+void displaylib_breaker::BreakerReset(void)
+{
+	_breakerOpen = false;
+	_backoffMs = _backoffMinMs;
+	_flushFailures = 0;
+}
+
+/*!
+	@brief Opens the breaker after a persistent bus failure
+*/
+void displaylib_breaker::breakerTrip(void)
+{
+	if (_breakerOpen)
+		return;
+	_breakerOpen = true;
+	_breakerTrips++;
+	_flushFailures = 0;
+	_backoffMs = _backoffMinMs;
+	_nextProbeUs = time_us_64() + (_backoffMs * 1000ULL);
+}
+
+/*!
+	@brief Is it time to probe the display
+	@return true if the breaker is open and the backoff delay has passed
+*/
+bool displaylib_breaker::breakerProbeDue(void) const
+{
+	return _breakerOpen && time_us_64() >= _nextProbeUs;
+}
+
+/*!
+	@brief Schedules the next probe after a failed one, doubling the delay
+*/
+void displaylib_breaker::breakerProbeFailed(void)
+{
+	_backoffMs = (_backoffMs > _backoffMaxMs / 2) ? _backoffMaxMs : _backoffMs * 2;
+	_nextProbeUs = time_us_64() + (_backoffMs * 1000ULL);
+}
+
+/*!
+	@brief Counts a failed flush write
+	@param attempts retries allowed, the driver retry attempts setting
+	@return true if the write is to be tried again on the next updateStep,
+		false if the retries are used up and the breaker is to open
+*/
+bool displaylib_breaker::breakerFlushFailed(uint8_t attempts)
+{
+	return ++_flushFailures <= attempts;
+}
+
+/*!
+	@brief A flush write was acknowledged, the failure count starts again
+*/
+void displaylib_breaker::breakerFlushOk(void)
+{
+	_flushFailures = 0;
+}
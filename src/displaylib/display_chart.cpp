@@ -0,0 +1,444 @@
+/*!
+	@file display_chart.cpp
+	@brief Source file for the strip chart widget
+	@author Gavin Lyons.
+*/
+
+#include <cstring>
+#include "pico/stdlib.h"
+#include "../../include/displaylib/display_chart.hpp"
+#include "../../include/displaylib/display_diag.hpp"
+
+/*!
+	@brief init the strip chart object
+	@param display the display driver object to draw to
+	@param x left of the chart
+	@param y top of the chart
+	@param w width of the chart in pixels, one sample per column
+	@param h height of the chart in pixels
+	@note Nothing is drawn until chartBegin is called.
+*/
+displaylib_strip_chart::displaylib_strip_chart(displaylib_graphics &display, int16_t x, int16_t y, int16_t w, int16_t h)
+	: _display(display), _x(x), _y(y), _w(w), _h(h)
+{
+}
+
+/*!
+	@brief Starts the chart and clears its rectangle of the screen buffer
+	@param history sample storage, at least (width + 1) * series values, must stay in scope
+	@param series number of series 1 to CHART_SERIES_MAX
+	@return Will return
+		-# Success
+		-# GenericError bad series count, or the display is rotated
+		-# BufferSize history too small
+		-# ShapeScreenBounds chart not inside the screen, or smaller than 2x2
+		-# BufferEmpty the screen buffer has not been assigned
+*/
+DisplayRet::Ret_Codes_e displaylib_strip_chart::chartBegin(std::span<int16_t> history, uint8_t series)
+{
+	_series = 0;
+	if (series == 0 || series > CHART_SERIES_MAX)
+	{
+		displaylib_diag::error(displaylib_diag::FuncStripChart, DisplayRet::GenericError, series);
+		return DisplayRet::GenericError;
+	}
+	if (_w < 2 || _h < 2 || _x < 0 || _y < 0 ||
+		_x + _w > _display.WIDTH || _y + _h > _display.HEIGHT)
+	{
+		displaylib_diag::error(displaylib_diag::FuncStripChart, DisplayRet::ShapeScreenBounds, _w, _h);
+		return DisplayRet::ShapeScreenBounds;
+	}
+	if (history.size() < static_cast<size_t>((_w + 1) * series))
+	{
+		displaylib_diag::error(displaylib_diag::FuncStripChart, DisplayRet::BufferSize, static_cast<int16_t>(history.size()));
+		return DisplayRet::BufferSize;
+	}
+	_history = history;
+	_series = series;
+	return chartClear();
+}
+
+/*!
+	@brief Sets a fixed range, switches autoscale off
+	@param minValue value at the bottom row
+	@param maxValue value at the top row, greater than minValue
+	@note Call chartRedraw to redraw the samples already shown.
+*/
+void displaylib_strip_chart::setChartRange(int16_t minValue, int16_t maxValue)
+{
+	if (minValue >= maxValue)
+	{
+		displaylib_diag::warning(displaylib_diag::FuncStripChart, DisplayRet::GenericError, minValue, maxValue);
+		if (minValue == INT16_MAX)
+			minValue--;
+		maxValue = minValue + 1;
+	}
+	_min = minValue;
+	_max = maxValue;
+	_autoscale = false;
+}
+
+/*!
+	@brief Sets autoscale, on by default
+	@param autoscale true, the range follows the min and max of the samples shown
+*/
+void displaylib_strip_chart::setChartAutoscale(bool autoscale)
+{
+	_autoscale = autoscale;
+}
+
+/*!
+	@brief Sets how a series is drawn
+	@param series the series 0 to CHART_SERIES_MAX-1
+	@param style StyleLine, StyleDots or StyleFill
+	@note Call chartRedraw to redraw the samples already shown.
+*/
+void displaylib_strip_chart::setSeriesStyle(uint8_t series, chart_style_e style)
+{
+	if (series < CHART_SERIES_MAX)
+		_style[series] = style;
+}
+
+/*!
+	@brief Sets a dotted horizontal threshold line
+	@param index line 0 to CHART_THRESHOLD_MAX-1
+	@param value value the line is drawn at
+	@param on false to remove the line
+	@note Call chartRedraw to redraw the samples already shown.
+*/
+void displaylib_strip_chart::setThreshold(uint8_t index, int16_t value, bool on)
+{
+	if (index >= CHART_THRESHOLD_MAX)
+		return;
+	_threshold[index] = value;
+	if (on)
+		_thresholdOn |= (1 << index);
+	else
+		_thresholdOn &= ~(1 << index);
+}
+
+/*!
+	@brief Adds a sample to a one series chart
+	@param sample the sample
+	@return as chartPush(samples)
+*/
+DisplayRet::Ret_Codes_e displaylib_strip_chart::chartPush(int16_t sample)
+{
+	const int16_t samples[1] = {sample};
+	return chartPush(samples);
+}
+
+/*!
+	@brief Adds a sample to each series, scrolls the chart one column and draws the new column
+	@param samples one sample per series
+	@return Will return
+		-# Success
+		-# GenericError chartBegin not called, too few samples, or the display is rotated
+		-# BufferEmpty the screen buffer has not been assigned
+	@note If autoscale changes the range the whole chart is redrawn from the history.
+*/
+DisplayRet::Ret_Codes_e displaylib_strip_chart::chartPush(std::span<const int16_t> samples)
+{
+	if (_series == 0 || samples.size() < _series)
+	{
+		displaylib_diag::error(displaylib_diag::FuncStripChart, DisplayRet::GenericError, _series, static_cast<int16_t>(samples.size()));
+		return DisplayRet::GenericError;
+	}
+	std::span<uint8_t> buffer;
+	DisplayRet::Ret_Codes_e result = _display.pageBuffer(buffer, displaylib_diag::FuncStripChart);
+	if (result != DisplayRet::Success)
+		return result;
+
+	_head = (_head + 1) % (_w + 1);
+	for (uint8_t series = 0; series < _series; series++)
+		_history[(_head * _series) + series] = samples[series];
+	if (_count <= _w)
+		_count++; // one more than shown, the line into the left column
+	_pushed++;
+	if (rescale())
+		return chartRedraw();
+	shiftLeft(buffer);
+	drawColumn(buffer, _x + _w - 1, 0);
+	_dirty = true;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Redraws the whole chart from the sample history
+	@return Success, or the error codes of chartPush
+	@note Call after clearing the screen buffer, or changing the range, styles or thresholds.
+*/
+DisplayRet::Ret_Codes_e displaylib_strip_chart::chartRedraw(void)
+{
+	if (_series == 0)
+	{
+		displaylib_diag::error(displaylib_diag::FuncStripChart, DisplayRet::GenericError);
+		return DisplayRet::GenericError;
+	}
+	std::span<uint8_t> buffer;
+	DisplayRet::Ret_Codes_e result = _display.pageBuffer(buffer, displaylib_diag::FuncStripChart);
+	if (result != DisplayRet::Success)
+		return result;
+	clearColumns(buffer, _x, _w);
+	for (uint16_t age = 0; age < _count && age < _w; age++)
+		drawColumn(buffer, _x + _w - 1 - age, age);
+	_dirty = true;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Removes all samples and clears the chart rectangle
+	@return Success, or the error codes of chartPush
+*/
+DisplayRet::Ret_Codes_e displaylib_strip_chart::chartClear(void)
+{
+	_count = 0;
+	_head = 0;
+	_pushed = 0;
+	return chartRedraw();
+}
+
+/*!
+	@brief Value at the bottom row
+	@return current range minimum
+*/
+int16_t displaylib_strip_chart::getChartMin(void) const
+{
+	return _min;
+}
+
+/*!
+	@brief Value at the top row
+	@return current range maximum
+*/
+int16_t displaylib_strip_chart::getChartMax(void) const
+{
+	return _max;
+}
+
+/*!
+	@brief Has the chart been drawn since the last flushDirty or clearDirty
+	@return true if the chart rectangle needs sending
+*/
+bool displaylib_strip_chart::getDirty(void) const
+{
+	return _dirty;
+}
+
+/*!
+	@brief The chart rectangle, to send with updateRegion
+	@return the rectangle, buffer co-ordinates, empty if the chart is not dirty
+*/
+displaylib_flush::flush_rect_t displaylib_strip_chart::getDirtyRect(void) const
+{
+	if (!_dirty)
+		return displaylib_flush::flush_rect_t{};
+	return displaylib_flush::flush_rect_t{_x, _y, _w, _h};
+}
+
+/*!
+	@brief Forgets the drawing, flushDirty sends nothing until the chart is drawn again
+*/
+void displaylib_strip_chart::clearDirty(void)
+{
+	_dirty = false;
+}
+
+/*!
+	@brief Sends the chart rectangle from the screen buffer to the display
+	@param display the display driver object, the same object drawn to
+	@return Success, or the error code of displaylib_flush::updateRegion
+*/
+DisplayRet::Ret_Codes_e displaylib_strip_chart::flushDirty(displaylib_flush &display)
+{
+	if (!_dirty)
+		return DisplayRet::Success;
+	DisplayRet::Ret_Codes_e result = display.updateRegion(getDirtyRect());
+	if (result == DisplayRet::Success)
+		_dirty = false;
+	return result;
+}
+
+/*!
+	@brief Bits of a page inside the chart rectangle
+	@param page the page
+	@return mask, bit 0 top row of the page
+*/
+uint8_t displaylib_strip_chart::pageMask(int16_t page) const
+{
+	const int16_t top = (_y > page * 8) ? _y : page * 8;
+	const int16_t bottom = (_y + _h - 1 < page * 8 + 7) ? _y + _h - 1 : page * 8 + 7;
+	return static_cast<uint8_t>((0xFF << (top & 7)) & (0xFF >> (7 - (bottom & 7))));
+}
+
+/*!
+	@brief Clears columns of the chart rectangle
+	@param buffer the screen buffer
+	@param column first column
+	@param count number of columns
+*/
+void displaylib_strip_chart::clearColumns(std::span<uint8_t> buffer, int16_t column, int16_t count)
+{
+	for (int16_t page = _y / 8; page <= (_y + _h - 1) / 8; page++)
+	{
+		const uint8_t keep = ~pageMask(page);
+		uint8_t *row = buffer.data() + (page * _display.WIDTH) + column;
+		for (int16_t col = 0; col < count; col++)
+			row[col] &= keep;
+	}
+}
+
+/*!
+	@brief Moves the chart rectangle one column left and clears the right column
+	@param buffer the screen buffer
+	@details Whole pages are moved with memmove, the top and bottom pages,
+		if the chart only covers part of them, are merged through a mask so
+		pixels outside the chart are kept.
+*/
+void displaylib_strip_chart::shiftLeft(std::span<uint8_t> buffer)
+{
+	for (int16_t page = _y / 8; page <= (_y + _h - 1) / 8; page++)
+	{
+		const uint8_t mask = pageMask(page);
+		uint8_t *row = buffer.data() + (page * _display.WIDTH) + _x;
+		if (mask == 0xFF)
+		{
+			memmove(row, row + 1, _w - 1);
+		}
+		else
+		{
+			for (int16_t col = 0; col < _w - 1; col++)
+				row[col] = (row[col] & ~mask) | (row[col + 1] & mask);
+		}
+		row[_w - 1] &= ~mask;
+	}
+}
+
+/*!
+	@brief Draws the thresholds and the series of one sample in a column
+	@param buffer the screen buffer
+	@param column the column, cleared
+	@param age age of the sample, 0 newest
+*/
+void displaylib_strip_chart::drawColumn(std::span<uint8_t> buffer, int16_t column, uint16_t age)
+{
+	if (((_pushed - age) & 1) == 0) // dotted, the dots scroll with the samples
+	{
+		for (uint8_t index = 0; index < CHART_THRESHOLD_MAX; index++)
+		{
+			if (_thresholdOn & (1 << index))
+			{
+				const int16_t row = valueRow(_threshold[index]);
+				drawRun(buffer, column, row, row);
+			}
+		}
+	}
+	for (uint8_t series = 0; series < _series; series++)
+	{
+		const int16_t row = valueRow(sampleAt(age, series));
+		switch (_style[series])
+		{
+		case StyleLine:
+			if (age + 1 < _count)
+			{
+				const int16_t previous = valueRow(sampleAt(age + 1, series));
+				if (previous < row)
+					drawRun(buffer, column, previous, row);
+				else
+					drawRun(buffer, column, row, previous);
+			}
+			else
+			{
+				drawRun(buffer, column, row, row);
+			}
+			break;
+		case StyleDots:
+			drawRun(buffer, column, row, row);
+			break;
+		case StyleFill:
+			drawRun(buffer, column, row, _y + _h - 1);
+			break;
+		}
+	}
+}
+
+/*!
+	@brief Sets a run of pixels in a column, a page at a time
+	@param buffer the screen buffer
+	@param column the column
+	@param rowStart first row
+	@param rowEnd last row, not less than rowStart
+*/
+void displaylib_strip_chart::drawRun(std::span<uint8_t> buffer, int16_t column, int16_t rowStart, int16_t rowEnd)
+{
+	int16_t row = rowStart;
+	while (row <= rowEnd)
+	{
+		const int16_t page = row / 8;
+		const int16_t last = (rowEnd < page * 8 + 7) ? rowEnd : page * 8 + 7;
+		buffer[(page * _display.WIDTH) + column] |= static_cast<uint8_t>((0xFF << (row & 7)) & (0xFF >> (7 - (last & 7))));
+		row = last + 1;
+	}
+}
+
+/*!
+	@brief Row of a value in the current range
+	@param value the value, clamped to the range
+	@return screen row
+*/
+int16_t displaylib_strip_chart::valueRow(int16_t value) const
+{
+	if (value < _min)
+		value = _min;
+	if (value > _max)
+		value = _max;
+	const int32_t offset = ((static_cast<int32_t>(value) - _min) * (_h - 1)) / (static_cast<int32_t>(_max) - _min);
+	return static_cast<int16_t>(_y + _h - 1 - offset);
+}
+
+/*!
+	@brief Sample from the history
+	@param age age of the sample, 0 newest
+	@param series the series
+	@return the sample
+*/
+int16_t displaylib_strip_chart::sampleAt(uint16_t age, uint8_t series) const
+{
+	const uint16_t column = (_head + _w + 1 - age) % (_w + 1);
+	return _history[(column * _series) + series];
+}
+
+/*!
+	@brief With autoscale on, sets the range to the min and max of the samples shown
+	@return true if the range changed and the chart must be redrawn
+*/
+bool displaylib_strip_chart::rescale(void)
+{
+	if (!_autoscale || _count == 0)
+		return false;
+	int16_t low = sampleAt(0, 0);
+	int16_t high = low;
+	for (uint16_t age = 0; age < _count && age < _w; age++)
+	{
+		for (uint8_t series = 0; series < _series; series++)
+		{
+			const int16_t sample = sampleAt(age, series);
+			if (sample < low)
+				low = sample;
+			if (sample > high)
+				high = sample;
+		}
+	}
+	if (low == high)
+	{
+		if (high == INT16_MAX)
+			low--;
+		else
+			high++;
+	}
+	if (low == _min && high == _max)
+		return false;
+	_min = low;
+	_max = high;
+	return true;
+}
@@ -0,0 +1,168 @@
+/*!
+	@file display_clocktune.cpp
+	@brief Source file for the I2C clock auto tuning
+	@author Gavin Lyons.
+*/
+
+#include "pico/stdlib.h"
+#include "../../include/displaylib/display_clocktune.hpp"
+#include "../../include/displaylib/display_diag.hpp"
+
+/*!
+	@brief Finds the fastest I2C clock that runs without errors and sets it
+	@param maxKHz highest clock tried, kHz, e.g. 400 if a device on the bus is Fast-mode only
+	@param marginPercent the clock is set this percent below the fastest step passed, 0 to 50
+	@return Will return
+		-# Success
+		-# I2CNotConnected no step passed, the clock is put back as it was and
+			the controller init re-sent
+	@details Blocking, about 0.1 to 0.5 S at 100 kHz start. Page 0 of display RAM
+		is written with test patterns and restored from the screen buffer. If a
+		step failed the controller init is re-sent, as a corrupt write may have
+		been taken as a command. Call after begin, before the first update.
+*/
+DisplayRet::Ret_Codes_e displaylib_clocktune::I2CClockTune(uint16_t maxKHz, uint8_t marginPercent)
+{
+	if (marginPercent > 50)
+	{
+		displaylib_diag::warning(displaylib_diag::FuncClockTune, DisplayRet::GenericError, marginPercent, 50);
+		marginPercent = 50;
+	}
+	_tuneMaxKHz = maxKHz;
+	_tuneMargin = marginPercent;
+	_tuneRuns++;
+	_lastTuneUs = time_us_64();
+	_retuneDue = false;
+	_windowWrites = 0;
+	_windowErrors = 0;
+
+	uint16_t passKHz = 0;
+	bool failed = false;
+	uint16_t beforeKHz = 0;
+	for (uint8_t step = 0; step < sizeof(CLOCK_TUNE_STEPS) / sizeof(CLOCK_TUNE_STEPS[0]); step++)
+	{
+		if (CLOCK_TUNE_STEPS[step] > maxKHz)
+			break;
+		const uint16_t oldKHz = clockTuneSet(CLOCK_TUNE_STEPS[step]);
+		if (step == 0)
+			beforeKHz = oldKHz;
+		for (uint8_t pass = 0; pass < CLOCK_TUNE_PASSES && !failed; pass++)
+			failed = !clockTuneProbe();
+		if (failed)
+			break;
+		passKHz = CLOCK_TUNE_STEPS[step];
+	}
+	if (passKHz == 0)
+	{
+		if (beforeKHz != 0)
+			clockTuneSet(beforeKHz);
+		if (failed)
+			clockTuneRecover();
+		displaylib_diag::error(displaylib_diag::FuncClockTune, DisplayRet::I2CNotConnected, maxKHz);
+		return DisplayRet::I2CNotConnected;
+	}
+
+	_tunedKHz = static_cast<uint16_t>((static_cast<uint32_t>(passKHz) * (100 - marginPercent)) / 100);
+	clockTuneSet(_tunedKHz);
+	if (failed)
+		clockTuneRecover();
+	if (!clockTuneProbe()) // also restores page 0 written by a failed step
+	{
+		displaylib_diag::error(displaylib_diag::FuncClockTune, DisplayRet::I2CNotConnected, _tunedKHz, passKHz);
+		return DisplayRet::I2CNotConnected;
+	}
+	displaylib_diag::info(displaylib_diag::FuncClockTune, DisplayRet::Success, _tunedKHz, passKHz);
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Clock set by the last tuning
+	@return kHz, 0 if I2CClockTune has not been run
+*/
+uint16_t displaylib_clocktune::GetI2CClockTuned(void) const
+{
+	return _tunedKHz;
+}
+
+/*!
+	@brief Number of tunings run, by the user and automatic
+	@return runs
+*/
+uint32_t displaylib_clocktune::GetI2CClockTuneRuns(void) const
+{
+	return _tuneRuns;
+}
+
+/*!
+	@brief Turns on or off automatic re-tuning when the error rate climbs
+	@param on true to re-tune, needs one I2CClockTune call first for the clock limits
+	@param errorLimit failed writes in a window of CLOCK_TUNE_WINDOW writes that
+		trigger a re-tune, 1 to 255, 0 is taken as 1
+	@note The re-tune is run by I2CClockRetune, called from the main loop.
+		Re-tunes are at least CLOCK_RETUNE_HOLDOFF_MS apart, between them
+		the retries and circuit breaker deal with errors as before.
+*/
+void displaylib_clocktune::SetI2CClockAutoTune(bool on, uint8_t errorLimit)
+{
+	_autoTune = on;
+	_errorLimit = (errorLimit == 0) ? 1 : errorLimit;
+	_retuneDue = false;
+	_windowWrites = 0;
+	_windowErrors = 0;
+}
+
+/*!
+	@brief Counts a bus write for the error rate, called by the driver for each attempt
+	@param ok true if the write was acknowledged
+*/
+void displaylib_clocktune::clockTuneNote(bool ok)
+{
+	if (!_autoTune || _tunedKHz == 0)
+		return;
+	_windowWrites++;
+	if (!ok && ++_windowErrors >= _errorLimit)
+		_retuneDue = true;
+	if (_windowWrites >= CLOCK_TUNE_WINDOW)
+	{
+		_windowWrites = 0;
+		_windowErrors = 0;
+	}
+}
+
+/*!
+	@brief Is an automatic re-tune due
+	@return true if the error limit was reached and CLOCK_RETUNE_HOLDOFF_MS
+		has passed since the last tuning
+*/
+bool displaylib_clocktune::GetI2CClockRetuneDue(void) const
+{
+	return _retuneDue && (time_us_64() - _lastTuneUs) >= (CLOCK_RETUNE_HOLDOFF_MS * 1000ULL);
+}
+
+/*!
+	@brief Runs the re-tune if one is due, with the clock limits of the last I2CClockTune
+	@return Will return
+		-# Success re-tuned, or no re-tune due
+		-# I2CNotConnected no step passed, see I2CClockTune
+	@details Blocking like I2CClockTune and writes test patterns to page 0, so
+		call it from the main loop between frames, when updateBusy is false.
+		The drivers never run it from updateStep. Does nothing unless
+		SetI2CClockAutoTune is on and the error limit was reached.
+*/
+DisplayRet::Ret_Codes_e displaylib_clocktune::I2CClockRetune(void)
+{
+	if (!GetI2CClockRetuneDue())
+		return DisplayRet::Success;
+	return I2CClockTune(_tuneMaxKHz, _tuneMargin);
+}
+
+/*!
+	@brief Drops to the lowest clock step if a re-tune is due, called by the
+		driver before the circuit breaker probes the display, so a clock the
+		board can no longer take does not keep the breaker open
+*/
+void displaylib_clocktune::clockTuneFallback(void)
+{
+	if (_retuneDue && _tunedKHz != 0)
+		clockTuneSet(CLOCK_TUNE_STEPS[0]);
+}
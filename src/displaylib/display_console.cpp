@@ -0,0 +1,250 @@
+/*!
+	@file display_console.cpp
+	@brief Source file for the hardware scrolled text console
+	@author Gavin Lyons.
+*/
+
+#include <cstring>
+#include "pico/stdlib.h"
+#include "../../include/displaylib/display_console.hpp"
+#include "../../include/displaylib/display_diag.hpp"
+
+/*!
+	@brief init the console class object
+	@param display the display driver object to print to
+*/
+displaylib_console::displaylib_console(displaylib_flush &display) : _display(display)
+{
+}
+
+/*!
+	@brief Starts the console, clears the display RAM and sets the start line to 0.
+	@param font the font, must be 8 pixels high
+	@return Will return
+		-# Success
+		-# FontDataEmpty or FontDataTooSmall bad font data
+		-# GenericError font not 8 pixels high or display has no start line register
+		-# I2CNotConnected bus error
+	@note Call after the driver begin/init method.
+*/
+DisplayRet::Ret_Codes_e displaylib_console::consoleBegin(std::span<const uint8_t> font)
+{
+	_active = false;
+	if (font.empty())
+	{
+		displaylib_diag::error(displaylib_diag::FuncConsoleBegin, DisplayRet::FontDataEmpty);
+		return DisplayRet::FontDataEmpty;
+	}
+	if (font.size() < 5)
+	{
+		displaylib_diag::error(displaylib_diag::FuncConsoleBegin, DisplayRet::FontDataTooSmall);
+		return DisplayRet::FontDataTooSmall;
+	}
+	if (font[1] != 8 || font[0] == 0 || font[0] > displaylib_flush::UPDATE_CHUNK_MAX)
+	{
+		displaylib_diag::error(displaylib_diag::FuncConsoleBegin, DisplayRet::GenericError, font[1]);
+		return DisplayRet::GenericError;
+	}
+	_font = font;
+	_fontWidth = font[0];
+	_fontOffset = font[2];
+	_fontNumChars = font[3];
+	_ramPages = _display.flushRamPages();
+	_topPage = 0;
+	_rows = _display._flushPages;
+	DisplayRet::Ret_Codes_e result = _display.flushStartLine(0);
+	if (result != DisplayRet::Success)
+		return result;
+	_active = true;
+	return consoleClear();
+}
+
+/*!
+	@brief Stops the console, sets the start line back to 0 so the driver
+		update functions draw in the right place again.
+	@return Success or the drivers bus error
+*/
+DisplayRet::Ret_Codes_e displaylib_console::consoleEnd(void)
+{
+	if (!_active)
+		return DisplayRet::Success;
+	_active = false;
+	return _display.flushStartLine(0);
+}
+
+/*!
+	@brief Clears the console, all of display RAM, cursor to top left
+	@return Success, GenericError if consoleBegin not called, or the drivers bus error
+*/
+DisplayRet::Ret_Codes_e displaylib_console::consoleClear(void)
+{
+	if (!_active)
+	{
+		displaylib_diag::error(displaylib_diag::FuncConsoleClear, DisplayRet::GenericError);
+		return DisplayRet::GenericError;
+	}
+	DisplayRet::Ret_Codes_e result;
+	for (uint8_t page = 0; page < _ramPages; page++)
+	{
+		result = clearPage(page);
+		if (result != DisplayRet::Success)
+			return result;
+	}
+	_row = 0;
+	_column = 0;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Sets the text colour of characters printed after the call
+	@param invert false white text on black, true black text on white
+	@note Rows are cleared to the background colour as they are scrolled in.
+*/
+void displaylib_console::setConsoleInvert(bool invert)
+{
+	_invert = invert;
+}
+
+/*!
+	@brief Number of text rows on screen
+	@return rows, screen height / 8
+*/
+uint8_t displaylib_console::getConsoleRows(void) const
+{
+	return _rows;
+}
+
+/*!
+	@brief Number of characters per row
+	@return columns, screen width / font width
+*/
+uint8_t displaylib_console::getConsoleColumns(void) const
+{
+	return (_fontWidth == 0) ? 0 : _display._flushWidth / _fontWidth;
+}
+
+/*!
+	@brief writes a character to the console, called by the print methods
+	@param character the character, '\\n' new line, '\\r' return to start of row
+	@return 1 if written, 0 on error, see getWriteError
+	@note Rows wrap at the right edge of the screen.
+*/
+size_t displaylib_console::write(uint8_t character)
+{
+	if (!_active)
+	{
+		setWriteError(DisplayRet::GenericError);
+		return 0;
+	}
+	DisplayRet::Ret_Codes_e result = DisplayRet::Success;
+	switch (character)
+	{
+	case '\n':
+		result = newLine();
+		break;
+	case '\r':
+		_column = 0;
+		break;
+	default:
+		if (_column + _fontWidth > _display._flushWidth)
+			result = newLine();
+		if (result == DisplayRet::Success)
+			result = drawGlyph(character);
+		break;
+	}
+	if (result != DisplayRet::Success)
+	{
+		setWriteError(result);
+		return 0;
+	}
+	return 1;
+}
+
+/*!
+	@brief Moves the cursor to the start of the next row, at the bottom row
+		the screen is scrolled with the start line register.
+	@return Success or the drivers bus error
+*/
+DisplayRet::Ret_Codes_e displaylib_console::newLine(void)
+{
+	_column = 0;
+	if (_row + 1 < _rows)
+	{
+		_row++;
+		return DisplayRet::Success;
+	}
+	// scroll: reuse the page leaving the top as the new bottom row
+	_topPage = (_topPage + 1) % _ramPages;
+	DisplayRet::Ret_Codes_e result = clearPage(cursorPage());
+	if (result != DisplayRet::Success)
+		return result;
+	return _display.flushStartLine(_topPage * 8);
+}
+
+/*!
+	@brief Fills one page of display RAM with the background colour
+	@param ramPage the page
+	@return Success or the drivers bus error
+*/
+DisplayRet::Ret_Codes_e displaylib_console::clearPage(uint8_t ramPage)
+{
+	uint8_t fill[displaylib_flush::UPDATE_CHUNK_MAX];
+	memset(fill, _invert ? 0xFF : 0x00, sizeof(fill));
+	_display.flushAddressLost();
+	DisplayRet::Ret_Codes_e result;
+	do
+	{ // a BusRetry write is sent again, the driver opens the breaker when the retries are used up
+		result = _display.flushSetAddress(ramPage, 0, _display._flushWidth - 1);
+		uint8_t remaining = _display._flushWidth;
+		while (result == DisplayRet::Success && remaining > 0)
+		{
+			const uint8_t length = (remaining > sizeof(fill)) ? sizeof(fill) : remaining;
+			result = _display.flushWriteData(std::span<const uint8_t>(fill, length));
+			remaining -= length;
+		}
+	} while (result == DisplayRet::BusRetry);
+	return result;
+}
+
+/*!
+	@brief Writes a character at the cursor straight to display RAM
+	@param character the character
+	@return Success, CharFontASCIIRange or the drivers bus error
+*/
+DisplayRet::Ret_Codes_e displaylib_console::drawGlyph(uint8_t character)
+{
+	if (character < _fontOffset || character >= (_fontOffset + _fontNumChars + 1))
+	{
+		displaylib_diag::error(displaylib_diag::FuncConsoleWrite, DisplayRet::CharFontASCIIRange, character);
+		return DisplayRet::CharFontASCIIRange;
+	}
+	const size_t fontIndex = ((character - _fontOffset) * _fontWidth) + 4;
+	std::span<const uint8_t> glyph = _font.subspan(fontIndex, _fontWidth);
+	uint8_t inverted[displaylib_flush::UPDATE_CHUNK_MAX];
+	if (_invert)
+	{
+		for (uint8_t col = 0; col < _fontWidth; col++)
+			inverted[col] = ~glyph[col];
+		glyph = std::span<const uint8_t>(inverted, _fontWidth);
+	}
+	_display.flushAddressLost();
+	DisplayRet::Ret_Codes_e result;
+	do
+	{ // as clearPage
+		result = _display.flushSetAddress(cursorPage(), _column, _column + _fontWidth - 1);
+		if (result == DisplayRet::Success)
+			result = _display.flushWriteData(glyph);
+	} while (result == DisplayRet::BusRetry);
+	if (result == DisplayRet::Success)
+		_column += _fontWidth;
+	return result;
+}
+
+/*!
+	@brief RAM page of the cursor row
+	@return page
+*/
+uint8_t displaylib_console::cursorPage(void) const
+{
+	return (_topPage + _row) % _ramPages;
+}
@@ -0,0 +1,201 @@
+/*!
+	@file display_diag.cpp
+	@brief Source file for the library diagnostics ring buffer
+	@author Gavin Lyons.
+*/
+
+#include "pico/stdlib.h"
+#include "../../include/displaylib/display_diag.hpp"
+
+#if _DIAG_LEVEL > 0
+displaylib_diag::diag_ring_t displaylib_diag::_rings[DIAG_CORES];
+uint32_t displaylib_diag::_droppedReported = 0;
+#endif
+
+/*!
+	@brief Adds an entry to the ring of the calling core
+	@param level level of entry
+	@param func function recording
+	@param code return code
+	@param arg0 first argument
+	@param arg1 second argument
+	@note If the ring is full the entry is dropped and counted.
+*/
+void displaylib_diag::record(diag_level_e level, diag_func_e func, DisplayRet::Ret_Codes_e code, int16_t arg0, int16_t arg1)
+{
+#if _DIAG_LEVEL > 0
+	const uint8_t core = coreNumber();
+	diag_ring_t &ring = _rings[core];
+	const uint8_t head = ring.head.load(std::memory_order_relaxed);
+	if (static_cast<uint8_t>(head - ring.tail.load(std::memory_order_acquire)) >= DIAG_RING_SIZE)
+	{
+		ring.dropped.store(ring.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		return;
+	}
+	diag_entry_t &entry = ring.entries[head & (DIAG_RING_SIZE - 1)];
+	entry.timeUs = time_us_32();
+	entry.arg0 = arg0;
+	entry.arg1 = arg1;
+	entry.level = level;
+	entry.func = func;
+	entry.code = code;
+	entry.core = core;
+	ring.head.store(head + 1, std::memory_order_release);
+#else
+	(void)level; (void)func; (void)code; (void)arg0; (void)arg1;
+#endif
+}
+
+/*!
+	@brief Removes the oldest entry, of either core
+	@param entry returns the entry
+	@return false if no entries are waiting
+*/
+bool displaylib_diag::pop(diag_entry_t &entry)
+{
+#if _DIAG_LEVEL > 0
+	diag_ring_t *oldest = nullptr;
+	uint32_t oldestUs = 0;
+	for (diag_ring_t &ring : _rings)
+	{
+		const uint8_t tail = ring.tail.load(std::memory_order_relaxed);
+		if (tail == ring.head.load(std::memory_order_acquire))
+			continue;
+		const uint32_t timeUs = ring.entries[tail & (DIAG_RING_SIZE - 1)].timeUs;
+		if (oldest == nullptr || static_cast<int32_t>(timeUs - oldestUs) < 0)
+		{
+			oldest = &ring;
+			oldestUs = timeUs;
+		}
+	}
+	if (oldest == nullptr)
+		return false;
+	const uint8_t tail = oldest->tail.load(std::memory_order_relaxed);
+	entry = oldest->entries[tail & (DIAG_RING_SIZE - 1)];
+	oldest->tail.store(tail + 1, std::memory_order_release);
+	return true;
+#else
+	(void)entry;
+	return false;
+#endif
+}
+
+/*!
+	@brief Prints the waiting entries with printf, call where stdio is cheap
+	@param maxEntries max entries to print this call
+	@return entries printed
+	@details Format, one line per entry:
+		displaylib E 1234567us c0 writeChar: CharScreenBounds(4) 130 8
+		The level is E error, W warning or I info. If entries were dropped since
+		the last drain a line with the count is printed first.
+*/
+uint16_t displaylib_diag::drain(uint16_t maxEntries)
+{
+#if _DIAG_LEVEL > 0
+	const uint32_t dropped = getDropped();
+	if (dropped != _droppedReported)
+	{
+		printf("displaylib diag: %lu entries dropped, ring full\r\n", static_cast<unsigned long>(dropped - _droppedReported));
+		_droppedReported = dropped;
+	}
+	static const char levelTag[] = {'-', 'E', 'W', 'I'};
+	uint16_t printed = 0;
+	diag_entry_t entry;
+	while (printed < maxEntries && pop(entry))
+	{
+		printf("displaylib %c %luus c%u %s: %s(%u) %d %d\r\n",
+			levelTag[entry.level & 0x03], static_cast<unsigned long>(entry.timeUs), entry.core,
+			funcName(entry.func), codeName(entry.code), entry.code, entry.arg0, entry.arg1);
+		printed++;
+	}
+	return printed;
+#else
+	(void)maxEntries;
+	return 0;
+#endif
+}
+
+/*!
+	@brief Total entries dropped because a ring was full
+	@return count since boot
+*/
+uint32_t displaylib_diag::getDropped(void)
+{
+#if _DIAG_LEVEL > 0
+	uint32_t dropped = 0;
+	for (const diag_ring_t &ring : _rings)
+		dropped += ring.dropped.load(std::memory_order_relaxed);
+	return dropped;
+#else
+	return 0;
+#endif
+}
+
+/*!
+	@brief Number of entries waiting to be drained
+	@return entries, both cores
+*/
+uint16_t displaylib_diag::pending(void)
+{
+#if _DIAG_LEVEL > 0
+	uint16_t count = 0;
+	for (const diag_ring_t &ring : _rings)
+		count += static_cast<uint8_t>(ring.head.load(std::memory_order_acquire) - ring.tail.load(std::memory_order_acquire));
+	return count;
+#else
+	return 0;
+#endif
+}
+
+/*!
+	@brief Name of a recording function
+	@param func diag_func_e
+	@return name
+*/
+const char *displaylib_diag::funcName(uint8_t func)
+{
+	static const char *const names[FuncCount] = {
+		"writeChar", "drawBitmap", "drawPolygon", "drawDotGrid", "setFont",
+		"updateBegin", "setUpdateChunkSize", "flushStartLine",
+		"pipelineStart", "frameSubmit",
+		"consoleBegin", "consoleClear", "consoleWrite",
+		"SetBufferPtr", "update", "clearBuffer", "FillPage", "Bitmap",
+		"begin", "init", "SPISetup", "I2CWriteByte", "I2CWriteBlock", "I2CReconnect", "setTextScale",
+		"updateRegion", "numericField", "stripChart", "animation", "manager", "clockTune", "snapshot", "remote", "listView",
+		"sprite", "grayscale", "CheckConnection"};
+	return (func < FuncCount) ? names[func] : "unknown";
+}
+
+/*!
+	@brief Name of a return code
+	@param code DisplayRet::Ret_Codes_e
+	@return name
+*/
+const char *displaylib_diag::codeName(uint8_t code)
+{
+	static const char *const names[] = {
+		"Success", "Reserved", "FontDataEmpty", "FontDataTooSmall",
+		"CharScreenBounds", "CharFontASCIIRange", "CharArrayNullptr",
+		"BitmapDataEmpty", "BitmapScreenBounds", "BitmapLargerThanScreen",
+		"BitmapVerticalSize", "BitmapHorizontalSize", "BitmapSize",
+		"BufferSize", "BufferEmpty", "I2CbeginFail", "I2CNotConnected",
+		"GenericError", "ShapeScreenBounds", "PipelineState", "BusRetry"};
+	return (code < sizeof(names) / sizeof(names[0])) ? names[code] : "unknown";
+}
+
+/*!
+	@brief Ring index of the calling core
+	@return 0 or 1
+	@note On the host build each thread is given a ring in turn, the main
+		thread and the pipeline worker thread.
+*/
+uint8_t displaylib_diag::coreNumber(void)
+{
+#if PICO_ON_DEVICE
+	return static_cast<uint8_t>(get_core_num());
+#else
+	static std::atomic<uint8_t> nextRing{0};
+	thread_local const uint8_t ring = nextRing.fetch_add(1) % DIAG_CORES;
+	return ring;
+#endif
+}
@@ -0,0 +1,743 @@
+/*!
+	@file display_flush.cpp
+	@brief Source file for the incremental, time sliced flush of a screen buffer
+	@author Gavin Lyons.
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "pico/stdlib.h"
+#include "../../include/displaylib/display_flush.hpp"
+#include "../../include/displaylib/display_diag.hpp"
+
+/*!
+	@brief init the flush class object constructor
+	@param w width of display in pixels, defined in sub-class
+	@param h height of display in pixels, defined in sub-class
+*/
+displaylib_flush::displaylib_flush(int16_t w, int16_t h)
+{
+	_flushWidth = w;
+	_flushPages = h / 8;
+}
+
+/*!
+	@brief Starts an incremental flush of the drivers screen buffer.
+	@return Will return
+		-# Success
+		-# BufferEmpty the screen buffer has not been assigned
+	@note If a flush is already in progress it is cancelled and restarted
+		from the first page, call updateStep to send the data.
+*/
+DisplayRet::Ret_Codes_e displaylib_flush::updateBegin(void)
+{
+	return updateBegin(flushBuffer());
+}
+
+/*!
+	@brief Starts an incremental flush of a user supplied frame.
+	@param frame span of frame data, vertically addressed, same layout as the screen buffer
+	@return Will return
+		-# Success
+		-# BufferEmpty frame is an empty object
+		-# BufferSize frame size is not equal to width * (height/8)
+	@note If a flush is already in progress it is cancelled and restarted.
+		The frame must not go out of scope until the flush is done.
+*/
+DisplayRet::Ret_Codes_e displaylib_flush::updateBegin(std::span<const uint8_t> frame)
+{
+	_flushActive = false;
+	if (frame.empty())
+	{
+		displaylib_diag::error(displaylib_diag::FuncUpdateBegin, DisplayRet::BufferEmpty);
+		return DisplayRet::BufferEmpty;
+	}
+	if (frame.size() != static_cast<size_t>(_flushWidth * _flushPages))
+	{
+		displaylib_diag::error(displaylib_diag::FuncUpdateBegin, DisplayRet::BufferSize, static_cast<int16_t>(frame.size()));
+		return DisplayRet::BufferSize;
+	}
+	_flushFrame = frame;
+	_flushPage = 0;
+	_flushPageEnd = _flushPages;
+	_flushColumn = 0;
+	_flushColumnStart = 0;
+	_flushColumnEnd = _flushWidth;
+	_flushSent = 0;
+	_flushTotal = _flushWidth * _flushPages;
+	_flushFrameUs = 0;
+	_flushAddressValid = false;
+	_flushActive = true;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Starts an incremental flush of a rectangle of the drivers screen buffer.
+	@param rect the rectangle, buffer co-ordinates, clipped to the frame,
+		rounded out to whole pages, e.g. getDirtyRect of a widget
+	@return Will return
+		-# Success, also when the rectangle is off screen, nothing is then sent
+		-# BufferEmpty the screen buffer has not been assigned
+	@details As updateRegion but sent by updateStep within its time budget,
+		only the pages the rectangle covers and in each only its columns.
+		If a flush is already in progress it is cancelled.
+*/
+DisplayRet::Ret_Codes_e displaylib_flush::updateBegin(const flush_rect_t &rect)
+{
+	DisplayRet::Ret_Codes_e result = updateBegin(flushBuffer());
+	if (result != DisplayRet::Success)
+		return result;
+	const int16_t left = std::max<int16_t>(rect.x, 0);
+	const int16_t right = static_cast<int16_t>(std::min<int32_t>(static_cast<int32_t>(rect.x) + rect.w, _flushWidth));
+	const int16_t top = std::max<int16_t>(rect.y, 0);
+	const int16_t bottom = static_cast<int16_t>(std::min<int32_t>(static_cast<int32_t>(rect.y) + rect.h, _flushPages * 8));
+	if (left >= right || top >= bottom)
+	{
+		_flushActive = false;
+		return DisplayRet::Success;
+	}
+	_flushColumnStart = static_cast<uint8_t>(left);
+	_flushColumnEnd = static_cast<uint8_t>(right);
+	_flushColumn = _flushColumnStart;
+	_flushPage = static_cast<uint8_t>(top / 8);
+	_flushPageEnd = static_cast<uint8_t>((bottom + 7) / 8);
+	_flushTotal = static_cast<uint16_t>((_flushColumnEnd - _flushColumnStart) * (_flushPageEnd - _flushPage));
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Sends the next chunks of the frame started by updateBegin, until
+		the time budget is spent or the frame is complete.
+	@param budgetUs time budget for this call in microseconds, zero for no limit
+	@return Will return
+		-# FlushIdle no flush in progress
+		-# FlushBusy budget spent, call again to resume
+		-# FlushDone frame complete
+		-# FlushError bus error, flush aborted
+	@details At least one chunk is sent per call. After that a chunk is only
+		started if the time taken by the previous chunk still fits in the budget.
+		Lower the chunk size with setUpdateChunkSize for tight budgets on slow buses.
+		While the display is still powering up, see isReady, nothing is sent
+		and FlushBusy is returned. A write the driver failed with BusRetry
+		returns FlushBusy and is sent again, addressed again, on the next call.
+*/
+displaylib_flush::flush_state_e displaylib_flush::updateStep(uint32_t budgetUs)
+{
+	if (!_flushActive)
+		return FlushIdle;
+	isReady(); // run any power up stage that is due
+	if (!_bootRamReady)
+		return FlushBusy;
+
+	const uint64_t startUs = time_us_64();
+	uint64_t elapsedUs = 0;
+	DisplayRet::Ret_Codes_e result;
+	do
+	{
+		const uint8_t columnEnd = _flushColumnEnd - 1;
+		const uint64_t chunkStartUs = time_us_64();
+		if (!_flushAddressValid)
+		{
+			result = flushSetAddress(_flushPage, _flushColumn, columnEnd);
+			if (result == DisplayRet::BusRetry)
+				break;
+			if (result != DisplayRet::Success)
+			{
+				_flushResult = result;
+				_flushActive = false;
+				return FlushError;
+			}
+			_flushAddressValid = true;
+		}
+		uint8_t length = _flushChunkSize;
+		if (length > _flushColumnEnd - _flushColumn)
+			length = _flushColumnEnd - _flushColumn;
+		result = flushWriteData(_flushFrame.subspan((_flushPage * _flushWidth) + _flushColumn, length));
+		if (result == DisplayRet::BusRetry)
+		{
+			_flushAddressValid = false; // the controller may have taken part of the write
+			break;
+		}
+		if (result != DisplayRet::Success)
+		{
+			_flushResult = result;
+			_flushActive = false;
+			return FlushError;
+		}
+		_flushSent += length;
+		_flushColumn += length;
+		if (_flushColumn >= _flushColumnEnd)
+		{
+			_flushColumn = _flushColumnStart;
+			_flushPage++;
+			_flushAddressValid = false; // next page needs addressing
+			if (_flushPage >= _flushPageEnd)
+			{
+				_flushActive = false;
+				_flushFrameUs += static_cast<uint32_t>(time_us_64() - startUs);
+				statsFrame(_flushFrameUs);
+				return FlushDone;
+			}
+		}
+		const uint64_t nowUs = time_us_64();
+		_flushChunkUs = static_cast<uint32_t>(nowUs - chunkStartUs);
+		elapsedUs = nowUs - startUs;
+	} while (budgetUs == 0 || (elapsedUs + _flushChunkUs) <= budgetUs);
+	_flushFrameUs += static_cast<uint32_t>(time_us_64() - startUs);
+	return FlushBusy;
+}
+
+/*!
+	@brief Cancels a flush in progress, the display keeps the part already sent.
+*/
+void displaylib_flush::updateCancel(void)
+{
+	_flushActive = false;
+}
+
+/*!
+	@brief Sends a rectangle of the drivers screen buffer to the display, blocking.
+	@param x left column of the rectangle, buffer co-ordinates, not rotated
+	@param y top row of the rectangle
+	@param w width in pixels
+	@param h height in pixels, rounded out to whole pages
+	@return Will return
+		-# Success, also when the rectangle is off screen
+		-# BufferEmpty the screen buffer has not been assigned
+		-# GenericError a flush started by updateBegin is in progress
+		-# the bus error code returned by the driver
+	@details Only the pages the rectangle covers are addressed, and in each
+		page only its columns are sent. Used to push a small changed area,
+		such as a readout, without sending the whole frame.
+*/
+DisplayRet::Ret_Codes_e displaylib_flush::updateRegion(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	if (_flushActive)
+	{
+		displaylib_diag::error(displaylib_diag::FuncUpdateRegion, DisplayRet::GenericError);
+		return DisplayRet::GenericError;
+	}
+	std::span<const uint8_t> frame = flushBuffer();
+	if (frame.size() < static_cast<size_t>(_flushWidth * _flushPages))
+	{
+		displaylib_diag::error(displaylib_diag::FuncUpdateRegion, DisplayRet::BufferEmpty);
+		return DisplayRet::BufferEmpty;
+	}
+	// clip to the frame
+	int16_t xEnd = x + w;
+	int16_t yEnd = y + h;
+	if (x < 0) x = 0;
+	if (y < 0) y = 0;
+	if (xEnd > _flushWidth) xEnd = _flushWidth;
+	if (yEnd > _flushPages * 8) yEnd = _flushPages * 8;
+	if (x >= xEnd || y >= yEnd)
+		return DisplayRet::Success;
+
+	while (!isReady() && !_bootRamReady)
+	{
+	} // display still powering up
+	DisplayRet::Ret_Codes_e result = DisplayRet::Success;
+	const uint8_t pageEnd = (yEnd + 7) / 8;
+	for (uint8_t page = y / 8; page < pageEnd && result == DisplayRet::Success; page++)
+	{
+		int16_t column = x;
+		bool addressed = false;
+		while (column < xEnd)
+		{
+			if (!addressed)
+			{
+				result = flushSetAddress(page, column, xEnd - 1);
+				if (result == DisplayRet::BusRetry)
+					continue; // the driver opens the breaker when the retries are used up
+				if (result != DisplayRet::Success)
+					break;
+				addressed = true;
+			}
+			uint8_t length = _flushChunkSize;
+			if (length > xEnd - column)
+				length = xEnd - column;
+			result = flushWriteData(frame.subspan((page * _flushWidth) + column, length));
+			if (result == DisplayRet::BusRetry)
+			{
+				addressed = false;
+				continue;
+			}
+			if (result != DisplayRet::Success)
+				break;
+			column += length;
+		}
+	}
+	_flushAddressValid = false;
+	return result;
+}
+
+/*!
+	@brief Sends a rectangle of the drivers screen buffer to the display, blocking.
+	@param rect the rectangle, buffer co-ordinates, e.g. getDirtyRect of a widget
+	@return as updateRegion(x, y, w, h), Success if the rectangle is empty
+*/
+DisplayRet::Ret_Codes_e displaylib_flush::updateRegion(const flush_rect_t &rect)
+{
+	return updateRegion(rect.x, rect.y, rect.w, rect.h);
+}
+
+/*!
+	@brief Smallest rectangle holding two rectangles
+	@param a first rectangle, may be empty
+	@param b second rectangle, may be empty
+	@return the rectangle holding both, the other one if one is empty
+*/
+displaylib_flush::flush_rect_t displaylib_flush::rectMerge(const flush_rect_t &a, const flush_rect_t &b)
+{
+	if (a.w <= 0 || a.h <= 0)
+		return b;
+	if (b.w <= 0 || b.h <= 0)
+		return a;
+	const int16_t left = std::min(a.x, b.x);
+	const int16_t top = std::min(a.y, b.y);
+	const int16_t right = std::max<int16_t>(a.x + a.w, b.x + b.w);
+	const int16_t bottom = std::max<int16_t>(a.y + a.h, b.y + b.h);
+	return flush_rect_t{left, top, static_cast<int16_t>(right - left), static_cast<int16_t>(bottom - top)};
+}
+
+/*!
+	@brief Is a flush in progress
+	@return true if updateBegin was called and the frame is not complete
+*/
+bool displaylib_flush::updateBusy(void) const
+{
+	return _flushActive;
+}
+
+/*!
+	@brief Progress of the flush in progress
+	@return percentage of the frame or rectangle sent 0-100, 100 when idle
+*/
+uint8_t displaylib_flush::updateProgress(void) const
+{
+	if (!_flushActive)
+		return 100;
+	return static_cast<uint8_t>((_flushSent * 100U) / _flushTotal);
+}
+
+/*!
+	@brief Number of bytes of the current frame sent so far
+	@return bytes sent
+*/
+uint16_t displaylib_flush::updateBytesSent(void) const
+{
+	return _flushSent;
+}
+
+/*!
+	@brief Number of bytes in a frame
+	@return width * (height/8)
+*/
+uint16_t displaylib_flush::updateBytesTotal(void) const
+{
+	return _flushWidth * _flushPages;
+}
+
+/*!
+	@brief The whole frame as a rectangle
+	@return 0, 0, width, pages * 8
+*/
+displaylib_flush::flush_rect_t displaylib_flush::updateFrameRect(void) const
+{
+	return flush_rect_t{0, 0, _flushWidth, static_cast<int16_t>(_flushPages * 8)};
+}
+
+/*!
+	@brief Gets the number of bytes sent per chunk by updateStep
+	@return chunk size in bytes
+*/
+uint8_t displaylib_flush::getUpdateChunkSize(void) const
+{
+	return _flushChunkSize;
+}
+
+/*!
+	@brief Sets the number of bytes sent per chunk by updateStep
+	@param chunkSize 1 to UPDATE_CHUNK_MAX, default UPDATE_CHUNK_DEFAULT
+	@note Smaller chunks give a finer time budget at a cost of more bus overhead.
+*/
+void displaylib_flush::setUpdateChunkSize(uint8_t chunkSize)
+{
+	if (chunkSize == 0 || chunkSize > UPDATE_CHUNK_MAX)
+	{
+		displaylib_diag::warning(displaylib_diag::FuncSetUpdateChunkSize, DisplayRet::GenericError, chunkSize, UPDATE_CHUNK_DEFAULT);
+		chunkSize = UPDATE_CHUNK_DEFAULT;
+	}
+	_flushChunkSize = chunkSize;
+}
+
+/*!
+	@brief Sends a whole frame started by updateBegin, blocking.
+	@return Success or the bus error code returned by the driver
+	@note Used by the drivers update methods
+*/
+DisplayRet::Ret_Codes_e displaylib_flush::updateComplete(void)
+{
+	flush_state_e state;
+	do
+	{
+		state = updateStep(0); // only busy while waiting for power up
+	} while (state == FlushBusy);
+	if (state == FlushError)
+		return _flushResult;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Tells the flush that the display RAM write pointer was moved,
+		by a direct write to the display. The next chunk is re-addressed.
+	@note Called by the drivers methods that write to display RAM directly.
+*/
+void displaylib_flush::flushAddressLost(void)
+{
+	_flushAddressValid = false;
+}
+
+/*!
+	@brief Is the display ready, runs the stages of the power up sequence
+		started by the drivers async begin/init method as their waits expire.
+	@return true when the power up sequence is finished, or none was started
+	@note Poll while doing other boot work. Updates may be started before it
+		returns true, they are sent as soon as display RAM can be written.
+*/
+bool displaylib_flush::isReady(void)
+{
+	while (_bootActive && time_us_64() >= _bootDeadlineUs)
+	{
+		const uint32_t waitUs = bootStage(_bootStage++);
+		if (waitUs == BOOT_DONE)
+		{
+			_bootActive = false;
+			_bootRamReady = true;
+		}
+		else
+		{
+			_bootDeadlineUs = time_us_64() + waitUs;
+		}
+	}
+	return !_bootActive;
+}
+
+/*!
+	@brief Starts the drivers power up sequence, runs the stages due now
+	@note Called by the drivers async begin/init method.
+*/
+void displaylib_flush::bootBegin(void)
+{
+	_bootActive = true;
+	_bootRamReady = false;
+	_bootStage = 0;
+	_bootDeadlineUs = time_us_64();
+	isReady();
+}
+
+/*!
+	@brief Waits until the power up sequence is finished, blocking
+	@note Called by the drivers blocking begin/init method.
+*/
+void displaylib_flush::bootComplete(void)
+{
+	while (!isReady())
+	{
+		const uint64_t nowUs = time_us_64();
+		if (_bootDeadlineUs > nowUs)
+			busy_wait_us(_bootDeadlineUs - nowUs);
+	}
+}
+
+/*!
+	@brief Called by a boot stage once the init commands are sent and
+		display RAM can be written, while later stages still wait.
+*/
+void displaylib_flush::bootRamReady(void)
+{
+	_bootRamReady = true;
+}
+
+/*!
+	@brief Runs one stage of the drivers power up sequence
+	@param stage stage number, 0 first
+	@return wait in uS before the next stage, or BOOT_DONE
+	@note Default has no stages, drivers override this.
+*/
+uint32_t displaylib_flush::bootStage(uint8_t stage)
+{
+	(void)stage;
+	return BOOT_DONE;
+}
+
+/*!
+	@brief Sets the display RAM line shown at the top of the screen, hardware scroll
+	@param line RAM line 0 to (flushRamPages() * 8) - 1
+	@return GenericError by default, drivers with a start line register override this
+*/
+DisplayRet::Ret_Codes_e displaylib_flush::flushStartLine(uint8_t line)
+{
+	displaylib_diag::error(displaylib_diag::FuncFlushStartLine, DisplayRet::GenericError, line);
+	return DisplayRet::GenericError;
+}
+
+/*!
+	@brief Number of pages in the display RAM, can be more than are shown on screen
+	@return pages, by default the pages of the screen
+*/
+uint8_t displaylib_flush::flushRamPages(void)
+{
+	return _flushPages;
+}
+
+#ifdef _BUS_STATS_ENABLE
+/*!
+	@brief Gets the bus counters of the display
+	@return reference to the counters
+	@note Switch off by commenting out _BUS_STATS_ENABLE in display_flush.hpp.
+		Frame time is the bus time of OLEDupdate/LCDupdate or of the updateStep
+		calls of one frame, not the time between updateBegin and the last step.
+*/
+const displaylib_flush::bus_stats_t &displaylib_flush::getBusStats(void) const
+{
+	return _busStats;
+}
+
+/*!
+	@brief Zeros the bus counters of the display
+*/
+void displaylib_flush::resetBusStats(void)
+{
+	_busStats = bus_stats_t{};
+}
+
+/*!
+	@brief Counts a bus write, called by the driver for each write attempt
+	@param returnCode bytes written, or the pico SDK error code PICO_ERROR_TIMEOUT
+		or PICO_ERROR_GENERIC (not acknowledged)
+	@param data the bytes of the write, including the I2C control byte
+*/
+void displaylib_flush::statsBusWrite(int returnCode, std::span<const uint8_t> data)
+{
+	traceRecord((returnCode < 0) ? TraceWriteFailed : TraceWrite, data.size());
+	captureRecord(returnCode, data);
+	_busStats.transactions++;
+	if (returnCode == PICO_ERROR_TIMEOUT)
+		_busStats.timeouts++;
+	else if (returnCode < 0)
+		_busStats.nacks++;
+	else
+		_busStats.bytes += data.size();
+}
+
+/*!
+	@brief Counts a frame and adds its bus time to the histogram
+	@param frameUs bus time of the frame, uS
+*/
+void displaylib_flush::statsFrame(uint32_t frameUs)
+{
+	traceRecord(TraceFrame, 0);
+	_busStats.frames++;
+	_busStats.frameTotalUs += frameUs;
+	if (frameUs > _busStats.frameMaxUs)
+		_busStats.frameMaxUs = frameUs;
+	uint8_t bin = 0;
+	while ((frameUs >>= 1) != 0 && bin < BUS_STATS_BINS - 1)
+		bin++;
+	_busStats.frameHistogram[bin]++;
+}
+#endif
+
+#ifdef _BUS_TRACE_ENABLE
+/*!
+	@brief Starts recording bus writes, DC/CS toggles and frame ends
+	@param records buffer supplied by the user, 8 bytes a record, recording
+		stops when it is full, e.g. 1024 records hold about 4 SSD1306 frames
+		at the default chunk size
+	@note Switch on by uncommenting _BUS_TRACE_ENABLE in display_flush.hpp.
+		Writes made before begin, e.g. the init, are only traced if started first.
+*/
+void displaylib_flush::busTraceStart(std::span<bus_trace_t> records)
+{
+	_traceRecords = records;
+	_traceCount = 0;
+	_traceDropped = 0;
+	_traceActive = !records.empty();
+}
+
+/*!
+	@brief Stops recording, the records stay in the buffer for busTraceDump
+*/
+void displaylib_flush::busTraceStop(void)
+{
+	_traceActive = false;
+}
+
+/*!
+	@brief Number of records in the trace buffer
+	@return records
+*/
+uint32_t displaylib_flush::getBusTraceCount(void) const
+{
+	return _traceCount;
+}
+
+/*!
+	@brief Number of records lost because the trace buffer was full
+	@return records
+*/
+uint32_t displaylib_flush::getBusTraceDropped(void) const
+{
+	return _traceDropped;
+}
+
+/*!
+	@brief Prints the trace with printf, for extra/tools/displaylib_buscost.py
+	@details One line a record, time_us,event,value, event is W write, F failed
+		write, D DC line, C CS line, R frame end. Save the output to a file on
+		the host, e.g. with the serial monitor log.
+*/
+void displaylib_flush::busTraceDump(void)
+{
+	static constexpr char eventNames[] = {'W', 'F', 'D', 'C', 'R'};
+	printf("# displaylib bus trace v1, %lu records, %lu dropped\r\n",
+		static_cast<unsigned long>(_traceCount), static_cast<unsigned long>(_traceDropped));
+	for (uint32_t index = 0; index < _traceCount; index++)
+	{
+		const bus_trace_t &record = _traceRecords[index];
+		printf("%lu,%c,%u\r\n", static_cast<unsigned long>(record.timeUs),
+			(record.event < sizeof(eventNames)) ? eventNames[record.event] : '?', record.value);
+	}
+	printf("# end\r\n");
+}
+
+/*!
+	@brief Adds a record to the bus trace if recording
+	@param event the event
+	@param value bytes written or line level
+*/
+void displaylib_flush::traceRecord(trace_event_e event, size_t value)
+{
+	if (!_traceActive)
+		return;
+	if (_traceCount >= _traceRecords.size())
+	{
+		_traceDropped++;
+		return;
+	}
+	bus_trace_t &record = _traceRecords[_traceCount++];
+	record.timeUs = time_us_32();
+	record.value = static_cast<uint16_t>(value);
+	record.event = event;
+}
+#endif
+
+#ifdef _BUS_CAPTURE_ENABLE
+/*!
+	@brief Starts capturing the bytes of every bus write
+	@param buffer buffer supplied by the user, each write takes BUS_CAPTURE_HEADER
+		bytes plus its data, e.g. 8K holds about 6 SSD1306 frames at the
+		default chunk size. Recording stops at the first write that does not fit.
+	@note Switch on by uncommenting _BUS_CAPTURE_ENABLE in display_flush.hpp.
+		Start before begin to capture the init, the decoder needs it to know
+		the addressing mode and panel setup.
+*/
+void displaylib_flush::busCaptureStart(std::span<uint8_t> buffer)
+{
+	_captureBuffer = buffer;
+	_captureUsed = 0;
+	_captureWrites = 0;
+	_captureDropped = 0;
+	_captureFull = false;
+	_captureActive = !buffer.empty();
+}
+
+/*!
+	@brief Stops capturing, the writes stay in the buffer for busCaptureDump
+*/
+void displaylib_flush::busCaptureStop(void)
+{
+	_captureActive = false;
+}
+
+/*!
+	@brief Number of writes in the capture buffer
+	@return writes
+*/
+uint32_t displaylib_flush::getBusCaptureWrites(void) const
+{
+	return _captureWrites;
+}
+
+/*!
+	@brief Number of writes lost because the capture buffer was full
+	@return writes
+*/
+uint32_t displaylib_flush::getBusCaptureDropped(void) const
+{
+	return _captureDropped;
+}
+
+/*!
+	@brief Prints the capture with printf, for extra/tools/displaylib_capture.py
+	@details One line a write, time_us,context,hex bytes. Context is C SPI
+		command (DC low), D SPI data (DC high), I I2C with the control byte
+		first, lower case if the write failed. The time is taken at the end
+		of the write. Save the output to a file on the host.
+*/
+void displaylib_flush::busCaptureDump(void)
+{
+	printf("# displaylib bus capture v1, %lu writes, %lu dropped\r\n",
+		static_cast<unsigned long>(_captureWrites), static_cast<unsigned long>(_captureDropped));
+	uint32_t offset = 0;
+	for (uint32_t write = 0; write < _captureWrites; write++)
+	{
+		const uint8_t *entry = _captureBuffer.data() + offset;
+		uint32_t timeUs = 0;
+		uint16_t length = 0;
+		std::memcpy(&timeUs, entry, sizeof(timeUs));
+		std::memcpy(&length, entry + 4, sizeof(length));
+		printf("%lu,%c,", static_cast<unsigned long>(timeUs), static_cast<char>(entry[6]));
+		for (uint16_t index = 0; index < length; index++)
+			printf("%02X", entry[BUS_CAPTURE_HEADER + index]);
+		printf("\r\n");
+		offset += BUS_CAPTURE_HEADER + length;
+	}
+	printf("# end\r\n");
+}
+
+/*!
+	@brief Adds a write to the capture if recording
+	@param returnCode bytes written or a pico SDK error code
+	@param data the bytes of the write
+	@details Entry layout, time_us_32 (4 bytes), length (2 bytes), context (1 byte), data.
+*/
+void displaylib_flush::captureRecord(int returnCode, std::span<const uint8_t> data)
+{
+	if (!_captureActive)
+		return;
+	if (_captureFull || data.size() > 0xFFFF ||
+		_captureUsed + BUS_CAPTURE_HEADER + data.size() > _captureBuffer.size())
+	{
+		_captureFull = true;
+		_captureDropped++;
+		return;
+	}
+	char context = 'I';
+	if (_captureDC >= 0)
+		context = _captureDC ? 'D' : 'C';
+	if (returnCode < 0)
+		context = static_cast<char>(context - 'A' + 'a');
+	const uint32_t timeUs = time_us_32();
+	const uint16_t length = static_cast<uint16_t>(data.size());
+	uint8_t *entry = _captureBuffer.data() + _captureUsed;
+	std::memcpy(entry, &timeUs, sizeof(timeUs));
+	std::memcpy(entry + 4, &length, sizeof(length));
+	entry[6] = static_cast<uint8_t>(context);
+	std::copy(data.begin(), data.end(), entry + BUS_CAPTURE_HEADER);
+	_captureUsed += BUS_CAPTURE_HEADER + length;
+	_captureWrites++;
+}
+#endif
@@ -5,6 +5,7 @@
 */
 
 #include "../../include/displaylib/display_fonts.hpp"
+#include "../../include/displaylib/display_diag.hpp"
 
 /*! 
     Standard ASCII 6x8 font 
@@ -1063,29 +1064,276 @@ displaylib_fonts::displaylib_fonts(){};
 	@return	Will return
 		-# Success
 		-# FontDataEmpty
-		-# FontDataTooSmall
+		-# FontDataTooSmall, also a remapped font with a bad header or missing data
+	@note The fallback set by setFontFallback is kept with its font, selecting
+		another font and then this one again, as the widgets do, restores it.
  */
 DisplayRet::Ret_Codes_e displaylib_fonts::setFont(std::span<const uint8_t> SelectedFontName) {
+	const DisplayRet::Ret_Codes_e result = selectFont(SelectedFontName);
+	if (result == DisplayRet::Success && _FontFallbackFont != nullptr && SelectedFontName.data() == _FontFallbackFont)
+		_FontFallback = (_FontFallbackCode == 0) ? -1 : fontGlyphLookup(_FontFallbackCode);
+	return result;
+}
+
+/*!
+	@brief Selects a font with its own fallback, for setFont
+	@param  SelectedFontName the font
+	@return Success, FontDataEmpty or FontDataTooSmall
+ */
+DisplayRet::Ret_Codes_e displaylib_fonts::selectFont(std::span<const uint8_t> SelectedFontName) {
 	if (SelectedFontName.empty())
 	{
-		printf("displaylib_fonts::setFont Error: Font data is empty\n");
+		displaylib_diag::error(displaylib_diag::FuncSetFont, DisplayRet::FontDataEmpty);
 		return DisplayRet::FontDataEmpty;
 	}
 
 	if (SelectedFontName.size() < 5) {  // Ensure the font data has at least 4 bytes
-		printf("displaylib_fonts::setFont Error: Font data too small\n");
+		displaylib_diag::error(displaylib_diag::FuncSetFont, DisplayRet::FontDataTooSmall, static_cast<int16_t>(SelectedFontName.size()));
 		return DisplayRet::FontDataTooSmall;
 	}
 
+	if (SelectedFontName[0] == 0 && SelectedFontName.size() >= 4 && (SelectedFontName[3] & FONT_FLAG_RANGES))
+		return setFontRanges(SelectedFontName);
+	if (SelectedFontName[0] == 0) // remapped font
+	{
+		const std::span<const uint8_t> font = SelectedFontName;
+		const uint16_t indexSize = (font.size() >= FONT_REMAP_HEADER_SIZE) ? (font[5] - font[4] + 1) : 0;
+		const uint16_t widthSize = (font.size() >= FONT_REMAP_HEADER_SIZE && (font[3] & FONT_FLAG_PROPORTIONAL)) ? font[6] : 0;
+		if (font.size() < FONT_REMAP_HEADER_SIZE || font[1] == 0 || font[2] == 0 || (font[2] % 8) != 0 ||
+			font[5] < font[4] || font[6] == 0 || font[6] == FONT_GLYPH_NONE ||
+			font.size() < FONT_REMAP_HEADER_SIZE + indexSize + widthSize + (static_cast<size_t>(font[6]) * font[1] * (font[2] / 8)))
+		{
+			displaylib_diag::error(displaylib_diag::FuncSetFont, DisplayRet::FontDataTooSmall, static_cast<int16_t>(font.size()));
+			return DisplayRet::FontDataTooSmall;
+		}
+		_FontSelect = font;
+		_Font_X_Size = font[1];
+		_Font_Y_Size = font[2];
+		_FontOffset = font[4];
+		_FontNumChars = font[5] - font[4];
+		_FontRemapped = true;
+		_FontProportional = (widthSize != 0);
+		_FontRangeCount = 0;
+		_FontGlyphCount = font[6];
+		_FontGlyphBytes = _Font_X_Size * (_Font_Y_Size / 8);
+		_FontFallback = -1;
+		_FontWidthStart = FONT_REMAP_HEADER_SIZE + indexSize;
+		_FontGlyphStart = _FontWidthStart + widthSize;
+		_FontInverted = false;
+		return DisplayRet::Success;
+	}
+
 	_FontSelect   = SelectedFontName;
 	_Font_X_Size  = SelectedFontName[0];
 	_Font_Y_Size  = SelectedFontName[1];
 	_FontOffset   = SelectedFontName[2];
 	_FontNumChars = SelectedFontName[3];
+	_FontRemapped = false;
+	_FontProportional = false;
+	_FontRangeCount = 0;
+	_FontGlyphBytes = (_Font_Y_Size % 8 == 0) ? (_Font_X_Size * (_Font_Y_Size / 8)) : ((_Font_X_Size * _Font_Y_Size) / 8);
+	_FontFallback = -1;
+	_FontGlyphStart = 4;
+	_FontGlyphCount = (_FontGlyphBytes == 0) ? 0 : (SelectedFontName.size() - 4) / _FontGlyphBytes;
+	if (_FontGlyphCount > _FontNumChars + 1U)
+		_FontGlyphCount = _FontNumChars + 1U;
 	_FontInverted = false;
 	return DisplayRet::Success;
 }
 
+/*!
+	@brief Reads a little endian 16 bit number from font data
+	@param font the font
+	@param index index of the low byte
+	@return the number
+*/
+static inline uint16_t fontRead16(std::span<const uint8_t> font, uint32_t index)
+{
+	return static_cast<uint16_t>(font[index] | (font[index + 1] << 8));
+}
+
+/*!
+	@brief Reads a little endian 32 bit number from font data
+	@param font the font
+	@param index index of the low byte
+	@return the number
+*/
+static inline uint32_t fontRead32(std::span<const uint8_t> font, uint32_t index)
+{
+	return fontRead16(font, index) | (static_cast<uint32_t>(fontRead16(font, index + 2)) << 16);
+}
+
+/*!
+	@brief Selects a range font, checks the header and every range once so lookups need not
+	@param font the font, flags FONT_FLAG_RANGES
+	@return Success or FontDataTooSmall
+*/
+DisplayRet::Ret_Codes_e displaylib_fonts::setFontRanges(std::span<const uint8_t> font)
+{
+	bool valid = (font.size() >= FONT_RANGE_HEADER_SIZE) && font[1] != 0 && font[2] != 0 && (font[2] % 8) == 0;
+	const uint16_t glyphs = valid ? fontRead16(font, 4) : 0;
+	const uint16_t fallback = valid ? fontRead16(font, 6) : 0;
+	const uint16_t ranges = valid ? fontRead16(font, 8) : 0;
+	const uint32_t widthStart = FONT_RANGE_HEADER_SIZE + (static_cast<uint32_t>(ranges) * FONT_RANGE_ENTRY_SIZE);
+	const uint32_t widthSize = (font[3] & FONT_FLAG_PROPORTIONAL) ? glyphs : 0;
+	valid = valid && glyphs != 0 && glyphs <= INT16_MAX && ranges != 0 && (fallback < glyphs || fallback == 0xFFFF) &&
+		font.size() >= widthStart + widthSize + (static_cast<size_t>(glyphs) * font[1] * (font[2] / 8));
+	uint32_t lastCode = 0;
+	for (uint16_t range = 0; valid && range < ranges; range++)
+	{
+		const uint32_t entry = FONT_RANGE_HEADER_SIZE + (static_cast<uint32_t>(range) * FONT_RANGE_ENTRY_SIZE);
+		const uint32_t first = fontRead32(font, entry);
+		const uint16_t count = fontRead16(font, entry + 4);
+		valid = count != 0 && first <= 0x10FFFF && (range == 0 || first >= lastCode) &&
+			static_cast<uint32_t>(fontRead16(font, entry + 6)) + count <= glyphs;
+		lastCode = first + count;
+	}
+	if (!valid)
+	{
+		displaylib_diag::error(displaylib_diag::FuncSetFont, DisplayRet::FontDataTooSmall, static_cast<int16_t>(font.size()));
+		return DisplayRet::FontDataTooSmall;
+	}
+	_FontSelect = font;
+	_Font_X_Size = font[1];
+	_Font_Y_Size = font[2];
+	_FontOffset = 0;
+	_FontNumChars = 0xFF;
+	_FontRemapped = true;
+	_FontProportional = (widthSize != 0);
+	_FontRangeCount = ranges;
+	_FontGlyphCount = glyphs;
+	_FontGlyphBytes = _Font_X_Size * (_Font_Y_Size / 8);
+	_FontFallback = (fallback == 0xFFFF) ? -1 : static_cast<int16_t>(fallback);
+	_FontWidthStart = widthStart;
+	_FontGlyphStart = widthStart + widthSize;
+	_FontInverted = false;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Finds the glyph of a character in the active font, without the fallback
+	@param codePoint the character, Unicode, 0x80-0xFF is Latin-1
+	@return glyph number, or -1 if the character is not in the font
+	@details Constant time for built in and remapped fonts, which count from
+		their offset or read their index table. A range font is a binary search
+		of its range table, a few steps for a few scripts.
+*/
+int16_t displaylib_fonts::fontGlyphLookup(char32_t codePoint) const
+{
+	if (_FontRangeCount > 0)
+	{
+		uint16_t low = 0;
+		uint16_t high = _FontRangeCount;
+		while (low < high)
+		{
+			const uint16_t middle = (low + high) / 2;
+			const uint32_t entry = FONT_RANGE_HEADER_SIZE + (static_cast<uint32_t>(middle) * FONT_RANGE_ENTRY_SIZE);
+			const uint32_t first = fontRead32(_FontSelect, entry);
+			if (codePoint < first)
+				high = middle;
+			else if (codePoint >= first + fontRead16(_FontSelect, entry + 4))
+				low = middle + 1;
+			else
+				return static_cast<int16_t>(fontRead16(_FontSelect, entry + 6) + (codePoint - first));
+		}
+		return -1;
+	}
+	if (codePoint < _FontOffset || codePoint > static_cast<char32_t>(_FontOffset + _FontNumChars))
+		return -1;
+	const uint16_t offset = codePoint - _FontOffset;
+	const uint16_t glyph = _FontRemapped ? _FontSelect[FONT_REMAP_HEADER_SIZE + offset] : offset;
+	return (glyph < _FontGlyphCount) ? static_cast<int16_t>(glyph) : -1;
+}
+
+/*!
+	@brief Finds the glyph of a character in the active font
+	@param codePoint the character, Unicode, 0x80-0xFF is Latin-1
+	@return glyph number, the fallback glyph if the character is not in the font,
+		or -1 if there is no fallback
+*/
+int16_t displaylib_fonts::fontGlyph(char32_t codePoint) const
+{
+	const int16_t glyph = fontGlyphLookup(codePoint);
+	return (glyph < 0) ? _FontFallback : glyph;
+}
+
+/*!
+	@brief Index of the first byte of a glyph in the font data
+	@param glyph glyph number from fontGlyph
+	@return index
+*/
+uint32_t displaylib_fonts::fontGlyphIndex(uint16_t glyph) const
+{
+	return _FontGlyphStart + (static_cast<uint32_t>(glyph) * _FontGlyphBytes);
+}
+
+/*!
+	@brief Width of a glyph, also the cursor advance
+	@param glyph glyph number from fontGlyph
+	@return columns, x size unless the font is proportional
+*/
+uint8_t displaylib_fonts::fontGlyphWidth(uint16_t glyph) const
+{
+	if (!_FontProportional)
+		return _Font_X_Size;
+	const uint8_t width = _FontSelect[_FontWidthStart + glyph];
+	return (width < _Font_X_Size) ? width : _Font_X_Size;
+}
+
+/*!
+	@brief Width of a character in the active font, for measuring proportional text
+	@param value the character, 0x80-0xFF is Latin-1
+	@return columns before text scale, 0 if the character is not in the font
+		and there is no fallback
+*/
+uint8_t displaylib_fonts::getCharWidth(char value) const
+{
+	return getCodePointWidth(static_cast<uint8_t>(value));
+}
+
+/*!
+	@brief Width of a Unicode character in the active font
+	@param codePoint the character
+	@return columns before text scale, 0 if the character is not in the font
+		and there is no fallback
+*/
+uint8_t displaylib_fonts::getCodePointWidth(char32_t codePoint) const
+{
+	const int16_t glyph = fontGlyph(codePoint);
+	return (glyph < 0) ? 0 : fontGlyphWidth(glyph);
+}
+
+/*!
+	@brief Sets the character drawn in place of characters the active font does not hold
+	@param codePoint a character in the font, 0 for none, errors are then reported
+	@return Success, or CharFontASCIIRange if the font does not hold it
+	@note Another font has its own fallback, range fonts can carry one. The
+		fallback is remembered for the active font, setFont with this font again
+		restores it.
+*/
+DisplayRet::Ret_Codes_e displaylib_fonts::setFontFallback(char32_t codePoint)
+{
+	const int16_t glyph = (codePoint == 0) ? -1 : fontGlyphLookup(codePoint);
+	if (codePoint != 0 && glyph < 0)
+	{
+		displaylib_diag::error(displaylib_diag::FuncSetFont, DisplayRet::CharFontASCIIRange, static_cast<int16_t>(codePoint));
+		return DisplayRet::CharFontASCIIRange;
+	}
+	_FontFallback = glyph;
+	_FontFallbackFont = _FontSelect.data();
+	_FontFallbackCode = codePoint;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Gets the active font
+	@return span of the font data set by setFont
+*/
+std::span<const uint8_t> displaylib_fonts::getFont(void) const
+{
+	return _FontSelect;
+}
+
 /*!
 	@brief setInvertFont
 	@param invertStatus set the invert status flag of font ,false = off. 
@@ -4,9 +4,11 @@
    @author  Gavin Lyons
 */
 
+#include <algorithm>
 #include "../../include/displaylib/display_graphics.hpp"
 #include "../../include/displaylib/display_fonts.hpp"
 #include "../../include/displaylib/ssd1306.hpp"
+#include "../../include/displaylib/display_diag.hpp"
 
 // === Graphics class implementation ===
 
@@ -28,7 +30,7 @@ displaylib_graphics::displaylib_graphics(int16_t w, int16_t h) : WIDTH(w), HEIGH
 	@brief Write 1 character on OLED.
 	@param  x character starting position on x-axis.
 	@param  y character starting position on x-axis.
-	@param  value Character to be written.
+	@param  value Character to be written, 0x80-0xFF is Latin-1
 	@return Will return
 		-# Success
 		-# CharScreenBounds co-ords out of bounds check x and y
@@ -36,7 +38,23 @@ displaylib_graphics::displaylib_graphics(int16_t w, int16_t h) : WIDTH(w), HEIGH
  */
 DisplayRet::Ret_Codes_e displaylib_graphics::writeChar(int16_t x, int16_t y, char value)
 {
-	uint16_t fontIndex = 0;
+	return writeCodePoint(x, y, static_cast<uint8_t>(value));
+}
+
+/*!
+	@brief Write 1 Unicode character on OLED.
+	@param  x character starting position on x-axis.
+	@param  y character starting position on x-axis.
+	@param  codePoint Character to be written
+	@return Will return
+		-# Success
+		-# CharScreenBounds co-ords out of bounds check x and y
+		-# CharFontASCIIRange Character not in the font and the font has no fallback,
+			see setFontFallback
+ */
+DisplayRet::Ret_Codes_e displaylib_graphics::writeCodePoint(int16_t x, int16_t y, char32_t codePoint)
+{
+	uint32_t fontIndex = 0;
 	uint16_t rowCount = 0;
 	uint16_t count = 0;
 	uint8_t colIndex;
@@ -47,24 +65,28 @@ DisplayRet::Ret_Codes_e displaylib_graphics::writeChar(int16_t x, int16_t y, cha
 	// 1. Check for screen out of  bounds
 	if ((x >= _width) ||				// Clip right
 		(y >= _height) ||				// Clip bottom
-		((x + _Font_X_Size + 1) < 0) || // Clip left
-		((y + _Font_Y_Size) < 0))		// Clip top
+		((x + (_Font_X_Size * _textScaleX) + 1) < 0) || // Clip left
+		((y + (_Font_Y_Size * _textScaleY)) < 0))		// Clip top
 	{
-		printf("displaylib_graphics::writeChar Error 2: Co-ordinates out of bounds \r\n");
+		displaylib_diag::error(displaylib_diag::FuncWriteChar, DisplayRet::CharScreenBounds, x, y);
 		return DisplayRet::CharScreenBounds;
 	}
 	// 2. Check for character out of font range bounds
-	if (value < _FontOffset || value >= (_FontOffset + _FontNumChars + 1))
+	const int16_t glyph = fontGlyph(codePoint);
+	if (glyph < 0)
 	{
-		printf("displaylib_graphics::writeChar Error 3: Character out of Font bounds  %c : %u<->%u \r\n", value, _FontOffset, _FontOffset + _FontNumChars);
+		displaylib_diag::error(displaylib_diag::FuncWriteChar, DisplayRet::CharFontASCIIRange, static_cast<int16_t>(codePoint), _FontOffset);
 		return DisplayRet::CharFontASCIIRange;
 	}
+	if (_textScaleX > 1 || _textScaleY > 1)
+		return writeCharScaled(x, y, glyph);
+	fontIndex = fontGlyphIndex(glyph);
 	if (_Font_Y_Size % 8 == 0) // Is the font height divisible by 8
 	{
-		fontIndex = ((value - _FontOffset) * (_Font_X_Size * (_Font_Y_Size / 8))) + 4;
+		const uint8_t glyphWidth = fontGlyphWidth(glyph);
 		for (rowCount = 0; rowCount < (_Font_Y_Size / 8); rowCount++)
 		{
-			for (count = 0; count < _Font_X_Size; count++)
+			for (count = 0; count < glyphWidth; count++)
 			{
 				// temp = *(_FontSelect + fontIndex + count + (rowCount * _Font_X_Size));
 				temp = _FontSelect[fontIndex + count + (rowCount * _Font_X_Size)];
@@ -84,7 +106,6 @@ DisplayRet::Ret_Codes_e displaylib_graphics::writeChar(int16_t x, int16_t y, cha
 	}
 	else
 	{
-		fontIndex = ((value - _FontOffset) * ((_Font_X_Size * _Font_Y_Size) / 8)) + 4;
 		colByte = _FontSelect[fontIndex];
 		colbit = 7;
 		for (cx = 0; cx < _Font_X_Size; cx++)
@@ -112,11 +133,161 @@ DisplayRet::Ret_Codes_e displaylib_graphics::writeChar(int16_t x, int16_t y, cha
 	return DisplayRet::Success;
 }
 
+/*!
+	@brief Nibble to scaled bits lookup table, each of the 4 bits repeated scale times
+	@param scale the scale factor, 2 to 4
+	@return the table
+*/
+static constexpr std::array<uint16_t, 16> textScaleTable(uint8_t scale)
+{
+	std::array<uint16_t, 16> table{};
+	for (uint8_t nibble = 0; nibble < 16; nibble++)
+		for (uint8_t bit = 0; bit < 4; bit++)
+			if (nibble & (1 << bit))
+				table[nibble] |= ((1 << scale) - 1) << (bit * scale);
+	return table;
+}
+
+/*! Bit doubling, tripling and quadrupling tables for writeCharScaled, 96 bytes of flash */
+static constexpr std::array<std::array<uint16_t, 16>, 3> TEXT_SCALE_TABLES =
+	{textScaleTable(2), textScaleTable(3), textScaleTable(4)};
+
+/*!
+	@brief writes a character scaled by setTextScale
+	@param  x character starting position on x-axis.
+	@param  y character starting position on y-axis.
+	@param  glyph glyph of the character, from fontGlyph
+	@return Success
+	@details Each 8 pixel piece of a font column is expanded by _textScaleY with
+		two table lookups and written to the buffer as whole bytes, repeated
+		_textScaleX times. If the driver gives no buffer, or the display is rotated,
+		the expanded column is drawn with drawPixel.
+*/
+DisplayRet::Ret_Codes_e displaylib_graphics::writeCharScaled(int16_t x, int16_t y, uint16_t glyph)
+{
+	std::span<uint8_t> buffer;
+	if (getRotation() == rDegrees_0)
+		buffer = graphicsBuffer();
+	if (buffer.size() < static_cast<size_t>(WIDTH * ((HEIGHT + 7) / 8)))
+		buffer = {};
+	const bool pageFont = (_Font_Y_Size % 8 == 0); // column bytes, else a bit stream
+	const uint8_t pieces = (_Font_Y_Size + 7) / 8;
+	const uint32_t fontIndex = fontGlyphIndex(glyph);
+	const uint8_t glyphWidth = pageFont ? fontGlyphWidth(glyph) : _Font_X_Size;
+	uint16_t streamBit = 0;
+	for (uint8_t col = 0; col < glyphWidth; col++)
+	{
+		for (uint8_t piece = 0; piece < pieces; piece++)
+		{
+			const uint8_t rows = ((_Font_Y_Size - (piece * 8)) < 8) ? (_Font_Y_Size - (piece * 8)) : 8;
+			uint8_t bits = 0;
+			if (pageFont)
+			{
+				bits = _FontSelect[fontIndex + col + (piece * _Font_X_Size)];
+			} else
+			{
+				for (uint8_t row = 0; row < rows; row++, streamBit++)
+					if (_FontSelect[fontIndex + (streamBit / 8)] & (0x80 >> (streamBit % 8)))
+						bits |= (1 << row);
+			}
+			uint32_t expanded = bits;
+			if (_textScaleY > 1)
+			{
+				const std::array<uint16_t, 16> &table = TEXT_SCALE_TABLES[_textScaleY - 2];
+				expanded = table[bits & 0x0F] | (static_cast<uint32_t>(table[bits >> 4]) << (4 * _textScaleY));
+			}
+			for (uint8_t repeat = 0; repeat < _textScaleX; repeat++)
+				writeColumnBits(x + (col * _textScaleX) + repeat, y + (piece * 8 * _textScaleY),
+					expanded, rows * _textScaleY, buffer);
+		}
+	}
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Writes a run of pixels down one column, font colours
+	@param x column
+	@param y top pixel
+	@param bits the pixels, bit 0 at y, 1 foreground
+	@param count number of pixels, max 32
+	@param buffer screen buffer, page layout, empty to use drawPixel
+*/
+void displaylib_graphics::writeColumnBits(int16_t x, int16_t y, uint32_t bits, uint8_t count, std::span<uint8_t> buffer)
+{
+	if (x < 0 || x >= _width)
+		return;
+	const bool invert = getInvertFont();
+	if (buffer.empty())
+	{
+		for (uint8_t i = 0; i < count; i++)
+			drawPixel(x, y + i, ((bits >> i) & 1) ? !invert : invert);
+		return;
+	}
+	while (count > 0 && y < _height)
+	{
+		if (y < 0) // clip top
+		{
+			const uint8_t skip = (-y < count) ? -y : count;
+			bits = (skip >= 32) ? 0 : (bits >> skip);
+			y += skip;
+			count -= skip;
+			continue;
+		}
+		const uint8_t offset = y & 7;
+		uint8_t length = 8 - offset;
+		if (length > count)
+			length = count;
+		if (y + length > _height)
+			length = _height - y;
+		const uint8_t lengthMask = (1 << length) - 1;
+		const uint8_t mask = lengthMask << offset;
+		uint8_t value = (bits & lengthMask) << offset;
+		if (invert)
+			value = ~value & mask;
+		uint8_t &cell = buffer[((y >> 3) * WIDTH) + x];
+		cell = (cell & ~mask) | value;
+		bits >>= length;
+		y += length;
+		count -= length;
+	}
+}
+
+/*!
+	@brief Sets the text scale, characters are drawn scaled up from the current font
+	@param scaleX scale factor x-axis, 1 to TEXT_SCALE_MAX
+	@param scaleY scale factor y-axis, 1 to TEXT_SCALE_MAX
+	@note e.g. pFontDefault at 2,2 gives 12x16 characters, at 3,4 18x32.
+		Invalid values set 1.
+*/
+void displaylib_graphics::setTextScale(uint8_t scaleX, uint8_t scaleY)
+{
+	if (scaleX < 1 || scaleX > TEXT_SCALE_MAX || scaleY < 1 || scaleY > TEXT_SCALE_MAX)
+	{
+		displaylib_diag::warning(displaylib_diag::FuncSetTextScale, DisplayRet::GenericError, scaleX, scaleY);
+		scaleX = 1;
+		scaleY = 1;
+	}
+	_textScaleX = scaleX;
+	_textScaleY = scaleY;
+}
+
+/*!
+	@brief Gets the text scale factor x-axis
+	@return scale 1 to TEXT_SCALE_MAX
+*/
+uint8_t displaylib_graphics::getTextScaleX(void) const { return _textScaleX; }
+
+/*!
+	@brief Gets the text scale factor y-axis
+	@return scale 1 to TEXT_SCALE_MAX
+*/
+uint8_t displaylib_graphics::getTextScaleY(void) const { return _textScaleY; }
+
 /*!
 	@brief Write Text character array on OLED.
 	@param  x character starting position on x-axis.
 	@param  y character starting position on y-axis.
-	@param  pText Pointer to the array of the text to be written.
+	@param  pText Pointer to the array of the text to be written, UTF-8 if setTextUTF8 is on.
 	@return Will return
 		-# 0 Success
 		-# CharArrayNullptr  String pText Array invalid pointer object
@@ -124,7 +295,6 @@ DisplayRet::Ret_Codes_e displaylib_graphics::writeChar(int16_t x, int16_t y, cha
  */
 DisplayRet::Ret_Codes_e displaylib_graphics::writeCharString(int16_t x, int16_t y, char *pText)
 {
-	uint8_t count = 0;
 	uint8_t MaxLength = 0;
 	// Check for null pointer
 	if (pText == nullptr)
@@ -133,19 +303,22 @@ DisplayRet::Ret_Codes_e displaylib_graphics::writeCharString(int16_t x, int16_t
 		return DisplayRet::CharArrayNullptr;
 	}
 	DisplayRet::Ret_Codes_e DrawCharReturnCode;
-	while (*pText != '\0')
+	const std::string_view text(pText);
+	size_t pos = 0;
+	while (pos < text.size())
 	{
+		const char32_t codePoint = textDecode(text, pos);
+		const int16_t charWidth = getCodePointWidth(codePoint) * _textScaleX; // proportional fonts vary
 		// check if text has reached end of screen
-		if ((x + (count * _Font_X_Size)) > _width - _Font_X_Size)
+		if (x > _width - charWidth)
 		{
-			y = y + _Font_Y_Size;
+			y = y + (_Font_Y_Size * _textScaleY);
 			x = 0;
-			count = 0;
 		}
-		DrawCharReturnCode = writeChar(x + (count * (_Font_X_Size)), y, *pText++);
+		DrawCharReturnCode = writeCodePoint(x, y, codePoint);
 		if (DrawCharReturnCode != DisplayRet::Success)
 			return DrawCharReturnCode;
-		count++;
+		x += charWidth;
 		MaxLength++;
 		if (MaxLength >= 200)
 			break; // 2nd way out of loop, safety check
@@ -153,43 +326,163 @@ DisplayRet::Ret_Codes_e displaylib_graphics::writeCharString(int16_t x, int16_t
 	return DisplayRet::Success;
 }
 
+/*!
+	@brief Decodes one character of UTF-8 text
+	@param text the text
+	@param pos index of the character, returns the index of the next
+	@return the code point, a byte that does not start a valid sequence is
+		returned as itself, Latin-1. Overlong forms, surrogates and code points
+		above U+10FFFF are not valid.
+*/
+char32_t displaylib_graphics::decodeUTF8(std::string_view text, size_t &pos)
+{
+	static constexpr char32_t LEAST[5] = {0, 0, 0x80, 0x800, 0x10000}; // shortest form of each length
+	const uint8_t lead = static_cast<uint8_t>(text[pos++]);
+	const uint8_t length = (lead >= 0xF0 && lead <= 0xF4) ? 4 : (lead >= 0xE0 && lead <= 0xEF) ? 3 : (lead >= 0xC2 && lead <= 0xDF) ? 2 : 1;
+	if (length == 1 || pos + length - 1 > text.size())
+		return lead;
+	char32_t codePoint = lead & (0x7F >> length);
+	for (uint8_t index = 0; index < length - 1; index++)
+	{
+		const uint8_t next = static_cast<uint8_t>(text[pos + index]);
+		if ((next & 0xC0) != 0x80)
+			return lead;
+		codePoint = (codePoint << 6) | (next & 0x3F);
+	}
+	if (codePoint < LEAST[length] || (codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF)
+		return lead;
+	pos += length - 1;
+	return codePoint;
+}
+
+/*!
+	@brief Decodes one character of text as set by setTextUTF8
+	@param text the text
+	@param pos index of the character, returns the index of the next
+	@return the code point, or the byte as Latin-1 when UTF-8 is off
+*/
+char32_t displaylib_graphics::textDecode(std::string_view text, size_t &pos) const
+{
+	if (_textUTF8)
+		return decodeUTF8(text, pos);
+	return static_cast<uint8_t>(text[pos++]);
+}
+
+/*!
+	@brief Width of text in the active font and text scale, for centring and right aligning
+	@param text the text, UTF-8 if setTextUTF8 is on
+	@return pixels, characters not in the font and without a fallback count 0
+*/
+int16_t displaylib_graphics::getTextWidth(std::string_view text) const
+{
+	int16_t width = 0;
+	size_t pos = 0;
+	while (pos < text.size())
+		width += getCodePointWidth(textDecode(text, pos)) * _textScaleX;
+	return width;
+}
+
+/*!
+	@brief Sets how text bytes are read by print, writeCharString and getTextWidth
+	@param utf8 true decodes UTF-8, false the default, one Latin-1 character per byte
+	@note Off by default so single byte text, e.g. print("\xDB") for a block
+		glyph, draws at once. Turn on for UTF-8 text and range fonts.
+*/
+void displaylib_graphics::setTextUTF8(bool utf8)
+{
+	if (_utf8Need > 0) // sequence cut short, Latin-1
+	{
+		for (uint8_t index = 0; index < _utf8Count; index++)
+			writeCode(_utf8Bytes[index]);
+		_utf8Need = 0;
+	}
+	_textUTF8 = utf8;
+}
+
+/*!
+	@brief Gets how text bytes are read
+	@return true if text is decoded as UTF-8
+*/
+bool displaylib_graphics::getTextUTF8(void) const { return _textUTF8; }
+
 /*!
 	@brief write method used in the print class when user calls print
-	@param character the character to print
+	@param character the character to print, a Latin-1 character, or with
+		setTextUTF8 on a byte of UTF-8 text, a byte that is not part of a
+		valid sequence is then drawn as Latin-1
 	@return Will return
 		-# 1. success
 		-# Ret_Codes_e enum error code An error in the writeChar method.
 
 */
 size_t displaylib_graphics::write(uint8_t character)
+{
+	if (!_textUTF8)
+	{
+		writeCode(character);
+		return 1;
+	}
+	if (_utf8Need > 0) // inside a UTF-8 sequence
+	{
+		if ((character & 0xC0) == 0x80)
+		{
+			_utf8Bytes[_utf8Count++] = character;
+			if (_utf8Count == _utf8Need)
+			{
+				const std::string_view sequence(reinterpret_cast<const char *>(_utf8Bytes), _utf8Count);
+				size_t pos = 0;
+				_utf8Need = 0;
+				while (pos < sequence.size()) // one character, or Latin-1 bytes if not valid
+					writeCode(decodeUTF8(sequence, pos));
+			}
+			return 1;
+		}
+		for (uint8_t index = 0; index < _utf8Count; index++)
+			writeCode(_utf8Bytes[index]); // broken sequence, Latin-1
+		_utf8Need = 0;
+	}
+	if (character >= 0xC2 && character <= 0xF4)
+	{
+		_utf8Bytes[0] = character;
+		_utf8Count = 1;
+		_utf8Need = (character >= 0xF0) ? 4 : (character >= 0xE0) ? 3 : 2;
+		return 1;
+	}
+	writeCode(character);
+	return 1;
+}
+
+/*!
+	@brief Draws one character at the cursor and moves the cursor, print
+	@param codePoint the character, Unicode
+*/
+void displaylib_graphics::writeCode(char32_t codePoint)
 {
 	DisplayRet::Ret_Codes_e DrawCharReturnCode;
-	switch (character)
+	switch (codePoint)
 	{
 	case '\n':
-		_cursor_y += _Font_Y_Size;
+		_cursor_y += _Font_Y_Size * _textScaleY;
 		_cursor_x = 0;
 		break;
 	case '\r':
 		break;
 	default:
-		DrawCharReturnCode = writeChar(_cursor_x, _cursor_y, character);
+		DrawCharReturnCode = writeCodePoint(_cursor_x, _cursor_y, codePoint);
 		if (DrawCharReturnCode != DisplayRet::Success)
 		{
 			// Set the write error based on the result of the drawing operation
 			setWriteError(DrawCharReturnCode); // Set error flag to non-zero value}
 			break;
 		}
-		_cursor_x += (_Font_X_Size);
-		if (_textwrap && (_cursor_x > (_width - (_Font_X_Size))))
+		_cursor_x += (getCodePointWidth(codePoint) * _textScaleX);
+		if (_textwrap && (_cursor_x > (_width - (_Font_X_Size * _textScaleX))))
 		{
-			_cursor_y += _Font_Y_Size;
+			_cursor_y += _Font_Y_Size * _textScaleY;
 			_cursor_x = 0;
 		}
 		break;
 	} // end of switch
-
-	return 1;
 }
 
 /*!
@@ -737,19 +1030,19 @@ DisplayRet::Ret_Codes_e displaylib_graphics::drawBitmap(int16_t x, int16_t y,
 	// 1. Completely out of bounds?
 	if (x > _width || y > _height)
 	{
-		printf("Error drawBitmap 2 : Bitmap co-ord out of bounds, check x and y\n");
+		displaylib_diag::error(displaylib_diag::FuncDrawBitmap, DisplayRet::BitmapScreenBounds, x, y);
 		return DisplayRet::BitmapScreenBounds;
 	}
 	// 2. bitmap weight and height
 	if (w > _width || h > _height)
 	{
-		printf("Error drawBitmap 3 : Bitmap is larger than screen, check w and h\n");
+		displaylib_diag::error(displaylib_diag::FuncDrawBitmap, DisplayRet::BitmapLargerThanScreen, w, h);
 		return DisplayRet::BitmapLargerThanScreen;
 	}
 	// 3. bitmap is null
 	if (bitmap.empty())
 	{
-		printf("Error drawBitmap 4 : Bitmap is is not valid object\n");
+		displaylib_diag::error(displaylib_diag::FuncDrawBitmap, DisplayRet::BitmapDataEmpty);
 		return DisplayRet::BitmapDataEmpty;
 	}
 
@@ -757,16 +1050,18 @@ DisplayRet::Ret_Codes_e displaylib_graphics::drawBitmap(int16_t x, int16_t y,
 	{
 		if (bitmap.size() != static_cast<size_t>(w * (h / 8))) // 4A-1 check  bitmap size
 		{
-			printf("Error drawBitmap 4A-1 : Vertical Bitmap size is incorrect: \n");
+			displaylib_diag::error(displaylib_diag::FuncDrawBitmap, DisplayRet::BitmapSize, w, h);
 			return DisplayRet::BitmapSize;
 		}
 		// 4A-2 check vertical bitmap size
 		if (h % 8 != 0)
 		{
-			printf("Error drawBitmap 4A-2: Check is bitmap height divisible evenly by eight\n");
+			displaylib_diag::error(displaylib_diag::FuncDrawBitmap, DisplayRet::BitmapVerticalSize, w, h);
 			return DisplayRet::BitmapVerticalSize;
 		}
 		// Vertical byte bitmaps mode
+		if (blitPages(x, y, bitmap, w, h, color, bg))
+			return DisplayRet::Success;
 		uint8_t vline;
 		int16_t i, j, r = 0, yin = y;
 		for (i = 0; i < (w + 1); i++)
@@ -802,13 +1097,13 @@ DisplayRet::Ret_Codes_e displaylib_graphics::drawBitmap(int16_t x, int16_t y,
 		// 4B-1.check bitmap size
 		if (bitmap.size() != static_cast<size_t>((w / 8) * h))
 		{
-			printf("Error drawBitmap 4B-1 : Horizontal Bitmap size is incorrect:  Check Size =  (w/8 * h)\n");
+			displaylib_diag::error(displaylib_diag::FuncDrawBitmap, DisplayRet::BitmapSize, w, h);
 			return DisplayRet::BitmapSize;
 		}
 		// 4B-2. check Horizontal bitmap size
 		if (w % 8 != 0)
 		{
-			printf("Error drawBitmap 4B-2 : Check is bitmap width divisible evenly by eight\n");
+			displaylib_diag::error(displaylib_diag::FuncDrawBitmap, DisplayRet::BitmapHorizontalSize, w, h);
 			return DisplayRet::BitmapHorizontalSize;
 		}
 		// Horizontal byte bitmaps mode
@@ -830,6 +1125,104 @@ DisplayRet::Ret_Codes_e displaylib_graphics::drawBitmap(int16_t x, int16_t y,
 	return DisplayRet::Success;
 } // end of function
 
+/*!
+	@brief The whole screen buffer for the widgets that write its bytes directly
+	@param buffer returns the buffer, WIDTH * pages bytes, page layout
+	@param func the widget, recorded with the error
+	@param physical the caller writes the physical layout, so any rotation is allowed
+	@return Success, BufferEmpty no buffer, GenericError display rotated
+*/
+DisplayRet::Ret_Codes_e displaylib_graphics::pageBuffer(std::span<uint8_t> &buffer,
+	displaylib_diag::diag_func_e func, bool physical)
+{
+	if (!physical && getRotation() != rDegrees_0)
+	{
+		displaylib_diag::error(func, DisplayRet::GenericError, getRotation());
+		return DisplayRet::GenericError;
+	}
+	buffer = graphicsBuffer();
+	if (buffer.size() < static_cast<size_t>(WIDTH * ((HEIGHT + 7) / 8)))
+	{
+		displaylib_diag::error(func, DisplayRet::BufferEmpty);
+		return DisplayRet::BufferEmpty;
+	}
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Copies a vertically addressed bitmap into the screen buffer a byte at a time
+	@param x left of bitmap
+	@param y top of bitmap
+	@param bitmap the bitmap data, page layout, checked by drawBitmap
+	@param w width of bitmap
+	@param h height of bitmap, a multiple of 8
+	@param color colour of bits set
+	@param bg colour of bits clear
+	@return false if not done, the caller draws with drawPixel
+	@details Used when the display is not rotated and the colours are foreground
+		and background, either way round. When y is on a page boundary each page
+		of the bitmap is a byte copy, otherwise each byte is split over two pages.
+		Clipped to the screen.
+*/
+bool displaylib_graphics::blitPages(int16_t x, int16_t y, std::span<const uint8_t> bitmap,
+	int16_t w, int16_t h, uint8_t color, uint8_t bg)
+{
+	if (getRotation() != rDegrees_0)
+		return false;
+	if (!((color == FG_COLOR && bg == BG_COLOR) || (color == BG_COLOR && bg == FG_COLOR)))
+		return false;
+	std::span<uint8_t> buffer = graphicsBuffer();
+	const int16_t screenPages = (HEIGHT + 7) / 8;
+	if (buffer.size() < static_cast<size_t>(WIDTH * screenPages))
+		return false;
+
+	const uint8_t invert = (color == BG_COLOR) ? 0xFF : 0x00;
+	const int16_t colStart = (x < 0) ? -x : 0;
+	const int16_t colEnd = (x + w > WIDTH) ? WIDTH - x : w;
+	if (colStart >= colEnd)
+		return true;
+	const int16_t pageTop = y >> 3; // floor, y may be negative
+	const uint8_t shift = y & 7;
+	for (int16_t page = 0; page < h / 8; page++)
+	{
+		const uint8_t *src = bitmap.data() + (page * w);
+		const int16_t upper = pageTop + page;
+		if (shift == 0)
+		{
+			if (upper < 0 || upper >= screenPages)
+				continue;
+			uint8_t *dest = buffer.data() + (upper * WIDTH) + x + colStart; // first visible column
+			const uint8_t *first = src + colStart;
+			if (invert == 0)
+			{
+				std::copy(first, src + colEnd, dest);
+			}
+			else
+			{
+				for (int16_t col = 0; col < colEnd - colStart; col++)
+					dest[col] = first[col] ^ invert;
+			}
+			continue;
+		}
+		const uint8_t upperMask = static_cast<uint8_t>(0xFF << shift);
+		for (int16_t col = colStart; col < colEnd; col++)
+		{
+			const uint8_t value = src[col] ^ invert;
+			if (upper >= 0 && upper < screenPages)
+			{
+				uint8_t &dest = buffer[(upper * WIDTH) + x + col];
+				dest = (dest & ~upperMask) | static_cast<uint8_t>(value << shift);
+			}
+			if (upper + 1 >= 0 && upper + 1 < screenPages)
+			{
+				uint8_t &dest = buffer[((upper + 1) * WIDTH) + x + col];
+				dest = (dest & upperMask) | (value >> (8 - shift));
+			}
+		}
+	}
+	return true;
+}
+
 /*!
 	@brief sets the data addressing mode in drawBitmap function.
 	@param  mode boolean mode  , true default
@@ -881,73 +1274,94 @@ void displaylib_graphics::setArcAngleOffset(int arcAngleOffset) {
 	angle (in degrees) before being drawn. The number of sides is enforced to be at least 3.
 	@param x The x-coordinate of the center of the polygon.
 	@param y The y-coordinate of the center of the polygon.
-	@param sides The number of sides the polygon will have. Must be at least 3.
+	@param sides The number of sides the polygon will have, 3 to POLYGON_SIDES_MAX.
 	@param diameter The diameter of the circle inscribed by the polygon.
 	@param rotation The angle (in degrees) by which to rotate the polygon.
 	@param fill if false draw ,if true fill
 	@param color The color of the polygon edges.
 	@returns error code  GenericError , if user inputs incorrect sides value 
+	@note No heap is used, the vertices are held in fixed size arrays on the stack.
  */
 DisplayRet::Ret_Codes_e displaylib_graphics::drawPolygon(int16_t x, int16_t y, uint8_t sides, int16_t diameter, float rotation, bool fill , uint8_t color) 
 {
-	if ((sides < 3 ) || (sides > 10)) {
-		printf("Error : drawPolygon : sides incorrect value 3-10\r\n");
+	if ((sides < 3 ) || (sides > POLYGON_SIDES_MAX)) {
+		displaylib_diag::error(displaylib_diag::FuncDrawPolygon, DisplayRet::GenericError, sides);
 		return DisplayRet::GenericError;
 	}
 	// Convert degrees to radians
 	const float degreesToRadians = std::numbers::pi / 180.0;
 	const float angleBetweenPoints = 360.0 / sides;
-	// Dynamic arrays for polygon vertices and intersections
-	std::vector<int16_t> vx(sides), vy(sides); // Dynamic size based on sides
-	std::vector<int16_t> intersectX(sides);    // Maximum sides intersections
+	std::array<int16_t, POLYGON_SIDES_MAX> vx, vy;
 	// Calculate polygon vertex positions
 	for (uint8_t i = 0; i < sides; i++) {
 		vx[i] = x + (sin((i * angleBetweenPoints + rotation) * degreesToRadians) * diameter);
 		vy[i] = y + (cos((i * angleBetweenPoints + rotation) * degreesToRadians) * diameter);
 	}
+	return drawPolygon(std::span<const int16_t>(vx.data(), sides), std::span<const int16_t>(vy.data(), sides), fill, color);
+}
+
+/*!
+	@brief Draws a polygon from a list of vertices, any shape, convex or not.
+	@param vx The x-coordinates of the vertices.
+	@param vy The y-coordinates of the vertices, same length as vx.
+	@param fill if false draw ,if true fill, even-odd rule
+	@param color The color of the polygon.
+	@returns error code GenericError, if fewer than 3 or more than POLYGON_SIDES_MAX
+		vertices, or vx and vy differ in length.
+	@note No heap is used, the fill scratch is a fixed size array on the stack.
+ */
+DisplayRet::Ret_Codes_e displaylib_graphics::drawPolygon(std::span<const int16_t> vx, std::span<const int16_t> vy, bool fill, uint8_t color)
+{
+	const size_t sides = vx.size();
+	if (sides < 3 || sides > POLYGON_SIDES_MAX || vy.size() != sides) {
+		displaylib_diag::error(displaylib_diag::FuncDrawPolygon, DisplayRet::GenericError, static_cast<int16_t>(sides), static_cast<int16_t>(vy.size()));
+		return DisplayRet::GenericError;
+	}
 	// If not filling, just draw the polygon outline
 	if (!fill) {
 		for (uint8_t i = 0; i < sides; i++) {
 			uint8_t j = (i + 1) % sides; // Next vertex
 			drawLine(vx[i], vy[i], vx[j], vy[j], color); // Draw edge between consecutive vertices
 		}
+		return DisplayRet::Success;
 	}
 	// If filling, use scanline algorithm to fill the polygon
-	else {
-		// Scanline fill algorithm
-		int16_t minY = vy[0], maxY = vy[0];
-		for (uint8_t i = 1; i < sides; i++) {
-			if (vy[i] < minY) minY = vy[i];
-			if (vy[i] > maxY) maxY = vy[i];
-		}
-		// Loop through scanlines
-		for (int16_t scanY = minY; scanY <= maxY; scanY++) {
-			uint8_t intersections = 0;
-			// Find intersections with polygon edges
-			for (uint8_t i = 0; i < sides; i++) {
-				uint8_t j = (i + 1) % sides;
-				if ((vy[i] <= scanY && vy[j] > scanY) || (vy[j] <= scanY && vy[i] > scanY)) {
-					// Compute intersection using linear interpolation
-					float t = (float)(scanY - vy[i]) / (vy[j] - vy[i]);
-					intersectX[intersections++] = vx[i] + t * (vx[j] - vx[i]);
-				}
+	std::array<int16_t, POLYGON_SIDES_MAX> intersectX; // Maximum sides intersections
+	int16_t minY = vy[0], maxY = vy[0];
+	for (uint8_t i = 1; i < sides; i++) {
+		if (vy[i] < minY) minY = vy[i];
+		if (vy[i] > maxY) maxY = vy[i];
+	}
+	// Clip the scanlines to the screen
+	if (minY < 0) minY = 0;
+	if (maxY >= _height) maxY = _height - 1;
+	// Loop through scanlines
+	for (int16_t scanY = minY; scanY <= maxY; scanY++) {
+		uint8_t intersections = 0;
+		// Find intersections with polygon edges
+		for (uint8_t i = 0; i < sides; i++) {
+			uint8_t j = (i + 1) % sides;
+			if ((vy[i] <= scanY && vy[j] > scanY) || (vy[j] <= scanY && vy[i] > scanY)) {
+				// Compute intersection using linear interpolation
+				float t = (float)(scanY - vy[i]) / (vy[j] - vy[i]);
+				intersectX[intersections++] = vx[i] + t * (vx[j] - vx[i]);
 			}
+		}
 
-			// Sort intersection points (bubble sort for simplicity)
-			for (uint8_t i = 0; i < intersections - 1; i++) {
-				for (uint8_t j = i + 1; j < intersections; j++) {
-					if (intersectX[i] > intersectX[j]) {
-						std::swap(intersectX[i], intersectX[j]);
-					}
-				}
+		// Sort intersection points (insertion sort, few points)
+		for (uint8_t i = 1; i < intersections; i++) {
+			const int16_t key = intersectX[i];
+			int8_t j = i - 1;
+			while (j >= 0 && intersectX[j] > key) {
+				intersectX[j + 1] = intersectX[j];
+				j--;
 			}
+			intersectX[j + 1] = key;
+		}
 
-			// Draw horizontal lines between pairs of intersections
-			for (uint8_t i = 0; i < intersections; i += 2) {
-				if (i + 1 < intersections) {
-					drawFastHLine(intersectX[i], scanY, intersectX[i + 1] - intersectX[i] + 1, color);
-				}
-			}
+		// Draw horizontal lines between pairs of intersections
+		for (uint8_t i = 0; i + 1 < intersections; i += 2) {
+			drawFastHLine(intersectX[i], scanY, intersectX[i + 1] - intersectX[i] + 1, color);
 		}
 	}
 	return DisplayRet::Success;
@@ -972,11 +1386,11 @@ DisplayRet::Ret_Codes_e displaylib_graphics::drawDotGrid(int16_t x, int16_t y, i
 {
 	//User input handling
 	if ((x >= _width) || (y >= _height)){
-		printf("drawDotGrid: Out of screen bounds\n");
+		displaylib_diag::error(displaylib_diag::FuncDrawDotGrid, DisplayRet::ShapeScreenBounds, x, y);
 		return DisplayRet::ShapeScreenBounds;
 	}
 	if (DotGridGap < 2 || DotGridGap > 20) {
-		printf("Warning : drawDotGrid: Invalid Dot Gap value(2-20) , setting to 2\n");
+		displaylib_diag::warning(displaylib_diag::FuncDrawDotGrid, DisplayRet::GenericError, DotGridGap);
 		DotGridGap = 2;
 	}
 	if ((x + w - 1) >= _width)
@@ -0,0 +1,590 @@
+/*!
+	@file display_grayscale.cpp
+	@brief Source file for the temporal dither grayscale canvas and sequencer
+	@author Gavin Lyons.
+*/
+
+#include <algorithm>
+#include "pico/stdlib.h"
+#include "../../include/displaylib/display_grayscale.hpp"
+#include "../../include/displaylib/display_diag.hpp"
+
+namespace
+{
+	/*! 4x4 Bayer matrix, thresholds 0-15, [row][column] */
+	constexpr uint8_t Bayer[4][4] = {{0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}};
+}
+
+/*!
+	@brief init the grayscale object
+	@param display the display driver object the planes are sent to
+*/
+displaylib_grayscale::displaylib_grayscale(displaylib_flush &display) : _display(display)
+{
+}
+
+/*!
+	@brief Starts the sequencer on a canvas
+	@param planes the canvas, 2 * width * (height/8) bytes, plane 0 then plane 1,
+		must stay in scope, it is not cleared
+	@return Will return
+		-# Success
+		-# BufferEmpty planes is an empty object
+		-# BufferSize planes is not 2 * width * (height/8) bytes
+		-# the drivers bus error, GrayRamFlip only
+	@details Picks GrayRamFlip if the display RAM has room for both planes,
+		and writes them to it, else GrayStream. The flush chunk size is set to UPDATE_CHUNK_MAX until grayEnd.
+		Call grayStep often, at least once per sub-frame period.
+*/
+DisplayRet::Ret_Codes_e displaylib_grayscale::grayBegin(std::span<uint8_t> planes)
+{
+	if (_active)
+		grayEnd();
+	const size_t planeSize = static_cast<size_t>(_display._flushWidth) * _display._flushPages;
+	if (planes.empty())
+	{
+		displaylib_diag::error(displaylib_diag::FuncGrayscale, DisplayRet::BufferEmpty);
+		return DisplayRet::BufferEmpty;
+	}
+	if (planes.size() != planeSize * 2)
+	{
+		displaylib_diag::error(displaylib_diag::FuncGrayscale, DisplayRet::BufferSize, static_cast<int16_t>(planes.size()));
+		return DisplayRet::BufferSize;
+	}
+	_planes = planes;
+	_display.updateCancel();
+	_mode = (_display.flushRamPages() >= _display._flushPages * 2) ? GrayRamFlip : GrayStream;
+	if (_mode == GrayRamFlip)
+	{
+		DisplayRet::Ret_Codes_e result = _display.flushStartLine(0);
+		if (result != DisplayRet::Success)
+			return result;
+		// both planes are written now, which also times a page for the uploads in grayStep
+		_uploadPending = static_cast<uint16_t>((1U << (_display._flushPages * 2)) - 1);
+		while (_uploadPending != 0)
+		{
+			result = uploadStep(0, true);
+			if (result != DisplayRet::Success)
+				return result;
+		}
+	}
+	_savedChunkSize = _display.getUpdateChunkSize();
+	_display.setUpdateChunkSize(displaylib_flush::UPDATE_CHUNK_MAX);
+	_sequencePos = 0;
+	_sending = false;
+	_tickUs = time_us_64();
+	resetStats();
+	_active = true;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Stops the sequencer, puts back the chunk size and the start line
+	@return Success or the drivers bus error
+	@note The display is left showing plane 0, or part of a plane. Send a
+		frame, e.g. from grayDither, to show a static picture.
+*/
+DisplayRet::Ret_Codes_e displaylib_grayscale::grayEnd(void)
+{
+	if (!_active)
+		return DisplayRet::Success;
+	_active = false;
+	if (_sending)
+		_display.updateCancel();
+	_sending = false;
+	_display.setUpdateChunkSize(_savedChunkSize);
+	if (_mode == GrayRamFlip)
+		return _display.flushStartLine(0);
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Sets the planes sent in each sub-frame of the sequence
+	@param sequence plane numbers, 0 or 1, 1 to GRAY_SEQUENCE_MAX entries
+	@return Success or GenericError bad sequence
+	@details The brightness of a level is the share of sub-frames that show a
+		plane with its bit set. The default 1 0 1 gives 0, 1/3, 2/3 and 1,
+		1 1 0 1 1 0 the same with the planes spread out, 1 0 gives 3 levels.
+*/
+DisplayRet::Ret_Codes_e displaylib_grayscale::setGraySequence(std::span<const uint8_t> sequence)
+{
+	if (sequence.empty() || sequence.size() > GRAY_SEQUENCE_MAX ||
+		std::any_of(sequence.begin(), sequence.end(), [](uint8_t number) { return number > 1; }))
+	{
+		displaylib_diag::error(displaylib_diag::FuncGrayscale, DisplayRet::GenericError, static_cast<int16_t>(sequence.size()));
+		return DisplayRet::GenericError;
+	}
+	std::copy(sequence.begin(), sequence.end(), _sequence);
+	_sequenceLength = static_cast<uint8_t>(sequence.size());
+	_sequencePos = 0;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Sets the sub-frame period
+	@param periodUs time each sub-frame is shown, uS, 0 as fast as the bus can send
+	@note With GrayStream a period shorter than the time to send a plane is an
+		overrun on every sub-frame, the rate is then set by the bus.
+*/
+void displaylib_grayscale::setSubframePeriod(uint32_t periodUs)
+{
+	_periodUs = periodUs;
+}
+
+/*!
+	@brief How sub-frames are sent
+	@return GrayRamFlip or GrayStream, picked by grayBegin
+*/
+displaylib_grayscale::gray_mode_e displaylib_grayscale::getGrayMode(void) const
+{
+	return _mode;
+}
+
+/*!
+	@brief Fills the canvas with one level
+	@param level 0 to 3
+*/
+void displaylib_grayscale::grayClear(uint8_t level)
+{
+	if (_planes.empty())
+		return;
+	std::span<uint8_t> low = plane(0);
+	std::span<uint8_t> high = plane(1);
+	std::fill(low.begin(), low.end(), (level & 1) ? 0xFF : 0x00);
+	std::fill(high.begin(), high.end(), (level & 2) ? 0xFF : 0x00);
+	planesChanged(0, _display._flushPages * 8);
+}
+
+/*!
+	@brief Sets one pixel of the canvas
+	@param x column
+	@param y row
+	@param level 0 to 3, higher bits ignored
+*/
+void displaylib_grayscale::grayDrawPixel(int16_t x, int16_t y, uint8_t level)
+{
+	if (_planes.empty() || x < 0 || y < 0 || x >= _display._flushWidth || y >= _display._flushPages * 8)
+		return;
+	const size_t index = x + (y / 8) * static_cast<size_t>(_display._flushWidth);
+	const uint8_t bit = static_cast<uint8_t>(1 << (y & 7));
+	std::span<uint8_t> low = plane(0);
+	std::span<uint8_t> high = plane(1);
+	low[index] = static_cast<uint8_t>((level & 1) ? (low[index] | bit) : (low[index] & ~bit));
+	high[index] = static_cast<uint8_t>((level & 2) ? (high[index] | bit) : (high[index] & ~bit));
+	planesChanged(y, 1);
+}
+
+/*!
+	@brief Reads one pixel of the canvas
+	@param x column
+	@param y row
+	@return level 0 to 3, 0 off the canvas
+*/
+uint8_t displaylib_grayscale::grayGetPixel(int16_t x, int16_t y) const
+{
+	if (_planes.empty() || x < 0 || y < 0 || x >= _display._flushWidth || y >= _display._flushPages * 8)
+		return 0;
+	const size_t index = x + (y / 8) * static_cast<size_t>(_display._flushWidth);
+	return static_cast<uint8_t>(((plane(0)[index] >> (y & 7)) & 1) | (((plane(1)[index] >> (y & 7)) & 1) << 1));
+}
+
+/*!
+	@brief Fills a rectangle of the canvas with one level, a page byte at a time
+	@param x left
+	@param y top
+	@param w width
+	@param h height
+	@param level 0 to 3
+*/
+void displaylib_grayscale::grayFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t level)
+{
+	if (_planes.empty())
+		return;
+	const int16_t left = std::max<int16_t>(x, 0);
+	const int16_t right = std::min<int16_t>(x + w, _display._flushWidth);
+	const int16_t top = std::max<int16_t>(y, 0);
+	const int16_t bottom = std::min<int16_t>(y + h, _display._flushPages * 8);
+	if (left >= right || top >= bottom)
+		return;
+	std::span<uint8_t> low = plane(0);
+	std::span<uint8_t> high = plane(1);
+	for (int16_t page = top / 8; page <= (bottom - 1) / 8; page++)
+	{
+		const int16_t rowLow = std::max<int16_t>(top - (page * 8), 0);
+		const int16_t rowHigh = std::min<int16_t>(bottom - (page * 8), 8);
+		const uint8_t rows = static_cast<uint8_t>(((1U << rowHigh) - 1U) & ~((1U << rowLow) - 1U));
+		const uint8_t lowBits = (level & 1) ? rows : 0;
+		const uint8_t highBits = (level & 2) ? rows : 0;
+		const size_t start = static_cast<size_t>(page) * _display._flushWidth;
+		for (int16_t column = left; column < right; column++)
+		{
+			low[start + column] = static_cast<uint8_t>((low[start + column] & ~rows) | lowBits);
+			high[start + column] = static_cast<uint8_t>((high[start + column] & ~rows) | highBits);
+		}
+	}
+	planesChanged(top, bottom - top);
+}
+
+/*!
+	@brief Draws the lit pixels of a 1 bit bitmap in one level, e.g. text or icons
+	@param x left
+	@param y top
+	@param w width
+	@param h height
+	@param bitmap page layout, w * ((h + 7) / 8) bytes
+	@param level 0 to 3
+	@return Success or BitmapSize bitmap too small
+	@note Unlit pixels are left as they are.
+*/
+DisplayRet::Ret_Codes_e displaylib_grayscale::grayDrawBitmap(int16_t x, int16_t y, int16_t w, int16_t h,
+	std::span<const uint8_t> bitmap, uint8_t level)
+{
+	if (w < 1 || h < 1 || bitmap.size() < static_cast<size_t>(w) * ((h + 7) / 8))
+	{
+		displaylib_diag::error(displaylib_diag::FuncGrayscale, DisplayRet::BitmapSize, w, h);
+		return DisplayRet::BitmapSize;
+	}
+	for (int16_t row = 0; row < h; row++)
+	{
+		for (int16_t column = 0; column < w; column++)
+		{
+			if ((bitmap[column + (row / 8) * w] >> (row & 7)) & 1)
+				grayDrawPixel(x + column, y + row, level);
+		}
+	}
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Draws an 8 bit grey image, reduced to the 4 levels
+	@param x left
+	@param y top
+	@param w width
+	@param h height
+	@param pixels w * h bytes, row by row, 0 black to 255 white
+	@param dither true to spread each pixel between the two nearest levels with
+		a 4x4 Bayer pattern, false to round to the nearest level
+	@return Success or BitmapSize pixels too small
+	@note The pattern is fixed to the screen, so images drawn next to each other match.
+*/
+DisplayRet::Ret_Codes_e displaylib_grayscale::grayDrawImage(int16_t x, int16_t y, int16_t w, int16_t h,
+	std::span<const uint8_t> pixels, bool dither)
+{
+	if (w < 1 || h < 1 || pixels.size() < static_cast<size_t>(w) * h)
+	{
+		displaylib_diag::error(displaylib_diag::FuncGrayscale, DisplayRet::BitmapSize, w, h);
+		return DisplayRet::BitmapSize;
+	}
+	for (int16_t row = 0; row < h; row++)
+	{
+		for (int16_t column = 0; column < w; column++)
+		{
+			const uint32_t value = pixels[column + row * static_cast<size_t>(w)];
+			uint32_t level;
+			if (dither)
+			{
+				// level 3 * value / 255 plus a threshold of (2b + 1) / 32, b the Bayer entry
+				const uint32_t threshold = Bayer[(y + row) & 3][(x + column) & 3];
+				level = std::min<uint32_t>(((value * 96) + ((2 * threshold) + 1) * 255) / 8160, 3);
+			}
+			else
+			{
+				level = ((value * 3) + 127) / 255;
+			}
+			grayDrawPixel(x + column, y + row, static_cast<uint8_t>(level));
+		}
+	}
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Draws a 2 bit image in the canvas layout, e.g. from displaylib_assets.py --gray
+	@param x left
+	@param y top
+	@param w width
+	@param h height
+	@param planes plane 0 then plane 1, each w * ((h + 7) / 8) bytes page layout
+	@return Success or BitmapSize planes too small
+*/
+DisplayRet::Ret_Codes_e displaylib_grayscale::grayDrawPlanes(int16_t x, int16_t y, int16_t w, int16_t h,
+	std::span<const uint8_t> planes)
+{
+	const size_t planeSize = static_cast<size_t>(w) * ((h + 7) / 8);
+	if (w < 1 || h < 1 || planes.size() < planeSize * 2)
+	{
+		displaylib_diag::error(displaylib_diag::FuncGrayscale, DisplayRet::BitmapSize, w, h);
+		return DisplayRet::BitmapSize;
+	}
+	for (int16_t row = 0; row < h; row++)
+	{
+		for (int16_t column = 0; column < w; column++)
+		{
+			const size_t index = column + (row / 8) * static_cast<size_t>(w);
+			const uint8_t level = static_cast<uint8_t>(((planes[index] >> (row & 7)) & 1) |
+				(((planes[planeSize + index] >> (row & 7)) & 1) << 1));
+			grayDrawPixel(x + column, y + row, level);
+		}
+	}
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Writes the canvas as a 1 bit ordered dither, the static fallback
+	@param frame width * (height/8) bytes, screen buffer layout, e.g. the driver screen buffer
+	@return Success, BufferEmpty no canvas, BufferSize frame the wrong size
+	@details Level n lights the pixels whose 4x4 Bayer threshold is under n/3,
+		0, 6, 11 and 16 of 16. A page byte covers rows 8p to 8p + 7, so the
+		pattern of each level is one byte per column mod 4, chosen by the two
+		plane bits with byte wide logic.
+*/
+DisplayRet::Ret_Codes_e displaylib_grayscale::grayDither(std::span<uint8_t> frame) const
+{
+	const size_t planeSize = static_cast<size_t>(_display._flushWidth) * _display._flushPages;
+	if (_planes.empty())
+	{
+		displaylib_diag::error(displaylib_diag::FuncGrayscale, DisplayRet::BufferEmpty);
+		return DisplayRet::BufferEmpty;
+	}
+	if (frame.size() != planeSize)
+	{
+		displaylib_diag::error(displaylib_diag::FuncGrayscale, DisplayRet::BufferSize, static_cast<int16_t>(frame.size()));
+		return DisplayRet::BufferSize;
+	}
+	uint8_t pattern[GRAY_LEVELS][4] = {};
+	for (uint8_t level = 0; level < GRAY_LEVELS; level++)
+	{
+		for (uint8_t column = 0; column < 4; column++)
+		{
+			for (uint8_t row = 0; row < 8; row++)
+			{
+				if (Bayer[row & 3][column] * 3 < level * 16)
+					pattern[level][column] |= static_cast<uint8_t>(1 << row);
+			}
+		}
+	}
+	const std::span<uint8_t> low = plane(0);
+	const std::span<uint8_t> high = plane(1);
+	for (size_t index = 0; index < planeSize; index++)
+	{
+		const uint8_t column = static_cast<uint8_t>((index % _display._flushWidth) & 3);
+		const uint8_t lowBits = low[index];
+		const uint8_t highBits = high[index];
+		frame[index] = static_cast<uint8_t>((lowBits & ~highBits & pattern[1][column]) |
+			(highBits & ~lowBits & pattern[2][column]) | (lowBits & highBits));
+	}
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Runs the sequencer, call in the main loop
+	@param budgetUs time budget for sending in this call, 0 no limit
+	@return Will return
+		-# FlushIdle waiting for the next sub-frame tick, or not started
+		-# FlushBusy a sub-frame or a plane upload is being sent
+		-# FlushDone a sub-frame went on the display in this call
+		-# FlushError bus error, the sub-frame is retried at the next tick
+	@details GrayStream: at the tick the plane of the next sub-frame is flushed
+		with updateStep, the next tick is counted from the one before, so the
+		cadence holds, unless the sub-frame started a period or more late, an
+		overrun, then from its start. GrayRamFlip: at each tick one start line
+		command shows the next plane, changed pages are then written to display
+		RAM in the time left before the next tick and within the budget.
+*/
+displaylib_flush::flush_state_e displaylib_grayscale::grayStep(uint32_t budgetUs)
+{
+	if (!_active)
+		return displaylib_flush::FlushIdle;
+	if (_mode == GrayRamFlip)
+	{
+		displaylib_flush::flush_state_e state = displaylib_flush::FlushIdle;
+		if (time_us_64() >= _tickUs)
+		{
+			subframeStart();
+			const uint8_t line = static_cast<uint8_t>(_sequence[_sequencePos] * _display._flushPages * 8);
+			if (_display.flushStartLine(line) != DisplayRet::Success)
+			{
+				_stats.flushErrors++;
+				return displaylib_flush::FlushError;
+			}
+			state = subframeDone(time_us_64());
+		}
+		if (_uploadPending != 0)
+		{
+			// a page longer than the period goes right after a flip, the next flip is late
+			const bool force = (state == displaylib_flush::FlushDone) && (_uploadPageUs >= _periodUs);
+			if (uploadStep(budgetUs, force) != DisplayRet::Success)
+			{
+				_stats.flushErrors++;
+				return displaylib_flush::FlushError;
+			}
+			if (state != displaylib_flush::FlushDone)
+				state = displaylib_flush::FlushBusy;
+		}
+		return state;
+	}
+	if (!_sending)
+	{
+		if (time_us_64() < _tickUs)
+			return displaylib_flush::FlushIdle;
+		const displaylib_flush::flush_state_e state = subframeStart();
+		if (state == displaylib_flush::FlushError)
+			return state;
+		_sending = true;
+	}
+	const displaylib_flush::flush_state_e state = _display.updateStep(budgetUs);
+	switch (state)
+	{
+		case displaylib_flush::FlushDone:
+			_sending = false;
+			return subframeDone(time_us_64());
+		case displaylib_flush::FlushError:
+			_sending = false;
+			_stats.flushErrors++;
+			return state;
+		case displaylib_flush::FlushIdle: // cancelled by the user
+			_sending = false;
+			return state;
+		default:
+			return state;
+	}
+}
+
+/*!
+	@brief Gets the sequencer counters
+	@return reference to the counters
+*/
+const displaylib_grayscale::gray_stats_t &displaylib_grayscale::getGrayStats(void) const
+{
+	return _stats;
+}
+
+/*!
+	@brief Sub-frames shown per second since grayBegin or resetStats
+	@return sub-frames per second, divide by the sequence length for the grey refresh rate
+*/
+float displaylib_grayscale::getSubframeRate(void) const
+{
+	const uint64_t elapsedUs = time_us_64() - _statsStartUs;
+	if (elapsedUs == 0)
+		return 0.0f;
+	return (_stats.subframes * 1000000.0f) / static_cast<float>(elapsedUs);
+}
+
+/*!
+	@brief Clears the counters and starts a new rate period
+*/
+void displaylib_grayscale::resetStats(void)
+{
+	_stats = gray_stats_t{};
+	_statsStartUs = time_us_64();
+}
+
+/*!
+	@brief One plane of the canvas
+	@param number 0 low bit, 1 high bit
+	@return the plane
+*/
+std::span<uint8_t> displaylib_grayscale::plane(uint8_t number) const
+{
+	const size_t planeSize = static_cast<size_t>(_display._flushWidth) * _display._flushPages;
+	return _planes.subspan(number * planeSize, planeSize);
+}
+
+/*!
+	@brief Starts a sub-frame at its tick, sets the next tick
+	@return FlushBusy, or FlushError if the GrayStream flush could not start
+*/
+displaylib_flush::flush_state_e displaylib_grayscale::subframeStart(void)
+{
+	const uint64_t nowUs = time_us_64();
+	if (_periodUs == 0 || nowUs >= _tickUs + _periodUs)
+	{
+		if (_periodUs != 0)
+			_stats.overruns++;
+		_tickUs = nowUs;
+	}
+	_tickUs += _periodUs;
+	_sendStartUs = nowUs;
+	if (_mode == GrayStream && _display.updateBegin(plane(_sequence[_sequencePos])) != DisplayRet::Success)
+	{
+		_stats.flushErrors++;
+		return displaylib_flush::FlushError;
+	}
+	return displaylib_flush::FlushBusy;
+}
+
+/*!
+	@brief Counts a sub-frame on the display and moves to the next in the sequence
+	@param nowUs time the sub-frame was sent
+	@return FlushDone
+*/
+displaylib_flush::flush_state_e displaylib_grayscale::subframeDone(uint64_t nowUs)
+{
+	_stats.sendLastUs = static_cast<uint32_t>(nowUs - _sendStartUs);
+	_stats.sendMaxUs = std::max(_stats.sendMaxUs, _stats.sendLastUs);
+	_stats.subframes++;
+	if (++_sequencePos >= _sequenceLength)
+	{
+		_sequencePos = 0;
+		_stats.cycles++;
+	}
+	return displaylib_flush::FlushDone;
+}
+
+/*!
+	@brief Writes changed planes to display RAM, GrayRamFlip, a page at a time
+	@param budgetUs time budget, 0 no limit, the first page is written even if over it
+	@param force write one page even if it does not fit before the next tick
+	@return Success or the drivers bus error
+	@details Plane p page g goes to RAM page p * pages + g, the start line of
+		plane p is then p * pages * 8. A page is only started if the time the
+		last page took fits before the next sub-frame tick, so the uploads fill
+		the gaps between start line commands.
+*/
+DisplayRet::Ret_Codes_e displaylib_grayscale::uploadStep(uint32_t budgetUs, bool force)
+{
+	const uint64_t startUs = time_us_64();
+	const uint64_t tickUs = (_periodUs != 0) ? _tickUs : UINT64_MAX;
+	bool first = true;
+	const uint8_t width = _display._flushWidth;
+	const uint8_t pages = _display._flushPages;
+	for (uint8_t ramPage = 0; ramPage < pages * 2 && _uploadPending != 0; ramPage++)
+	{
+		if (!(_uploadPending & (1U << ramPage)))
+			continue;
+		const uint64_t pageStartUs = time_us_64();
+		if (!force && pageStartUs + _uploadPageUs > tickUs)
+			break;
+		if (!first && budgetUs != 0 && (pageStartUs - startUs) + _uploadPageUs > budgetUs)
+			break;
+		force = false;
+		first = false;
+		const std::span<const uint8_t> data = plane(ramPage / pages).subspan(static_cast<size_t>(ramPage % pages) * width, width);
+		_display.flushAddressLost();
+		DisplayRet::Ret_Codes_e result = _display.flushSetAddress(ramPage, 0, width - 1);
+		for (size_t sent = 0; result == DisplayRet::Success && sent < data.size(); sent += displaylib_flush::UPDATE_CHUNK_MAX)
+			result = _display.flushWriteData(data.subspan(sent, std::min<size_t>(displaylib_flush::UPDATE_CHUNK_MAX, data.size() - sent)));
+		if (result == DisplayRet::BusRetry)
+			break; // the page stays pending, sent again on the next step
+		if (result != DisplayRet::Success)
+			return result;
+		_uploadPending = static_cast<uint16_t>(_uploadPending & ~(1U << ramPage));
+		_stats.uploadPages++;
+		_uploadPageUs = static_cast<uint32_t>(time_us_64() - pageStartUs);
+	}
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Notes rows of the canvas changed, GrayRamFlip writes their pages again
+	@param y first row
+	@param h rows
+*/
+void displaylib_grayscale::planesChanged(int16_t y, int16_t h)
+{
+	if (_mode != GrayRamFlip || h < 1)
+		return;
+	const uint8_t pages = _display._flushPages;
+	for (int16_t page = y / 8; page <= (y + h - 1) / 8 && page < pages; page++)
+		_uploadPending = static_cast<uint16_t>(_uploadPending | (1U << page) | (1U << (page + pages)));
+}
@@ -0,0 +1,579 @@
+/*!
+	@file display_list.cpp
+	@brief Source file for the list view widget
+	@author Gavin Lyons.
+*/
+
+#include <algorithm>
+#include <string_view>
+#include "pico/stdlib.h"
+#include "../../include/displaylib/display_list.hpp"
+#include "../../include/displaylib/display_diag.hpp"
+
+/*!
+	@brief init the list view object
+	@param display the display driver object to draw to
+	@param x left of the list
+	@param y top of the list
+	@param w width of the list
+	@param h height of the list
+	@param font the font of the rows
+	@note Nothing is drawn until listBegin is called.
+*/
+displaylib_list_view::displaylib_list_view(displaylib_graphics &display, int16_t x, int16_t y, int16_t w, int16_t h,
+	std::span<const uint8_t> font) : _display(display), _font(font), _x(x), _y(y), _w(w), _h(h)
+{
+}
+
+/*!
+	@brief Starts the list, top row selected, and draws it
+	@param provider function that writes the text of a row
+	@param context passed to the provider, e.g. the menu it reads from, may be nullptr
+	@param rows number of rows
+	@return Will return
+		-# Success
+		-# GenericError provider is nullptr, font over 64 pixels high, or the display is rotated
+		-# ShapeScreenBounds list not inside the screen
+		-# FontDataEmpty or FontDataTooSmall bad font data
+		-# BufferEmpty the screen buffer has not been assigned
+*/
+DisplayRet::Ret_Codes_e displaylib_list_view::listBegin(list_row_t provider, void *context, uint16_t rows)
+{
+	_provider = nullptr;
+	if (provider == nullptr)
+	{
+		displaylib_diag::error(displaylib_diag::FuncListView, DisplayRet::GenericError);
+		return DisplayRet::GenericError;
+	}
+	if (_w < 1 || _h < 1 || _x < 0 || _y < 0 ||
+		_x + _w > _display.WIDTH || _y + _h > _display.HEIGHT)
+	{
+		displaylib_diag::error(displaylib_diag::FuncListView, DisplayRet::ShapeScreenBounds, _w, _h);
+		return DisplayRet::ShapeScreenBounds;
+	}
+	const std::span<const uint8_t> userFont = _display.getFont();
+	const bool userInvert = _display.getInvertFont();
+	DisplayRet::Ret_Codes_e result = _display.setFont(_font);
+	const uint8_t fontHeight = _display._Font_Y_Size;
+	_display.setFont(userFont);
+	_display.setInvertFont(userInvert);
+	if (result != DisplayRet::Success)
+	{
+		displaylib_diag::error(displaylib_diag::FuncListView, result);
+		return result;
+	}
+	if (fontHeight == 0 || fontHeight > 64)
+	{
+		displaylib_diag::error(displaylib_diag::FuncListView, DisplayRet::GenericError, fontHeight);
+		return DisplayRet::GenericError;
+	}
+	_provider = provider;
+	_context = context;
+	_rows = rows;
+	_rowHeight = static_cast<int16_t>(fontHeight + _spacing);
+	_selected = 0;
+	_scroll = 0;
+	_target = 0;
+	return listRedraw();
+}
+
+/*!
+	@brief Changes the number of rows and redraws the list
+	@param rows number of rows
+	@return Success, or the error codes of listRedraw
+	@note The selection and scroll are kept when still inside the list.
+*/
+DisplayRet::Ret_Codes_e displaylib_list_view::setRowCount(uint16_t rows)
+{
+	_rows = rows;
+	if (_selected >= _rows)
+		_selected = (_rows == 0) ? 0 : _rows - 1;
+	_target = scrollFor(_selected);
+	_scroll = _target;
+	return listRedraw();
+}
+
+/*!
+	@brief Sets the pixels below the text of each row
+	@param pixels the spacing, 0 the default
+	@note Call before listBegin, the row height is set by listBegin.
+*/
+void displaylib_list_view::setRowSpacing(uint8_t pixels)
+{
+	_spacing = pixels;
+}
+
+/*!
+	@brief Sets how far each listScrollStep scrolls
+	@param pixels pixels per step, 0 the default jumps at once, no listScrollStep needed
+*/
+void displaylib_list_view::setScrollSpeed(uint8_t pixels)
+{
+	_speed = pixels;
+}
+
+/*!
+	@brief Draws every row in view again
+	@return Will return
+		-# Success
+		-# GenericError listBegin not called, or the display is rotated
+		-# BufferEmpty the screen buffer has not been assigned
+	@note Call after clearing the screen buffer, or when many rows changed.
+*/
+DisplayRet::Ret_Codes_e displaylib_list_view::listRedraw(void)
+{
+	std::span<uint8_t> buffer;
+	DisplayRet::Ret_Codes_e result = listBuffer(buffer);
+	if (result != DisplayRet::Success)
+		return result;
+	return drawBand(buffer, _y, _y + _h);
+}
+
+/*!
+	@brief Draws a row again after its text changed, nothing is drawn if it is out of view
+	@param row the row
+	@return Success, or the error codes of listRedraw
+*/
+DisplayRet::Ret_Codes_e displaylib_list_view::invalidateRow(uint16_t row)
+{
+	std::span<uint8_t> buffer;
+	DisplayRet::Ret_Codes_e result = listBuffer(buffer);
+	if (result != DisplayRet::Success || row >= _rows)
+		return result;
+	const int32_t rowTop = _y + (static_cast<int32_t>(row) * _rowHeight) - _scroll;
+	const int32_t top = std::max<int32_t>(rowTop, _y);
+	const int32_t bottom = std::min<int32_t>(rowTop + _rowHeight, _y + _h);
+	if (top >= bottom)
+		return DisplayRet::Success;
+	return drawBand(buffer, static_cast<int16_t>(top), static_cast<int16_t>(bottom));
+}
+
+/*!
+	@brief Selects a row, scrolls it into view if needed
+	@param row the row, past the end selects the last row
+	@return Success, or the error codes of listRedraw
+	@details The highlight is moved by inverting the bands of the old and new
+		rows, no text is drawn. If the row is not fully in view the list
+		scrolls, at once or over listScrollStep calls, see setScrollSpeed.
+*/
+DisplayRet::Ret_Codes_e displaylib_list_view::setSelected(uint16_t row)
+{
+	std::span<uint8_t> buffer;
+	DisplayRet::Ret_Codes_e result = listBuffer(buffer);
+	if (result != DisplayRet::Success || _rows == 0)
+		return result;
+	if (row >= _rows)
+		row = _rows - 1;
+	if (row != _selected)
+	{
+		bandInvert(buffer, _selected, _y, _y + _h);
+		_selected = row;
+		bandInvert(buffer, _selected, _y, _y + _h);
+	}
+	const int32_t target = scrollFor(_selected);
+	if (target == _target)
+		return DisplayRet::Success;
+	return listScrollTo(target);
+}
+
+/*!
+	@brief Moves the selection up or down
+	@param rows rows to move, negative up, stops at the first and last row
+	@return Success, or the error codes of listRedraw
+*/
+DisplayRet::Ret_Codes_e displaylib_list_view::moveSelection(int16_t rows)
+{
+	int32_t row = static_cast<int32_t>(_selected) + rows;
+	row = std::clamp<int32_t>(row, 0, (_rows == 0) ? 0 : _rows - 1);
+	return setSelected(static_cast<uint16_t>(row));
+}
+
+/*!
+	@brief Scrolls the list without moving the selection
+	@param pixels list pixel to show at the top, clamped to the list
+	@return Success, or the error codes of listRedraw
+	@note With a scroll speed set only the target is set, call listScrollStep.
+*/
+DisplayRet::Ret_Codes_e displaylib_list_view::listScrollTo(int32_t pixels)
+{
+	std::span<uint8_t> buffer;
+	DisplayRet::Ret_Codes_e result = listBuffer(buffer);
+	if (result != DisplayRet::Success)
+		return result;
+	_target = std::clamp<int32_t>(pixels, 0, scrollMax());
+	if (_speed == 0)
+		scrollBy(buffer, _target - _scroll);
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Scrolls up to the scroll speed pixels towards the target, call once a frame
+	@return true if there is more to scroll
+	@note Each step shifts the list bytes and draws the rows moved into view.
+*/
+bool displaylib_list_view::listScrollStep(void)
+{
+	if (_scroll == _target)
+		return false;
+	std::span<uint8_t> buffer;
+	if (listBuffer(buffer) != DisplayRet::Success)
+		return false;
+	const int32_t step = (_speed == 0) ? 0x7FFFFFFF : _speed;
+	scrollBy(buffer, std::clamp<int32_t>(_target - _scroll, -step, step));
+	return _scroll != _target;
+}
+
+/*!
+	@brief Selected row
+	@return the row
+*/
+uint16_t displaylib_list_view::getSelected(void) const
+{
+	return _selected;
+}
+
+/*!
+	@brief Rows in the list
+	@return row count
+*/
+uint16_t displaylib_list_view::getRowCount(void) const
+{
+	return _rows;
+}
+
+/*!
+	@brief Height of a row
+	@return pixels, font height plus row spacing, set by listBegin
+*/
+int16_t displaylib_list_view::getRowHeight(void) const
+{
+	return _rowHeight;
+}
+
+/*!
+	@brief List pixel at the top of the rectangle
+	@return the scroll in pixels
+*/
+int32_t displaylib_list_view::getScroll(void) const
+{
+	return _scroll;
+}
+
+/*!
+	@brief Is a scroll in progress
+	@return true if listScrollStep has more to do
+*/
+bool displaylib_list_view::getScrolling(void) const
+{
+	return _scroll != _target;
+}
+
+/*!
+	@brief Have rows been drawn since the last flushDirty or clearDirty
+	@return true if the dirty rectangle needs sending
+*/
+bool displaylib_list_view::getDirty(void) const
+{
+	return _dirtyBottom > _dirtyTop;
+}
+
+/*!
+	@brief Rectangle of the rows drawn since the last flush, the full list width
+	@return the rectangle, buffer co-ordinates, empty if nothing changed
+*/
+displaylib_flush::flush_rect_t displaylib_list_view::getDirtyRect(void) const
+{
+	if (!getDirty())
+		return displaylib_flush::flush_rect_t{};
+	return displaylib_flush::flush_rect_t{_x, _dirtyTop, _w, static_cast<int16_t>(_dirtyBottom - _dirtyTop)};
+}
+
+/*!
+	@brief Empties the band of changed rows without sending it
+*/
+void displaylib_list_view::clearDirty(void)
+{
+	_dirtyTop = 0;
+	_dirtyBottom = 0;
+}
+
+/*!
+	@brief Sends the changed rows to the display with updateRegion
+	@param display the display driver object, the same display as the constructor
+	@return Success or the updateRegion error, the rows stay dirty on error
+*/
+DisplayRet::Ret_Codes_e displaylib_list_view::flushDirty(displaylib_flush &display)
+{
+	if (!getDirty())
+		return DisplayRet::Success;
+	DisplayRet::Ret_Codes_e result = display.updateRegion(getDirtyRect());
+	if (result == DisplayRet::Success)
+		clearDirty();
+	return result;
+}
+
+/*!
+	@brief Gets the screen buffer of the display
+	@param buffer returns the buffer
+	@return Success, GenericError listBegin not called, or the errors of displaylib_graphics::pageBuffer
+*/
+DisplayRet::Ret_Codes_e displaylib_list_view::listBuffer(std::span<uint8_t> &buffer)
+{
+	if (_provider == nullptr)
+	{
+		displaylib_diag::error(displaylib_diag::FuncListView, DisplayRet::GenericError);
+		return DisplayRet::GenericError;
+	}
+	return _display.pageBuffer(buffer, displaylib_diag::FuncListView);
+}
+
+/*!
+	@brief Largest scroll, the last row at the bottom of the rectangle
+	@return pixels, 0 if the rows fit
+*/
+int32_t displaylib_list_view::scrollMax(void) const
+{
+	const int32_t total = static_cast<int32_t>(_rows) * _rowHeight;
+	return (total > _h) ? total - _h : 0;
+}
+
+/*!
+	@brief Scroll nearest the current target that shows a whole row
+	@param row the row
+	@return pixels
+*/
+int32_t displaylib_list_view::scrollFor(uint16_t row) const
+{
+	const int32_t top = static_cast<int32_t>(row) * _rowHeight;
+	int32_t scroll = _target;
+	if (top < scroll)
+		scroll = top;
+	else if (top + _rowHeight > scroll + _h)
+		scroll = top + _rowHeight - _h;
+	return std::clamp<int32_t>(scroll, 0, scrollMax());
+}
+
+/*!
+	@brief Bits of a page inside a band of screen rows
+	@param page the page
+	@param top first screen row of the band
+	@param bottom screen row below the band
+	@return mask, bit 0 top row of the page
+*/
+uint8_t displaylib_list_view::bandMask(int16_t page, int16_t top, int16_t bottom) const
+{
+	const int16_t low = std::max<int16_t>(top, page * 8);
+	const int16_t high = std::min<int16_t>(bottom, page * 8 + 8);
+	if (high <= low)
+		return 0;
+	return static_cast<uint8_t>(((1U << (high - low)) - 1U) << (low & 7));
+}
+
+/*!
+	@brief Inverts the band of a row, the part inside a band of screen rows
+	@param buffer the screen buffer
+	@param row the row
+	@param top first screen row that may change
+	@param bottom screen row below
+*/
+void displaylib_list_view::bandInvert(std::span<uint8_t> buffer, uint16_t row, int16_t top, int16_t bottom)
+{
+	if (row >= _rows)
+		return;
+	const int32_t rowTop = _y + (static_cast<int32_t>(row) * _rowHeight) - _scroll;
+	top = static_cast<int16_t>(std::max<int32_t>(rowTop, top));
+	bottom = static_cast<int16_t>(std::min<int32_t>(rowTop + _rowHeight, bottom));
+	if (top >= bottom)
+		return;
+	for (int16_t page = top / 8; page <= (bottom - 1) / 8; page++)
+	{
+		const uint8_t mask = bandMask(page, top, bottom);
+		uint8_t *cell = buffer.data() + (page * _display.WIDTH) + _x;
+		for (int16_t col = 0; col < _w; col++)
+			cell[col] ^= mask;
+	}
+	markDirty(top, bottom);
+}
+
+/*!
+	@brief Scrolls the list, shifts the bytes of the rectangle and draws the rows moved into view
+	@param buffer the screen buffer
+	@param pixels pixels to scroll, positive moves the rows up
+	@details Each output byte is made from the two source bytes the shift
+		spans. Up, pages are done top first, down bottom first, so a byte is
+		read before it is written. The top and bottom pages are merged through
+		a mask so pixels outside the list are kept.
+*/
+void displaylib_list_view::scrollBy(std::span<uint8_t> buffer, int32_t pixels)
+{
+	if (pixels == 0)
+		return;
+	_scroll += pixels;
+	if (pixels >= _h || -pixels >= _h)
+	{
+		drawBand(buffer, _y, _y + _h);
+		return;
+	}
+	const int16_t pages = static_cast<int16_t>((_display.HEIGHT + 7) / 8);
+	const int16_t firstPage = _y / 8;
+	const int16_t lastPage = (_y + _h - 1) / 8;
+	for (int16_t step = 0; step <= lastPage - firstPage; step++)
+	{
+		const int16_t page = (pixels > 0) ? firstPage + step : lastPage - step;
+		const uint8_t mask = bandMask(page, _y, _y + _h);
+		const int32_t source = (page * 8) + pixels; // screen row moved to the top of the page
+		const int32_t sourcePage = source >> 3;     // floor, also for rows above the screen
+		const uint8_t bit = static_cast<uint8_t>(source & 7);
+		uint8_t *cell = buffer.data() + (page * _display.WIDTH) + _x;
+		const uint8_t *low = (sourcePage >= 0 && sourcePage < pages) ?
+			buffer.data() + (sourcePage * _display.WIDTH) + _x : nullptr;
+		const uint8_t *high = (sourcePage + 1 >= 0 && sourcePage + 1 < pages) ?
+			buffer.data() + ((sourcePage + 1) * _display.WIDTH) + _x : nullptr;
+		for (int16_t col = 0; col < _w; col++)
+		{
+			uint8_t value = low ? static_cast<uint8_t>(low[col] >> bit) : 0;
+			if (bit != 0 && high)
+				value = static_cast<uint8_t>(value | (high[col] << (8 - bit)));
+			cell[col] = static_cast<uint8_t>((cell[col] & ~mask) | (value & mask));
+		}
+	}
+	markDirty(_y, _y + _h);
+	if (pixels > 0)
+		drawBand(buffer, static_cast<int16_t>(_y + _h - pixels), _y + _h);
+	else
+		drawBand(buffer, _y, static_cast<int16_t>(_y - pixels));
+}
+
+/*!
+	@brief Clears a band of screen rows of the list and draws the rows in it
+	@param buffer the screen buffer
+	@param top first screen row, inside the list
+	@param bottom screen row below, inside the list
+	@return Success or the setFont error
+	@note The font and font invert of the display are restored after.
+*/
+DisplayRet::Ret_Codes_e displaylib_list_view::drawBand(std::span<uint8_t> buffer, int16_t top, int16_t bottom)
+{
+	for (int16_t page = top / 8; page <= (bottom - 1) / 8; page++)
+	{
+		const uint8_t keep = static_cast<uint8_t>(~bandMask(page, top, bottom));
+		uint8_t *cell = buffer.data() + (page * _display.WIDTH) + _x;
+		for (int16_t col = 0; col < _w; col++)
+			cell[col] &= keep;
+	}
+	markDirty(top, bottom);
+	const std::span<const uint8_t> userFont = _display.getFont();
+	const bool userInvert = _display.getInvertFont();
+	DisplayRet::Ret_Codes_e result = _display.setFont(_font);
+	if (result != DisplayRet::Success)
+	{
+		displaylib_diag::error(displaylib_diag::FuncListView, result);
+		return result;
+	}
+	const int32_t first = (top - _y + _scroll) / _rowHeight;
+	const int32_t last = (bottom - 1 - _y + _scroll) / _rowHeight;
+	for (int32_t row = first; row <= last && row < _rows; row++)
+	{
+		drawRow(buffer, static_cast<uint16_t>(row), top, bottom);
+		if (row == _selected)
+			bandInvert(buffer, _selected, top, bottom);
+	}
+	_display.setFont(userFont);
+	_display.setInvertFont(userInvert);
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Draws the text of a row, clipped to a band of screen rows and the list width
+	@param buffer the screen buffer, the band cleared
+	@param row the row
+	@param top first screen row to draw
+	@param bottom screen row below
+	@note The font of the list is set on the display by the caller.
+*/
+void displaylib_list_view::drawRow(std::span<uint8_t> buffer, uint16_t row, int16_t top, int16_t bottom)
+{
+	char text[LIST_TEXT_MAX];
+	const uint8_t length = std::min<uint8_t>(_provider(row, std::span<char>(text), _context), LIST_TEXT_MAX);
+	const std::string_view view(text, length);
+	const int32_t rowTop = _y + (static_cast<int32_t>(row) * _rowHeight) - _scroll;
+	const int16_t right = _x + _w;
+	const uint8_t height = _display._Font_Y_Size;
+	int16_t x = _x + LIST_TEXT_INSET;
+	size_t pos = 0;
+	while (pos < view.size() && x < right)
+	{
+		const char32_t codePoint = _display.textDecode(view, pos);
+		const int16_t glyph = _display.fontGlyph(codePoint);
+		if (glyph < 0)
+			continue;
+		const uint32_t index = _display.fontGlyphIndex(glyph);
+		const uint8_t glyphWidth = _display.fontGlyphWidth(glyph);
+		for (uint8_t col = 0; col < glyphWidth && x + col < right; col++)
+		{
+			const uint64_t bits = glyphColumn(index, col);
+			for (uint8_t bit = 0; bit < height; bit++)
+			{
+				const int32_t y = rowTop + bit;
+				if (y < top)
+					continue;
+				if (y >= bottom)
+					break;
+				if ((bits >> bit) & 1)
+					buffer[((y >> 3) * _display.WIDTH) + x + col] |= static_cast<uint8_t>(1U << (y & 7));
+			}
+		}
+		x = static_cast<int16_t>(x + _display.getCodePointWidth(codePoint));
+	}
+}
+
+/*!
+	@brief One column of a glyph of the font set on the display
+	@param index start of the glyph in the font data
+	@param column the column
+	@return the pixels, bit 0 top
+	@details Fonts a multiple of 8 high are stored a page of columns at a time,
+		other heights as a bit stream, column by column, most significant bit first.
+*/
+uint64_t displaylib_list_view::glyphColumn(uint32_t index, uint8_t column) const
+{
+	const std::span<const uint8_t> font = _display._FontSelect;
+	const uint8_t width = _display._Font_X_Size;
+	const uint8_t height = _display._Font_Y_Size;
+	uint64_t bits = 0;
+	if (height % 8 == 0)
+	{
+		for (uint8_t page = 0; page < height / 8; page++)
+		{
+			const uint32_t at = index + column + (page * width);
+			if (at < font.size())
+				bits |= static_cast<uint64_t>(font[at]) << (page * 8);
+		}
+		return bits;
+	}
+	const uint32_t start = static_cast<uint32_t>(column) * height;
+	for (uint8_t bit = 0; bit < height; bit++)
+	{
+		const uint32_t at = index + ((start + bit) >> 3);
+		if (at < font.size() && (font[at] & (0x80 >> ((start + bit) & 7))))
+			bits |= static_cast<uint64_t>(1) << bit;
+	}
+	return bits;
+}
+
+/*!
+	@brief Grows the dirty band to hold a band of screen rows
+	@param top first screen row
+	@param bottom screen row below
+*/
+void displaylib_list_view::markDirty(int16_t top, int16_t bottom)
+{
+	if (!getDirty())
+	{
+		_dirtyTop = top;
+		_dirtyBottom = bottom;
+		return;
+	}
+	_dirtyTop = std::min(_dirtyTop, top);
+	_dirtyBottom = std::max(_dirtyBottom, bottom);
+}
@@ -0,0 +1,324 @@
+/*!
+	@file display_manager.cpp
+	@brief Source file for the multi panel manager
+	@author Gavin Lyons.
+*/
+
+#include <utility>
+#include "pico/stdlib.h"
+#include "../../include/displaylib/display_manager.hpp"
+#include "../../include/displaylib/display_diag.hpp"
+
+/*!
+	@brief init the manager
+	@param policy how the bus budget is shared between panels on one bus
+*/
+displaylib_manager::displaylib_manager(manager_policy_e policy) : _policy(policy)
+{
+	_statsStartUs = time_us_64();
+}
+
+/*!
+	@brief Adds a display, the panel number is the number of panels added before it
+	@param display the display driver object, begin/init already called
+	@param bus bus number, 0 to MANAGER_BUSES_MAX-1, the same for displays sharing a bus
+	@param priority weight for PolicyPriority, 1 to 255, 0 is taken as 1
+	@return Success, or GenericError if MANAGER_PANELS_MAX panels added or bus out of range
+*/
+DisplayRet::Ret_Codes_e displaylib_manager::panelAdd(displaylib_flush &display, uint8_t bus, uint8_t priority)
+{
+	if (_panelCount >= MANAGER_PANELS_MAX || bus >= MANAGER_BUSES_MAX)
+	{
+		displaylib_diag::error(displaylib_diag::FuncManager, DisplayRet::GenericError, _panelCount, bus);
+		return DisplayRet::GenericError;
+	}
+	manager_panel_t &panel = _panels[_panelCount++];
+	panel = manager_panel_t{};
+	panel.display = &display;
+	panel.bus = bus;
+	panel.priority = (priority == 0) ? 1 : priority;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Number of panels added
+	@return panels
+*/
+uint8_t displaylib_manager::getPanelCount(void) const
+{
+	return _panelCount;
+}
+
+/*!
+	@brief Starts sending the screen buffer of a panel, sent by managerStep
+	@param panel panel number
+	@return Success, GenericError bad panel, or the error code of updateBegin
+	@note If the last frame is still being sent the submit is merged, the panel
+		is sent again from the top when the frame in progress is done.
+*/
+DisplayRet::Ret_Codes_e displaylib_manager::panelSubmit(uint8_t panel)
+{
+	if (panel >= _panelCount)
+	{
+		displaylib_diag::error(displaylib_diag::FuncManager, DisplayRet::GenericError, panel);
+		return DisplayRet::GenericError;
+	}
+	return panelSubmit(panel, _panels[panel].display->updateFrameRect());
+}
+
+/*!
+	@brief Starts sending a rectangle of the screen buffer of a panel, sent by managerStep
+	@param panel panel number
+	@param rect the rectangle, buffer co-ordinates, e.g. getDirtyRect of a widget
+	@return Success, also for an empty rectangle, nothing is then sent,
+		GenericError bad panel, or the error code of updateBegin
+	@note If the last frame is still being sent the submit is merged, the
+		rectangles of the merged submits are joined and sent when the frame in
+		progress is done.
+*/
+DisplayRet::Ret_Codes_e displaylib_manager::panelSubmit(uint8_t panel, const displaylib_flush::flush_rect_t &rect)
+{
+	if (panel >= _panelCount)
+	{
+		displaylib_diag::error(displaylib_diag::FuncManager, DisplayRet::GenericError, panel);
+		return DisplayRet::GenericError;
+	}
+	if (rect.w <= 0 || rect.h <= 0)
+		return DisplayRet::Success;
+	manager_panel_t &entry = _panels[panel];
+	if (entry.pending)
+	{
+		if (!entry.again)
+		{
+			entry.againUs = time_us_64();
+			entry.againRect = displaylib_flush::flush_rect_t{};
+		}
+		entry.again = true;
+		entry.againRect = displaylib_flush::rectMerge(entry.againRect, rect);
+		entry.stats.framesMerged++;
+		return DisplayRet::Success;
+	}
+	DisplayRet::Ret_Codes_e result = entry.display->updateBegin(rect);
+	if (result != DisplayRet::Success || !entry.display->updateBusy())
+		return result; // error, or the rectangle is off screen
+	entry.pending = true;
+	entry.submitUs = time_us_64();
+	entry.stats.framesSubmitted++;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Abandons the frame in progress of a panel, and any merged submit
+	@param panel panel number
+*/
+void displaylib_manager::panelCancel(uint8_t panel)
+{
+	if (panel >= _panelCount || !_panels[panel].pending)
+		return;
+	_panels[panel].display->updateCancel();
+	_panels[panel].pending = false;
+	_panels[panel].again = false;
+	_panels[panel].skipped = false;
+}
+
+/*!
+	@brief Is a frame of a panel pending
+	@param panel panel number
+	@return true if being sent
+*/
+bool displaylib_manager::panelBusy(uint8_t panel) const
+{
+	return (panel < _panelCount) && _panels[panel].pending;
+}
+
+/*!
+	@brief Sends part of the pending frames, call once per main loop pass
+	@return number of panels still pending
+	@details Bus by bus, the pending panels on the bus are ordered, panels that got
+		no time last step first, then by turn or priority. Each gets a share of
+		the bus time left, the time left divided by the weight of the panels not
+		yet served, so time a panel does not use passes to the next. updateStep
+		sends at least one chunk, so once the budget is used up the remaining
+		panels are skipped and go first next step.
+*/
+uint8_t displaylib_manager::managerStep(void)
+{
+	uint8_t pendingCount = 0;
+	for (uint8_t bus = 0; bus < MANAGER_BUSES_MAX; bus++)
+	{
+		uint8_t order[MANAGER_PANELS_MAX];
+		uint8_t count = 0;
+		for (uint8_t index = 0; index < _panelCount; index++)
+			if (_panels[index].pending && _panels[index].bus == bus)
+				order[count++] = index;
+		if (count == 0)
+			continue;
+
+		// order: skipped panels first, then round robin turn or priority, stable sort
+		const uint8_t turn = _busTurn[bus]++ % count;
+		uint8_t rank[MANAGER_PANELS_MAX];
+		for (uint8_t index = 0; index < count; index++)
+			rank[index] = (_policy == PolicyPriority) ? (255 - _panels[order[index]].priority) :
+				((index + count - turn) % count);
+		for (uint8_t index = 1; index < count; index++)
+		{
+			for (uint8_t back = index; back > 0; back--)
+			{
+				const manager_panel_t &before = _panels[order[back - 1]];
+				const manager_panel_t &after = _panels[order[back]];
+				const bool swap = (after.skipped && !before.skipped) ||
+					(after.skipped == before.skipped && rank[back] < rank[back - 1]);
+				if (!swap)
+					break;
+				std::swap(order[back], order[back - 1]);
+				std::swap(rank[back], rank[back - 1]);
+			}
+		}
+
+		const uint32_t budgetUs = _busBudgetUs[bus];
+		uint32_t remainingUs = budgetUs;
+		uint32_t weightLeft = 0;
+		for (uint8_t index = 0; index < count; index++)
+			weightLeft += (_policy == PolicyPriority) ? _panels[order[index]].priority : 1;
+		for (uint8_t index = 0; index < count; index++)
+		{
+			manager_panel_t &panel = _panels[order[index]];
+			const uint8_t weight = (_policy == PolicyPriority) ? panel.priority : 1;
+			if (budgetUs != 0 && remainingUs == 0)
+			{
+				panel.skipped = true;
+				panel.stats.stepsSkipped++;
+				continue;
+			}
+			uint32_t shareUs = 0; // 0, no budget, sends the whole frame
+			if (budgetUs != 0)
+			{
+				shareUs = static_cast<uint32_t>((static_cast<uint64_t>(remainingUs) * weight) / weightLeft);
+				if (shareUs == 0)
+					shareUs = 1;
+			}
+			weightLeft -= weight;
+			const uint64_t startUs = time_us_64();
+			stepPanel(panel, shareUs);
+			const uint32_t usedUs = static_cast<uint32_t>(time_us_64() - startUs);
+			panel.skipped = false;
+			remainingUs = (usedUs >= remainingUs) ? 0 : remainingUs - usedUs;
+		}
+		for (uint8_t index = 0; index < count; index++)
+			if (_panels[order[index]].pending)
+				pendingCount++;
+	}
+	return pendingCount;
+}
+
+/*!
+	@brief Is any frame pending
+	@return true if managerStep has work to do
+*/
+bool displaylib_manager::managerBusy(void) const
+{
+	for (uint8_t index = 0; index < _panelCount; index++)
+		if (_panels[index].pending)
+			return true;
+	return false;
+}
+
+/*!
+	@brief Sets how the bus budget is shared between panels on one bus
+	@param policy the policy
+*/
+void displaylib_manager::setPolicy(manager_policy_e policy)
+{
+	_policy = policy;
+}
+
+/*!
+	@brief Sets the bus time per managerStep of a bus
+	@param bus bus number
+	@param budgetUs uS, 0 to send all pending frames in each step
+*/
+void displaylib_manager::setBusBudget(uint8_t bus, uint32_t budgetUs)
+{
+	if (bus < MANAGER_BUSES_MAX)
+		_busBudgetUs[bus] = budgetUs;
+}
+
+/*!
+	@brief Counters of a panel
+	@param panel panel number, an invalid number gives the counters of panel 0
+	@return the counters
+*/
+const displaylib_manager::panel_stats_t &displaylib_manager::getPanelStats(uint8_t panel) const
+{
+	return _panels[(panel < _panelCount) ? panel : 0].stats;
+}
+
+/*!
+	@brief Frames per second sent to a panel since resetStats or the manager was made
+	@param panel panel number
+	@return frames per second, 0 if invalid
+*/
+float displaylib_manager::getPanelFps(uint8_t panel) const
+{
+	const uint64_t elapsedUs = time_us_64() - _statsStartUs;
+	if (panel >= _panelCount || elapsedUs == 0)
+		return 0.0f;
+	return (_panels[panel].stats.framesFlushed * 1000000.0f) / static_cast<float>(elapsedUs);
+}
+
+/*!
+	@brief Clears the counters of all panels and starts a new fps period
+*/
+void displaylib_manager::resetStats(void)
+{
+	for (uint8_t index = 0; index < _panelCount; index++)
+		_panels[index].stats = panel_stats_t{};
+	_statsStartUs = time_us_64();
+}
+
+/*!
+	@brief Sends part of the frame of one panel and updates its counters
+	@param panel the panel
+	@param budgetUs budget for updateStep, 0 whole frame
+*/
+void displaylib_manager::stepPanel(manager_panel_t &panel, uint32_t budgetUs)
+{
+	const uint64_t startUs = time_us_64();
+	const displaylib_flush::flush_state_e state = panel.display->updateStep(budgetUs);
+	const uint64_t nowUs = time_us_64();
+	panel.stats.busUs += static_cast<uint32_t>(nowUs - startUs);
+	switch (state)
+	{
+	case displaylib_flush::FlushBusy:
+		return;
+	case displaylib_flush::FlushDone:
+	{
+		const uint32_t latencyUs = static_cast<uint32_t>(nowUs - panel.submitUs);
+		panel.stats.latencyLastUs = latencyUs;
+		if (latencyUs > panel.stats.latencyMaxUs)
+			panel.stats.latencyMaxUs = latencyUs;
+		// running average, weight of 1/8 for newest frame
+		panel.stats.latencyAvgUs = (panel.stats.framesFlushed == 0) ? latencyUs :
+			panel.stats.latencyAvgUs - (panel.stats.latencyAvgUs >> 3) + (latencyUs >> 3);
+		panel.stats.framesFlushed++;
+		break;
+	}
+	case displaylib_flush::FlushError:
+		panel.stats.flushErrors++;
+		break;
+	default: // FlushIdle, cancelled outside the manager
+		break;
+	}
+	panel.pending = false;
+	if (panel.again && state != displaylib_flush::FlushIdle)
+	{
+		panel.again = false;
+		if (panel.display->updateBegin(panel.againRect) == DisplayRet::Success && panel.display->updateBusy())
+		{
+			panel.pending = true;
+			panel.submitUs = panel.againUs;
+			panel.stats.framesSubmitted++;
+		}
+	}
+	panel.again = false;
+}
@@ -0,0 +1,332 @@
+/*!
+	@file display_numeric.cpp
+	@brief Source file for the numeric readout widget
+	@author Gavin Lyons.
+*/
+
+#include "pico/stdlib.h"
+#include "../../include/displaylib/display_numeric.hpp"
+#include "../../include/displaylib/display_diag.hpp"
+
+/*!
+	@brief init the numeric field object
+	@param display the display driver object to draw to
+	@param x left of the field
+	@param y top of the field
+	@param width characters in the field, 1 to FIELD_WIDTH_MAX
+	@param font the font of the field
+	@note Nothing is drawn until setValue or setText is called.
+*/
+displaylib_numeric_field::displaylib_numeric_field(displaylib_graphics &display, int16_t x, int16_t y,
+	uint8_t width, std::span<const uint8_t> font) : _display(display), _font(font), _x(x), _y(y), _width(width)
+{
+	if (_width == 0 || _width > FIELD_WIDTH_MAX)
+	{
+		displaylib_diag::warning(displaylib_diag::FuncNumericField, DisplayRet::GenericError, width, FIELD_WIDTH_MAX);
+		_width = (_width == 0) ? 1 : FIELD_WIDTH_MAX;
+	}
+}
+
+/*!
+	@brief Sets how setValue formats the value
+	@param decimals digits after the decimal point, 0 to FIELD_DECIMALS_MAX,
+		the value passed to setValue is scaled by 10^decimals, e.g. 2 shows 1234 as 12.34
+	@param pad padding left of the digits, spaces or leading zeros
+	@param plusSign true to show a + for positive values
+*/
+void displaylib_numeric_field::setFormat(uint8_t decimals, numeric_pad_e pad, bool plusSign)
+{
+	if (decimals > FIELD_DECIMALS_MAX)
+	{
+		displaylib_diag::warning(displaylib_diag::FuncNumericField, DisplayRet::GenericError, decimals, FIELD_DECIMALS_MAX);
+		decimals = FIELD_DECIMALS_MAX;
+	}
+	_decimals = decimals;
+	_pad = pad;
+	_plusSign = plusSign;
+}
+
+/*!
+	@brief Sets the text scale of the field, see displaylib_graphics::setTextScale
+	@param scaleX scale factor x-axis 1 to TEXT_SCALE_MAX
+	@param scaleY scale factor y-axis 1 to TEXT_SCALE_MAX
+	@note The whole field is redrawn by the next setValue or setText.
+*/
+void displaylib_numeric_field::setFieldScale(uint8_t scaleX, uint8_t scaleY)
+{
+	if (scaleX < 1 || scaleX > displaylib_graphics::TEXT_SCALE_MAX ||
+		scaleY < 1 || scaleY > displaylib_graphics::TEXT_SCALE_MAX)
+	{
+		displaylib_diag::warning(displaylib_diag::FuncNumericField, DisplayRet::GenericError, scaleX, scaleY);
+		scaleX = 1;
+		scaleY = 1;
+	}
+	_scaleX = scaleX;
+	_scaleY = scaleY;
+	_valid = false;
+}
+
+/*!
+	@brief Formats a value and draws the cells that changed
+	@param value the value, scaled by 10^decimals, see setFormat
+	@return Will return
+		-# Success
+		-# FontDataEmpty or FontDataTooSmall bad font data
+		-# the error code of writeChar, the cell is drawn again next call
+*/
+DisplayRet::Ret_Codes_e displaylib_numeric_field::setValue(int32_t value)
+{
+	char text[FIELD_WIDTH_MAX];
+	formatValue(value, text);
+	return render(text);
+}
+
+/*!
+	@brief Draws text in the field, left aligned, and redraws the cells that changed
+	@param text the text, padded with spaces or cut to the field width
+	@return as setValue
+	@note For readouts such as a clock, "12:04:59", one field is cheaper than three.
+*/
+DisplayRet::Ret_Codes_e displaylib_numeric_field::setText(std::string_view text)
+{
+	char cells[FIELD_WIDTH_MAX];
+	for (uint8_t cell = 0; cell < _width; cell++)
+		cells[cell] = (cell < text.size()) ? text[cell] : ' ';
+	return render(cells);
+}
+
+/*!
+	@brief Forgets the cached characters, the next setValue or setText redraws every cell
+	@note Call after the screen buffer was cleared or drawn over.
+*/
+void displaylib_numeric_field::invalidate(void)
+{
+	_valid = false;
+}
+
+/*!
+	@brief Cells drawn since the last flushDirty or clearDirty
+	@return mask, bit 0 is the leftmost cell
+*/
+uint16_t displaylib_numeric_field::getDirtyCells(void) const
+{
+	return _dirty;
+}
+
+/*!
+	@brief Have cells been drawn since the last flushDirty or clearDirty
+	@return true if the dirty cells need sending
+*/
+bool displaylib_numeric_field::getDirty(void) const
+{
+	return _dirty != 0;
+}
+
+/*!
+	@brief Smallest rectangle holding the dirty cells
+	@return the rectangle in buffer co-ordinates, turned for the current
+		rotation, ready for updateRegion, empty if nothing is dirty
+*/
+displaylib_flush::flush_rect_t displaylib_numeric_field::getDirtyRect(void) const
+{
+	if (_dirty == 0)
+		return displaylib_flush::flush_rect_t{};
+	uint8_t first = 0;
+	while (!(_dirty & (1 << first)))
+		first++;
+	uint8_t last = _width - 1;
+	while (!(_dirty & (1 << last)))
+		last--;
+	// the cells in screen co-ordinates, as rotated
+	const int16_t x = _x + (first * getCellWidth());
+	const int16_t y = _y;
+	const int16_t w = (last - first + 1) * getCellWidth();
+	const int16_t h = getCellHeight();
+	switch (_display.getRotation())
+	{
+	case displaylib_graphics::rDegrees_90: // buffer x = width - 1 - y, buffer y = x
+		return displaylib_flush::flush_rect_t{static_cast<int16_t>(_display.height() - y - h), x, h, w};
+	case displaylib_graphics::rDegrees_180:
+		return displaylib_flush::flush_rect_t{static_cast<int16_t>(_display.width() - x - w),
+			static_cast<int16_t>(_display.height() - y - h), w, h};
+	case displaylib_graphics::rDegrees_270: // buffer x = y, buffer y = height - 1 - x
+		return displaylib_flush::flush_rect_t{y, static_cast<int16_t>(_display.width() - x - w), h, w};
+	default:
+		return displaylib_flush::flush_rect_t{x, y, w, h};
+	}
+}
+
+/*!
+	@brief Clears the dirty cell mask, the cells are not sent
+*/
+void displaylib_numeric_field::clearDirty(void)
+{
+	_dirty = 0;
+}
+
+/*!
+	@brief Sends the dirty cells from the screen buffer to the display
+	@param display the display driver object, the same object drawn to
+	@return Success, or the error code of displaylib_flush::updateRegion
+	@note The cells stay dirty on error.
+*/
+DisplayRet::Ret_Codes_e displaylib_numeric_field::flushDirty(displaylib_flush &display)
+{
+	if (_dirty == 0)
+		return DisplayRet::Success;
+	DisplayRet::Ret_Codes_e result = display.updateRegion(getDirtyRect());
+	if (result == DisplayRet::Success)
+		_dirty = 0;
+	return result;
+}
+
+/*!
+	@brief Characters in the field
+	@return width in characters
+*/
+uint8_t displaylib_numeric_field::getFieldWidth(void) const
+{
+	return _width;
+}
+
+/*!
+	@brief Width of one character cell
+	@return pixels, font width times x scale
+*/
+int16_t displaylib_numeric_field::getCellWidth(void) const
+{
+	if (_font.size() < 5)
+		return 0;
+	return ((_font[0] == 0) ? _font[1] : _font[0]) * _scaleX; // remapped font header starts 0
+}
+
+/*!
+	@brief Height of one character cell
+	@return pixels, font height times y scale
+*/
+int16_t displaylib_numeric_field::getCellHeight(void) const
+{
+	if (_font.size() < 5)
+		return 0;
+	return ((_font[0] == 0) ? _font[2] : _font[1]) * _scaleY;
+}
+
+/*!
+	@brief Formats a value right aligned into the field width
+	@param value the value, scaled by 10^decimals
+	@param text returns the characters, _width of them, not terminated
+	@return number of characters used by sign and digits, 0 if the value did not fit
+*/
+uint8_t displaylib_numeric_field::formatValue(int32_t value, char *text) const
+{
+	char digits[FIELD_DECIMALS_MAX + 2]; // least significant first
+	uint8_t count = 0;
+	uint32_t magnitude = (value < 0) ? (0U - static_cast<uint32_t>(value)) : static_cast<uint32_t>(value);
+	do
+	{
+		digits[count++] = static_cast<char>('0' + (magnitude % 10));
+		magnitude /= 10;
+	} while (magnitude != 0 || count <= _decimals); // at least one digit before the point
+	const char sign = (value < 0) ? '-' : (_plusSign ? '+' : '\0');
+	const uint8_t length = count + (_decimals ? 1 : 0) + (sign ? 1 : 0);
+	if (length > _width)
+	{
+		for (uint8_t cell = 0; cell < _width; cell++)
+			text[cell] = '-';
+		return 0;
+	}
+	uint8_t pos = _width;
+	for (uint8_t digit = 0; digit < count; digit++)
+	{
+		if (_decimals != 0 && digit == _decimals)
+			text[--pos] = '.';
+		text[--pos] = digits[digit];
+	}
+	if (_pad == PadZero)
+	{
+		while (pos > (sign ? 1 : 0))
+			text[--pos] = '0';
+	}
+	else if (sign)
+	{
+		text[--pos] = sign;
+	}
+	while (pos > 0)
+		text[--pos] = ' ';
+	if (sign && _pad == PadZero)
+		text[0] = sign;
+	return length;
+}
+
+/*!
+	@brief Draws the cells whose character differs from the cache
+	@param text the new characters, _width of them
+	@return Success or an error code, see setValue
+	@note The font, its invert flag and the text scale of the display are restored after.
+*/
+DisplayRet::Ret_Codes_e displaylib_numeric_field::render(const char *text)
+{
+	uint16_t changed = 0;
+	for (uint8_t cell = 0; cell < _width; cell++)
+	{
+		if (!_valid || text[cell] != _last[cell])
+			changed |= (1 << cell);
+	}
+	if (changed == 0)
+		return DisplayRet::Success;
+
+	const std::span<const uint8_t> userFont = _display.getFont();
+	const bool userInvert = _display.getInvertFont();
+	const uint8_t userScaleX = _display.getTextScaleX();
+	const uint8_t userScaleY = _display.getTextScaleY();
+	DisplayRet::Ret_Codes_e result = _display.setFont(_font);
+	if (result != DisplayRet::Success)
+	{
+		displaylib_diag::error(displaylib_diag::FuncNumericField, result);
+		return result;
+	}
+	_display.setTextScale(_scaleX, _scaleY);
+	for (uint8_t cell = 0; cell < _width; cell++)
+	{
+		if (!(changed & (1 << cell)))
+			continue;
+		DisplayRet::Ret_Codes_e cellResult = drawCell(cell, text[cell]);
+		if (cellResult == DisplayRet::Success)
+		{
+			_last[cell] = text[cell];
+		}
+		else
+		{
+			_last[cell] = '\0'; // draw again next time
+			result = cellResult;
+		}
+		_dirty |= (1 << cell);
+	}
+	_valid = true;
+	_display.setFont(userFont);
+	_display.setInvertFont(userInvert);
+	_display.setTextScale(userScaleX, userScaleY);
+	return result;
+}
+
+/*!
+	@brief Draws one character cell
+	@param cell cell number, 0 leftmost
+	@param character the character
+	@return Success or the error code of writeChar
+	@note A space the font does not hold is drawn as a cleared cell, as are
+		the columns right of a narrow glyph of a proportional font.
+*/
+DisplayRet::Ret_Codes_e displaylib_numeric_field::drawCell(uint8_t cell, char character)
+{
+	const int16_t cellX = _x + (cell * getCellWidth());
+	const int16_t glyphWidth = _display.getCharWidth(character) * _scaleX; // font set by the caller
+	if (character == ' ' && glyphWidth == 0)
+	{
+		_display.fillRect(cellX, _y, getCellWidth(), getCellHeight(), displaylib_graphics::BG_COLOR);
+		return DisplayRet::Success;
+	}
+	if (glyphWidth > 0 && glyphWidth < getCellWidth())
+		_display.fillRect(cellX + glyphWidth, _y, getCellWidth() - glyphWidth, getCellHeight(), displaylib_graphics::BG_COLOR);
+	return _display.writeChar(cellX, _y, character);
+}
@@ -0,0 +1,404 @@
+/*!
+	@file display_pipeline.cpp
+	@brief Source file for the dual core render and flush pipeline
+	@author Gavin Lyons.
+*/
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#if PICO_ON_DEVICE
+#include "pico/multicore.h"
+#endif
+#include "../../include/displaylib/display_pipeline.hpp"
+#include "../../include/displaylib/display_diag.hpp"
+
+// *** displaylib_slot_queue ***
+
+/*!
+	@brief Add a slot number to the queue, producer side only
+	@param slot the slot number
+	@return false if the queue is full
+*/
+bool displaylib_slot_queue::push(uint8_t slot)
+{
+	const uint8_t head = _head.load(std::memory_order_relaxed);
+	if (static_cast<uint8_t>(head - _tail.load(std::memory_order_acquire)) >= CAPACITY)
+		return false;
+	_entries[head & (CAPACITY - 1)] = slot;
+	_head.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+/*!
+	@brief Remove the oldest slot number from the queue, consumer side only
+	@param slot returns the slot number
+	@return false if the queue is empty
+*/
+bool displaylib_slot_queue::pop(uint8_t &slot)
+{
+	const uint8_t tail = _tail.load(std::memory_order_relaxed);
+	if (tail == _head.load(std::memory_order_acquire))
+		return false;
+	slot = _entries[tail & (CAPACITY - 1)];
+	_tail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+/*!
+	@brief Number of entries in the queue
+	@return entries, exact on the consumer side, may be stale elsewhere
+*/
+uint8_t displaylib_slot_queue::count(void) const
+{
+	return static_cast<uint8_t>(_head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire));
+}
+
+/*!
+	@brief Empty the queue, only call when neither side is in use
+*/
+void displaylib_slot_queue::clear(void)
+{
+	_head.store(0, std::memory_order_relaxed);
+	_tail.store(0, std::memory_order_relaxed);
+}
+
+// *** displaylib_pipeline ***
+
+#if PICO_ON_DEVICE
+displaylib_pipeline *displaylib_pipeline::_core1Pipeline = nullptr;
+#endif
+
+/*!
+	@brief init the pipeline class object
+	@param display the display driver object frames are sent to
+*/
+displaylib_pipeline::displaylib_pipeline(displaylib_flush &display) : _display(display)
+{
+}
+
+/*!
+	@brief Stops the worker if still running
+*/
+displaylib_pipeline::~displaylib_pipeline()
+{
+	pipelineStop();
+}
+
+/*!
+	@brief Starts the flush worker on core1 (a thread on host builds)
+	@param slotStorage user storage for the frame slots, at least slots * width * (height/8) bytes
+	@param slots number of frame slots PIPELINE_SLOTS_MIN to PIPELINE_SLOTS_MAX,
+		one is being sent while the others are rendered or queued, PolicyDropOldest
+		needs 3 or more for core0 not to wait for a whole frame, see frameAcquire
+	@param policy what to do when core0 renders faster than core1 can flush
+	@return Will return
+		-# Success
+		-# BufferEmpty slotStorage is an empty object
+		-# BufferSize slotStorage too small for the number of slots
+		-# GenericError slots out of range
+	@note If running the pipeline is stopped and restarted. Core1 must be free.
+*/
+DisplayRet::Ret_Codes_e displaylib_pipeline::pipelineStart(std::span<uint8_t> slotStorage, uint8_t slots, pipeline_policy_e policy)
+{
+	pipelineStop();
+	if (slotStorage.empty())
+	{
+		displaylib_diag::error(displaylib_diag::FuncPipelineStart, DisplayRet::BufferEmpty);
+		return DisplayRet::BufferEmpty;
+	}
+	if (slots < PIPELINE_SLOTS_MIN || slots > PIPELINE_SLOTS_MAX)
+	{
+		displaylib_diag::error(displaylib_diag::FuncPipelineStart, DisplayRet::GenericError, slots);
+		return DisplayRet::GenericError;
+	}
+	const uint16_t frameSize = _display.updateBytesTotal();
+	if (slotStorage.size() < static_cast<size_t>(frameSize * slots))
+	{
+		displaylib_diag::error(displaylib_diag::FuncPipelineStart, DisplayRet::BufferSize, static_cast<int16_t>(slotStorage.size()), slots);
+		return DisplayRet::BufferSize;
+	}
+	_slotStorage = slotStorage;
+	_frameSize = frameSize;
+	_slots = slots;
+	_policy = policy;
+	_renderSlot = -1;
+	_readyQueue.clear();
+	_freeQueue.clear();
+	for (uint8_t slot = 0; slot < _slots; slot++)
+		_freeQueue.push(slot);
+	resetStats();
+	_resetRequest = false;
+	_framesFlushed = 0;
+	_framesDropped = 0;
+	_flushErrors = 0;
+	_latencyLastUs = 0;
+	_latencyMaxUs = 0;
+	_latencyAvgUs = 0;
+
+	_running = true;
+	_workerActive = true;
+#if PICO_ON_DEVICE
+	_core1Pipeline = this;
+	multicore_reset_core1();
+	multicore_launch_core1(core1Entry);
+#else
+	_workerThread = std::thread(&displaylib_pipeline::worker, this);
+#endif
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Stops the flush worker, a frame being sent is cancelled
+	@note Blocks until the worker has exited, frames still queued are discarded
+*/
+void displaylib_pipeline::pipelineStop(void)
+{
+	if (!_running)
+		return;
+	_running = false;
+	wakeWorker();
+#if PICO_ON_DEVICE
+	while (_workerActive)
+		tight_loop_contents();
+	multicore_reset_core1();
+	_core1Pipeline = nullptr;
+#else
+	if (_workerThread.joinable())
+		_workerThread.join();
+#endif
+}
+
+/*!
+	@brief Is the flush worker running
+	@return true if running
+*/
+bool displaylib_pipeline::pipelineRunning(void) const
+{
+	return _running;
+}
+
+/*!
+	@brief Gets a free frame slot for core0 to render into
+	@return span of the slot, w * (h/8) bytes, empty if the pipeline is not running
+	@details Point the driver buffer at the slot before drawing. If every slot
+		is in use this waits until core1 finishes the frame it is sending. With
+		PolicyDropOldest and 3 or more slots at least two frames are then queued,
+		core1 drops the older after its current chunk, so the wait is one chunk.
+		With 2 slots one is being sent and one queued, nothing can be dropped,
+		the wait is the rest of the frame as with PolicyBlock.
+		Calling again before frameSubmit returns the same slot.
+	@note The slot content is the frame rendered in it before, not cleared.
+*/
+std::span<uint8_t> displaylib_pipeline::frameAcquire(void)
+{
+	if (!_running)
+		return {};
+	if (_renderSlot < 0)
+	{
+		uint8_t slot;
+		if (!_freeQueue.pop(slot))
+		{
+			const uint64_t waitStartUs = time_us_64();
+			while (!_freeQueue.pop(slot))
+			{
+				if (!_running)
+					return {};
+				tight_loop_contents();
+			}
+			_acquireWaitUs += static_cast<uint32_t>(time_us_64() - waitStartUs);
+		}
+		_renderSlot = slot;
+	}
+	return _slotStorage.subspan(_renderSlot * _frameSize, _frameSize);
+}
+
+/*!
+	@brief Hands the slot got by frameAcquire to core1 to be sent to the display
+	@return Success or PipelineState if not running or no slot was acquired
+*/
+DisplayRet::Ret_Codes_e displaylib_pipeline::frameSubmit(void)
+{
+	if (!_running || _renderSlot < 0)
+	{
+		displaylib_diag::error(displaylib_diag::FuncFrameSubmit, DisplayRet::PipelineState, _renderSlot);
+		return DisplayRet::PipelineState;
+	}
+	_slotSubmitUs[_renderSlot] = time_us_64();
+	_readyQueue.push(static_cast<uint8_t>(_renderSlot)); // never full, queue holds every slot
+	_renderSlot = -1;
+	_framesSubmitted++;
+	wakeWorker();
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Has core1 sent every submitted frame
+	@return true if no frame is queued or being sent
+*/
+bool displaylib_pipeline::pipelineIdle(void) const
+{
+	return _readyQueue.count() == 0 && !_workerBusy;
+}
+
+/*!
+	@brief Sets the time budget core1 passes to each updateStep
+	@param budgetUs budget in microseconds, zero sends the frame in one step
+	@note With PolicyDropOldest stale frames are only dropped between steps,
+		so this sets the longest core0 waits in frameAcquire.
+*/
+void displaylib_pipeline::setStepBudget(uint32_t budgetUs)
+{
+	_stepBudgetUs = budgetUs;
+}
+
+/*!
+	@brief Gets the pipeline counters
+	@return copy of the counters
+	@note Frames per second = framesFlushed * 1000000 / elapsedUs
+*/
+displaylib_pipeline::pipeline_stats_t displaylib_pipeline::getStats(void) const
+{
+	pipeline_stats_t stats;
+	stats.framesSubmitted = _framesSubmitted;
+	stats.framesFlushed = _framesFlushed;
+	stats.framesDropped = _framesDropped;
+	stats.flushErrors = _flushErrors;
+	stats.latencyLastUs = _latencyLastUs;
+	stats.latencyMaxUs = _latencyMaxUs;
+	stats.latencyAvgUs = _latencyAvgUs;
+	stats.acquireWaitUs = _acquireWaitUs;
+	stats.elapsedUs = static_cast<uint32_t>(time_us_64() - _statsStartUs);
+	return stats;
+}
+
+/*!
+	@brief Zeros the pipeline counters
+	@note The core1 counters are zeroed by core1 before its next frame.
+*/
+void displaylib_pipeline::resetStats(void)
+{
+	_framesSubmitted = 0;
+	_acquireWaitUs = 0;
+	_statsStartUs = time_us_64();
+	_resetRequest = true;
+}
+
+/*!
+	@brief Flush worker loop, run on core1, sends queued frames until stopped
+*/
+void displaylib_pipeline::worker(void)
+{
+	while (_running)
+	{
+		if (_resetRequest)
+		{
+			_framesFlushed = 0;
+			_framesDropped = 0;
+			_flushErrors = 0;
+			_latencyLastUs = 0;
+			_latencyMaxUs = 0;
+			_latencyAvgUs = 0;
+			_resetRequest = false;
+		}
+		_workerBusy = true;
+		uint8_t slot;
+		if (!_readyQueue.pop(slot))
+		{
+			_workerBusy = false;
+			workerWait();
+			continue;
+		}
+		if (_policy == PolicyDropOldest)
+		{
+			uint8_t newerSlot;
+			while (_readyQueue.pop(newerSlot))
+			{
+				_freeQueue.push(slot);
+				_framesDropped = _framesDropped + 1;
+				slot = newerSlot;
+			}
+		}
+
+		displaylib_flush::flush_state_e state = displaylib_flush::FlushError;
+		if (_display.updateBegin(_slotStorage.subspan(slot * _frameSize, _frameSize)) == DisplayRet::Success)
+		{
+			do
+			{
+				state = _display.updateStep(_stepBudgetUs);
+				if (_policy == PolicyDropOldest)
+					recycleStale();
+			} while (state == displaylib_flush::FlushBusy && _running);
+		}
+		if (state == displaylib_flush::FlushDone)
+		{
+			const uint32_t latencyUs = static_cast<uint32_t>(time_us_64() - _slotSubmitUs[slot]);
+			const uint32_t averageUs = _latencyAvgUs;
+			_latencyLastUs = latencyUs;
+			if (latencyUs > _latencyMaxUs)
+				_latencyMaxUs = latencyUs;
+			// running average, weight of 1/8 for newest frame
+			_latencyAvgUs = (_framesFlushed == 0) ? latencyUs :
+				averageUs - (averageUs >> 3) + (latencyUs >> 3);
+			_framesFlushed = _framesFlushed + 1;
+		}
+		else if (state == displaylib_flush::FlushError)
+		{
+			_flushErrors = _flushErrors + 1;
+		}
+		else
+		{
+			_display.updateCancel(); // stopped mid frame
+		}
+		_freeQueue.push(slot);
+		_workerBusy = false;
+	}
+	_workerActive = false;
+}
+
+/*!
+	@brief With PolicyDropOldest, returns every queued frame but the newest to the free queue
+	@note Called by the worker between flush steps, so core0 is not held up
+		for a whole frame when it renders faster than core1 sends.
+*/
+void displaylib_pipeline::recycleStale(void)
+{
+	uint8_t queued = _readyQueue.count();
+	uint8_t slot;
+	while (queued-- > 1 && _readyQueue.pop(slot))
+	{
+		_freeQueue.push(slot);
+		_framesDropped = _framesDropped + 1;
+	}
+}
+
+/*!
+	@brief Idles the worker until core0 submits a frame or stops the pipeline
+*/
+void displaylib_pipeline::workerWait(void)
+{
+#if PICO_ON_DEVICE
+	__wfe();
+#else
+	std::this_thread::yield();
+#endif
+}
+
+/*!
+	@brief Wakes the worker from workerWait
+*/
+void displaylib_pipeline::wakeWorker(void)
+{
+#if PICO_ON_DEVICE
+	__sev();
+#endif
+}
+
+#if PICO_ON_DEVICE
+/*!
+	@brief Core1 entry point, runs the worker of the pipeline that launched it
+*/
+void displaylib_pipeline::core1Entry(void)
+{
+	_core1Pipeline->worker();
+}
+#endif
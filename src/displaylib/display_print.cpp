@@ -134,6 +134,16 @@ size_t Print::println(const std::string &s) {
     return n;
 }
 
+size_t Print::print(std::string_view s) {
+    return write(s.data(), s.length());
+}
+
+size_t Print::println(std::string_view s) {
+    size_t n = print(s);
+    n += println();
+    return n;
+}
+
 // Private Methods /////////////////////////////////////////////////////////////
 
 size_t Print::printNumber(unsigned long n, uint8_t base)
@@ -0,0 +1,372 @@
+/*!
+	@file display_remote.cpp
+	@brief Source file for the remote framebuffer receiver
+	@author Gavin Lyons.
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "pico/stdlib.h"
+#include "../../include/displaylib/display_remote.hpp"
+#include "../../include/displaylib/display_diag.hpp"
+
+/*!
+	@brief init the remote framebuffer receiver
+	@param display the display whose screen buffer is written
+	@note Nothing is received until remoteBegin is called.
+*/
+displaylib_remote::displaylib_remote(displaylib_graphics &display)
+	: _display(display)
+{
+}
+
+/*!
+	@brief Starts the receiver
+	@param staging buffer for the payload of one frame, at least width * pages
+		bytes, a larger one lets the sender use RemotePages for any rectangle
+		and XOR runs that do not pack well, must stay in scope
+	@return Will return
+		-# Success
+		-# BufferEmpty the screen buffer has not been assigned
+		-# BufferSize staging buffer smaller than the screen buffer
+*/
+DisplayRet::Ret_Codes_e displaylib_remote::remoteBegin(std::span<uint8_t> staging)
+{
+	const size_t frameBytes = static_cast<size_t>(_display.WIDTH) * ((_display.HEIGHT + 7) / 8);
+	std::span<uint8_t> buffer;
+	DisplayRet::Ret_Codes_e result = _display.pageBuffer(buffer, displaylib_diag::FuncRemote, true);
+	if (result != DisplayRet::Success)
+		return result;
+	if (staging.size() < frameBytes)
+	{
+		displaylib_diag::error(displaylib_diag::FuncRemote, DisplayRet::BufferSize,
+			static_cast<int16_t>(staging.size()), static_cast<int16_t>(frameBytes));
+		return DisplayRet::BufferSize;
+	}
+	_staging = staging.first(std::min<size_t>(staging.size(), 0xFFFF));
+	_state = ParseSync0;
+	_stats = remote_stats_t{};
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Passes received bytes to the receiver, for transports other than stdio
+	@param bytes the bytes received
+	@return frames applied to the screen buffer
+*/
+uint16_t displaylib_remote::remoteFeed(std::span<const uint8_t> bytes)
+{
+	uint16_t frames = 0;
+	for (const uint8_t value : bytes)
+		frames += remoteByte(value) ? 1 : 0;
+	return frames;
+}
+
+/*!
+	@brief Reads the bytes waiting on stdio and passes them to the receiver
+	@param budgetUs most time spent, uS, returns early when no byte is waiting
+	@return frames applied to the screen buffer
+	@note Call from the main loop, then flushDirty, or updateStep for a time
+		sliced flush of the rectangle.
+*/
+uint16_t displaylib_remote::remotePoll(uint32_t budgetUs)
+{
+	if (_staging.empty())
+		return 0;
+	uint16_t frames = 0;
+	const uint64_t startUs = time_us_64();
+	do
+	{
+		const int value = getchar_timeout_us(0);
+		if (value < 0)
+			break;
+		frames += remoteByte(static_cast<uint8_t>(value)) ? 1 : 0;
+	} while ((time_us_64() - startUs) < budgetUs);
+	return frames;
+}
+
+/*!
+	@brief Frame counters since remoteBegin
+	@return the counters
+*/
+const displaylib_remote::remote_stats_t &displaylib_remote::getRemoteStats(void) const
+{
+	return _stats;
+}
+
+/*!
+	@brief Have bytes changed since the last flushDirty or clearDirty
+	@return true if the dirty rectangle needs sending
+*/
+bool displaylib_remote::getDirty(void) const
+{
+	return _dirtyX2 >= _dirtyX;
+}
+
+/*!
+	@brief Rectangle of the screen buffer changed by the frames applied since the last flush
+	@return the rectangle, whole pages, empty if nothing changed
+*/
+displaylib_flush::flush_rect_t displaylib_remote::getDirtyRect(void) const
+{
+	if (!getDirty())
+		return displaylib_flush::flush_rect_t{};
+	return displaylib_flush::flush_rect_t{_dirtyX, static_cast<int16_t>(_dirtyPage * 8),
+		static_cast<int16_t>(_dirtyX2 - _dirtyX + 1), static_cast<int16_t>((_dirtyPage2 - _dirtyPage + 1) * 8)};
+}
+
+/*!
+	@brief Forgets the received changes, flushDirty sends nothing until the next frame
+*/
+void displaylib_remote::clearDirty(void)
+{
+	_dirtyX = 0;
+	_dirtyX2 = -1;
+	_dirtyPage = 0;
+	_dirtyPage2 = -1;
+}
+
+/*!
+	@brief Sends the changed rectangle to the display with updateRegion
+	@param display the display driver object, the same display as the constructor
+	@return Success or the updateRegion error, the rectangle is kept on error
+*/
+DisplayRet::Ret_Codes_e displaylib_remote::flushDirty(displaylib_flush &display)
+{
+	if (!getDirty())
+		return DisplayRet::Success;
+	DisplayRet::Ret_Codes_e result = display.updateRegion(getDirtyRect());
+	if (result == DisplayRet::Success)
+		clearDirty();
+	return result;
+}
+
+/*!
+	@brief Runs one received byte through the frame parser
+	@param value the byte
+	@return true if a frame was applied to the screen buffer
+*/
+bool displaylib_remote::remoteByte(uint8_t value)
+{
+	if (_staging.empty())
+		return false;
+	_stats.bytes++;
+	switch (_state)
+	{
+		case ParseSync0:
+			if (value == REMOTE_SYNC0)
+				_state = ParseSync1;
+			break;
+		case ParseSync1:
+			if (value == REMOTE_SYNC1)
+			{
+				_state = ParseHeader;
+				_count = 0;
+				_crc = 0xFFFF;
+			}
+			else if (value != REMOTE_SYNC0)
+				_state = ParseSync0;
+			break;
+		case ParseHeader:
+			_header[_count++] = value;
+			_crc = crcUpdate(_crc, value);
+			if (_count < sizeof(_header))
+				break;
+			_length = static_cast<uint16_t>(_header[2] | (_header[3] << 8));
+			_received = 0;
+			_count = 0;
+			if (_length > _staging.size())
+			{
+				// the payload is not stored, look for the next frame in it
+				_stats.lengthErrors++;
+				remoteReply('E', RemoteErrorLength);
+				_state = ParseSync0;
+			}
+			else
+				_state = (_length == 0) ? ParseCrc : ParsePayload;
+			break;
+		case ParsePayload:
+			_staging[_received++] = value;
+			_crc = crcUpdate(_crc, value);
+			if (_received == _length)
+				_state = ParseCrc;
+			break;
+		case ParseCrc:
+			if (_count++ == 0)
+			{
+				_crcSent = value;
+				break;
+			}
+			_crcSent = static_cast<uint16_t>(_crcSent | (value << 8));
+			_state = ParseSync0;
+			if (_crcSent != _crc)
+			{
+				_stats.crcErrors++;
+				remoteReply('E', RemoteErrorCrc);
+				return false;
+			}
+			return remoteApply();
+	}
+	return false;
+}
+
+/*!
+	@brief Applies a checked frame to the screen buffer and answers it
+	@return true if the screen buffer was written
+*/
+bool displaylib_remote::remoteApply(void)
+{
+	const uint16_t width = static_cast<uint16_t>(_display.WIDTH);
+	const uint16_t pages = static_cast<uint16_t>((_display.HEIGHT + 7) / 8);
+	const std::span<uint8_t> buffer = _display.graphicsBuffer();
+	const std::span<const uint8_t> payload(_staging.data(), _length);
+	bool ok = false;
+	switch (_header[0])
+	{
+		case RemoteHello:
+			printf("I %u %u %u\r\n", static_cast<unsigned>(width), static_cast<unsigned>(_display.HEIGHT),
+				static_cast<unsigned>(_staging.size()));
+			return false;
+		case RemoteFull:
+			if (payload.size() == static_cast<size_t>(width) * pages)
+			{
+				std::copy(payload.begin(), payload.end(), buffer.begin());
+				remoteMark(0, 0);
+				remoteMark(width - 1, pages - 1);
+				ok = true;
+			}
+			break;
+		case RemotePages:
+		{
+			if (payload.size() < REMOTE_PAGES_HEADER)
+				break;
+			const uint16_t page = payload[0], pageCount = payload[1], column = payload[2], columns = payload[3];
+			if (pageCount == 0 || columns == 0 || page + pageCount > pages || column + columns > width ||
+				payload.size() != REMOTE_PAGES_HEADER + static_cast<size_t>(pageCount) * columns)
+				break;
+			const uint8_t *source = payload.data() + REMOTE_PAGES_HEADER;
+			for (uint16_t row = 0; row < pageCount; row++, source += columns)
+				std::memcpy(buffer.data() + (page + row) * width + column, source, columns);
+			remoteMark(column, page);
+			remoteMark(column + columns - 1, page + pageCount - 1);
+			ok = true;
+			break;
+		}
+		case RemoteXorRle:
+			// checked in full first, so a bad payload leaves the buffer as it was
+			ok = remoteXorRle(payload, false) && remoteXorRle(payload, true);
+			break;
+		default:
+			break;
+	}
+	if (!ok)
+	{
+		_stats.formatErrors++;
+		displaylib_diag::warning(displaylib_diag::FuncRemote, DisplayRet::BitmapSize, _header[0], static_cast<int16_t>(_length));
+		remoteReply('E', RemoteErrorFormat);
+		return false;
+	}
+	_stats.frames++;
+	remoteReply('K', 0);
+	return true;
+}
+
+/*!
+	@brief Checks or applies a RemoteXorRle payload
+	@param payload the runs
+	@param apply false to only check the runs cover the buffer exactly, true to XOR them in
+	@return true if the runs cover the buffer exactly
+*/
+bool displaylib_remote::remoteXorRle(std::span<const uint8_t> payload, bool apply)
+{
+	const uint16_t width = static_cast<uint16_t>(_display.WIDTH);
+	const uint32_t total = static_cast<uint32_t>(width) * ((_display.HEIGHT + 7) / 8);
+	const std::span<uint8_t> buffer = _display.graphicsBuffer();
+	uint32_t position = 0;
+	size_t index = 0;
+	while (index < payload.size())
+	{
+		const uint8_t control = payload[index++];
+		const bool repeat = (control & 0x80) != 0;
+		const uint32_t run = repeat ? (control - 0x80U + 2U) : (control + 1U);
+		if ((repeat ? 1U : run) > payload.size() - index || run > total - position)
+			return false;
+		if (repeat)
+		{
+			const uint8_t value = payload[index++];
+			if (apply && value != 0)
+			{
+				for (uint32_t count = 0; count < run; count++)
+					buffer[position + count] ^= value;
+				remoteMark(position % width, position / width);
+				remoteMark((position + run - 1) % width, (position + run - 1) / width);
+				if ((position / width) != ((position + run - 1) / width))
+				{
+					remoteMark(0, position / width);
+					remoteMark(width - 1, position / width);
+				}
+			}
+		}
+		else if (apply)
+		{
+			for (uint32_t count = 0; count < run; count++)
+			{
+				if (payload[index + count] == 0)
+					continue;
+				buffer[position + count] ^= payload[index + count];
+				remoteMark((position + count) % width, (position + count) / width);
+			}
+		}
+		if (!repeat)
+			index += run;
+		position += run;
+	}
+	return position == total;
+}
+
+/*!
+	@brief Answers a frame with a line on stdout
+	@param code K applied or E rejected
+	@param detail error code of an E
+*/
+void displaylib_remote::remoteReply(char code, uint8_t detail)
+{
+	if (code == 'E')
+		printf("E %u %u\r\n", static_cast<unsigned>(_header[1]), static_cast<unsigned>(detail));
+	else
+		printf("%c %u\r\n", code, static_cast<unsigned>(_header[1]));
+}
+
+/*!
+	@brief Grows the changed rectangle to hold a byte
+	@param column column of the byte
+	@param page page of the byte
+*/
+void displaylib_remote::remoteMark(uint16_t column, uint16_t page)
+{
+	if (!getDirty())
+	{
+		_dirtyX = _dirtyX2 = static_cast<int16_t>(column);
+		_dirtyPage = _dirtyPage2 = static_cast<int16_t>(page);
+		return;
+	}
+	_dirtyX = std::min<int16_t>(_dirtyX, static_cast<int16_t>(column));
+	_dirtyX2 = std::max<int16_t>(_dirtyX2, static_cast<int16_t>(column));
+	_dirtyPage = std::min<int16_t>(_dirtyPage, static_cast<int16_t>(page));
+	_dirtyPage2 = std::max<int16_t>(_dirtyPage2, static_cast<int16_t>(page));
+}
+
+/*!
+	@brief CRC-16/CCITT-FALSE, polynomial 0x1021, one byte
+	@param crc the CRC so far, 0xFFFF at the start
+	@param value the byte
+	@return the new CRC
+*/
+uint16_t displaylib_remote::crcUpdate(uint16_t crc, uint8_t value)
+{
+	crc = static_cast<uint16_t>(crc ^ (value << 8));
+	for (uint8_t bit = 0; bit < 8; bit++)
+		crc = static_cast<uint16_t>((crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1));
+	return crc;
+}
@@ -0,0 +1,281 @@
+/*!
+	@file display_snapshot.cpp
+	@brief Source file for the screen buffer snapshot
+	@author Gavin Lyons.
+*/
+
+#include <cstring>
+#include "pico/stdlib.h"
+#include "../../include/displaylib/display_snapshot.hpp"
+#include "../../include/displaylib/display_diag.hpp"
+
+/*!
+	@brief init the snapshot object
+	@param display the display whose screen buffer is sent
+*/
+displaylib_snapshot::displaylib_snapshot(displaylib_flush &display)
+	: _display(display)
+{
+}
+
+/*!
+	@brief Starts a snapshot of the screen buffer, a snapshot in progress is dropped
+	@param format SnapshotPBM or SnapshotRLE
+	@return Will return
+		-# Success
+		-# BufferEmpty the screen buffer has not been assigned
+		-# BufferSize the screen buffer is smaller than the display
+*/
+DisplayRet::Ret_Codes_e displaylib_snapshot::snapshotBegin(snapshot_format_e format)
+{
+	snapshotCancel();
+	const std::span<const uint8_t> frame = _display.flushBuffer();
+	if (frame.empty())
+	{
+		displaylib_diag::error(displaylib_diag::FuncSnapshot, DisplayRet::BufferEmpty);
+		return DisplayRet::BufferEmpty;
+	}
+	const size_t frameBytes = static_cast<size_t>(_display._flushWidth) * _display._flushPages;
+	if (frame.size() < frameBytes)
+	{
+		displaylib_diag::error(displaylib_diag::FuncSnapshot, DisplayRet::BufferSize,
+			static_cast<int16_t>(frame.size()), static_cast<int16_t>(frameBytes));
+		return DisplayRet::BufferSize;
+	}
+	_frame = frame.first(frameBytes);
+	_width = _display._flushWidth;
+	_height = static_cast<uint16_t>(_display._flushPages * 8);
+	_format = format;
+	_stage = StageHeader;
+	_position = 0;
+	_lineChars = 0;
+	_sum1 = 0;
+	_sum2 = 0;
+	_tokenLength = 0;
+	_tokenSent = 0;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Sends the next part of the snapshot to a Print object
+	@param out where to write, e.g. a USB CDC or UART wrapper
+	@param maxBytes most bytes written in this call
+	@return true if there is more to send
+*/
+bool displaylib_snapshot::snapshotStep(Print &out, uint16_t maxBytes)
+{
+	uint8_t chunk[SNAPSHOT_CHUNK];
+	while (maxBytes > 0 && _stage != StageIdle)
+	{
+		const size_t length = snapshotFill(chunk, (maxBytes < SNAPSHOT_CHUNK) ? maxBytes : SNAPSHOT_CHUNK);
+		if (length != 0)
+			out.write(chunk, length);
+		maxBytes = static_cast<uint16_t>(maxBytes - length);
+	}
+	return snapshotBusy();
+}
+
+/*!
+	@brief Sends the next part of the snapshot to a file or stream
+	@param out where to write, e.g. stdout, open files in binary mode for SnapshotPBM
+	@param maxBytes most bytes written in this call
+	@return true if there is more to send, false when done or on a write error,
+		which cancels the snapshot
+*/
+bool displaylib_snapshot::snapshotStep(FILE *out, uint16_t maxBytes)
+{
+	uint8_t chunk[SNAPSHOT_CHUNK];
+	while (maxBytes > 0 && _stage != StageIdle)
+	{
+		const size_t length = snapshotFill(chunk, (maxBytes < SNAPSHOT_CHUNK) ? maxBytes : SNAPSHOT_CHUNK);
+		if (length != 0 && fwrite(chunk, 1, length, out) != length)
+		{
+			displaylib_diag::error(displaylib_diag::FuncSnapshot, DisplayRet::GenericError, _position);
+			snapshotCancel();
+			return false;
+		}
+		maxBytes = static_cast<uint16_t>(maxBytes - length);
+	}
+	return snapshotBusy();
+}
+
+/*!
+	@brief Sends a whole snapshot to a Print object, blocking
+	@param out where to write
+	@param format SnapshotPBM or SnapshotRLE
+	@return Success or the snapshotBegin error, GenericError if the Print object
+		reported a write error
+*/
+DisplayRet::Ret_Codes_e displaylib_snapshot::snapshot(Print &out, snapshot_format_e format)
+{
+	const DisplayRet::Ret_Codes_e result = snapshotBegin(format);
+	if (result != DisplayRet::Success)
+		return result;
+	out.clearWriteError();
+	while (snapshotStep(out, SNAPSHOT_CHUNK)) {}
+	return (out.getWriteError() == 0) ? DisplayRet::Success : DisplayRet::GenericError;
+}
+
+/*!
+	@brief Sends a whole snapshot to a file or stream, blocking
+	@param out where to write
+	@param format SnapshotPBM or SnapshotRLE
+	@return Success or the snapshotBegin error, GenericError on a write error
+*/
+DisplayRet::Ret_Codes_e displaylib_snapshot::snapshot(FILE *out, snapshot_format_e format)
+{
+	const DisplayRet::Ret_Codes_e result = snapshotBegin(format);
+	if (result != DisplayRet::Success)
+		return result;
+	while (snapshotStep(out, SNAPSHOT_CHUNK)) {}
+	return (ferror(out) == 0 && fflush(out) == 0) ? DisplayRet::Success : DisplayRet::GenericError;
+}
+
+/*!
+	@brief Drops the snapshot in progress, the host decoder rejects the partial output
+*/
+void displaylib_snapshot::snapshotCancel(void)
+{
+	_stage = StageIdle;
+	_tokenLength = 0;
+	_tokenSent = 0;
+}
+
+/*!
+	@brief Is a snapshot in progress
+	@return true if there is more to send
+*/
+bool displaylib_snapshot::snapshotBusy(void) const
+{
+	return _stage != StageIdle;
+}
+
+/*!
+	@brief Progress of the snapshot in progress
+	@return percentage of the image sent 0-100, 100 when idle
+*/
+uint8_t displaylib_snapshot::snapshotProgress(void) const
+{
+	if (_stage == StageIdle || _stage >= StageEnd)
+		return 100;
+	const uint32_t total = (_format == SnapshotPBM) ? ((_width + 7U) / 8U) * _height : _frame.size();
+	return static_cast<uint8_t>((_position * 100U) / total);
+}
+
+/*!
+	@brief Copies the next bytes of the snapshot, used internally
+	@param out destination
+	@param space bytes free at out
+	@return bytes copied, less than space only when the snapshot is finished
+*/
+size_t displaylib_snapshot::snapshotFill(uint8_t *out, size_t space)
+{
+	size_t used = 0;
+	while (used < space && _stage != StageIdle)
+	{
+		if (_tokenSent >= _tokenLength)
+		{
+			if (_stage == StageDone)
+			{
+				_stage = StageIdle;
+				break;
+			}
+			snapshotToken();
+			continue;
+		}
+		size_t length = _tokenLength - _tokenSent;
+		if (length > space - used)
+			length = space - used;
+		std::memcpy(out + used, _token + _tokenSent, length);
+		_tokenSent = static_cast<uint8_t>(_tokenSent + length);
+		used += length;
+	}
+	return used;
+}
+
+/*!
+	@brief Makes the next token of the snapshot in _token and moves on the stage, used internally
+*/
+void displaylib_snapshot::snapshotToken(void)
+{
+	int length = 0;
+	_tokenSent = 0;
+	switch (_stage)
+	{
+		case StageHeader:
+			if (_format == SnapshotPBM)
+				length = snprintf(_token, sizeof(_token), "P4\n%u %u\n",
+					static_cast<unsigned>(_width), static_cast<unsigned>(_height));
+			else
+				length = snprintf(_token, sizeof(_token), "# displaylib snapshot v1 rle %u %u\r\n",
+					static_cast<unsigned>(_width), static_cast<unsigned>(_height));
+			_stage = StageBody;
+			break;
+		case StageBody:
+			if (_format == SnapshotPBM)
+			{
+				// rows of 8 pixels a byte, most significant bit left, from the page layout
+				const uint32_t rowBytes = (_width + 7U) / 8U;
+				const uint32_t total = rowBytes * _height;
+				while (length < static_cast<int>(sizeof(_token)) && _position < total)
+				{
+					const uint16_t y = static_cast<uint16_t>(_position / rowBytes);
+					const uint16_t x0 = static_cast<uint16_t>((_position % rowBytes) * 8);
+					const uint8_t *column = _frame.data() + (y / 8) * _width;
+					const uint8_t mask = static_cast<uint8_t>(1U << (y & 7));
+					uint8_t value = 0;
+					for (uint16_t x = x0; x < x0 + 8 && x < _width; x++)
+						if (column[x] & mask)
+							value |= static_cast<uint8_t>(0x80 >> (x - x0));
+					_token[length++] = static_cast<char>(value);
+					_position++;
+				}
+				if (_position >= total)
+					_stage = StageDone;
+			}
+			else if (_lineChars >= SNAPSHOT_LINE)
+			{
+				length = snprintf(_token, sizeof(_token), "\r\n");
+				_lineChars = 0;
+			}
+			else
+			{
+				const uint8_t value = _frame[_position];
+				uint16_t run = 1;
+				while (_position + run < _frame.size() && run < 255 && _frame[_position + run] == value)
+					run++;
+				if (run >= 4)
+					length = snprintf(_token, sizeof(_token), "*%02X%02X", static_cast<unsigned>(run), static_cast<unsigned>(value));
+				else
+				{
+					run = 1;
+					length = snprintf(_token, sizeof(_token), "%02X", static_cast<unsigned>(value));
+				}
+				for (uint16_t count = 0; count < run; count++)
+					snapshotChecksum(value);
+				_position += run;
+				_lineChars = static_cast<uint8_t>(_lineChars + length);
+				if (_position >= _frame.size())
+					_stage = StageEnd;
+			}
+			break;
+		case StageEnd:
+			length = snprintf(_token, sizeof(_token), "\r\n# end %04X\r\n",
+				static_cast<unsigned>((_sum2 << 8) | _sum1));
+			_stage = StageDone;
+			break;
+		default:
+			break;
+	}
+	_tokenLength = static_cast<uint8_t>((length > 0) ? length : 0);
+}
+
+/*!
+	@brief Adds a buffer byte to the Fletcher-16 checksum, used internally
+	@param value the byte
+*/
+void displaylib_snapshot::snapshotChecksum(uint8_t value)
+{
+	_sum1 = static_cast<uint16_t>((_sum1 + value) % 255);
+	_sum2 = static_cast<uint16_t>((_sum2 + _sum1) % 255);
+}
@@ -0,0 +1,665 @@
+/*!
+	@file display_sprite.cpp
+	@brief Source file for the sprite layer
+	@author Gavin Lyons.
+*/
+
+#include <algorithm>
+#include "pico/stdlib.h"
+#include "../../include/displaylib/display_sprite.hpp"
+#include "../../include/displaylib/display_diag.hpp"
+
+/*!
+	@brief init the sprite layer object
+	@param display the display driver object to draw to
+	@note Nothing is drawn until layerUpdate is called.
+*/
+displaylib_sprite_layer::displaylib_sprite_layer(displaylib_graphics &display)
+	: _display(display)
+{
+}
+
+/*!
+	@brief Starts the layer with no sprites
+	@param saveArea bytes to hold the screen under the sprites, must stay in scope,
+		each sprite takes w * ((h + 7) / 8 + 1)
+	@return Will return
+		-# Success
+		-# GenericError the display is rotated
+		-# BufferEmpty the screen buffer has not been assigned
+	@note Sprites already drawn are left in the screen buffer.
+*/
+DisplayRet::Ret_Codes_e displaylib_sprite_layer::layerBegin(std::span<uint8_t> saveArea)
+{
+	std::span<uint8_t> buffer;
+	DisplayRet::Ret_Codes_e result = _display.pageBuffer(buffer, displaylib_diag::FuncSprite);
+	if (result != DisplayRet::Success)
+		return result;
+	_saveArea = saveArea;
+	_saveUsed = 0;
+	_count = 0;
+	_dirtyCount = 0;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Adds a sprite, shown from the next layerUpdate
+	@param bitmap the image, page layout, w * ((h + 7) / 8) bytes, must stay in scope
+	@param mask 1 where the sprite is opaque, same layout and size, or empty to draw
+		the lit pixels of the bitmap only
+	@param w width
+	@param h height, 1 to SPRITE_HEIGHT_MAX
+	@param x left, may be off screen
+	@param y top, may be off screen
+	@param z z-order, higher is in front, sprites with the same z in the order added
+	@return the sprite number, or SPRITE_NONE if the layer is full, the bitmap or mask
+		is the wrong size, or the save area is too small
+*/
+uint8_t displaylib_sprite_layer::spriteAdd(std::span<const uint8_t> bitmap, std::span<const uint8_t> mask,
+	int16_t w, int16_t h, int16_t x, int16_t y, uint8_t z)
+{
+	if (_count >= SPRITE_MAX)
+	{
+		displaylib_diag::error(displaylib_diag::FuncSprite, DisplayRet::GenericError, _count);
+		return SPRITE_NONE;
+	}
+	if (!checkFrame(bitmap, mask, w, h))
+		return SPRITE_NONE;
+	const size_t saveSize = static_cast<size_t>(w) * (((h + 7) / 8) + 1);
+	if (_saveUsed + saveSize > _saveArea.size())
+	{
+		displaylib_diag::error(displaylib_diag::FuncSprite, DisplayRet::BufferSize,
+			static_cast<int16_t>(_saveArea.size()), static_cast<int16_t>(_saveUsed + saveSize));
+		return SPRITE_NONE;
+	}
+	sprite_t &sprite = _sprites[_count];
+	sprite = sprite_t{};
+	sprite.bitmap = bitmap;
+	sprite.mask = mask;
+	sprite.x = x;
+	sprite.y = y;
+	sprite.w = w;
+	sprite.h = h;
+	sprite.z = z;
+	sprite.save = _saveUsed;
+	_saveUsed = static_cast<uint16_t>(_saveUsed + saveSize);
+	return _count++;
+}
+
+/*!
+	@brief Changes the image of a sprite, e.g. the next frame of an animation
+	@param sprite the sprite
+	@param bitmap the image, the same size as the sprite
+	@param mask the mask, or empty, see spriteAdd
+	@return Success, or GenericError no such sprite, BitmapSize bitmap or mask the wrong size
+*/
+DisplayRet::Ret_Codes_e displaylib_sprite_layer::spriteSetFrame(uint8_t sprite, std::span<const uint8_t> bitmap,
+	std::span<const uint8_t> mask)
+{
+	if (sprite >= _count)
+	{
+		displaylib_diag::error(displaylib_diag::FuncSprite, DisplayRet::GenericError, sprite);
+		return DisplayRet::GenericError;
+	}
+	if (!checkFrame(bitmap, mask, _sprites[sprite].w, _sprites[sprite].h))
+		return DisplayRet::BitmapSize;
+	_sprites[sprite].bitmap = bitmap;
+	_sprites[sprite].mask = mask;
+	_sprites[sprite].changed = true;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Moves a sprite, drawn there by the next layerUpdate
+	@param sprite the sprite
+	@param x left
+	@param y top
+*/
+void displaylib_sprite_layer::spriteMoveTo(uint8_t sprite, int16_t x, int16_t y)
+{
+	if (sprite >= _count || (_sprites[sprite].x == x && _sprites[sprite].y == y))
+		return;
+	_sprites[sprite].x = x;
+	_sprites[sprite].y = y;
+	_sprites[sprite].changed = true;
+}
+
+/*!
+	@brief Moves a sprite by an offset
+	@param sprite the sprite
+	@param dx pixels right, negative left
+	@param dy pixels down, negative up
+*/
+void displaylib_sprite_layer::spriteMove(uint8_t sprite, int16_t dx, int16_t dy)
+{
+	if (sprite >= _count)
+		return;
+	spriteMoveTo(sprite, _sprites[sprite].x + dx, _sprites[sprite].y + dy);
+}
+
+/*!
+	@brief Sets how far a sprite moves on each layerUpdate
+	@param sprite the sprite
+	@param vx pixels right per update, negative left
+	@param vy pixels down per update, negative up
+*/
+void displaylib_sprite_layer::spriteSetVelocity(uint8_t sprite, int8_t vx, int8_t vy)
+{
+	if (sprite >= _count)
+		return;
+	_sprites[sprite].vx = vx;
+	_sprites[sprite].vy = vy;
+}
+
+/*!
+	@brief Shows or hides a sprite, a hidden sprite is erased by the next layerUpdate
+	@param sprite the sprite
+	@param show true to show
+*/
+void displaylib_sprite_layer::spriteShow(uint8_t sprite, bool show)
+{
+	if (sprite >= _count || _sprites[sprite].visible == show)
+		return;
+	_sprites[sprite].visible = show;
+	_sprites[sprite].changed = true;
+}
+
+/*!
+	@brief Sets the z-order of a sprite
+	@param sprite the sprite
+	@param z higher is in front
+*/
+void displaylib_sprite_layer::spriteSetZ(uint8_t sprite, uint8_t z)
+{
+	if (sprite >= _count || _sprites[sprite].z == z)
+		return;
+	_sprites[sprite].z = z;
+	_sprites[sprite].changed = true;
+}
+
+/*!
+	@brief Position and size of a sprite
+	@param sprite the sprite
+	@return the rectangle, not clipped to the screen, w is 0 if there is no such sprite
+*/
+displaylib_flush::flush_rect_t displaylib_sprite_layer::getSpriteRect(uint8_t sprite) const
+{
+	displaylib_flush::flush_rect_t rect;
+	if (sprite >= _count)
+		return rect;
+	rect.x = _sprites[sprite].x;
+	rect.y = _sprites[sprite].y;
+	rect.w = _sprites[sprite].w;
+	rect.h = _sprites[sprite].h;
+	return rect;
+}
+
+/*!
+	@brief Sprites added
+	@return count, sprite numbers are 0 to count - 1
+*/
+uint8_t displaylib_sprite_layer::getSpriteCount(void) const
+{
+	return _count;
+}
+
+/*!
+	@brief Pixel accurate collision test of two sprites at their current positions
+	@param first a sprite
+	@param second another sprite
+	@return true if an opaque pixel of each is in the same place, hidden sprites never collide
+	@details Only the columns both rectangles cover are tested, each as one AND
+		of the two mask columns, shifted to the rows both cover.
+*/
+bool displaylib_sprite_layer::spriteCollide(uint8_t first, uint8_t second) const
+{
+	if (first >= _count || second >= _count || first == second ||
+		!_sprites[first].visible || !_sprites[second].visible)
+		return false;
+	const sprite_t &a = _sprites[first];
+	const sprite_t &b = _sprites[second];
+	const int16_t left = std::max(a.x, b.x);
+	const int16_t right = std::min(a.x + a.w, b.x + b.w);
+	const int16_t top = std::max(a.y, b.y);
+	const int16_t bottom = std::min(a.y + a.h, b.y + b.h);
+	if (left >= right || top >= bottom)
+		return false;
+	const uint8_t rows = static_cast<uint8_t>(bottom - top);
+	const uint64_t rowMask = (rows >= 64) ? ~0ULL : ((1ULL << rows) - 1);
+	for (int16_t x = left; x < right; x++)
+	{
+		const uint64_t columnA = maskColumn(a, x - a.x) >> (top - a.y);
+		const uint64_t columnB = maskColumn(b, x - b.x) >> (top - b.y);
+		if (columnA & columnB & rowMask)
+			return true;
+	}
+	return false;
+}
+
+/*!
+	@brief Finds a sprite colliding with a sprite
+	@param sprite the sprite
+	@param start first sprite number to test, pass the last result + 1 to find the next
+	@return the sprite number, or SPRITE_NONE
+*/
+uint8_t displaylib_sprite_layer::spriteCollideAny(uint8_t sprite, uint8_t start) const
+{
+	for (uint8_t other = start; other < _count; other++)
+	{
+		if (spriteCollide(sprite, other))
+			return other;
+	}
+	return SPRITE_NONE;
+}
+
+/*!
+	@brief Moves the sprites by their velocity, erases and redraws the sprites that changed
+	@return Will return
+		-# Success
+		-# GenericError the display is rotated
+		-# BufferEmpty the screen buffer has not been assigned
+	@details The sprites to redo are the changed sprites, plus any drawn sprite
+		drawn after one of them over its old place, or in front of it in z-order
+		over its new place. They are erased last drawn first, each putting back
+		the bytes it saved, then the visible ones are drawn in z-order. Sprites
+		away from the change are not touched.
+*/
+DisplayRet::Ret_Codes_e displaylib_sprite_layer::layerUpdate(void)
+{
+	std::span<uint8_t> buffer;
+	DisplayRet::Ret_Codes_e result = _display.pageBuffer(buffer, displaylib_diag::FuncSprite);
+	if (result != DisplayRet::Success)
+		return result;
+	for (uint8_t index = 0; index < _count; index++)
+	{
+		sprite_t &sprite = _sprites[index];
+		if (sprite.vx != 0 || sprite.vy != 0)
+		{
+			sprite.x = static_cast<int16_t>(sprite.x + sprite.vx);
+			sprite.y = static_cast<int16_t>(sprite.y + sprite.vy);
+			sprite.changed = true;
+		}
+	}
+	uint8_t order[SPRITE_MAX];
+	const uint8_t count = sortLayer(order);
+	uint8_t position[SPRITE_MAX];   // place in the new z-order
+	displaylib_flush::flush_rect_t place[SPRITE_MAX]; // new screen rectangle
+	bool redo[SPRITE_MAX];
+	for (uint8_t pos = 0; pos < count; pos++)
+		position[order[pos]] = pos;
+	for (uint8_t index = 0; index < _count; index++)
+	{
+		place[index] = _sprites[index].visible ? screenRect(_sprites[index]) : displaylib_flush::flush_rect_t{};
+		redo[index] = _sprites[index].changed;
+	}
+	// add the drawn sprites on top of a sprite being erased, or in front of its new place
+	bool grown = true;
+	while (grown)
+	{
+		grown = false;
+		for (uint8_t index = 0; index < _count; index++)
+		{
+			const sprite_t &sprite = _sprites[index];
+			if (redo[index] || !sprite.drawn)
+				continue;
+			for (uint8_t other = 0; other < _count; other++)
+			{
+				const sprite_t &below = _sprites[other];
+				if (!redo[other])
+					continue;
+				if ((below.drawn && below.serial < sprite.serial && overlap(sprite.drawnRect, below.drawnRect)) ||
+					(position[other] < position[index] && overlap(sprite.drawnRect, place[other])))
+				{
+					redo[index] = true;
+					grown = true;
+					break;
+				}
+			}
+		}
+	}
+	uint8_t drawn[SPRITE_MAX];
+	const uint8_t drawnCount = sortDrawn(drawn);
+	for (uint8_t pos = drawnCount; pos-- > 0;)
+	{
+		if (redo[drawn[pos]])
+			spriteErase(buffer, _sprites[drawn[pos]]);
+	}
+	for (uint8_t pos = 0; pos < count; pos++)
+	{
+		sprite_t &sprite = _sprites[order[pos]];
+		if (redo[order[pos]] && sprite.visible)
+			spriteDraw(buffer, sprite);
+		sprite.changed = false;
+	}
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Erases every sprite, putting back the screen under them
+	@return Success, or the errors of layerUpdate
+	@note Draw the background, then layerUpdate draws the sprites again.
+*/
+DisplayRet::Ret_Codes_e displaylib_sprite_layer::layerErase(void)
+{
+	std::span<uint8_t> buffer;
+	DisplayRet::Ret_Codes_e result = _display.pageBuffer(buffer, displaylib_diag::FuncSprite);
+	if (result != DisplayRet::Success)
+		return result;
+	uint8_t drawn[SPRITE_MAX];
+	const uint8_t count = sortDrawn(drawn);
+	for (uint8_t pos = count; pos-- > 0;)
+		spriteErase(buffer, _sprites[drawn[pos]]);
+	for (uint8_t index = 0; index < _count; index++)
+		_sprites[index].changed = true;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Forgets the sprites on screen, the next layerUpdate draws them all
+	@note Call after the whole screen buffer was cleared or drawn over.
+*/
+void displaylib_sprite_layer::layerInvalidate(void)
+{
+	for (uint8_t index = 0; index < _count; index++)
+	{
+		_sprites[index].drawn = false;
+		_sprites[index].changed = true;
+	}
+}
+
+/*!
+	@brief Have sprites been erased or drawn since the last flushDirty or clearDirty
+	@return true if there are dirty rectangles to send
+*/
+bool displaylib_sprite_layer::getDirty(void) const
+{
+	return _dirtyCount > 0;
+}
+
+/*!
+	@brief Dirty rectangles kept since the last flushDirty or clearDirty
+	@return count
+*/
+uint8_t displaylib_sprite_layer::getDirtyCount(void) const
+{
+	return _dirtyCount;
+}
+
+/*!
+	@brief A dirty rectangle
+	@param index 0 to getDirtyCount() - 1
+	@return the rectangle in screen co-ordinates, w is 0 if there is no such rectangle
+*/
+displaylib_flush::flush_rect_t displaylib_sprite_layer::getDirtyRect(uint8_t index) const
+{
+	return (index < _dirtyCount) ? _dirty[index] : displaylib_flush::flush_rect_t{};
+}
+
+/*!
+	@brief Empties the dirty list, e.g. after layerInvalidate and a full update
+*/
+void displaylib_sprite_layer::clearDirty(void)
+{
+	_dirtyCount = 0;
+}
+
+/*!
+	@brief Sends the dirty rectangles to the display with updateRegion
+	@param display the display driver object, the same display as the constructor
+	@return Success or the updateRegion error, the rectangles not sent stay dirty
+*/
+DisplayRet::Ret_Codes_e displaylib_sprite_layer::flushDirty(displaylib_flush &display)
+{
+	while (_dirtyCount > 0)
+	{
+		DisplayRet::Ret_Codes_e result = display.updateRegion(_dirty[_dirtyCount - 1]);
+		if (result != DisplayRet::Success)
+			return result;
+		_dirtyCount--;
+	}
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Checks the size of a sprite image and mask
+	@param bitmap the image
+	@param mask the mask or empty
+	@param w width
+	@param h height
+	@return true if they fit the size
+*/
+bool displaylib_sprite_layer::checkFrame(std::span<const uint8_t> bitmap, std::span<const uint8_t> mask,
+	int16_t w, int16_t h) const
+{
+	const size_t bytes = static_cast<size_t>(w) * ((h + 7) / 8);
+	if (w < 1 || h < 1 || h > SPRITE_HEIGHT_MAX || bitmap.size() < bytes || (!mask.empty() && mask.size() < bytes))
+	{
+		displaylib_diag::error(displaylib_diag::FuncSprite, DisplayRet::BitmapSize, w, h);
+		return false;
+	}
+	return true;
+}
+
+/*!
+	@brief Part of a sprite on screen
+	@param sprite the sprite
+	@return the rectangle clipped to the screen, w is 0 if off screen
+*/
+displaylib_flush::flush_rect_t displaylib_sprite_layer::screenRect(const sprite_t &sprite) const
+{
+	displaylib_flush::flush_rect_t rect;
+	const int16_t left = std::max<int16_t>(sprite.x, 0);
+	const int16_t right = std::min<int16_t>(sprite.x + sprite.w, _display.WIDTH);
+	const int16_t top = std::max<int16_t>(sprite.y, 0);
+	const int16_t bottom = std::min<int16_t>(sprite.y + sprite.h, _display.HEIGHT);
+	if (left >= right || top >= bottom)
+		return rect;
+	rect.x = left;
+	rect.y = top;
+	rect.w = right - left;
+	rect.h = bottom - top;
+	return rect;
+}
+
+/*!
+	@brief Sprite numbers back to front, by z then the order added
+	@param order returns the numbers
+	@return number of sprites
+*/
+uint8_t displaylib_sprite_layer::sortLayer(uint8_t *order) const
+{
+	for (uint8_t index = 0; index < _count; index++)
+	{
+		uint8_t pos = index;
+		while (pos > 0 && _sprites[order[pos - 1]].z > _sprites[index].z)
+		{
+			order[pos] = order[pos - 1];
+			pos--;
+		}
+		order[pos] = index;
+	}
+	return _count;
+}
+
+/*!
+	@brief Drawn sprite numbers in the order they were drawn
+	@param order returns the numbers
+	@return number of sprites drawn
+*/
+uint8_t displaylib_sprite_layer::sortDrawn(uint8_t *order) const
+{
+	uint8_t count = 0;
+	for (uint8_t index = 0; index < _count; index++)
+	{
+		if (!_sprites[index].drawn)
+			continue;
+		uint8_t pos = count++;
+		while (pos > 0 && _sprites[order[pos - 1]].serial > _sprites[index].serial)
+		{
+			order[pos] = order[pos - 1];
+			pos--;
+		}
+		order[pos] = index;
+	}
+	return count;
+}
+
+/*!
+	@brief Puts back the bytes under a drawn sprite, the rows it covered only
+	@param buffer the screen buffer
+	@param sprite the sprite
+*/
+void displaylib_sprite_layer::spriteErase(std::span<uint8_t> buffer, sprite_t &sprite)
+{
+	if (!sprite.drawn)
+		return;
+	const displaylib_flush::flush_rect_t &rect = sprite.drawnRect;
+	const int16_t firstPage = rect.y / 8;
+	const int16_t lastPage = (rect.y + rect.h - 1) / 8;
+	const uint8_t *saved = _saveArea.data() + sprite.save;
+	for (int16_t page = firstPage; page <= lastPage; page++)
+	{
+		const int16_t low = std::max<int16_t>(rect.y, page * 8) - (page * 8);
+		const int16_t high = std::min<int16_t>(rect.y + rect.h, (page * 8) + 8) - (page * 8);
+		const uint8_t rows = static_cast<uint8_t>(((1U << high) - 1U) & ~((1U << low) - 1U));
+		uint8_t *cell = buffer.data() + (page * _display.WIDTH) + rect.x;
+		const uint8_t *from = saved + ((page - firstPage) * rect.w);
+		for (int16_t col = 0; col < rect.w; col++)
+			cell[col] = static_cast<uint8_t>((cell[col] & ~rows) | (from[col] & rows));
+	}
+	sprite.drawn = false;
+	markDirty(rect);
+}
+
+/*!
+	@brief Saves the bytes under a sprite and draws it
+	@param buffer the screen buffer
+	@param sprite the sprite
+	@details Each bitmap byte covers rows y + 8p to y + 8p + 7, when y is not a
+		multiple of 8 it is split over two screen pages, shifted down into the
+		first and up into the second. Rows past the sprite height or off
+		screen are cleared from the mask first.
+*/
+void displaylib_sprite_layer::spriteDraw(std::span<uint8_t> buffer, sprite_t &sprite)
+{
+	const displaylib_flush::flush_rect_t rect = screenRect(sprite);
+	if (rect.w == 0)
+		return;
+	const int16_t firstPage = rect.y / 8;
+	const int16_t lastPage = (rect.y + rect.h - 1) / 8;
+	uint8_t *saved = _saveArea.data() + sprite.save;
+	for (int16_t page = firstPage; page <= lastPage; page++)
+	{
+		const uint8_t *cell = buffer.data() + (page * _display.WIDTH) + rect.x;
+		std::copy(cell, cell + rect.w, saved + ((page - firstPage) * rect.w));
+	}
+	const int16_t spritePages = (sprite.h + 7) / 8;
+	const int16_t shift = sprite.y & 7;      // rows into the screen page, y may be negative
+	const int16_t basePage = sprite.y >> 3;  // floor
+	for (int16_t page = 0; page < spritePages; page++)
+	{
+		// rows of this bitmap byte that are inside the sprite and on screen
+		const int16_t rowTop = sprite.y + (page * 8);
+		const int16_t low = std::max<int16_t>(rect.y - rowTop, 0);
+		const int16_t high = std::min<int16_t>({static_cast<int16_t>(rect.y + rect.h - rowTop), 8,
+			static_cast<int16_t>(sprite.h - (page * 8))});
+		if (low >= high)
+			continue;
+		const uint8_t rows = static_cast<uint8_t>(((1U << high) - 1U) & ~((1U << low) - 1U));
+		const int16_t screenPage = basePage + page;
+		uint8_t *first = (screenPage >= 0) ? buffer.data() + (screenPage * _display.WIDTH) : nullptr;
+		uint8_t *second = buffer.data() + ((screenPage + 1) * _display.WIDTH);
+		for (int16_t x = rect.x; x < rect.x + rect.w; x++)
+		{
+			const int16_t column = (page * sprite.w) + (x - sprite.x);
+			const uint8_t image = sprite.bitmap[column];
+			const uint8_t opaque = static_cast<uint8_t>((sprite.mask.empty() ? image : sprite.mask[column]) & rows);
+			if (opaque == 0)
+				continue;
+			const uint16_t maskBits = static_cast<uint16_t>(opaque << shift);
+			const uint16_t imageBits = static_cast<uint16_t>((image & opaque) << shift);
+			if (first && (maskBits & 0xFF))
+				first[x] = static_cast<uint8_t>((first[x] & ~maskBits) | imageBits);
+			if (maskBits >> 8)
+				second[x] = static_cast<uint8_t>((second[x] & ~(maskBits >> 8)) | (imageBits >> 8));
+		}
+	}
+	sprite.drawn = true;
+	sprite.drawnRect = rect;
+	sprite.serial = ++_serial;
+	markDirty(rect);
+}
+
+/*!
+	@brief One column of the mask of a sprite
+	@param sprite the sprite
+	@param column the column, 0 to w - 1
+	@return the opaque pixels, bit 0 top row
+*/
+uint64_t displaylib_sprite_layer::maskColumn(const sprite_t &sprite, int16_t column) const
+{
+	const std::span<const uint8_t> mask = sprite.mask.empty() ? sprite.bitmap : sprite.mask;
+	uint64_t bits = 0;
+	for (int16_t page = 0; page < (sprite.h + 7) / 8; page++)
+		bits |= static_cast<uint64_t>(mask[(page * sprite.w) + column]) << (page * 8);
+	return (sprite.h >= 64) ? bits : (bits & ((1ULL << sprite.h) - 1));
+}
+
+/*!
+	@brief Adds a rectangle to the dirty list, merged with any it overlaps
+	@param rect the rectangle
+	@details When the list is full the rectangle is merged with the one that
+		grows the least.
+*/
+void displaylib_sprite_layer::markDirty(displaylib_flush::flush_rect_t rect)
+{
+	if (rect.w == 0)
+		return;
+	bool merged = true;
+	while (merged)
+	{
+		merged = false;
+		for (uint8_t index = 0; index < _dirtyCount; index++)
+		{
+			if (overlap(rect, _dirty[index]))
+			{
+				rect = displaylib_flush::rectMerge(rect, _dirty[index]);
+				_dirty[index] = _dirty[--_dirtyCount];
+				merged = true;
+				break;
+			}
+		}
+	}
+	if (_dirtyCount < SPRITE_DIRTY_MAX)
+	{
+		_dirty[_dirtyCount++] = rect;
+		return;
+	}
+	uint8_t best = 0;
+	int32_t bestGrowth = INT32_MAX;
+	for (uint8_t index = 0; index < _dirtyCount; index++)
+	{
+		const displaylib_flush::flush_rect_t both = displaylib_flush::rectMerge(rect, _dirty[index]);
+		const int32_t growth = (static_cast<int32_t>(both.w) * both.h) -
+			(static_cast<int32_t>(_dirty[index].w) * _dirty[index].h);
+		if (growth < bestGrowth)
+		{
+			bestGrowth = growth;
+			best = index;
+		}
+	}
+	rect = displaylib_flush::rectMerge(rect, _dirty[best]);
+	_dirty[best] = _dirty[--_dirtyCount];
+	markDirty(rect);
+}
+
+/*!
+	@brief Do two rectangles share a pixel
+	@param a a rectangle
+	@param b another
+	@return true if they overlap, empty rectangles never do
+*/
+bool displaylib_sprite_layer::overlap(const displaylib_flush::flush_rect_t &a, const displaylib_flush::flush_rect_t &b)
+{
+	return a.w > 0 && b.w > 0 && a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
@@ -0,0 +1,116 @@
+/*!
+	@file display_suspend.cpp
+	@brief Source file for the display suspend and resume bookkeeping
+	@author Gavin Lyons.
+*/
+
+#include <algorithm>
+#include "pico/stdlib.h"
+#include "../../include/displaylib/display_suspend.hpp"
+
+/*!
+	@brief init the suspend class object
+	@param retained the state the sleep mode of the controller keeps, suspend_state_e mask
+*/
+displaylib_suspend::displaylib_suspend(uint8_t retained) : _suspendRetained(retained)
+{
+}
+
+/*!
+	@brief Is the display suspended
+	@return true between suspend and resume
+*/
+bool displaylib_suspend::GetSuspended(void) const
+{
+	return _suspended;
+}
+
+/*!
+	@brief The state the controller keeps while suspended, as long as it stays powered
+	@return suspend_state_e mask
+*/
+uint8_t displaylib_suspend::GetSuspendRetained(void) const
+{
+	return _suspendRetained;
+}
+
+/*!
+	@brief Records the commands last sent for a state, replayed if the state is lost
+	@param state the state, not StateRAM
+	@param commands the command bytes, at most SUSPEND_CMD_MAX
+*/
+void displaylib_suspend::suspendNote(suspend_state_e state, std::span<const uint8_t> commands)
+{
+	uint8_t index = 0;
+	while (index < SUSPEND_STATES && state != (1 << index))
+		index++;
+	if (index >= SUSPEND_STATES || commands.size() > SUSPEND_CMD_MAX)
+		return;
+	std::copy(commands.begin(), commands.end(), _stateCmds[index]);
+	_stateCmdLength[index] = static_cast<uint8_t>(commands.size());
+}
+
+/*!
+	@brief Marks the display suspended and takes the fingerprint of the screen buffer
+	@param frame the screen buffer
+*/
+void displaylib_suspend::suspendRecord(std::span<const uint8_t> frame)
+{
+	_suspendHash = frameHash(frame);
+	_suspended = true;
+}
+
+/*!
+	@brief Works out what must be restored on resume, clears the suspended flag
+	@param frame the screen buffer
+	@param powerLost true if the display lost power while suspended
+	@return suspend_state_e mask of the state to restore
+*/
+uint8_t displaylib_suspend::suspendLost(std::span<const uint8_t> frame, bool powerLost)
+{
+	uint8_t lost = powerLost ? static_cast<uint8_t>(StateAll) : static_cast<uint8_t>(~_suspendRetained & StateAll);
+	if (!(lost & StateRAM) && frameHash(frame) != _suspendHash)
+		lost |= StateRAM; // buffer drawn on while suspended
+	if (frame.empty())
+		lost &= ~StateRAM;
+	_suspended = false;
+	return lost;
+}
+
+/*!
+	@brief Sends the recorded commands of the lost states in one block
+	@param lost suspend_state_e mask from suspendLost
+	@return Success or a bus error code
+	@note States never set by the user are skipped, init has set their defaults.
+*/
+DisplayRet::Ret_Codes_e displaylib_suspend::suspendReplay(uint8_t lost)
+{
+	uint8_t commands[SUSPEND_STATES * SUSPEND_CMD_MAX];
+	uint8_t length = 0;
+	for (uint8_t index = 0; index < SUSPEND_STATES; index++)
+	{
+		if (!(lost & (1 << index)))
+			continue;
+		std::copy(_stateCmds[index], _stateCmds[index] + _stateCmdLength[index], commands + length);
+		length += _stateCmdLength[index];
+	}
+	if (length == 0)
+		return DisplayRet::Success;
+	return suspendSendCommands(std::span<const uint8_t>(commands, length));
+}
+
+/*!
+	@brief Fingerprint of a frame, 32 bit FNV-1a
+	@param frame the frame
+	@return the hash
+*/
+uint32_t displaylib_suspend::frameHash(std::span<const uint8_t> frame)
+{
+	uint32_t hash = 2166136261U;
+	for (uint8_t byte : frame)
+	{
+		hash ^= byte;
+		hash *= 16777619U;
+	}
+	return hash;
+}
@@ -5,13 +5,14 @@
 */
 
 #include "../../include/displaylib/erm19264.hpp"
+#include "../../include/displaylib/display_diag.hpp"
 
 /*!
 	@brief init the LCD class object
 	@param lcdwidth width of LCD in pixels
 	@param lcdheight height of LCD in pixels
  */
-ERM19264::ERM19264(int16_t lcdwidth, int16_t lcdheight) : displaylib_graphics(lcdwidth, lcdheight)
+ERM19264::ERM19264(int16_t lcdwidth, int16_t lcdheight) : displaylib_graphics(lcdwidth, lcdheight), displaylib_flush(lcdwidth, lcdheight), displaylib_suspend(SUSPEND_RETAINED)
 {
 	_LCD_HEIGHT = lcdheight;
 	_LCD_WIDTH = lcdwidth;
@@ -64,37 +65,68 @@ void ERM19264::LCDSPISetup(spi_inst_t* spiType, uint32_t spiSpeedKhz,int8_t cd,
 }
 
 /*!
-	@brief begin Method initialise LCD
+	@brief begin Method initialise LCD, blocking
 	@param VbiasPOT contrast default = 0x49 , range 0x00 to 0xFE
 	@param AddressSet AC [2:0] registers for RAM addr ctrl. default=2 range 0-7
  */
 void ERM19264::LCDinit(uint8_t VbiasPOT, uint8_t AddressSet)
+{
+	LCDinitAsync(VbiasPOT, AddressSet);
+	bootComplete();
+}
+
+/*!
+	@brief begin Method initialise LCD, does not wait for power up
+	@param VbiasPOT contrast default = 0x49 , range 0x00 to 0xFE
+	@param AddressSet AC [2:0] registers for RAM addr ctrl. default=2 range 0-7
+	@note Poll isReady to finish the power up sequence while doing other work,
+		the buffer can be sent once the init commands are sent.
+ */
+void ERM19264::LCDinitAsync(uint8_t VbiasPOT, uint8_t AddressSet)
 {
 	_VbiasPOT = VbiasPOT;
 	if (AddressSet > 7 ) AddressSet = 0x02;
 	_AddressCtrl =  AddressSet;
-	display_CD_SetHigh;
-	display_CS_SetHigh;
-	busy_wait_ms(UC1609_INIT_DELAY2);
-
-	LCDReset();
-
-	display_CS_SetLow;
-
-	SendCommand(UC1609_TEMP_COMP_REG, UC1609_TEMP_COMP_SET);
-	SendCommand(UC1609_ADDRESS_CONTROL, _AddressCtrl);
-	SendCommand(UC1609_FRAMERATE_REG, UC1609_FRAMERATE_SET);
-	SendCommand(UC1609_BIAS_RATIO, UC1609_BIAS_RATIO_SET);
-	SendCommand(UC1609_POWER_CONTROL, UC1609_PC_SET);
-	busy_wait_ms(UC1609_INIT_DELAY);
-
-	SendCommand(UC1609_GN_PM, 0);
-	SendCommand(UC1609_GN_PM, _VbiasPOT); //  changed by user
-
-	SendCommand(UC1609_DISPLAY_ON, 0x01);					  // turn on display
-	SendCommand(UC1609_LCD_CONTROL, ROTATION_NORMAL); // rotate to normal
+	bootBegin();
+}
 
-	display_CS_SetHigh;
+/*!
+	@brief Power up sequence, hardware reset, power control command table in
+		one SPI burst, then bias and display on once the charge pump has settled.
+	@param stage stage number
+	@return wait in uS before the next stage, or BOOT_DONE
+	@note Display RAM can be written during the charge pump wait.
+*/
+uint32_t ERM19264::bootStage(uint8_t stage)
+{
+	switch (stage)
+	{
+		case 0:
+			display_CD_SetHigh;
+			display_CS_SetHigh;
+			display_RST_SetLow;
+			return UC1609_RESET_LOW_US;
+		case 1:
+			display_RST_SetHigh;
+			return UC1609_RESET_WAIT_US;
+		case 2:
+		{
+			const auto powerCmds = PowerCommands(_AddressCtrl);
+			display_CS_SetLow;
+			SendCommands(powerCmds);
+			display_CS_SetHigh;
+			bootRamReady();
+			return UC1609_POWER_WAIT_US;
+		}
+		default:
+		{
+			const auto enableCmds = EnableCommands(_VbiasPOT);
+			display_CS_SetLow;
+			SendCommands(enableCmds);
+			display_CS_SetHigh;
+			return BOOT_DONE;
+		}
+	}
 }
 
 /*!
@@ -110,6 +142,17 @@ void ERM19264::SendCommand(uint8_t command, uint8_t value)
 	display_CD_SetHigh;
 }
 
+/*!
+	@brief Sends a block of commands to the display in one SPI write
+	@param commands the command bytes
+*/
+void ERM19264::SendCommands(std::span<const uint8_t> commands)
+{
+	display_CD_SetLow;
+	statsBusWrite(spi_write_blocking(_spiInterface, commands.data(), commands.size()), commands);
+	display_CD_SetHigh;
+}
+
 /*!
 	@brief Resets LCD in a four wire setup called at start
 	and  should also be called in a controlled power down setting
@@ -152,6 +195,58 @@ void ERM19264::LCDEnable(uint8_t bits)
 	display_CS_SetHigh;
 }
 
+/*!
+	@brief Puts the LCD to sleep, display off.
+	@return Success
+	@note Display RAM and all registers are retained while VDD stays on,
+		resume with LCDResume.
+*/
+DisplayRet::Ret_Codes_e ERM19264::LCDSuspend(void)
+{
+	if (GetSuspended())
+		return DisplayRet::Success;
+	suspendRecord(flushBuffer());
+	LCDEnable(0);
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Wakes the LCD from LCDSuspend, restores only what was lost.
+	@param powerLost set true if the LCD supply was switched off while suspended,
+		the LCD is then re-initialised and invert and scroll restored.
+	@return Success or LCDupdate error
+	@details The screen buffer is only sent if it changed since LCDSuspend,
+		or power was lost. It is sent before the display is turned on.
+*/
+DisplayRet::Ret_Codes_e ERM19264::LCDResume(bool powerLost)
+{
+	if (!GetSuspended())
+		return DisplayRet::Success;
+	const uint8_t lost = suspendLost(flushBuffer(), powerLost);
+	if (powerLost)
+		LCDinit(_VbiasPOT, _AddressCtrl);
+	DisplayRet::Ret_Codes_e result = DisplayRet::Success;
+	if (lost & StateRAM)
+		result = LCDupdate();
+	suspendReplay(lost);
+	if (!powerLost)
+		LCDEnable(1);
+	return result;
+}
+
+/*!
+	@brief Sends a block of commands, used by the suspend replay
+	@param commands the command bytes
+	@return Success
+*/
+DisplayRet::Ret_Codes_e ERM19264::suspendSendCommands(std::span<const uint8_t> commands)
+{
+	display_CS_SetLow;
+	SendCommands(commands);
+	display_CS_SetHigh;
+	return DisplayRet::Success;
+}
+
 /*!
 	@brief Scroll the displayed image up by SL rows.
 	@details The valid SL value is between 0 (for no
@@ -161,9 +256,11 @@ void ERM19264::LCDEnable(uint8_t bits)
 */
 void ERM19264::LCDscroll(uint8_t bits)
 {
+	const uint8_t scrollCmd[1] = {static_cast<uint8_t>(UC1609_SCROLL | bits)};
 	display_CS_SetLow;
-	SendCommand(UC1609_SCROLL, bits);
+	SendCommands(scrollCmd);
 	display_CS_SetHigh;
+	suspendNote(StateStartLine, scrollCmd);
 }
 
 /*!
@@ -204,9 +301,11 @@ void ERM19264::LCDsetRotateCmd(LCD_rotate_cmd_e  rotatevalue)
 */
 void ERM19264::LCDInvertDisplay(uint8_t bits)
 {
+	const uint8_t invertCmd[1] = {static_cast<uint8_t>(UC1609_INVERSE_DISPLAY | bits)};
 	display_CS_SetLow;
-	SendCommand(UC1609_INVERSE_DISPLAY, bits);
+	SendCommands(invertCmd);
 	display_CS_SetHigh;
+	suspendNote(StateInvert, invertCmd);
 }
 
 /*!
@@ -228,6 +327,7 @@ void ERM19264::LCDAllpixelsOn(uint8_t bits)
 */
 void ERM19264::LCDFillScreen(uint8_t dataPattern = 0, uint8_t delay = 0)
 {
+	flushAddressLost();
 	display_CS_SetLow;
 	uint16_t numofbytes = _LCD_WIDTH * (_LCD_HEIGHT / 8); // width * height
 	for (uint16_t i = 0; i < numofbytes; i++)
@@ -244,6 +344,7 @@ void ERM19264::LCDFillScreen(uint8_t dataPattern = 0, uint8_t delay = 0)
 */
 void ERM19264::LCDFillPage(uint8_t dataPattern = 0)
 {
+	flushAddressLost();
 	display_CS_SetLow;
 	uint16_t numofbytes = ((_LCD_WIDTH * (_LCD_HEIGHT / 8)) / 8); // (width * height/8)/8 = 192 bytes
 	for (uint16_t i = 0; i < numofbytes; i++)
@@ -264,6 +365,7 @@ void ERM19264::LCDFillPage(uint8_t dataPattern = 0)
 */
 void ERM19264::LCDBitmap(int16_t x, int16_t y, uint8_t w, uint8_t h, std::span<const uint8_t>  data)
 {
+	flushAddressLost();
 	display_CS_SetLow;
 
 	uint8_t tx, ty;
@@ -299,7 +401,7 @@ void ERM19264::LCDBitmap(int16_t x, int16_t y, uint8_t w, uint8_t h, std::span<c
 	 @param data the data byte to send 
 */
 void ERM19264::SendData(uint8_t data){
-	spi_write_blocking(_spiInterface, &data, 1);
+	statsBusWrite(spi_write_blocking(_spiInterface, &data, 1), std::span<const uint8_t>(&data, 1));
 }
 
 /*!
@@ -308,19 +410,79 @@ void ERM19264::SendData(uint8_t data){
 	@return 
 		-# Success 
 		-# BufferEmpty if buffer is empty object
+		-# BufferSize if buffer size does not match the screen
+	@note Blocking, see updateBegin and updateStep to spread the update over several calls.
 */
 DisplayRet::Ret_Codes_e ERM19264::LCDupdate()
 {
 	if (_LCDbuffer.empty())
 	{
-		printf("ERM19264_UC1609::LCDupdate Error Buffer is empty, cannot update screen\r\n");
+		displaylib_diag::error(displaylib_diag::FuncUpdate, DisplayRet::BufferEmpty);
 		return DisplayRet::BufferEmpty;
 	}
-	uint8_t x = 0;
-	uint8_t y = 0;
-	uint8_t w = this->_LCD_WIDTH;
-	uint8_t h = this->_LCD_HEIGHT;
-	LCDBuffer(x, y, w, h, _LCDbuffer);
+	DisplayRet::Ret_Codes_e result = updateBegin();
+	if (result != DisplayRet::Success)
+		return result;
+	return updateComplete();
+}
+
+/*!
+	@brief Returns the screen buffer, the default frame for updateBegin
+	@return span of the screen buffer
+*/
+std::span<const uint8_t> ERM19264::flushBuffer(void)
+{
+	return _LCDbuffer;
+}
+
+/*!
+	@brief The screen buffer for the graphics byte writes
+	@return the buffer, empty if not set
+*/
+std::span<uint8_t> ERM19264::graphicsBuffer(void)
+{
+	return _LCDbuffer;
+}
+
+/*!
+	@brief Sets the page and column address for the flush
+	@param page page to write
+	@param column first column to write
+	@param columnEnd unused, the UC1609 has no column window
+	@return Success
+*/
+DisplayRet::Ret_Codes_e ERM19264::flushSetAddress(uint8_t page, uint8_t column, uint8_t columnEnd)
+{
+	(void)columnEnd;
+	display_CS_SetLow;
+	SendCommand(UC1609_SET_COLADD_LSB, (column & 0x0F));
+	SendCommand(UC1609_SET_COLADD_MSB, (column & 0xF0) >> 4);
+	SendCommand(UC1609_SET_PAGEADD, page);
+	display_CS_SetHigh;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Writes a chunk of the flush to display RAM in one SPI transfer
+	@param data the data to write
+	@return Success
+*/
+DisplayRet::Ret_Codes_e ERM19264::flushWriteData(std::span<const uint8_t> data)
+{
+	display_CS_SetLow;
+	statsBusWrite(spi_write_blocking(_spiInterface, data.data(), data.size()), data);
+	display_CS_SetHigh;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Sets the RAM line shown at top of screen, hardware scroll, as LCDscroll
+	@param line RAM line 0-63
+	@return Success
+*/
+DisplayRet::Ret_Codes_e ERM19264::flushStartLine(uint8_t line)
+{
+	LCDscroll(line & 0x3F);
 	return DisplayRet::Success;
 }
 
@@ -335,7 +497,7 @@ DisplayRet::Ret_Codes_e ERM19264::LCDclearBuffer()
 {
 	if (_LCDbuffer.empty())
 	{
-		printf("ERM19264_UC1609::LCDclearBuffer Error: Buffer is empty, cannot clear\r\n");
+		displaylib_diag::error(displaylib_diag::FuncClearBuffer, DisplayRet::BufferEmpty);
 		return DisplayRet::BufferEmpty;
 	}
 
@@ -354,6 +516,7 @@ DisplayRet::Ret_Codes_e ERM19264::LCDclearBuffer()
 */
 void ERM19264::LCDBuffer(int16_t x, int16_t y, uint8_t w, uint8_t h, std::span<uint8_t> data)
 {
+	flushAddressLost();
 	display_CS_SetLow;
 
 	uint8_t tx, ty;
@@ -444,13 +607,13 @@ DisplayRet::Ret_Codes_e ERM19264::LCDSetBufferPtr(uint8_t width, uint8_t height,
 {
 	if (buffer.size() != static_cast<size_t>(width * (height / 8)))
 	{
-		printf("ERM19264_UC1609::LCDSetBufferPtr Error 2: buffer size does not equal w * (h/8))\r\n");
+		displaylib_diag::error(displaylib_diag::FuncSetBufferPtr, DisplayRet::BufferSize, width, height);
 		return DisplayRet::BufferSize;
 	}
 	_LCDbuffer = buffer;
 
 	if (buffer.empty())	{
-		printf("ERM19264_UC1609::LCDSetBufferPtr Error 3: Problem assigning buffer, received empty buffer\r\n");
+		displaylib_diag::error(displaylib_diag::FuncSetBufferPtr, DisplayRet::BufferEmpty);
 		return DisplayRet::BufferEmpty;
 	}
 	return DisplayRet::Success;
@@ -463,6 +626,7 @@ DisplayRet::Ret_Codes_e ERM19264::LCDSetBufferPtr(uint8_t width, uint8_t height,
 */
 void ERM19264::LCDGotoXY(uint8_t column , uint8_t page)
 {
+	flushAddressLost();
 	display_CS_SetLow;
 	SendCommand(UC1609_SET_COLADD_LSB, (column & 0x0F)); 
 	SendCommand(UC1609_SET_COLADD_MSB, (column & 0xF0) >> 4);
@@ -5,13 +5,14 @@
  */
 
 #include "../../include/displaylib/nokia5110.hpp"
+#include "../../include/displaylib/display_diag.hpp"
 
 /*!
 	@brief init the LCD class object
 	@param lcdwidth width of LCD in pixels
 	@param lcdheight height of LCD in pixels
  */
-NOKIA_5110::NOKIA_5110(int16_t lcdwidth, int16_t lcdheight) : displaylib_graphics(lcdwidth, lcdheight)
+NOKIA_5110::NOKIA_5110(int16_t lcdwidth, int16_t lcdheight) : displaylib_graphics(lcdwidth, lcdheight), displaylib_flush(lcdwidth, lcdheight), displaylib_suspend(SUSPEND_RETAINED)
 {
 	_LCD_HEIGHT = lcdheight;
 	_LCD_WIDTH = lcdwidth;
@@ -53,7 +54,7 @@ DisplayRet::Ret_Codes_e NOKIA_5110::LCDSPISetup(spi_inst_t *spiType, uint32_t sp
 	auto baudRateReturned = spi_init(_spiInterface, spiSpeedKhz * 1000);
 	if (baudRateReturned  == 0)
 	{
-		printf("Warning :: the actual baud rate set of spi_init is zero\n");
+		displaylib_diag::warning(displaylib_diag::FuncSPISetup, DisplayRet::GenericError);
 	}
 	// Initialize SPI pins
 	gpio_set_function(_display_SCLK, GPIO_FUNC_SPI);
@@ -70,33 +71,64 @@ DisplayRet::Ret_Codes_e NOKIA_5110::LCDSPISetup(spi_inst_t *spiType, uint32_t sp
 }
 
 /*!
-	@brief Init the LCD command sequence, called from begin
+	@brief Init the LCD command sequence, called from begin, blocking
 			This sends the commands to the PCD8544 to init LCD
 	@param Inverse false normal mode true display inverted
 	@param Contrast Set LCD VOP contrast range 0xB1-BF
 	@param Bias LCD Bias mode 1:48 0x12 to 0x14
 */
 void NOKIA_5110::LCDInit(bool Inverse, uint8_t Contrast, uint8_t Bias)
+{
+	LCDInitAsync(Inverse, Contrast, Bias);
+	bootComplete();
+}
+
+/*!
+	@brief Init the LCD command sequence, called from begin, does not wait for power up
+	@param Inverse false normal mode true display inverted
+	@param Contrast Set LCD VOP contrast range 0xB1-BF
+	@param Bias LCD Bias mode 1:48 0x12 to 0x14
+	@note Poll isReady to finish the power up sequence while doing other work.
+		The datasheet requires the reset within 30mS of power on.
+*/
+void NOKIA_5110::LCDInitAsync(bool Inverse, uint8_t Contrast, uint8_t Bias)
 {
 	_inverse = Inverse;
 	_bias = Bias;
 	_contrast = Contrast;
-	busy_wait_ms(100);
-	display_RST_SetHigh;
-	display_RST_SetLow;
-	busy_wait_ms(50);
+	bootBegin();
+}
+
+/*!
+	@brief Power up sequence, reset pulse then the init command table in one SPI burst.
+	@param stage stage number
+	@return wait in uS before the next stage, or BOOT_DONE
+*/
+uint32_t NOKIA_5110::bootStage(uint8_t stage)
+{
+	if (stage == 0)
+	{
+		display_RST_SetLow;
+		return LCD_RESET_LOW_US;
+	}
 	display_RST_SetHigh;
-	// get into the EXTENDED mode
-	LCDWriteCommand(LCD_FUNCTIONSET | LCD_EXTENDEDINSTRUCTION);
-	LCDWriteCommand(_bias);
-	LCDWriteCommand(LCD_SETTEMP);
-	LCDWriteCommand(_contrast);
-	LCDWriteCommand(LCD_FUNCTIONSET); // We must send 0x20 before modifying the display control mode
-	// set LCDdisplayUpdate to normal mode or inverted
-	if (_inverse == false)
-		LCDWriteCommand(LCD_DISPLAYCONTROL | LCD_DISPLAYNORMAL);
-	else
-		LCDWriteCommand(LCD_DISPLAYCONTROL | LCD_DISPLAYINVERTED);
+	const auto initCmds = InitCommands(_inverse, _contrast, _bias);
+	suspendSendCommands(initCmds);
+	return BOOT_DONE;
+}
+
+/*!
+	@brief Sends a block of commands in one SPI write
+	@param commands the command bytes
+	@return Success
+*/
+DisplayRet::Ret_Codes_e NOKIA_5110::suspendSendCommands(std::span<const uint8_t> commands)
+{
+	display_CD_SetLow;
+	display_CS_SetLow;
+	statsBusWrite(spi_write_blocking(_spiInterface, commands.data(), commands.size()), commands);
+	display_CS_SetHigh;
+	return DisplayRet::Success;
 }
 
 /*!
@@ -126,7 +158,7 @@ void NOKIA_5110::LCDPowerDown(void)
 */
 void NOKIA_5110::LCDWriteData(uint8_t dataByte)
 {
-	spi_write_blocking(_spiInterface, &dataByte, 1);
+	statsBusWrite(spi_write_blocking(_spiInterface, &dataByte, 1), std::span<const uint8_t>(&dataByte, 1));
 }
 
 /*!
@@ -200,6 +232,7 @@ void NOKIA_5110::drawPixel(int16_t x, int16_t y, uint8_t color)
 */
 void NOKIA_5110::LCDfillScreen(uint8_t Pattern)
 {
+	flushAddressLost();
 	uint16_t i;
 	LCDWriteCommand(LCD_SETYADDR); // set y = 0
 	LCDWriteCommand(LCD_SETXADDR); // set x = 0
@@ -256,6 +289,48 @@ void NOKIA_5110::LCDdisableSleep(void)
 		LCDWriteCommand(LCD_DISPLAYCONTROL | LCD_DISPLAYINVERTED);
 }
 
+/*!
+	@brief Puts the LCD in power down mode, as LCDenableSleep
+	@return Success
+	@note Display RAM is kept while VDD stays on, resume with LCDResume.
+*/
+DisplayRet::Ret_Codes_e NOKIA_5110::LCDSuspend(void)
+{
+	if (GetSuspended())
+		return DisplayRet::Success;
+	suspendRecord(flushBuffer());
+	LCDenableSleep();
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Wakes the LCD from LCDSuspend, restores only what was lost.
+	@param powerLost set true if the LCD supply was switched off while suspended,
+		the LCD is then re-initialised.
+	@return Success or LCDupdate error
+	@details Bias, contrast and invert are sent in one burst, which also leaves
+		power down mode. The screen buffer is only sent if it changed since
+		LCDSuspend, or power was lost.
+*/
+DisplayRet::Ret_Codes_e NOKIA_5110::LCDResume(bool powerLost)
+{
+	if (!GetSuspended())
+		return DisplayRet::Success;
+	const uint8_t lost = suspendLost(flushBuffer(), powerLost);
+	if (powerLost)
+	{
+		LCDInit(_inverse, _contrast, _bias);
+	} else
+	{
+		const auto wakeCmds = InitCommands(_inverse, _contrast, _bias);
+		suspendSendCommands(wakeCmds);
+	}
+	_sleep = false;
+	if (lost & StateRAM)
+		return LCDupdate();
+	return DisplayRet::Success;
+}
+
 /*!
 	@brief LCDisSleeping
 	@return  value of _sleep, if true LCD is in sleep mode.
@@ -268,15 +343,66 @@ bool NOKIA_5110::LCDIsSleeping() { return _sleep; }
 	@return
 		-# Success
 		-# BufferEmpty if buffer is empty object
+		-# BufferSize if buffer size does not match the screen
+	@note Blocking, see updateBegin and updateStep to spread the update over several calls.
 */
 DisplayRet::Ret_Codes_e NOKIA_5110::LCDupdate()
 {
 	if (_LCDbuffer.empty())
 	{
-		printf("NOKIA_5110 ::LCDupdate Error Buffer is empty, cannot update screen\r\n");
+		displaylib_diag::error(displaylib_diag::FuncUpdate, DisplayRet::BufferEmpty);
 		return DisplayRet::BufferEmpty;
 	}
-	LCDBuffer(_LCDbuffer);
+	DisplayRet::Ret_Codes_e result = updateBegin();
+	if (result != DisplayRet::Success)
+		return result;
+	return updateComplete();
+}
+
+/*!
+	@brief Returns the screen buffer, the default frame for updateBegin
+	@return span of the screen buffer
+*/
+std::span<const uint8_t> NOKIA_5110::flushBuffer(void)
+{
+	return _LCDbuffer;
+}
+
+/*!
+	@brief The screen buffer for the graphics byte writes
+	@return the buffer, empty if not set
+*/
+std::span<uint8_t> NOKIA_5110::graphicsBuffer(void)
+{
+	return _LCDbuffer;
+}
+
+/*!
+	@brief Sets the row block and column address for the flush
+	@param page row block to write 0-5
+	@param column first column to write
+	@param columnEnd unused, the PCD8544 has no column window
+	@return Success
+*/
+DisplayRet::Ret_Codes_e NOKIA_5110::flushSetAddress(uint8_t page, uint8_t column, uint8_t columnEnd)
+{
+	(void)columnEnd;
+	LCDWriteCommand(LCD_SETXADDR | column);
+	LCDWriteCommand(LCD_SETYADDR | page);
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Writes a chunk of the flush to display RAM in one SPI transfer
+	@param data the data to write
+	@return Success
+*/
+DisplayRet::Ret_Codes_e NOKIA_5110::flushWriteData(std::span<const uint8_t> data)
+{
+	display_CD_SetHigh; // Data send
+	display_CS_SetLow;
+	statsBusWrite(spi_write_blocking(_spiInterface, data.data(), data.size()), data);
+	display_CS_SetHigh;
 	return DisplayRet::Success;
 }
 
@@ -291,7 +417,7 @@ DisplayRet::Ret_Codes_e NOKIA_5110::LCDclearBuffer()
 {
 	if (_LCDbuffer.empty())
 	{
-		printf("NOKIA_5110::LCDclearBuffer Error: Buffer is empty, cannot clear\r\n");
+		displaylib_diag::error(displaylib_diag::FuncClearBuffer, DisplayRet::BufferEmpty);
 		return DisplayRet::BufferEmpty;
 	}
 
@@ -306,6 +432,7 @@ DisplayRet::Ret_Codes_e NOKIA_5110::LCDclearBuffer()
 */
 void NOKIA_5110::LCDBuffer(std::span<uint8_t> data)
 {
+	flushAddressLost();
 	LCDWriteCommand(LCD_SETYADDR); // set y = 0
 	LCDWriteCommand(LCD_SETXADDR); // set x = 0
 	display_CD_SetHigh;			   // Data send
@@ -331,14 +458,14 @@ DisplayRet::Ret_Codes_e NOKIA_5110::LCDSetBufferPtr(uint8_t width, uint8_t heigh
 {
 	if (buffer.size() != static_cast<size_t>(width * (height / 8)))
 	{
-		printf("NOKIA_5110::LCDSetBufferPtr Error 2: buffer size does not equal w * (h/8))\r\n");
+		displaylib_diag::error(displaylib_diag::FuncSetBufferPtr, DisplayRet::BufferSize, width, height);
 		return DisplayRet::BufferSize;
 	}
 	_LCDbuffer = buffer;
 
 	if (buffer.empty())
 	{
-		printf("NOKIA_5110::LCDSetBufferPtr Error 3: Problem assigning buffer, received empty buffer\r\n");
+		displaylib_diag::error(displaylib_diag::FuncSetBufferPtr, DisplayRet::BufferEmpty);
 		return DisplayRet::BufferEmpty;
 	}
 	return DisplayRet::Success;
@@ -352,6 +479,7 @@ DisplayRet::Ret_Codes_e NOKIA_5110::LCDSetBufferPtr(uint8_t width, uint8_t heigh
 */
 void NOKIA_5110::LCDgotoXY(uint8_t x, uint8_t y)
 {
+	flushAddressLost();
 	LCDWriteCommand(LCD_SETXADDR  | x); // Column. (result 0x80 to 0xD3)
 	LCDWriteCommand(LCD_SETYADDR  | y); // Row.
 }
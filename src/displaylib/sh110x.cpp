@@ -4,15 +4,17 @@
 */
 
 //#include <stdio.h> 
+#include <algorithm>
 #include "pico/stdlib.h"
 #include "../../include/displaylib/sh110x.hpp"
+#include "../../include/displaylib/display_diag.hpp"
 
 /*!
 	@brief init the screen object
 	@param oledwidth width of OLED in pixels
 	@param oledheight height of OLED in pixels
 */
-SH110X::SH110X(int16_t oledwidth, int16_t oledheight) :displaylib_graphics(oledwidth, oledheight)
+SH110X::SH110X(int16_t oledwidth, int16_t oledheight) :displaylib_graphics(oledwidth, oledheight), displaylib_flush(oledwidth, oledheight), displaylib_suspend(SUSPEND_RETAINED)
 {
 	_OLED_HEIGHT = oledheight;
 	_OLED_WIDTH = oledwidth;
@@ -34,12 +36,12 @@ DisplayRet::Ret_Codes_e SH110X::OLEDSetBufferPtr(uint8_t width, uint8_t height ,
 {
 	if(buffer.size() != static_cast<size_t>(width * (height / 8)))
 	{
-		printf("Error 1: OLEDSetBufferPtr: buffer size does not equal : width * (height/8))\n");
+		displaylib_diag::error(displaylib_diag::FuncSetBufferPtr, DisplayRet::BufferSize, width, height);
 		return DisplayRet::BufferSize;
 	}
 	if(buffer.empty())
 	{
-		printf("Error 2: OLEDSetBufferPtr: Problem assigning buffer pointer, empty object\r\n");
+		displaylib_diag::error(displaylib_diag::FuncSetBufferPtr, DisplayRet::BufferEmpty);
 		return DisplayRet::BufferEmpty;
 	}
 	_OLEDbuffer = buffer;
@@ -61,6 +63,30 @@ DisplayRet::Ret_Codes_e SH110X::OLEDSetBufferPtr(uint8_t width, uint8_t height ,
 */
 DisplayRet::Ret_Codes_e SH110X::OLEDbegin(OLED_IC_type_e OLEDtype, int8_t resetPin, uint8_t I2Caddress, 
 	i2c_inst_t* i2c_type, uint16_t CLKspeed, uint8_t  SDApin, uint8_t  SCLKpin)
+{
+	DisplayRet::Ret_Codes_e result = OLEDbeginAsync(OLEDtype, resetPin, I2Caddress, i2c_type, CLKspeed, SDApin, SCLKpin);
+	if (result == DisplayRet::Success)
+		bootComplete();
+	return result;
+}
+
+/*!
+	@brief  begin Method initialise OLED I2C communication, does not wait for power up
+	@param OLEDtype enum type of display sh1106 or sh1107
+	@param resetPin Used only if reset pin present on device, iF not = set to -1
+	@param I2Caddress I2C Bus address by default 0x3C
+	@param i2c_type The I2C interface i2c0 or ic21 interface
+	@param CLKspeed I2C Bus Clock speed in KHz. 
+	@param SDApin I2C data GPIO pin  
+	@param SCLKpin I2C clock GPIO pin 
+	@return 
+		-# Success if successful , init I2C communication
+		-# I2CbeginFail 
+	@note Poll isReady to finish the power up sequence while doing other work,
+		the buffer can be sent once the init commands are sent.
+*/
+DisplayRet::Ret_Codes_e SH110X::OLEDbeginAsync(OLED_IC_type_e OLEDtype, int8_t resetPin, uint8_t I2Caddress, 
+	i2c_inst_t* i2c_type, uint16_t CLKspeed, uint8_t  SDApin, uint8_t  SCLKpin)
 {
 	_OLED_IC_type = OLEDtype;
 	_Display_RST = resetPin;
@@ -87,15 +113,12 @@ DisplayRet::Ret_Codes_e SH110X::OLEDbegin(OLED_IC_type_e OLEDtype, int8_t resetP
 	ReturnCode = i2c_read_timeout_us(_i2c, _OLEDAddressI2C , &rxData, 1, false, _TimeoutDelayI2C);
 	if (ReturnCode < 1){ // no bytes read back from device or error issued
 		if (_bSerialDebugFlag)
-		{
-			printf("1201 ERROR I2C_SSD1306 OLED :: begin: \r\n");
-			printf("Check Connection, Return code :: %d ,RX data :: %u \r\n", ReturnCode , rxData);
-		}
+			displaylib_diag::error(displaylib_diag::FuncBegin, DisplayRet::I2CNotConnected, static_cast<int16_t>(ReturnCode), rxData);
 		_bIsConnected = false;
 		return DisplayRet::I2CbeginFail;
 	}
 	_bIsConnected = true;
-	OLEDinit();
+	bootBegin();
 	return DisplayRet::Success;
 }
 
@@ -126,23 +149,64 @@ void SH110X::OLEDPowerDown(void)
 }
 
 /*!
-	@brief Called from OLEDbegin carries out Power on sequence and register init
+	@brief Puts the OLED to sleep, display off.
+	@return Success or I2CNotConnected
+	@note Display RAM and all registers are retained while VDD stays on,
+		resume with OLEDResume.
+*/
+DisplayRet::Ret_Codes_e SH110X::OLEDSuspend(void)
+{
+	if (GetSuspended())
+		return DisplayRet::Success;
+	suspendRecord(_OLEDbuffer);
+	const uint8_t sleepCmd[1] = {SH110X_DISPLAYOFF};
+	return I2CWriteBlock(sleepCmd, SH110X_COMMAND_BYTE);
+}
+
+/*!
+	@brief Wakes the OLED from OLEDSuspend, restores only what was lost.
+	@param powerLost set true if the OLED supply was switched off while suspended,
+		the OLED is then re-initialised and all user state restored.
+	@return Success or I2CNotConnected
+	@details The screen buffer is only sent if it changed since OLEDSuspend,
+		or power was lost. It is sent before the display is turned on.
+*/
+DisplayRet::Ret_Codes_e SH110X::OLEDResume(bool powerLost)
+{
+	if (!GetSuspended())
+		return DisplayRet::Success;
+	const uint8_t lost = suspendLost(_OLEDbuffer, powerLost);
+	DisplayRet::Ret_Codes_e result = DisplayRet::Success;
+	if (powerLost)
+		OLEDinit();
+	if (lost & StateRAM)
+		result = OLEDupdate();
+	if (result == DisplayRet::Success)
+		result = suspendReplay(lost);
+	if (result != DisplayRet::Success || powerLost)
+		return result;
+	const uint8_t wakeCmd[1] = {SH110X_DISPLAYON};
+	return I2CWriteBlock(wakeCmd, SH110X_COMMAND_BYTE);
+}
+
+/*!
+	@brief Sends a block of commands, used by the suspend replay
+	@param commands the command bytes
+	@return Success or I2CNotConnected
+*/
+DisplayRet::Ret_Codes_e SH110X::suspendSendCommands(std::span<const uint8_t> commands)
+{
+	return I2CWriteBlock(commands, SH110X_COMMAND_BYTE);
+}
+
+/*!
+	@brief Carries out Power on sequence and register init, blocking
+	@note OLEDbegin and the circuit breaker reconnect run the same sequence, see bootStage.
 */
 void SH110X::OLEDinit()
 {
-	switch(_OLED_IC_type)
-	{
-		case SH1106_IC:
-			SH1106_begin();
-		break;
-		case SH1107_IC:
-			SH1107_begin();
-		break;
-		default:
-			printf("Warning: OLEDinit: Unknown OLED type, Init Sh1106 by default\n");
-			SH1106_begin();
-		break;
-	}
+	bootBegin();
+	bootComplete();
 }
 
 /*!
@@ -160,98 +224,45 @@ void SH110X::OLEDReset(void)
 }
 
 /*!
- @brief Init routine for SH1106 OLED
-*/
-void SH110X::SH1106_begin(void)
-{
-	const uint16_t _INITDELAY = 100; /**< Initialisation delay in mS */
-	if(_Display_RST >= 0)
-	{
-		OLEDReset(); // Hw reset pin
-	}
-	pageStartOffset = 2; // the SH1106 display  requires a small offset 
-
-	I2CWriteByte(SH110X_DISPLAYOFF);
-	I2CWriteByte(SH110X_SETDISPLAYCLOCKDIV);
-	I2CWriteByte(0x80);
-
-	I2CWriteByte(SH110X_SETMULTIPLEX);
-	I2CWriteByte(0x3F);
-
-	I2CWriteByte(SH110X_SETDISPLAYOFFSET);
-	I2CWriteByte(0x00);
-	I2CWriteByte(SH110X_SETSTARTLINE);
-
-	I2CWriteByte(SH110X_DCDC);
-	I2CWriteByte(0x8B);
-
-	I2CWriteByte(SH110X_SEGREMAP + 1); // Left rotation +1
-	I2CWriteByte(SH110X_COMSCANDEC);
-	I2CWriteByte(SH110X_SETCOMPINS);
-	I2CWriteByte(0x12);  // Alternative (POR)
-
-	I2CWriteByte(SH110X_SETCONTRAST);
-	I2CWriteByte(0xFF);
-
-	I2CWriteByte(SH110X_SETPRECHARGE);
-	I2CWriteByte(0x1F);
-
-	I2CWriteByte(SH110X_SETVCOMDETECT);
-	I2CWriteByte(0x40);
-	I2CWriteByte(0x33);
-
-	I2CWriteByte(SH110X_NORMALDISPLAY);
-	I2CWriteByte(SH110X_MEMORYMODE);
-	I2CWriteByte(0x10);
-	I2CWriteByte(SH110X_DISPLAYALLON_RESUME);
-
-	busy_wait_ms(_INITDELAY);
-	I2CWriteByte(SH110X_DISPLAYON);
-}
-
-/*!
- @brief Init routine for SH1107 OLED
+	@brief Power up sequence, optional hardware reset, init command table
+		in one I2C transaction, then display on after the DC-DC converter settles.
+	@param stage stage number
+	@return wait in uS before the next stage, or BOOT_DONE
+	@note Display RAM can be written during the DC-DC wait.
 */
-void SH110X::SH1107_begin(void)
+uint32_t SH110X::bootStage(uint8_t stage)
 {
-	const uint16_t _INITDELAY = 100; /**< Initialisation delay in mS */
-	if(_Display_RST >= 0)
-	{
-		OLEDReset();
-	}
-	I2CWriteByte(SH110X_DISPLAYOFF);
-	I2CWriteByte(SH110X_SETDISPLAYCLOCKDIV);
-	I2CWriteByte(0x51);
-	I2CWriteByte(SH110X_MEMORYMODE);
-	I2CWriteByte(SH110X_SETCONTRAST);
-	I2CWriteByte(0x4F);
-	I2CWriteByte(SH110X_DCDC);
-	I2CWriteByte(0x8A);
-	I2CWriteByte(SH110X_SEGREMAP);
-	I2CWriteByte(SH110X_COMSCANINC);
-	I2CWriteByte(SH110X_SETDISPSTARTLINE);
-	I2CWriteByte(0x0);
-	I2CWriteByte(SH110X_SETDISPLAYOFFSET);
-	I2CWriteByte(0x60);
-	I2CWriteByte(SH110X_SETPRECHARGE);
-	I2CWriteByte(0x22);
-	I2CWriteByte(SH110X_SETVCOMDETECT);
-	I2CWriteByte(0x35);
-	I2CWriteByte(SH110X_SETMULTIPLEX);
-	I2CWriteByte(0x3F);
-	I2CWriteByte(SH110X_DISPLAYALLON_RESUME);
-	I2CWriteByte(SH110X_NORMALDISPLAY);
-
-	if (_width == 128 && _height == 128)
+	switch (stage)
 	{
-		I2CWriteByte(SH110X_SETDISPLAYOFFSET);
-		I2CWriteByte(0x00);
-		I2CWriteByte(SH110X_SETMULTIPLEX);
-		I2CWriteByte(0x7F);
+		case 0: // Hw reset pin, if used
+			if (_Display_RST < 0)
+				return 0;
+			gpio_put(_Display_RST, false);
+			return SH110X_RESET_LOW_US;
+		case 1:
+			if (_Display_RST < 0)
+				return 0;
+			gpio_put(_Display_RST, true);
+			return SH110X_RESET_WAIT_US;
+		case 2:
+			if (_OLED_IC_type == SH1107_IC)
+			{
+				const auto initCmds = SH1107InitCommands(_width == 128 && _height == 128);
+				I2CWriteBlock(initCmds, SH110X_COMMAND_BYTE);
+			}
+			else
+			{
+				if (_OLED_IC_type != SH1106_IC)
+					displaylib_diag::warning(displaylib_diag::FuncInit, DisplayRet::GenericError, _OLED_IC_type);
+				pageStartOffset = 2; // the SH1106 display  requires a small offset 
+				I2CWriteBlock(SH1106_INIT_COMMANDS, SH110X_COMMAND_BYTE);
+			}
+			bootRamReady();
+			return SH110X_DCDC_WAIT_US;
+		default:
+			I2CWriteByte(SH110X_DISPLAYON);
+			return BOOT_DONE;
 	}
-
-	busy_wait_ms(_INITDELAY);
-	I2CWriteByte(SH110X_DISPLAYON);
 }
 
 /*!
@@ -270,9 +281,9 @@ void SH110X::OLEDEnable(uint8_t bits)
 */
 void SH110X::OLEDContrast(uint8_t contrast)
 {
-	
-	I2CWriteByte(SH110X_SETCONTRAST);
-	I2CWriteByte(contrast);
+	const uint8_t contrastCmds[2] = {SH110X_SETCONTRAST, contrast};
+	I2CWriteBlock(contrastCmds, SH110X_COMMAND_BYTE);
+	suspendNote(StateContrast, contrastCmds);
 }
 
 /*!
@@ -281,7 +292,9 @@ void SH110X::OLEDContrast(uint8_t contrast)
 */
 void SH110X::OLEDInvert(bool value)
 {
-	value ? I2CWriteByte(SH110X_INVERTDISPLAY) : I2CWriteByte(SH110X_NORMALDISPLAY);
+	const uint8_t invertCmd[1] = {value ? SH110X_INVERTDISPLAY : SH110X_NORMALDISPLAY};
+	I2CWriteBlock(invertCmd, SH110X_COMMAND_BYTE);
+	suspendNote(StateInvert, invertCmd);
 }
 
 /*!
@@ -291,6 +304,7 @@ void SH110X::OLEDInvert(bool value)
 */
 void SH110X::OLEDFillScreen(uint8_t dataPattern, uint8_t delay)
 {
+	flushAddressLost();
 	for (uint8_t row = 0; row < _OLED_PAGE_NUM; row++)
 	{
 		I2CWriteByte( SH110X_SETPAGEADDR  | row);
@@ -312,6 +326,7 @@ void SH110X::OLEDFillScreen(uint8_t dataPattern, uint8_t delay)
 */
 void SH110X::OLEDFillPage(uint8_t page_num, uint8_t dataPattern,uint8_t mydelay)
 {
+	flushAddressLost();
 	uint8_t Result =SH110X_SETPAGEADDR | page_num;
 	I2CWriteByte(Result);
 	I2CWriteByte(SH110X_SETLOWCOLUMN + (pageStartOffset & 0x0F)); // SH110X_SETLOWCOLUMN   = 0x00
@@ -332,48 +347,313 @@ void SH110X::OLEDFillPage(uint8_t page_num, uint8_t dataPattern,uint8_t mydelay)
 */
 void SH110X::I2CWriteByte(uint8_t value, uint8_t cmd)
 {
+	if (GetBreakerOpen()) return;
 	uint8_t  dataBuffer[2] = {cmd,value};
 	uint8_t attemptI2Cwrite = 0;
 	int16_t returnCode = 0;
 	
 	//returnCode = bcm2835_i2c_write(buf, 2); 
 	returnCode = i2c_write_timeout_us(_i2c, _OLEDAddressI2C, dataBuffer, 2 , false, _TimeoutDelayI2C);
-	
+	statsBusWrite(returnCode, dataBuffer);
+	clockTuneNote(returnCode >= 1);
+
 	while(returnCode < 1)
 	{ // failure to write I2C byte 
 		if (_bSerialDebugFlag)
-		{
-			printf("SH110X::I2C_Write_Byte : Cannot Write byte : Retry Attempt = %u\n", attemptI2Cwrite);
-			printf("Error code %i\n", returnCode);
-		}
+			displaylib_diag::warning(displaylib_diag::FuncI2CWriteByte, DisplayRet::I2CNotConnected, attemptI2Cwrite, static_cast<int16_t>(returnCode));
 		if (attemptI2Cwrite >= _I2CRetryAttempts) break;
-		returnCode = i2c_write_timeout_us(_i2c, _OLEDAddressI2C, dataBuffer, 2 , false, _TimeoutDelayI2C);
+		statsRetry();
 		busy_wait_ms(_I2CRetryDelay); // mS
+		returnCode = i2c_write_timeout_us(_i2c, _OLEDAddressI2C, dataBuffer, 2 , false, _TimeoutDelayI2C);
+		statsBusWrite(returnCode, dataBuffer);
+		clockTuneNote(returnCode >= 1);
 		attemptI2Cwrite ++;
 	}
 	if (returnCode < 1) 
+	{
 		_bIsConnected = false;
+		breakerTrip();
+	}
 	else
 		_bIsConnected = true;
 }
 
+/*!
+	@brief Writes a block of bytes to I2C address in one transaction, command or data, used internally
+	@param data the bytes to be written, split into transactions of at most UPDATE_CHUNK_MAX bytes
+	@param cmd command or data control byte
+	@return Success or I2CNotConnected if the write failed after the retry attempts
+	@note isDebugEnabled()  ,will output data on I2C failures.
+*/
+DisplayRet::Ret_Codes_e SH110X::I2CWriteBlock(std::span<const uint8_t> data, uint8_t cmd)
+{
+	if (GetBreakerOpen())
+		return DisplayRet::I2CNotConnected;
+	uint8_t dataBuffer[UPDATE_CHUNK_MAX + 1];
+	while (!data.empty())
+	{
+		const size_t length = (data.size() > UPDATE_CHUNK_MAX) ? UPDATE_CHUNK_MAX : data.size();
+		dataBuffer[0] = cmd;
+		std::copy(data.begin(), data.begin() + length, dataBuffer + 1);
+		uint8_t attemptI2Cwrite = 0;
+		int16_t returnCode = i2c_write_timeout_us(_i2c, _OLEDAddressI2C, dataBuffer, length + 1, false, _TimeoutDelayI2C);
+		statsBusWrite(returnCode, std::span<const uint8_t>(dataBuffer, length + 1));
+		clockTuneNote(returnCode >= 1);
+		while (returnCode < 1)
+		{ // failure to write I2C block
+			if (_bSerialDebugFlag)
+				displaylib_diag::warning(displaylib_diag::FuncI2CWriteBlock, DisplayRet::I2CNotConnected, attemptI2Cwrite, static_cast<int16_t>(returnCode));
+			if (attemptI2Cwrite >= _I2CRetryAttempts) break;
+			statsRetry();
+			busy_wait_ms(_I2CRetryDelay); // mS
+			returnCode = i2c_write_timeout_us(_i2c, _OLEDAddressI2C, dataBuffer, length + 1, false, _TimeoutDelayI2C);
+			statsBusWrite(returnCode, std::span<const uint8_t>(dataBuffer, length + 1));
+			clockTuneNote(returnCode >= 1);
+			attemptI2Cwrite ++;
+		}
+		if (returnCode < 1)
+		{
+			_bIsConnected = false;
+			breakerTrip();
+			return DisplayRet::I2CNotConnected;
+		}
+		data = data.subspan(length);
+	}
+	_bIsConnected = true;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Writes a flush chunk or address in one I2C transaction, used by the flush hooks
+	@param data the bytes to be written, at most UPDATE_CHUNK_MAX
+	@param cmd command or data control byte
+	@return Will return
+		-# Success
+		-# BusRetry the write failed, updateStep sends it again on its next call
+		-# I2CNotConnected the write and _I2CRetryAttempts retries failed, the breaker is open
+	@note Never waits, so updateStep keeps to its budget: one attempt per call,
+		with a timeout of twice the transfer time plus BREAKER_FLUSH_MARGIN_US,
+		and no retry delay. The blocking writes use I2CWriteBlock.
+*/
+DisplayRet::Ret_Codes_e SH110X::I2CWriteFlush(std::span<const uint8_t> data, uint8_t cmd)
+{
+	if (GetBreakerOpen())
+		return DisplayRet::I2CNotConnected;
+	uint8_t dataBuffer[UPDATE_CHUNK_MAX + 1];
+	const size_t length = std::min<size_t>(data.size(), UPDATE_CHUNK_MAX);
+	dataBuffer[0] = cmd;
+	std::copy(data.begin(), data.begin() + length, dataBuffer + 1);
+	// 9 clocks a byte, address byte included, twice over
+	const uint32_t transferUs = static_cast<uint32_t>(((length + 2) * 9 * 2000) / _CLKSpeed);
+	const uint32_t timeoutUs = std::min<uint32_t>(_TimeoutDelayI2C, transferUs + BREAKER_FLUSH_MARGIN_US);
+	const int16_t returnCode = i2c_write_timeout_us(_i2c, _OLEDAddressI2C, dataBuffer, length + 1, false, timeoutUs);
+	statsBusWrite(returnCode, std::span<const uint8_t>(dataBuffer, length + 1));
+	clockTuneNote(returnCode >= 1);
+	if (returnCode >= 1)
+	{
+		breakerFlushOk();
+		_bIsConnected = true;
+		return DisplayRet::Success;
+	}
+	if (_bSerialDebugFlag)
+		displaylib_diag::warning(displaylib_diag::FuncI2CWriteBlock, DisplayRet::BusRetry, static_cast<int16_t>(returnCode));
+	if (breakerFlushFailed(_I2CRetryAttempts))
+	{
+		statsRetry();
+		return DisplayRet::BusRetry;
+	}
+	_bIsConnected = false;
+	breakerTrip();
+	return DisplayRet::I2CNotConnected;
+}
+
+/*!
+	@brief Checks the circuit breaker before a frame is sent, used internally
+	@return true if the bus can be used, false if the display is treated as disconnected
+	@details While the breaker is open the display is probed with CheckConnection
+		on the backoff schedule, see SetBreakerBackoff. When it answers the
+		breaker closes and the power up sequence is started again, as the display
+		may have lost power, without blocking: the stages run from isReady and
+		updateStep. The frame being sent is dropped, the next one waits in
+		updateStep until display RAM can be written. Once the sequence is done
+		the user state (contrast, invert etc) is restored.
+		While open a due re-tune of the I2C clock drops it to the lowest step
+		before the probe, the re-tune itself is run by I2CClockRetune.
+*/
+bool SH110X::I2CBreakerCheck(void)
+{
+	if (!GetBreakerOpen())
+	{
+		if (_breakerReplay && isReady())
+		{
+			_breakerReplay = false;
+			suspendReplay(StateAll & ~StateRAM); // user state set since begin
+		}
+		return !GetBreakerOpen();
+	}
+	if (!breakerProbeDue())
+		return false;
+	clockTuneFallback();
+	if (CheckConnection() != DisplayRet::Success)
+	{
+		breakerProbeFailed();
+		return false;
+	}
+	if (_bSerialDebugFlag)
+		displaylib_diag::info(displaylib_diag::FuncI2CReconnect, DisplayRet::Success, static_cast<int16_t>(GetBreakerTrips()));
+	BreakerReset();
+	_breakerReplay = true;
+	bootBegin(); // runs the stages due now, the rest from isReady
+	flushAddressLost();
+	return false;
+}
+
+/*!
+	@brief Writes one I2C transaction for the clock tuning, used internally
+	@param data the bytes, control byte first
+	@return true if all bytes were acknowledged
+	@note No retries, a short timeout and not counted for the re-tune error rate.
+*/
+bool SH110X::I2CProbeWrite(std::span<const uint8_t> data)
+{
+	int16_t returnCode = i2c_write_timeout_us(_i2c, _OLEDAddressI2C, data.data(), data.size(), false, CLOCK_TUNE_TIMEOUT_US);
+	statsBusWrite(returnCode, data);
+	return returnCode == static_cast<int16_t>(data.size());
+}
+
+/*!
+	@brief Sets the I2C clock for the clock tuning
+	@param kHz the clock, kHz
+	@return the clock before, kHz
+*/
+uint16_t SH110X::clockTuneSet(uint16_t kHz)
+{
+	const uint16_t before = _CLKSpeed;
+	_CLKSpeed = kHz;
+	i2c_set_baudrate(_i2c, _CLKSpeed * 1000);
+	return before;
+}
+
+/*!
+	@brief Clock tuning probe, writes test patterns over page 0 of display RAM,
+		reads the status byte, then writes page 0 back from the screen buffer
+	@return true if every transaction was acknowledged
+	@note Page addressing mode, the column address is set again for each pass.
+*/
+bool SH110X::clockTuneProbe(void)
+{
+	if (GetBreakerOpen())
+		return false;
+	static constexpr uint8_t patterns[4] = {0x55, 0xAA, 0xFF, 0x00};
+	const uint8_t addressCmds[4] = {SH110X_COMMAND_BYTE, SH110X_SETPAGEADDR,
+		static_cast<uint8_t>(SH110X_SETLOWCOLUMN + (pageStartOffset & 0x0F)),
+		static_cast<uint8_t>(SH110X_SETHIGHCOLUMN + (pageStartOffset >> 4))};
+	uint8_t dataBuffer[UPDATE_CHUNK_MAX + 1];
+	dataBuffer[0] = SH110X_DATA_BYTE;
+	bool passed = true;
+	for (uint8_t pattern : patterns)
+	{
+		std::fill(dataBuffer + 1, dataBuffer + UPDATE_CHUNK_MAX + 1, pattern);
+		passed = I2CProbeWrite(addressCmds) && passed;
+		for (uint8_t column = 0; column < _OLED_WIDTH; column += UPDATE_CHUNK_MAX)
+		{
+			const uint8_t length = std::min<uint8_t>(UPDATE_CHUNK_MAX, _OLED_WIDTH - column);
+			passed = I2CProbeWrite(std::span<const uint8_t>(dataBuffer, length + 1)) && passed;
+		}
+	}
+	uint8_t status = 0;
+	passed = (i2c_read_timeout_us(_i2c, _OLEDAddressI2C, &status, 1, false, CLOCK_TUNE_TIMEOUT_US) == 1) && passed;
+
+	// restore page 0
+	passed = I2CProbeWrite(addressCmds) && passed;
+	for (uint8_t column = 0; column < _OLED_WIDTH; column += UPDATE_CHUNK_MAX)
+	{
+		const uint8_t length = std::min<uint8_t>(UPDATE_CHUNK_MAX, _OLED_WIDTH - column);
+		for (uint8_t index = 0; index < length; index++)
+			dataBuffer[index + 1] = _OLEDbuffer.empty() ? 0x00 : _OLEDbuffer[column + index];
+		passed = I2CProbeWrite(std::span<const uint8_t>(dataBuffer, length + 1)) && passed;
+	}
+	flushAddressLost();
+	return passed;
+}
+
+/*!
+	@brief Re-sends the init and user state after a failed clock tuning step
+*/
+void SH110X::clockTuneRecover(void)
+{
+	OLEDinit();
+	suspendReplay(StateAll & ~StateRAM);
+	flushAddressLost();
+}
+
 /*!
 	@brief updates the buffer i.e. writes it to the screen
 	@return 
 		-# Success 
 		-# BufferEmpty if buffer is empty object
+		-# I2CNotConnected if the I2C write failed
+	@note Blocking, see updateBegin and updateStep to spread the update over several calls.
 */
 DisplayRet::Ret_Codes_e SH110X::OLEDupdate()
 {
 	if (_OLEDbuffer.empty())
 	{
-		printf("Error: OLEDupdate: Buffer is empty, cannot update screen\r\n");
+		displaylib_diag::error(displaylib_diag::FuncUpdate, DisplayRet::BufferEmpty);
 		return DisplayRet::BufferEmpty;
 	}
-	uint8_t w = this->_OLED_WIDTH; 
-	uint8_t h = this->_OLED_HEIGHT;
-	OLEDBufferScreen(w,  h, this->_OLEDbuffer);
-	return DisplayRet::Success;
+	DisplayRet::Ret_Codes_e result = updateBegin();
+	if (result != DisplayRet::Success)
+		return result;
+	return updateComplete();
+}
+
+/*!
+	@brief Returns the screen buffer, the default frame for updateBegin
+	@return span of the screen buffer
+*/
+std::span<const uint8_t> SH110X::flushBuffer(void)
+{
+	return _OLEDbuffer;
+}
+
+/*!
+	@brief The screen buffer for the graphics byte writes
+	@return the buffer, empty if not set
+*/
+std::span<uint8_t> SH110X::graphicsBuffer(void)
+{
+	return _OLEDbuffer;
+}
+
+/*!
+	@brief Sets the page and column address for the flush, page addressing mode
+	@param page page to write
+	@param column first column to write
+	@param columnEnd unused, the SH110X has no column window
+	@return Success, BusRetry or I2CNotConnected, see I2CWriteFlush
+	@note The three addressing commands are sent in one I2C transaction.
+*/
+DisplayRet::Ret_Codes_e SH110X::flushSetAddress(uint8_t page, uint8_t column, uint8_t columnEnd)
+{
+	if (!I2CBreakerCheck())
+		return DisplayRet::I2CNotConnected;
+	(void)columnEnd;
+	const uint8_t ramColumn = column + pageStartOffset;
+	const uint8_t addressCmds[3] = {static_cast<uint8_t>(SH110X_SETPAGEADDR + page),
+		static_cast<uint8_t>(SH110X_SETLOWCOLUMN + (ramColumn & 0x0F)),
+		static_cast<uint8_t>(SH110X_SETHIGHCOLUMN + (ramColumn >> 4))};
+	return I2CWriteFlush(addressCmds, SH110X_COMMAND_BYTE);
+}
+
+/*!
+	@brief Writes a chunk of the flush to display RAM in one I2C transaction
+	@param data the data to write
+	@return Success, BusRetry or I2CNotConnected, see I2CWriteFlush
+*/
+DisplayRet::Ret_Codes_e SH110X::flushWriteData(std::span<const uint8_t> data)
+{
+	return I2CWriteFlush(data, SH110X_DATA_BYTE);
 }
 
 /*!
@@ -386,7 +666,7 @@ DisplayRet::Ret_Codes_e SH110X::OLEDclearBuffer()
 {
 	if (_OLEDbuffer.empty())
 	{
-		printf("Error: OLEDclearBuffer: Buffer is empty, cannot clear\r\n");
+		displaylib_diag::error(displaylib_diag::FuncClearBuffer, DisplayRet::BufferEmpty);
 		return DisplayRet::BufferEmpty;
 	}
 
@@ -404,6 +684,7 @@ DisplayRet::Ret_Codes_e SH110X::OLEDclearBuffer()
 void SH110X::OLEDBufferScreen(uint8_t w, uint8_t h, std::span<uint8_t> data)
 {
 	uint8_t page;
+	flushAddressLost();
 
 	for (page = 0; page < (h/8); page++) 
 	{
@@ -470,12 +751,10 @@ int16_t SH110X::CheckConnection()
 	returnValue = i2c_read_timeout_us(_i2c, _OLEDAddressI2C , &rxData, 1, false, _TimeoutDelayI2C);
 	if (_bSerialDebugFlag)
 	{
-		printf("SH110X::CheckConnection. Info \r\n");
-		printf("I2C Return value = %d , RxData =  %u \r\n", returnValue , rxData);
 		if (returnValue >= 1)
-			printf("Connected.\r\n ");
+			displaylib_diag::info(displaylib_diag::FuncCheckConnection, DisplayRet::Success, returnValue, rxData);
 		else
-		 	printf("Not Connected. \r\n");	
+			displaylib_diag::warning(displaylib_diag::FuncCheckConnection, DisplayRet::I2CNotConnected, returnValue, rxData);
 	}
 	if (returnValue < 1) {
 		_bIsConnected = false;
@@ -5,15 +5,17 @@
 */
 
 //#include <stdio.h> 
+#include <algorithm>
 #include "pico/stdlib.h"
 #include "../../include/displaylib/ssd1306.hpp"
+#include "../../include/displaylib/display_diag.hpp"
 
 /*!
 	@brief init the screen object
 	@param oledwidth width of OLED in pixels 
 	@param oledheight height of OLED in pixels 
  */
-SSD1306  :: SSD1306(int16_t oledwidth, int16_t oledheight) :displaylib_graphics(oledwidth, oledheight)
+SSD1306  :: SSD1306(int16_t oledwidth, int16_t oledheight) :displaylib_graphics(oledwidth, oledheight), displaylib_flush(oledwidth, oledheight), displaylib_suspend(SUSPEND_RETAINED)
 {
 	_OLED_HEIGHT = oledheight;
 	_OLED_WIDTH = oledwidth;
@@ -32,6 +34,26 @@ SSD1306  :: SSD1306(int16_t oledwidth, int16_t oledheight) :displaylib_graphics(
 		-# I2CbeginFail 
 */
 DisplayRet::Ret_Codes_e  SSD1306::OLEDbegin( uint8_t I2Caddress, i2c_inst_t* i2c_type, uint16_t CLKspeed, uint8_t  SDApin, uint8_t  SCLKpin)
+{
+	DisplayRet::Ret_Codes_e result = OLEDbeginAsync(I2Caddress, i2c_type, CLKspeed, SDApin, SCLKpin);
+	if (result == DisplayRet::Success)
+		bootComplete();
+	return result;
+}
+
+/*!
+	@brief  begin Method initialise OLED I2C communication, does not wait for power up
+	@param I2Caddress I2C Bus address by default 0x3C
+	@param i2c_type The I2C interface i2c0 or ic21 interface
+	@param CLKspeed I2C Bus Clock speed in KHz. 
+	@param SDApin I2C data GPIO pin  
+	@param SCLKpin I2C clock GPIO pin 
+	@return 
+		-# Success if successful , init I2C communication
+		-# I2CbeginFail 
+	@note Poll isReady to finish the power up sequence while doing other work.
+*/
+DisplayRet::Ret_Codes_e  SSD1306::OLEDbeginAsync( uint8_t I2Caddress, i2c_inst_t* i2c_type, uint16_t CLKspeed, uint8_t  SDApin, uint8_t  SCLKpin)
 {
 	_OLEDAddressI2C = I2Caddress;
 	_i2c = i2c_type; 
@@ -53,15 +75,12 @@ DisplayRet::Ret_Codes_e  SSD1306::OLEDbegin( uint8_t I2Caddress, i2c_inst_t* i2c
 	ReturnCode = i2c_read_timeout_us(_i2c, _OLEDAddressI2C , &rxData, 1, false, _TimeoutDelayI2C);
 	if (ReturnCode < 1){ // no bytes read back from device or error issued
 		if (_bSerialDebugFlag)
-		{
-			printf("1201 ERROR I2C_SSD1306 OLED :: begin: \r\n");
-			printf("Check Connection, Return code :: %d ,RX data :: %u \r\n", ReturnCode , rxData);
-		}
+			displaylib_diag::error(displaylib_diag::FuncBegin, DisplayRet::I2CNotConnected, static_cast<int16_t>(ReturnCode), rxData);
 		_bIsConnected = false;
 		return DisplayRet::I2CbeginFail;
 	}
 	_bIsConnected = true;
-	OLEDinit();
+	bootBegin();
 	return DisplayRet::Success;
 }
 
@@ -79,13 +98,13 @@ DisplayRet::Ret_Codes_e SSD1306::OLEDSetBufferPtr(uint8_t width, uint8_t height
 {
 	if (buffer.size() != static_cast<size_t>(width * (height / 8)))
 	{
-		printf("SSD1306::OLEDSetBufferPtr Error 2: buffer size does not equal w * (h/8))\r\n");
+		displaylib_diag::error(displaylib_diag::FuncSetBufferPtr, DisplayRet::BufferSize, width, height);
 		return DisplayRet::BufferSize;
 	}
 	_OLEDbuffer = buffer;
 
 	if (buffer.empty())	{
-		printf("SSD1306::OLEDSetBufferPtr Error 3: Problem assigning buffer, received empty buffer\r\n");
+		displaylib_diag::error(displaylib_diag::FuncSetBufferPtr, DisplayRet::BufferEmpty);
 		return DisplayRet::BufferEmpty;
 	}
 	return DisplayRet::Success;
@@ -112,59 +131,79 @@ void SSD1306::OLEDPowerDown(void)
 }
 
 /*!
-	@brief Called from OLEDbegin carries out Power on sequence and register init
+	@brief Puts the OLED to sleep, display off and charge pump off.
+	@return Success or I2CNotConnected
+	@note GDDRAM and all registers are retained while VDD stays on,
+		resume with OLEDResume.
 */
-void SSD1306::OLEDinit()
- {
-	const uint8_t  SSD1306_INITDELAY = 100 ;/**< Initialisation delay in mS */
-	busy_wait_ms(SSD1306_INITDELAY);
-	I2CWriteByte( SSD1306_DISPLAY_OFF);
-	I2CWriteByte( SSD1306_SET_DISPLAY_CLOCK_DIV_RATIO);
-	I2CWriteByte( 0x80);
-	I2CWriteByte( SSD1306_SET_MULTIPLEX_RATIO );
-	I2CWriteByte( _OLED_HEIGHT - 1 );
-	I2CWriteByte( SSD1306_SET_DISPLAY_OFFSET );
-	I2CWriteByte(0x00);
-	I2CWriteByte( SSD1306_SET_START_LINE|0x00);
-	I2CWriteByte( SSD1306_CHARGE_PUMP );
-	I2CWriteByte(0x14);
-	I2CWriteByte( SSD1306_MEMORY_ADDR_MODE );
-	I2CWriteByte(0x00);  //Horizontal Addressing Mode is Used
-	I2CWriteByte( SSD1306_SET_SEGMENT_REMAP| 0x01);
-	I2CWriteByte( SSD1306_COM_SCAN_DIR_DEC );
-
-switch (_OLED_HEIGHT)
-{
-	case 64: 
-		I2CWriteByte( SSD1306_SET_COM_PINS );
-		I2CWriteByte( 0x12 );
-		I2CWriteByte( SSD1306_SET_CONTRAST_CONTROL );
-		I2CWriteByte(0xCF);
-	break;
-	case 32: 
-		I2CWriteByte( SSD1306_SET_COM_PINS );
-		I2CWriteByte( 0x02 );
-		I2CWriteByte( SSD1306_SET_CONTRAST_CONTROL );
-		I2CWriteByte(0x8F);
-	break;
-	case 16: // NOTE: not tested, lacking part. 
-		I2CWriteByte( SSD1306_SET_COM_PINS );
-		I2CWriteByte( 0x2 ); // ?
-		I2CWriteByte( SSD1306_SET_CONTRAST_CONTROL );
-		I2CWriteByte(0xAF);
-	break;
+DisplayRet::Ret_Codes_e SSD1306::OLEDSuspend(void)
+{
+	if (GetSuspended())
+		return DisplayRet::Success;
+	suspendRecord(_OLEDbuffer);
+	const uint8_t sleepCmds[3] = {SSD1306_DISPLAY_OFF, SSD1306_CHARGE_PUMP, 0x10};
+	return I2CWriteBlock(sleepCmds, SSD1306_COMMAND);
+}
+
+/*!
+	@brief Wakes the OLED from OLEDSuspend, restores only what was lost.
+	@param powerLost set true if the OLED supply was switched off while suspended,
+		the OLED is then re-initialised and all user state restored.
+	@return Success or I2CNotConnected
+	@details The screen buffer is only sent if it changed since OLEDSuspend,
+		or power was lost. It is sent before the display is turned on.
+*/
+DisplayRet::Ret_Codes_e SSD1306::OLEDResume(bool powerLost)
+{
+	if (!GetSuspended())
+		return DisplayRet::Success;
+	const uint8_t lost = suspendLost(_OLEDbuffer, powerLost);
+	DisplayRet::Ret_Codes_e result = DisplayRet::Success;
+	if (powerLost)
+		OLEDinit();
+	if (lost & StateRAM)
+		result = OLEDupdate();
+	if (result == DisplayRet::Success)
+		result = suspendReplay(lost);
+	if (result != DisplayRet::Success || powerLost)
+		return result;
+	const uint8_t wakeCmds[3] = {SSD1306_CHARGE_PUMP, 0x14, SSD1306_DISPLAY_ON};
+	return I2CWriteBlock(wakeCmds, SSD1306_COMMAND);
 }
 
-	I2CWriteByte( SSD1306_SET_PRECHARGE_PERIOD );
-	I2CWriteByte( 0xF1 );
-	I2CWriteByte( SSD1306_SET_VCOM_DESELECT );
-	I2CWriteByte( 0x40 );
-	I2CWriteByte( SSD1306_DISPLAY_ALL_ON_RESUME );
-	I2CWriteByte( SSD1306_NORMAL_DISPLAY );
-	I2CWriteByte( SSD1306_DEACTIVATE_SCROLL );
-	I2CWriteByte( SSD1306_DISPLAY_ON );
+/*!
+	@brief Sends a block of commands, used by the suspend replay
+	@param commands the command bytes
+	@return Success or I2CNotConnected
+*/
+DisplayRet::Ret_Codes_e SSD1306::suspendSendCommands(std::span<const uint8_t> commands)
+{
+	return I2CWriteBlock(commands, SSD1306_COMMAND);
+}
+
+/*!
+	@brief Carries out Power on sequence and register init, blocking
+	@note OLEDbegin and the circuit breaker reconnect run the same sequence, see bootStage.
+*/
+void SSD1306::OLEDinit()
+{
+	bootBegin();
+	bootComplete();
+}
 
-	busy_wait_ms(SSD1306_INITDELAY);
+/*!
+	@brief Power up sequence, the init command table is sent in one I2C transaction.
+	@param stage stage number
+	@return BOOT_DONE, display RAM can be written at once
+	@note The datasheet 100mS from display on to panel lit (tAF) does not block RAM writes,
+		the display is ready once the ACK check in OLEDbeginAsync has passed.
+*/
+uint32_t SSD1306::bootStage(uint8_t stage)
+{
+	(void)stage;
+	const auto initCmds = InitCommands(_OLED_HEIGHT);
+	I2CWriteBlock(initCmds, SSD1306_COMMAND);
+	return BOOT_DONE;
 }
 
 /*!
@@ -182,8 +221,9 @@ void SSD1306::OLEDEnable(uint8_t bits)
 */
 void SSD1306::OLEDContrast(uint8_t contrast)
 {
-	I2CWriteByte( SSD1306_SET_CONTRAST_CONTROL );
-	I2CWriteByte(contrast);
+	const uint8_t contrastCmds[2] = {SSD1306_SET_CONTRAST_CONTROL, contrast};
+	I2CWriteBlock(contrastCmds, SSD1306_COMMAND);
+	suspendNote(StateContrast, contrastCmds);
 }
 
 /*!
@@ -192,7 +232,9 @@ void SSD1306::OLEDContrast(uint8_t contrast)
 */
 void SSD1306::OLEDInvert(bool value)
 {
- value ? I2CWriteByte( SSD1306_INVERT_DISPLAY ) : I2CWriteByte( SSD1306_NORMAL_DISPLAY );
+	const uint8_t invertCmd[1] = {value ? SSD1306_INVERT_DISPLAY : SSD1306_NORMAL_DISPLAY};
+	I2CWriteBlock(invertCmd, SSD1306_COMMAND);
+	suspendNote(StateInvert, invertCmd);
 }
 
 /*!
@@ -202,6 +244,7 @@ void SSD1306::OLEDInvert(bool value)
 */
 void SSD1306::OLEDFillScreen(uint8_t dataPattern, uint8_t delay)
 {
+	flushAddressLost();
 	for (uint8_t row = 0; row < _OLED_PAGE_NUM; row++)
 	{
 		I2CWriteByte( 0xB0 | row);
@@ -223,6 +266,7 @@ void SSD1306::OLEDFillScreen(uint8_t dataPattern, uint8_t delay)
 */
 void SSD1306::OLEDFillPage(uint8_t page_num, uint8_t dataPattern,uint8_t mydelay)
 {
+	flushAddressLost();
 	uint8_t Result =0xB0 | page_num; 
 	I2CWriteByte(Result);
 	I2CWriteByte(SSD1306_SET_LOWER_COLUMN);
@@ -258,35 +302,33 @@ DisplayRet::Ret_Codes_e SSD1306::OLEDBitmap(int16_t x, int16_t y, int16_t w, int
 // 1. Completely out of bounds?
 if (x > _width || y > _height)
 {
-	printf("SSD1306::OLEDBitmap Error 1: Bitmap co-ord out of bounds, check x and y\r\n");
+	displaylib_diag::error(displaylib_diag::FuncDriverBitmap, DisplayRet::BitmapScreenBounds, x, y);
 	return DisplayRet::BitmapScreenBounds;
 }
 // 2. bitmap weight and height
 if (w > _width || h > _height)
 {
-	printf("SSD1306::OLEDBitmap Error 2: Bitmap is larger than screen, check w and h\r\n");
+	displaylib_diag::error(displaylib_diag::FuncDriverBitmap, DisplayRet::BitmapLargerThanScreen, w, h);
 	return DisplayRet::BitmapLargerThanScreen;
 }
 // 3. bitmap is null
 if(pBitmap.empty()) 
 {
-	printf("SSD1306::OLEDBitmap Error 3: Bitmap is is not valid \n");
+	displaylib_diag::error(displaylib_diag::FuncDriverBitmap, DisplayRet::BitmapDataEmpty);
 	return DisplayRet::BitmapDataEmpty;
 }
 
 // 4. check Horizontal bitmap size
 if(w % 8 != 0 )
 {
-	printf("SSD1306::OLEDBitmap Error 4: Bitmap width size is incorrect: w %i h %i \n", w , h);
-	printf("Check is bitmap width divisible evenly by eight \n");
+	displaylib_diag::error(displaylib_diag::FuncDriverBitmap, DisplayRet::BitmapHorizontalSize, w, h);
 	return DisplayRet::BitmapHorizontalSize;
 }
 
 // 5. check  bitmap size
 if(pBitmap.size() != static_cast<size_t>((w / 8) * h))
 {
-	printf("SSD1306::OLEDBitmap Error 5: Bitmap size is incorrect: w %i h %i \n", w , h);
-	printf("Check bitmap size = ((w/8)*h)  \n");
+	displaylib_diag::error(displaylib_diag::FuncDriverBitmap, DisplayRet::BitmapSize, w, h);
 	return DisplayRet::BitmapSize;
 }
 
@@ -323,51 +365,333 @@ return DisplayRet::Success;
 	@param value write the value to be written
 	@param cmd command or data
 	@note In the event of an error will loop 3 times each time.
+		If it still fails the circuit breaker opens, see I2CBreakerCheck.
 */
 void SSD1306::I2CWriteByte(uint8_t value, uint8_t cmd)
 {
+	if (GetBreakerOpen()) return;
 	uint8_t  dataBuffer[2] = {cmd,value};
 	uint8_t attemptI2Cwrite = 0;
 	int16_t returnCode = 0;
 	
 	//returnCode = bcm2835_i2c_write(buf, 2); 
 	returnCode = i2c_write_timeout_us(_i2c, _OLEDAddressI2C, dataBuffer, 2 , false, _TimeoutDelayI2C);
-	
+	statsBusWrite(returnCode, dataBuffer);
+	clockTuneNote(returnCode >= 1);
+
 	while(returnCode < 1)
 	{ // failure to write I2C byte 
 		if (_bSerialDebugFlag)
-		{
-			printf("SSD1306::I2C_Write_Byte : Cannot Write byte : Retry Attempt = %u\n", attemptI2Cwrite);
-			printf("Error code %i\n", returnCode);
-		}
+			displaylib_diag::warning(displaylib_diag::FuncI2CWriteByte, DisplayRet::I2CNotConnected, attemptI2Cwrite, static_cast<int16_t>(returnCode));
 		if (attemptI2Cwrite >= _I2CRetryAttempts) break;
-		returnCode = i2c_write_timeout_us(_i2c, _OLEDAddressI2C, dataBuffer, 2 , false, _TimeoutDelayI2C);
+		statsRetry();
 		busy_wait_ms(_I2CRetryDelay); // mS
+		returnCode = i2c_write_timeout_us(_i2c, _OLEDAddressI2C, dataBuffer, 2 , false, _TimeoutDelayI2C);
+		statsBusWrite(returnCode, dataBuffer);
+		clockTuneNote(returnCode >= 1);
 		attemptI2Cwrite ++;
 	}
 	if (returnCode < 1) 
+	{
 		_bIsConnected = false;
+		breakerTrip();
+	}
 	else
 		_bIsConnected = true;
 }
 
+/*!
+	@brief Writes a block of bytes to I2C address in one transaction, command or data, used internally
+	@param data the bytes to be written, split into transactions of at most UPDATE_CHUNK_MAX bytes
+	@param cmd command or data control byte
+	@return Success or I2CNotConnected if the write failed after the retry attempts
+	@note In the event of an error will retry _I2CRetryAttempts times.
+*/
+DisplayRet::Ret_Codes_e SSD1306::I2CWriteBlock(std::span<const uint8_t> data, uint8_t cmd)
+{
+	if (GetBreakerOpen())
+		return DisplayRet::I2CNotConnected;
+	uint8_t dataBuffer[UPDATE_CHUNK_MAX + 1];
+	while (!data.empty())
+	{
+		const size_t length = (data.size() > UPDATE_CHUNK_MAX) ? UPDATE_CHUNK_MAX : data.size();
+		dataBuffer[0] = cmd;
+		std::copy(data.begin(), data.begin() + length, dataBuffer + 1);
+		uint8_t attemptI2Cwrite = 0;
+		int16_t returnCode = i2c_write_timeout_us(_i2c, _OLEDAddressI2C, dataBuffer, length + 1, false, _TimeoutDelayI2C);
+		statsBusWrite(returnCode, std::span<const uint8_t>(dataBuffer, length + 1));
+		clockTuneNote(returnCode >= 1);
+		while (returnCode < 1)
+		{ // failure to write I2C block
+			if (_bSerialDebugFlag)
+				displaylib_diag::warning(displaylib_diag::FuncI2CWriteBlock, DisplayRet::I2CNotConnected, attemptI2Cwrite, static_cast<int16_t>(returnCode));
+			if (attemptI2Cwrite >= _I2CRetryAttempts) break;
+			statsRetry();
+			busy_wait_ms(_I2CRetryDelay); // mS
+			returnCode = i2c_write_timeout_us(_i2c, _OLEDAddressI2C, dataBuffer, length + 1, false, _TimeoutDelayI2C);
+			statsBusWrite(returnCode, std::span<const uint8_t>(dataBuffer, length + 1));
+			clockTuneNote(returnCode >= 1);
+			attemptI2Cwrite ++;
+		}
+		if (returnCode < 1)
+		{
+			_bIsConnected = false;
+			breakerTrip();
+			return DisplayRet::I2CNotConnected;
+		}
+		data = data.subspan(length);
+	}
+	_bIsConnected = true;
+	return DisplayRet::Success;
+}
+
+/*!
+	@brief Writes a flush chunk or address in one I2C transaction, used by the flush hooks
+	@param data the bytes to be written, at most UPDATE_CHUNK_MAX
+	@param cmd command or data control byte
+	@return Will return
+		-# Success
+		-# BusRetry the write failed, updateStep sends it again on its next call
+		-# I2CNotConnected the write and _I2CRetryAttempts retries failed, the breaker is open
+	@note Never waits, so updateStep keeps to its budget: one attempt per call,
+		with a timeout of twice the transfer time plus BREAKER_FLUSH_MARGIN_US,
+		and no retry delay. The blocking writes use I2CWriteBlock.
+*/
+DisplayRet::Ret_Codes_e SSD1306::I2CWriteFlush(std::span<const uint8_t> data, uint8_t cmd)
+{
+	if (GetBreakerOpen())
+		return DisplayRet::I2CNotConnected;
+	uint8_t dataBuffer[UPDATE_CHUNK_MAX + 1];
+	const size_t length = std::min<size_t>(data.size(), UPDATE_CHUNK_MAX);
+	dataBuffer[0] = cmd;
+	std::copy(data.begin(), data.begin() + length, dataBuffer + 1);
+	// 9 clocks a byte, address byte included, twice over
+	const uint32_t transferUs = static_cast<uint32_t>(((length + 2) * 9 * 2000) / _CLKSpeed);
+	const uint32_t timeoutUs = std::min<uint32_t>(_TimeoutDelayI2C, transferUs + BREAKER_FLUSH_MARGIN_US);
+	const int16_t returnCode = i2c_write_timeout_us(_i2c, _OLEDAddressI2C, dataBuffer, length + 1, false, timeoutUs);
+	statsBusWrite(returnCode, std::span<const uint8_t>(dataBuffer, length + 1));
+	clockTuneNote(returnCode >= 1);
+	if (returnCode >= 1)
+	{
+		breakerFlushOk();
+		_bIsConnected = true;
+		return DisplayRet::Success;
+	}
+	if (_bSerialDebugFlag)
+		displaylib_diag::warning(displaylib_diag::FuncI2CWriteBlock, DisplayRet::BusRetry, static_cast<int16_t>(returnCode));
+	if (breakerFlushFailed(_I2CRetryAttempts))
+	{
+		statsRetry();
+		return DisplayRet::BusRetry;
+	}
+	_bIsConnected = false;
+	breakerTrip();
+	return DisplayRet::I2CNotConnected;
+}
+
+/*!
+	@brief Checks the circuit breaker before a frame is sent, used internally
+	@return true if the bus can be used, false if the display is treated as disconnected
+	@details While the breaker is open the display is probed with CheckConnection
+		on the backoff schedule, see SetBreakerBackoff. When it answers the
+		breaker closes and the power up sequence is started again, as the display
+		may have lost power, without blocking: the stages run from isReady and
+		updateStep. The frame being sent is dropped, the next one waits in
+		updateStep until display RAM can be written. Once the sequence is done
+		the user state (contrast, invert etc) is restored.
+		While open a due re-tune of the I2C clock drops it to the lowest step
+		before the probe, the re-tune itself is run by I2CClockRetune.
+*/
+bool SSD1306::I2CBreakerCheck(void)
+{
+	if (!GetBreakerOpen())
+	{
+		if (_breakerReplay && isReady())
+		{
+			_breakerReplay = false;
+			suspendReplay(StateAll & ~StateRAM); // user state set since begin
+		}
+		return !GetBreakerOpen();
+	}
+	if (!breakerProbeDue())
+		return false;
+	clockTuneFallback();
+	if (CheckConnection() != DisplayRet::Success)
+	{
+		breakerProbeFailed();
+		return false;
+	}
+	if (_bSerialDebugFlag)
+		displaylib_diag::info(displaylib_diag::FuncI2CReconnect, DisplayRet::Success, static_cast<int16_t>(GetBreakerTrips()));
+	BreakerReset();
+	_breakerReplay = true;
+	bootBegin(); // runs the stages due now, the rest from isReady
+	flushAddressLost();
+	return false;
+}
+
+/*!
+	@brief Writes one I2C transaction for the clock tuning, used internally
+	@param data the bytes, control byte first
+	@return true if all bytes were acknowledged
+	@note No retries, a short timeout and not counted for the re-tune error rate.
+*/
+bool SSD1306::I2CProbeWrite(std::span<const uint8_t> data)
+{
+	int16_t returnCode = i2c_write_timeout_us(_i2c, _OLEDAddressI2C, data.data(), data.size(), false, CLOCK_TUNE_TIMEOUT_US);
+	statsBusWrite(returnCode, data);
+	return returnCode == static_cast<int16_t>(data.size());
+}
+
+/*!
+	@brief Sets the I2C clock for the clock tuning
+	@param kHz the clock, kHz
+	@return the clock before, kHz
+*/
+uint16_t SSD1306::clockTuneSet(uint16_t kHz)
+{
+	const uint16_t before = _CLKSpeed;
+	_CLKSpeed = kHz;
+	i2c_set_baudrate(_i2c, _CLKSpeed * 1000);
+	return before;
+}
+
+/*!
+	@brief Clock tuning probe, writes test patterns over page 0 of GDDRAM,
+		reads the status byte, then writes page 0 back from the screen buffer
+	@return true if every transaction was acknowledged
+*/
+bool SSD1306::clockTuneProbe(void)
+{
+	if (GetBreakerOpen())
+		return false;
+	static constexpr uint8_t patterns[4] = {0x55, 0xAA, 0xFF, 0x00};
+	const uint8_t addressCmds[7] = {SSD1306_COMMAND, SSD1306_SET_COLUMN_ADDR, 0,
+		static_cast<uint8_t>(_OLED_WIDTH - 1), SSD1306_SET_PAGE_ADDR, 0, 0};
+	uint8_t dataBuffer[UPDATE_CHUNK_MAX + 1];
+	dataBuffer[0] = SSD1306_DATA_CONTINUE;
+	bool passed = true;
+	for (uint8_t pattern : patterns)
+	{
+		std::fill(dataBuffer + 1, dataBuffer + UPDATE_CHUNK_MAX + 1, pattern);
+		passed = I2CProbeWrite(addressCmds) && passed;
+		for (uint8_t column = 0; column < _OLED_WIDTH; column += UPDATE_CHUNK_MAX)
+		{
+			const uint8_t length = std::min<uint8_t>(UPDATE_CHUNK_MAX, _OLED_WIDTH - column);
+			passed = I2CProbeWrite(std::span<const uint8_t>(dataBuffer, length + 1)) && passed;
+		}
+	}
+	uint8_t status = 0;
+	passed = (i2c_read_timeout_us(_i2c, _OLEDAddressI2C, &status, 1, false, CLOCK_TUNE_TIMEOUT_US) == 1) && passed;
+
+	// restore page 0
+	passed = I2CProbeWrite(addressCmds) && passed;
+	for (uint8_t column = 0; column < _OLED_WIDTH; column += UPDATE_CHUNK_MAX)
+	{
+		const uint8_t length = std::min<uint8_t>(UPDATE_CHUNK_MAX, _OLED_WIDTH - column);
+		for (uint8_t index = 0; index < length; index++)
+			dataBuffer[index + 1] = _OLEDbuffer.empty() ? 0x00 : _OLEDbuffer[column + index];
+		passed = I2CProbeWrite(std::span<const uint8_t>(dataBuffer, length + 1)) && passed;
+	}
+	flushAddressLost();
+	return passed;
+}
+
+/*!
+	@brief Re-sends the init and user state after a failed clock tuning step
+*/
+void SSD1306::clockTuneRecover(void)
+{
+	OLEDinit();
+	suspendReplay(StateAll & ~StateRAM);
+	flushAddressLost();
+}
+
 /*!
 	@brief updates the buffer i.e. writes it to the screen
+	@return
+		-# Success
+		-# BufferEmpty if buffer is empty object
+		-# I2CNotConnected if the I2C write failed
+	@note Blocking, see updateBegin and updateStep to spread the update over several calls.
 */
 DisplayRet::Ret_Codes_e SSD1306::OLEDupdate()
 {
 	if (_OLEDbuffer.empty())
 	{
-		printf("SSD1306::OLEDupdate Error: Buffer is empty, cannot update screen\r\n");
+		displaylib_diag::error(displaylib_diag::FuncUpdate, DisplayRet::BufferEmpty);
 		return DisplayRet::BufferEmpty;
 	}
-	uint8_t x = 0;
-	uint8_t y = 0;
-	uint8_t w = this->_OLED_WIDTH;
-	uint8_t h = this->_OLED_HEIGHT;
+	DisplayRet::Ret_Codes_e result = updateBegin();
+	if (result != DisplayRet::Success)
+		return result;
+	return updateComplete();
+}
 
-	OLEDBuffer(x, y, w, h, _OLEDbuffer);
-	return DisplayRet::Success;
+/*!
+	@brief Returns the screen buffer, the default frame for updateBegin
+	@return span of the screen buffer
+*/
+std::span<const uint8_t> SSD1306::flushBuffer(void)
+{
+	return _OLEDbuffer;
+}
+
+/*!
+	@brief The screen buffer for the graphics byte writes
+	@return the buffer, empty if not set
+*/
+std::span<uint8_t> SSD1306::graphicsBuffer(void)
+{
+	return _OLEDbuffer;
+}
+
+/*!
+	@brief Sets the GDDRAM write window for the flush, one page from column to columnEnd
+	@param page page to write
+	@param column first column to write
+	@param columnEnd last column to write
+	@return Success, BusRetry or I2CNotConnected, see I2CWriteFlush
+	@note The six addressing commands are sent in one I2C transaction.
+*/
+DisplayRet::Ret_Codes_e SSD1306::flushSetAddress(uint8_t page, uint8_t column, uint8_t columnEnd)
+{
+	if (!I2CBreakerCheck())
+		return DisplayRet::I2CNotConnected;
+	const uint8_t addressCmds[6] = {SSD1306_SET_COLUMN_ADDR, column, columnEnd,
+		SSD1306_SET_PAGE_ADDR, page, page};
+	return I2CWriteFlush(addressCmds, SSD1306_COMMAND);
+}
+
+/*!
+	@brief Writes a chunk of the flush to GDDRAM in one I2C transaction
+	@param data the data to write
+	@return Success, BusRetry or I2CNotConnected, see I2CWriteFlush
+*/
+DisplayRet::Ret_Codes_e SSD1306::flushWriteData(std::span<const uint8_t> data)
+{
+	return I2CWriteFlush(data, SSD1306_DATA_CONTINUE);
+}
+
+/*!
+	@brief Sets the RAM line shown at top of screen, hardware scroll
+	@param line RAM line 0-63
+	@return Success or I2CNotConnected
+*/
+DisplayRet::Ret_Codes_e SSD1306::flushStartLine(uint8_t line)
+{
+	const uint8_t startLineCmd[1] = {static_cast<uint8_t>(SSD1306_SET_START_LINE | (line & 0x3F))};
+	suspendNote(StateStartLine, startLineCmd);
+	return I2CWriteBlock(startLineCmd, SSD1306_COMMAND);
+}
+
+/*!
+	@brief Number of pages in the display RAM
+	@return 8, the GDDRAM is 64 lines for all screen heights
+*/
+uint8_t SSD1306::flushRamPages(void)
+{
+	return 8;
 }
 
 /*!
@@ -377,7 +701,7 @@ DisplayRet::Ret_Codes_e SSD1306::OLEDclearBuffer()
 {
 	if (_OLEDbuffer.empty())
 	{
-		printf("SSD1306::OLEDclearBuffer Error: Buffer is empty, cannot clear\r\n");
+		displaylib_diag::error(displaylib_diag::FuncClearBuffer, DisplayRet::BufferEmpty);
 		return DisplayRet::BufferEmpty;
 	}
 
@@ -398,6 +722,7 @@ void SSD1306::OLEDBuffer(int16_t x, int16_t y, uint8_t w, uint8_t h, std::span<u
 {
 	uint8_t tx, ty;
 	uint16_t offset = 0;
+	flushAddressLost();
 		
 	I2CWriteByte( SSD1306_SET_COLUMN_ADDR );
 	I2CWriteByte(0);   // Column start address (0 = reset)
@@ -473,14 +798,10 @@ void SSD1306::drawPixel(int16_t x, int16_t y, uint8_t color)
 */
 void SSD1306::OLEDStartScrollRight(uint8_t start, uint8_t stop) 
 {
-	I2CWriteByte(SSD1306_RIGHT_HORIZONTAL_SCROLL);
-	I2CWriteByte(0X00);
-	I2CWriteByte(start);  // start page
-	I2CWriteByte(0X00);
-	I2CWriteByte(stop);   // end page
-	I2CWriteByte(0X00);
-	I2CWriteByte(0XFF);
-	I2CWriteByte(SSD1306_ACTIVATE_SCROLL);
+	const uint8_t scrollCmds[8] = {SSD1306_RIGHT_HORIZONTAL_SCROLL, 0x00, start, 0x00, stop, 0x00, 0xFF,
+		SSD1306_ACTIVATE_SCROLL};
+	I2CWriteBlock(scrollCmds, SSD1306_COMMAND);
+	suspendNote(StateScroll, scrollCmds);
 }
 
 /*!
@@ -490,14 +811,10 @@ void SSD1306::OLEDStartScrollRight(uint8_t start, uint8_t stop)
 */
 void SSD1306::OLEDStartScrollLeft(uint8_t start, uint8_t stop) 
 {
-	I2CWriteByte(SSD1306_LEFT_HORIZONTAL_SCROLL);
-	I2CWriteByte(0X00);
-	I2CWriteByte(start);
-	I2CWriteByte(0X00);
-	I2CWriteByte(stop);
-	I2CWriteByte(0X00);
-	I2CWriteByte(0XFF);
-	I2CWriteByte(SSD1306_ACTIVATE_SCROLL);
+	const uint8_t scrollCmds[8] = {SSD1306_LEFT_HORIZONTAL_SCROLL, 0x00, start, 0x00, stop, 0x00, 0xFF,
+		SSD1306_ACTIVATE_SCROLL};
+	I2CWriteBlock(scrollCmds, SSD1306_COMMAND);
+	suspendNote(StateScroll, scrollCmds);
 }
 
 /*!
@@ -507,16 +824,11 @@ void SSD1306::OLEDStartScrollLeft(uint8_t start, uint8_t stop)
 */
 void SSD1306::OLEDStartScrollDiagRight(uint8_t start, uint8_t stop) 
 {
-	I2CWriteByte(SSD1306_SET_VERTICAL_SCROLL_AREA);
-	I2CWriteByte(0X00);
-	I2CWriteByte(_OLED_HEIGHT);
-	I2CWriteByte(SSD1306_VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL);
-	I2CWriteByte(0X00);
-	I2CWriteByte(start);
-	I2CWriteByte(0X00);
-	I2CWriteByte(stop);
-	I2CWriteByte(0X01);
-	I2CWriteByte(SSD1306_ACTIVATE_SCROLL);
+	const uint8_t scrollCmds[11] = {SSD1306_SET_VERTICAL_SCROLL_AREA, 0x00, _OLED_HEIGHT,
+		SSD1306_VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL, 0x00, start, 0x00, stop, 0x01,
+		SSD1306_ACTIVATE_SCROLL};
+	I2CWriteBlock(scrollCmds, SSD1306_COMMAND);
+	suspendNote(StateScroll, scrollCmds);
 }
 
 /*!
@@ -526,16 +838,11 @@ void SSD1306::OLEDStartScrollDiagRight(uint8_t start, uint8_t stop)
 */
 void SSD1306::OLEDStartScrollDiagLeft(uint8_t start, uint8_t stop) 
 {
-	I2CWriteByte(SSD1306_SET_VERTICAL_SCROLL_AREA);
-	I2CWriteByte(0X00);
-	I2CWriteByte(_OLED_HEIGHT);
-	I2CWriteByte(SSD1306_VERTICAL_AND_LEFT_HORIZONTAL_SCROLL);
-	I2CWriteByte(0X00);
-	I2CWriteByte(start);
-	I2CWriteByte(0X00);
-	I2CWriteByte(stop);
-	I2CWriteByte(0X01);
-	I2CWriteByte(SSD1306_ACTIVATE_SCROLL);
+	const uint8_t scrollCmds[11] = {SSD1306_SET_VERTICAL_SCROLL_AREA, 0x00, _OLED_HEIGHT,
+		SSD1306_VERTICAL_AND_LEFT_HORIZONTAL_SCROLL, 0x00, start, 0x00, stop, 0x01,
+		SSD1306_ACTIVATE_SCROLL};
+	I2CWriteBlock(scrollCmds, SSD1306_COMMAND);
+	suspendNote(StateScroll, scrollCmds);
 }
 
 /*!
@@ -543,7 +850,9 @@ void SSD1306::OLEDStartScrollDiagLeft(uint8_t start, uint8_t stop)
 */
 void SSD1306::OLEDStopScroll(void) 
 {
-	I2CWriteByte(SSD1306_DEACTIVATE_SCROLL);
+	const uint8_t scrollCmd[1] = {SSD1306_DEACTIVATE_SCROLL};
+	I2CWriteBlock(scrollCmd, SSD1306_COMMAND);
+	suspendNote(StateScroll, scrollCmd);
 }
 
 /*!
@@ -558,12 +867,10 @@ int16_t SSD1306::CheckConnection()
 	returnValue = i2c_read_timeout_us(_i2c, _OLEDAddressI2C , &rxData, 1, false, _TimeoutDelayI2C);
 	if (_bSerialDebugFlag)
 	{
-		printf("SSD1306::CheckConnection. Info \r\n");
-		printf("I2C Return value = %d , RxData =  %u \r\n", returnValue , rxData);
 		if (returnValue >= 1)
-			printf("Connected.\r\n ");
+			displaylib_diag::info(displaylib_diag::FuncCheckConnection, DisplayRet::Success, returnValue, rxData);
 		else
-		 	printf("Not Connected. \r\n");	
+			displaylib_diag::warning(displaylib_diag::FuncCheckConnection, DisplayRet::I2CNotConnected, returnValue, rxData);
 	}
 	if (returnValue < 1) {
 		_bIsConnected = false;
@@ -0,0 +1,93 @@
+/*!
+	@file alloc_check.cpp
+	@brief Host check that drawing and text do not use the heap, a counting
+		operator new is installed and every drawing path is run.
+*/
+
+#include <cstdlib>
+#include <new>
+#include <string_view>
+#include "displaylib/ssd1306.hpp"
+#include "host_check.hpp"
+
+static bool counting = false;
+static uint32_t allocations = 0;
+
+void *operator new(std::size_t size)
+{
+	if (counting)
+		allocations++;
+	if (void *memory = std::malloc(size ? size : 1))
+		return memory;
+	throw std::bad_alloc();
+}
+void *operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete[](void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, std::size_t) noexcept { std::free(memory); }
+
+static uint8_t screenBuffer[1024];
+
+int main()
+{
+	SSD1306 display(128, 64);
+	HOST_CHECK(display.OLEDbegin(SSD1306::SSD1306_ADDR, i2c1, 400, 18, 19) == DisplayRet::Success);
+	HOST_CHECK(display.OLEDSetBufferPtr(128, 64, screenBuffer) == DisplayRet::Success);
+	display.OLEDclearBuffer();
+	const int16_t vx[5] = {10, 60, 50, 20, 5};
+	const int16_t vy[5] = {5, 10, 50, 60, 30};
+
+	counting = true;
+	for (uint8_t rotation = 0; rotation < 4; rotation++)
+	{
+		display.setRotation(static_cast<displaylib_graphics::display_rotate_e>(rotation));
+		display.drawLine(0, 0, 127, 63, display.FG_COLOR);
+		display.drawRect(2, 2, 40, 20, display.FG_COLOR);
+		display.fillRect(50, 2, 20, 20, display.INVERSE);
+		display.drawCircle(64, 32, 20, display.FG_COLOR);
+		display.fillCircle(30, 40, 10, display.FG_COLOR);
+		display.drawTriangle(0, 63, 20, 40, 40, 63, display.FG_COLOR);
+		display.fillTriangle(80, 63, 100, 40, 120, 63, display.FG_COLOR);
+		display.drawRoundRect(70, 30, 40, 20, 5, display.FG_COLOR);
+		display.fillRoundRect(10, 10, 30, 15, 4, display.INVERSE);
+		display.drawLineAngle(64, 32, 45, 0, 20, 0, display.FG_COLOR);
+		display.drawQuadrilateral(5, 5, 40, 8, 35, 40, 8, 30, display.FG_COLOR);
+		display.fillQuadrilateral(60, 5, 90, 8, 85, 40, 62, 30, display.FG_COLOR);
+		for (uint8_t sides = 3; sides <= displaylib_graphics::POLYGON_SIDES_MAX; sides++)
+		{
+			HOST_CHECK(display.drawPolygon(64, 32, sides, 40, 10.0f, false, display.FG_COLOR) == DisplayRet::Success);
+			HOST_CHECK(display.drawPolygon(64, 32, sides, 30, 0.0f, true, display.INVERSE) == DisplayRet::Success);
+		}
+		HOST_CHECK(display.drawPolygon(vx, vy, true, display.FG_COLOR) == DisplayRet::Success);
+		HOST_CHECK(display.drawPolygon(vx, vy, false, display.INVERSE) == DisplayRet::Success);
+		display.drawArc(64, 32, 25, 4, 10.0f, 200.0f, display.FG_COLOR);
+		display.drawSimpleArc(64, 32, 15, 30.0f, 300.0f, display.FG_COLOR);
+		display.drawEllipse(64, 32, 30, 12, false, display.FG_COLOR);
+		display.drawEllipse(64, 32, 20, 8, true, display.INVERSE);
+		HOST_CHECK(display.drawDotGrid(0, 0, 64, 32, 4, display.FG_COLOR) == DisplayRet::Success);
+
+		display.setFont(pFontDefault);
+		display.setCursor(0, 0);
+		display.print(std::string_view("string_view text"));
+		display.println(std::string_view("and a line"));
+		display.print("char text ");
+		display.print(12345);
+		display.print(-3.25, 2);
+		display.setTextScale(2, 3);
+		display.print(std::string_view("Big"));
+		display.setTextScale(1, 1);
+		char text[] = "writeCharString";
+		HOST_CHECK(display.writeCharString(0, 40, text) == DisplayRet::Success);
+		display.writeChar(100, 50, 'Z');
+		HOST_CHECK(display.getTextWidth("width") > 0);
+	}
+	display.setRotation(displaylib_graphics::rDegrees_0);
+	HOST_CHECK(display.OLEDupdate() == DisplayRet::Success);
+	counting = false;
+
+	if (allocations != 0)
+		fprintf(stderr, "drawing made %u heap allocations\n", static_cast<unsigned>(allocations));
+	HOST_CHECK(allocations == 0);
+	return host_check::result();
+}
@@ -0,0 +1,134 @@
+/*!
+	@file animation_check.cpp
+	@brief Host check of the animation round trip, frames converted by
+		displaylib_add_assets at build time, played with animationBegin,
+		animationNext and animationSeek and the first drawn with drawCompressed,
+		against the source PBM files. The image height is not a multiple of 8,
+		the pad rows must leave the screen below the image as it was.
+	@details animation_check <directory of walk0.pbm to walk4.pbm>
+*/
+
+#include <algorithm>
+#include <string>
+#include "displaylib/ssd1306.hpp"
+#include "displaylib/display_animation.hpp"
+#include "host_check.hpp"
+#include "walk.hpp"
+
+static constexpr int FRAMES = 5;
+static constexpr int IMAGE_W = 37;
+static constexpr int IMAGE_H = 21;
+
+static uint8_t screenBuffer[1024];
+static bool frameBits[FRAMES][IMAGE_H][IMAGE_W];
+
+// Reads a P1 PBM of the image size, comments skipped
+static bool readFrame(const std::string &path, bool (&bits)[IMAGE_H][IMAGE_W])
+{
+	FILE *file = fopen(path.c_str(), "r");
+	if (file == nullptr)
+		return false;
+	std::string text;
+	for (int c = fgetc(file); c != EOF; c = fgetc(file))
+		text += static_cast<char>(c);
+	fclose(file);
+	std::string tokens;
+	for (size_t pos = 0; pos < text.size(); pos++)
+	{
+		if (text[pos] == '#')
+			pos = text.find('\n', pos);
+		else
+			tokens += text[pos];
+		if (pos == std::string::npos)
+			break;
+	}
+	int width = 0, height = 0, used = 0;
+	if (sscanf(tokens.c_str(), " P1 %d %d%n", &width, &height, &used) != 2 || width != IMAGE_W || height != IMAGE_H)
+		return false;
+	int index = 0;
+	for (size_t pos = used; pos < tokens.size() && index < IMAGE_W * IMAGE_H; pos++)
+	{
+		if (tokens[pos] == '0' || tokens[pos] == '1')
+		{
+			bits[index / IMAGE_W][index % IMAGE_W] = (tokens[pos] == '1');
+			index++;
+		}
+	}
+	return index == IMAGE_W * IMAGE_H;
+}
+
+// The screen buffer expected with a frame drawn at x, y over base
+static void expectFrame(const uint8_t *base, int frame, int16_t x, int16_t y, uint8_t *expected)
+{
+	std::copy(base, base + sizeof(screenBuffer), expected);
+	for (int16_t row = 0; row < IMAGE_H; row++)
+	{
+		for (int16_t col = 0; col < IMAGE_W; col++)
+		{
+			const int16_t px = x + col, py = y + row;
+			if (px < 0 || px >= 128 || py < 0 || py >= 64)
+				continue;
+			uint8_t &cell = expected[(py / 8) * 128 + px];
+			cell = frameBits[frame][row][col] ? (cell | (1 << (py % 8))) : (cell & ~(1 << (py % 8)));
+		}
+	}
+}
+
+static bool screenIs(const uint8_t *base, int frame, int16_t x, int16_t y)
+{
+	uint8_t expected[sizeof(screenBuffer)];
+	expectFrame(base, frame, x, y, expected);
+	return std::equal(expected, expected + sizeof(expected), screenBuffer);
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc != 2)
+	{
+		fprintf(stderr, "usage: animation_check frames_directory\n");
+		return 2;
+	}
+	for (int frame = 0; frame < FRAMES; frame++)
+		HOST_CHECK(readFrame(std::string(argv[1]) + "/walk" + std::to_string(frame) + ".pbm", frameBits[frame]));
+
+	SSD1306 display(128, 64);
+	HOST_CHECK(display.OLEDbegin(SSD1306::SSD1306_ADDR, i2c1, 400, 18, 19) == DisplayRet::Success);
+	HOST_CHECK(display.OLEDSetBufferPtr(128, 64, screenBuffer) == DisplayRet::Success);
+	displaylib_animation animation(display);
+	HOST_CHECK(walk_height == IMAGE_H);
+
+	// page aligned, shifted, clipped at every edge
+	const int16_t places[][2] = {{20, 16}, {-5, 13}, {100, 45}, {30, -6}, {0, 43}};
+	for (const auto &place : places)
+	{
+		const int16_t x = place[0], y = place[1];
+		uint8_t base[sizeof(screenBuffer)];
+		for (size_t index = 0; index < sizeof(screenBuffer); index++)
+			screenBuffer[index] = static_cast<uint8_t>((index * 11) | 0x81);
+		std::copy(screenBuffer, screenBuffer + sizeof(screenBuffer), base);
+
+		HOST_CHECK(animation.animationBegin(walk, x, y) == DisplayRet::Success);
+		HOST_CHECK(animation.getFrameCount() == FRAMES);
+		HOST_CHECK(animation.getAnimationHeight() == IMAGE_H);
+		HOST_CHECK(screenIs(base, 0, x, y));
+		for (int frame = 1; frame <= FRAMES; frame++)
+		{
+			animation.clearDirty();
+			HOST_CHECK(animation.animationNext() == DisplayRet::Success);
+			HOST_CHECK(screenIs(base, frame % FRAMES, x, y));
+			const displaylib_flush::flush_rect_t dirty = animation.getDirtyRect();
+			HOST_CHECK(dirty.w > 0 && dirty.y >= y && dirty.y + dirty.h <= y + IMAGE_H);
+		}
+		for (uint16_t frame : {4, 2, 1, 3, 0, 4})
+		{
+			HOST_CHECK(animation.animationSeek(frame) == DisplayRet::Success);
+			HOST_CHECK(animation.getFrame() == frame);
+			HOST_CHECK(screenIs(base, frame, x, y));
+		}
+
+		std::copy(base, base + sizeof(base), screenBuffer);
+		HOST_CHECK(displaylib_animation::drawCompressed(display, x, y, walk) == DisplayRet::Success);
+		HOST_CHECK(screenIs(base, 0, x, y));
+	}
+	return host_check::result();
+}
@@ -0,0 +1,18 @@
+# Checks the header written by displaylib_add_assets for asset_check, a container
+# that is larger than its array left out, then runs asset_check to draw the rest.
+# -DPROGRAM= -DHEADER=
+file(READ ${HEADER} header)
+foreach(name box box_rle box_r90 checker checker_r90 arrow arrow_r90 ramp ramp_r90)
+  if(NOT header MATCHES "> ${name} = {")
+    message(FATAL_ERROR "${name} not written to ${HEADER}")
+  endif()
+endforeach()
+foreach(name box_r90_rle checker_rle arrow_rle)
+  if(header MATCHES "> ${name} = {")
+    message(FATAL_ERROR "${name} is larger than its array and must be left out of ${HEADER}")
+  endif()
+endforeach()
+execute_process(COMMAND ${PROGRAM} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "asset_check failed: ${result}")
+endif()
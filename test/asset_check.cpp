@@ -0,0 +1,85 @@
+/*!
+	@file asset_check.cpp
+	@brief Host check of the asset pipeline, a PBM, XBM and PGM converted by
+		displaylib_add_assets with ROTATE 90 and COMPRESS, the arrays drawn with
+		drawBitmap and the containers with drawCompressed against the images.
+*/
+
+#include <algorithm>
+#include "displaylib/ssd1306.hpp"
+#include "displaylib/display_animation.hpp"
+#include "host_check.hpp"
+#include "test_assets.hpp"
+
+static uint8_t screenBuffer[1024];
+
+// The source images, test/assets
+static bool boxOn(int x, int y) { return x == 0 || x == 15 || y == 0 || y == 9; }
+static bool checkerOn(int x, int y) { return ((x + y) % 2) == 0; }
+static bool arrowOn(int x, int y) { return x >= y && x < 12 - y; }
+static bool rampOn(int x, int y) { (void)y; return x * 17 >= 128; }
+
+// Rotated 90 clockwise, the source image height given
+template <bool (*on)(int, int), int SOURCE_H>
+static bool rotatedOn(int x, int y) { return on(y, SOURCE_H - 1 - x); }
+
+/*!
+	@brief Draws an asset over a patterned screen and compares it to the image
+	@param display the display
+	@param on the image pixels
+	@param data the array or container
+	@param width image width
+	@param height image rows, an array is drawn with the padded height
+	@param compressed true a container, the pad rows left as they were,
+		false an array, the pad rows background
+	@return true if the screen buffer is as expected
+*/
+static bool drawnAs(SSD1306 &display, bool (*on)(int, int), std::span<const uint8_t> data,
+	int16_t width, int16_t height, bool compressed)
+{
+	const int16_t x = 5, y = 11;
+	const int16_t padded = static_cast<int16_t>((height + 7) & ~7);
+	for (size_t index = 0; index < sizeof(screenBuffer); index++)
+		screenBuffer[index] = static_cast<uint8_t>((index * 13) | 0x42);
+	uint8_t expected[sizeof(screenBuffer)];
+	std::copy(screenBuffer, screenBuffer + sizeof(screenBuffer), expected);
+	for (int16_t row = 0; row < (compressed ? height : padded); row++)
+	{
+		for (int16_t col = 0; col < width; col++)
+		{
+			const int16_t py = y + row;
+			uint8_t &cell = expected[(py / 8) * 128 + x + col];
+			const bool lit = row < height && on(col, row);
+			cell = lit ? (cell | (1 << (py % 8))) : (cell & ~(1 << (py % 8)));
+		}
+	}
+	DisplayRet::Ret_Codes_e result = compressed ?
+		displaylib_animation::drawCompressed(display, x, y, data) :
+		display.drawBitmap(x, y, data, width, padded, SSD1306::FG_COLOR, SSD1306::BG_COLOR);
+	return result == DisplayRet::Success && std::equal(expected, expected + sizeof(expected), screenBuffer);
+}
+
+int main()
+{
+	SSD1306 display(128, 64);
+	HOST_CHECK(display.OLEDbegin(SSD1306::SSD1306_ADDR, i2c1, 400, 18, 19) == DisplayRet::Success);
+	HOST_CHECK(display.OLEDSetBufferPtr(128, 64, screenBuffer) == DisplayRet::Success);
+	display.setDrawBitmapAddr(true);
+
+	// arrays, the height padded to whole pages, containers the real height
+	HOST_CHECK(box_width == 16 && box_height == 16 && box_rle_height == 10);
+	HOST_CHECK(box_r90_width == 10 && box_r90_height == 16);
+	HOST_CHECK(arrow_width == 12 && arrow_height == 8);
+	HOST_CHECK(ramp_r90_width == 8 && ramp_r90_height == 16);
+
+	HOST_CHECK(drawnAs(display, boxOn, box, 16, 10, false));
+	HOST_CHECK(drawnAs(display, boxOn, box_rle, 16, 10, true));
+	HOST_CHECK(drawnAs(display, rotatedOn<boxOn, 10>, box_r90, 10, 16, false));
+	HOST_CHECK(drawnAs(display, checkerOn, checker, 8, 10, false));
+	HOST_CHECK(drawnAs(display, rotatedOn<checkerOn, 10>, checker_r90, 10, 8, false));
+	HOST_CHECK(drawnAs(display, arrowOn, arrow, 12, 8, false));
+	HOST_CHECK(drawnAs(display, rotatedOn<arrowOn, 8>, arrow_r90, 8, 12, false));
+	HOST_CHECK(drawnAs(display, rampOn, ramp, 16, 8, false));
+	HOST_CHECK(drawnAs(display, rotatedOn<rampOn, 8>, ramp_r90, 8, 16, false));
+	return host_check::result();
+}
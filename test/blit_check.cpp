@@ -0,0 +1,53 @@
+/*!
+	@file blit_check.cpp
+	@brief Host check of the vertical drawBitmap byte copy, clipped at every
+		edge, page aligned and shifted, both colours, against a pixel model.
+*/
+
+#include <algorithm>
+#include "displaylib/ssd1306.hpp"
+#include "host_check.hpp"
+
+static uint8_t screenBuffer[1024];
+
+int main()
+{
+	SSD1306 display(128, 64);
+	HOST_CHECK(display.OLEDbegin(SSD1306::SSD1306_ADDR, i2c1, 400, 18, 19) == DisplayRet::Success);
+	HOST_CHECK(display.OLEDSetBufferPtr(128, 64, screenBuffer) == DisplayRet::Success);
+	display.setDrawBitmapAddr(true);
+
+	// 12x16 bitmap, a different byte in each column and page
+	uint8_t bitmap[12 * 2];
+	for (uint8_t index = 0; index < sizeof(bitmap); index++)
+		bitmap[index] = static_cast<uint8_t>((index * 37) ^ 0xA5);
+
+	const int16_t places[][2] = {{-3, 0}, {-3, 5}, {120, 8}, {122, -4}, {40, -11}, {-11, 51}, {60, 56}};
+	for (const auto &place : places)
+	{
+		for (uint8_t color = 0; color < 2; color++)
+		{
+			uint8_t expected[1024];
+			for (size_t index = 0; index < sizeof(screenBuffer); index++)
+				screenBuffer[index] = static_cast<uint8_t>(index * 11);
+			std::copy(screenBuffer, screenBuffer + sizeof(screenBuffer), expected);
+			for (int16_t col = 0; col < 12; col++)
+			{
+				for (int16_t row = 0; row < 16; row++)
+				{
+					const int16_t x = place[0] + col, y = place[1] + row;
+					if (x < 0 || x >= 128 || y < 0 || y >= 64)
+						continue;
+					const bool on = ((bitmap[(row / 8) * 12 + col] >> (row % 8)) & 1) == (color == 0);
+					uint8_t &cell = expected[(y / 8) * 128 + x];
+					cell = on ? (cell | (1 << (y % 8))) : (cell & ~(1 << (y % 8)));
+				}
+			}
+			const uint8_t fg = color == 0 ? SSD1306::FG_COLOR : SSD1306::BG_COLOR;
+			const uint8_t bg = color == 0 ? SSD1306::BG_COLOR : SSD1306::FG_COLOR;
+			HOST_CHECK(display.drawBitmap(place[0], place[1], bitmap, 12, 16, fg, bg) == DisplayRet::Success);
+			HOST_CHECK(std::equal(expected, expected + sizeof(expected), screenBuffer));
+		}
+	}
+	return host_check::result();
+}
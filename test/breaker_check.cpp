@@ -0,0 +1,143 @@
+/*!
+	@file breaker_check.cpp
+	@brief Host check of the I2C circuit breaker, a cable pulled mid frame trips
+		it without updateStep overrunning its budget, the reconnect runs the power
+		up sequence again without blocking and restores the user state.
+*/
+
+#include <algorithm>
+#include "displaylib/sh110x.hpp"
+#include "displaylib/ssd1306.hpp"
+#include "host_stubs.hpp"
+#include "host_check.hpp"
+
+static uint8_t screenBuffer[1024];
+
+// Is the contrast command with this value in a recorded I2C command write
+static bool contrastSent(uint8_t value)
+{
+	for (const auto &write : host_stub::i2cWrites)
+		for (size_t index = 1; write[0] == 0x00 && index + 1 < write.size(); index++)
+			if (write[index] == 0x81 && write[index + 1] == value)
+				return true;
+	return false;
+}
+
+/*!
+	@brief Pulls the cable part way through a frame sent in steps
+	@param display the display
+	@param breaker its circuit breaker
+	@param budgetUs budget of each updateStep
+	@return the longest step, uS, the steps must end in FlushError with the breaker open
+*/
+// Runs updateStep until the frame in flight ends
+static displaylib_flush::flush_state_e sendAll(displaylib_flush &display)
+{
+	displaylib_flush::flush_state_e state;
+	uint16_t steps = 0;
+	do
+	{
+		state = display.updateStep(500);
+		host_stub::timeUs += 1000; // main loop work
+	} while (state == displaylib_flush::FlushBusy && ++steps < 1000);
+	return state;
+}
+
+static uint32_t pullMidFrame(displaylib_flush &display, displaylib_breaker &breaker, uint32_t budgetUs)
+{
+	HOST_CHECK(display.updateBegin() == DisplayRet::Success);
+	HOST_CHECK(display.updateStep(budgetUs) == displaylib_flush::FlushBusy);
+	host_stub::i2cFailWrites = 0xFFFFFFFF;
+	uint32_t worstUs = 0;
+	displaylib_flush::flush_state_e state;
+	uint8_t steps = 0;
+	do
+	{
+		const uint64_t startUs = host_stub::timeUs;
+		state = display.updateStep(budgetUs);
+		worstUs = std::max(worstUs, static_cast<uint32_t>(host_stub::timeUs - startUs));
+	} while (state == displaylib_flush::FlushBusy && ++steps < 100);
+	HOST_CHECK(state == displaylib_flush::FlushError);
+	HOST_CHECK(steps <= 4); // first attempt and the 3 retries, one per step
+	HOST_CHECK(breaker.GetBreakerOpen());
+	return worstUs;
+}
+
+int main()
+{
+	SH110X display(128, 64);
+	HOST_CHECK(display.OLEDbegin(SH110X::SH1106_IC, -1, SH110X::SH110X_ADDR, i2c1, 400, 18, 19) == DisplayRet::Success);
+	HOST_CHECK(display.OLEDSetBufferPtr(128, 64, screenBuffer) == DisplayRet::Success);
+	display.OLEDContrast(0x22);
+	HOST_CHECK(display.OLEDupdate() == DisplayRet::Success);
+
+	// cable pulled mid frame, the breaker opens and no step waits on retries
+	HOST_CHECK(pullMidFrame(display, display, 500) < 3000);
+	HOST_CHECK(display.OLEDupdate() != DisplayRet::Success);
+	HOST_CHECK(display.GetBreakerOpen());
+
+	// cable back, the probe is due, the reconnect must not block for the SH1106 DC-DC wait
+	host_stub::i2cFailWrites = 0;
+	host_stub::timeUs += 200000;
+	host_stub::busRecord = true;
+	HOST_CHECK(display.updateBegin() == DisplayRet::Success);
+	const uint64_t startUs = host_stub::timeUs;
+	HOST_CHECK(display.updateStep(2000) == displaylib_flush::FlushError); // frame in flight dropped
+	HOST_CHECK(host_stub::timeUs - startUs < 5000);
+	HOST_CHECK(!display.GetBreakerOpen());
+	HOST_CHECK(!display.isReady());
+
+	// the next frame is sent in steps while the power up sequence finishes
+	HOST_CHECK(display.updateBegin() == DisplayRet::Success);
+	displaylib_flush::flush_state_e state;
+	uint16_t steps = 0;
+	do
+	{
+		state = display.updateStep(2000);
+		host_stub::timeUs += 1000; // main loop work
+	} while (state == displaylib_flush::FlushBusy && ++steps < 1000);
+	HOST_CHECK(state == displaylib_flush::FlushDone);
+	HOST_CHECK(!contrastSent(0x22)); // not before the sequence is done
+
+	host_stub::timeUs += 100000;
+	HOST_CHECK(display.isReady());
+	HOST_CHECK(display.OLEDupdate() == DisplayRet::Success);
+	HOST_CHECK(contrastSent(0x22));
+
+	// the same on the SSD1306 at 400 kHz
+	host_stub::reset();
+	SSD1306 ssd1306(128, 64);
+	HOST_CHECK(ssd1306.OLEDbegin(SSD1306::SSD1306_ADDR, i2c1, 400, 18, 19) == DisplayRet::Success);
+	HOST_CHECK(ssd1306.OLEDSetBufferPtr(128, 64, screenBuffer) == DisplayRet::Success);
+	HOST_CHECK(ssd1306.OLEDupdate() == DisplayRet::Success);
+	HOST_CHECK(pullMidFrame(ssd1306, ssd1306, 500) < 3000);
+
+	// a failed probe goes to the diagnostics ring, not stdout
+	ssd1306.SetDebugMode(true);
+	displaylib_diag::diag_entry_t entry;
+	while (displaylib_diag::pop(entry)) {}
+	host_stub::timeUs += 200000;
+	host_stub::i2cFailAboveBaud = 1; // reads fail too
+	HOST_CHECK(ssd1306.updateBegin() == DisplayRet::Success);
+	HOST_CHECK(ssd1306.updateStep(500) == displaylib_flush::FlushError);
+	host_stub::i2cFailAboveBaud = 0;
+	bool probed = false;
+	while (displaylib_diag::pop(entry))
+		probed |= (entry.func == displaylib_diag::FuncCheckConnection && entry.code == DisplayRet::I2CNotConnected);
+	HOST_CHECK(probed);
+	ssd1306.SetDebugMode(false);
+
+	// a write that fails once is sent again on the next step, the frame completes
+	host_stub::i2cFailWrites = 0;
+	host_stub::timeUs += 200000;
+	HOST_CHECK(ssd1306.updateBegin() == DisplayRet::Success);
+	HOST_CHECK(sendAll(ssd1306) == displaylib_flush::FlushError); // probe, reconnect, frame dropped
+	HOST_CHECK(ssd1306.updateBegin() == DisplayRet::Success);
+	HOST_CHECK(sendAll(ssd1306) == displaylib_flush::FlushDone);
+	HOST_CHECK(ssd1306.updateBegin() == DisplayRet::Success);
+	HOST_CHECK(ssd1306.updateStep(500) == displaylib_flush::FlushBusy);
+	host_stub::i2cFailWrites = 1;
+	HOST_CHECK(sendAll(ssd1306) == displaylib_flush::FlushDone);
+	HOST_CHECK(!ssd1306.GetBreakerOpen());
+	return host_check::result();
+}
@@ -0,0 +1,20 @@
+# Runs capture_check for one controller, rebuilds the display RAM from the
+# capture with displaylib_capture.py and compares it with the screen buffer.
+# -DPROGRAM= -DCONTROLLER= -DSIZE=WxH -DPYTHON= -DTOOLS= -DWORK=
+file(MAKE_DIRECTORY ${WORK})
+execute_process(COMMAND ${PROGRAM} ${CONTROLLER} ${WORK}/expected.pbm
+  OUTPUT_FILE ${WORK}/capture.txt RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "capture_check ${CONTROLLER} failed: ${result}")
+endif()
+execute_process(COMMAND ${PYTHON} ${TOOLS}/displaylib_capture.py --controller ${CONTROLLER}
+    --size ${SIZE} --ram ${WORK}/ram.pbm ${WORK}/capture.txt
+  RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "displaylib_capture.py failed on the ${CONTROLLER} capture: ${result}")
+endif()
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${WORK}/expected.pbm ${WORK}/ram.pbm
+  RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "${CONTROLLER}: display RAM rebuilt from the capture differs from the screen buffer")
+endif()
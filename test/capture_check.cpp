@@ -0,0 +1,121 @@
+/*!
+	@file capture_check.cpp
+	@brief Host check of the bus capture, _BUS_CAPTURE_ENABLE. A pattern is drawn
+		and sent with the driver update, the capture is printed on stdout and the
+		screen buffer written as a PBM, capture_check.cmake rebuilds the display
+		RAM from the capture with displaylib_capture.py and compares the two.
+		capture_check <ssd1306|sh1106|sh1107|ch1115|uc1609|pcd8544> <expected.pbm>
+*/
+
+#include <cstring>
+#include <string_view>
+#include "displaylib/ssd1306.hpp"
+#include "displaylib/sh110x.hpp"
+#include "displaylib/ch1115.hpp"
+#include "displaylib/erm19264.hpp"
+#include "displaylib/nokia5110.hpp"
+#include "host_check.hpp"
+
+static uint8_t captureBuffer[32768];
+static uint8_t screenBuffer[192 * 64 / 8];
+
+// Text, shapes and a filled block touching every page and both edges
+static void drawPattern(displaylib_graphics &display)
+{
+	const int16_t w = display.width();
+	const int16_t h = display.height();
+	display.drawRect(0, 0, w, h, display.FG_COLOR);
+	display.fillCircle(w / 2, h / 2, h / 4, display.FG_COLOR);
+	display.drawLine(0, h - 1, w - 1, 0, display.INVERSE);
+	display.fillRect(w - 12, 3, 9, h - 6, display.FG_COLOR);
+	display.setFont(pFontDefault);
+	display.setCursor(2, 2);
+	display.print("Capture");
+}
+
+template <class Display>
+static bool finish(Display &display, const char *path, int width, int height)
+{
+	display.busCaptureStop();
+	display.busCaptureDump();
+	HOST_CHECK(display.getBusCaptureDropped() == 0);
+	return host_check::writePagesPbm(path, std::span<const uint8_t>(screenBuffer, width * (height / 8)), width, height);
+}
+
+int main(int argc, char **argv)
+{
+	if (argc != 3)
+	{
+		fprintf(stderr, "usage: capture_check <controller> <expected.pbm>\n");
+		return 2;
+	}
+	const std::string_view controller = argv[1];
+	const char *path = argv[2];
+	bool written = false;
+	if (controller == "ssd1306")
+	{
+		SSD1306 display(128, 64);
+		display.busCaptureStart(captureBuffer);
+		HOST_CHECK(display.OLEDbegin(SSD1306::SSD1306_ADDR, i2c1, 400, 18, 19) == DisplayRet::Success);
+		HOST_CHECK(display.OLEDSetBufferPtr(128, 64, std::span<uint8_t>(screenBuffer, 1024)) == DisplayRet::Success);
+		display.OLEDclearBuffer();
+		drawPattern(display);
+		HOST_CHECK(display.OLEDupdate() == DisplayRet::Success);
+		written = finish(display, path, 128, 64);
+	}
+	else if (controller == "sh1106" || controller == "sh1107")
+	{
+		SH110X display(128, 64);
+		display.busCaptureStart(captureBuffer);
+		HOST_CHECK(display.OLEDbegin(controller == "sh1106" ? SH110X::SH1106_IC : SH110X::SH1107_IC,
+			-1, SH110X::SH110X_ADDR, i2c1, 400, 18, 19) == DisplayRet::Success);
+		HOST_CHECK(display.OLEDSetBufferPtr(128, 64, std::span<uint8_t>(screenBuffer, 1024)) == DisplayRet::Success);
+		display.OLEDclearBuffer();
+		drawPattern(display);
+		HOST_CHECK(display.OLEDupdate() == DisplayRet::Success);
+		written = finish(display, path, 128, 64);
+	}
+	else if (controller == "ch1115")
+	{
+		ERMCH1115 display(128, 64);
+		display.busCaptureStart(captureBuffer);
+		display.OLEDSPISetup(spi0, 8000, 3, 2, 5, 6, 7);
+		display.OLEDinit(0x80);
+		HOST_CHECK(display.OLEDSetBufferPtr(128, 64, screenBuffer, 1024) == 0);
+		display.OLEDclearBuffer();
+		drawPattern(display);
+		display.OLEDupdate();
+		written = finish(display, path, 128, 64);
+	}
+	else if (controller == "uc1609")
+	{
+		ERM19264 display(192, 64);
+		display.busCaptureStart(captureBuffer);
+		display.LCDSPISetup(spi0, 8000, 3, 2, 5, 6, 7);
+		display.LCDinit();
+		HOST_CHECK(display.LCDSetBufferPtr(192, 64, screenBuffer) == DisplayRet::Success);
+		display.LCDclearBuffer();
+		drawPattern(display);
+		HOST_CHECK(display.LCDupdate() == DisplayRet::Success);
+		written = finish(display, path, 192, 64);
+	}
+	else if (controller == "pcd8544")
+	{
+		NOKIA_5110 display(84, 48);
+		display.busCaptureStart(captureBuffer);
+		HOST_CHECK(display.LCDSPISetup(spi0, 4000, 3, 2, 5, 6, 7) == DisplayRet::Success);
+		display.LCDInit(false, 0xB2, 0x13);
+		HOST_CHECK(display.LCDSetBufferPtr(84, 48, std::span<uint8_t>(screenBuffer, 84 * 48 / 8)) == DisplayRet::Success);
+		display.LCDclearBuffer();
+		drawPattern(display);
+		HOST_CHECK(display.LCDupdate() == DisplayRet::Success);
+		written = finish(display, path, 84, 48);
+	}
+	else
+	{
+		fprintf(stderr, "capture_check: unknown controller %s\n", argv[1]);
+		return 2;
+	}
+	HOST_CHECK(written);
+	return host_check::result();
+}
@@ -0,0 +1,84 @@
+/*!
+	@file clocktune_check.cpp
+	@brief Host check of the I2C clock tuning, the fastest clock the simulated
+		bus takes, the re-tune run only by I2CClockRetune and never from an
+		update, and the controller init re-sent when the first step fails.
+*/
+
+#include "displaylib/ssd1306.hpp"
+#include "host_stubs.hpp"
+#include "host_check.hpp"
+
+static uint8_t screenBuffer[1024];
+
+// Is the init burst, display off first, in a recorded I2C command write
+static bool initSent(void)
+{
+	for (const auto &write : host_stub::i2cWrites)
+		if (write.size() > 2 && write[0] == 0x00 && write[1] == 0xAE)
+			return true;
+	return false;
+}
+
+// Sends frames in steps until one is done, the breaker may drop the first
+static bool sendFrame(SSD1306 &display)
+{
+	for (uint8_t frame = 0; frame < 4; frame++)
+	{
+		if (display.updateBegin() != DisplayRet::Success)
+			return false;
+		displaylib_flush::flush_state_e state;
+		uint16_t steps = 0;
+		do
+		{
+			state = display.updateStep(2000);
+			host_stub::timeUs += 1000; // main loop work
+		} while (state == displaylib_flush::FlushBusy && ++steps < 1000);
+		if (state == displaylib_flush::FlushDone)
+			return true;
+		host_stub::timeUs += 200000; // breaker backoff
+	}
+	return false;
+}
+
+int main()
+{
+	SSD1306 display(128, 64);
+	HOST_CHECK(display.OLEDbegin(SSD1306::SSD1306_ADDR, i2c1, 400, 18, 19) == DisplayRet::Success);
+	HOST_CHECK(display.OLEDSetBufferPtr(128, 64, screenBuffer) == DisplayRet::Success);
+
+	// the board takes 600 kHz, not 800, set 10% below
+	host_stub::i2cFailAboveBaud = 700000;
+	HOST_CHECK(display.I2CClockTune() == DisplayRet::Success);
+	HOST_CHECK(display.GetI2CClockTuned() == 540);
+	HOST_CHECK(host_stub::i2cBaud == 540000);
+	display.SetI2CClockAutoTune(true);
+
+	// the wiring gets worse, errors climb, updates never run the re-tune
+	host_stub::i2cFailAboveBaud = 300000;
+	host_stub::timeUs += 6000000; // past the hold off
+	HOST_CHECK(display.OLEDupdate() != DisplayRet::Success);
+	HOST_CHECK(display.GetI2CClockRetuneDue());
+	HOST_CHECK(sendFrame(display)); // reconnected at the lowest step
+	HOST_CHECK(display.GetI2CClockTuneRuns() == 1);
+	HOST_CHECK(host_stub::i2cBaud == 100000);
+
+	// between frames the re-tune runs
+	HOST_CHECK(display.I2CClockRetune() == DisplayRet::Success);
+	HOST_CHECK(display.GetI2CClockTuneRuns() == 2);
+	HOST_CHECK(display.GetI2CClockTuned() == 180);
+	HOST_CHECK(!display.GetI2CClockRetuneDue());
+	HOST_CHECK(display.I2CClockRetune() == DisplayRet::Success); // none due, nothing run
+	HOST_CHECK(display.GetI2CClockTuneRuns() == 2);
+
+	// the first step fails, the clock is put back and the init re-sent
+	host_stub::busRecord = true;
+	host_stub::i2cWrites.clear();
+	host_stub::i2cFailWrites = 1;
+	HOST_CHECK(display.I2CClockTune() == DisplayRet::I2CNotConnected);
+	HOST_CHECK(host_stub::i2cBaud == 180000);
+	HOST_CHECK(initSent());
+	HOST_CHECK(sendFrame(display));
+
+	return host_check::result();
+}
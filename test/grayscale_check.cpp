@@ -0,0 +1,166 @@
+/*!
+	@file grayscale_check.cpp
+	@brief Host check of the grayscale sequencer on the simulated bus, the
+		sub-frame cadence and overrun count of GrayStream, the start line flips
+		and page uploads of GrayRamFlip, and the grayDither pattern of each level.
+*/
+
+#include <vector>
+#include "displaylib/ssd1306.hpp"
+#include "displaylib/display_grayscale.hpp"
+#include "host_stubs.hpp"
+#include "host_check.hpp"
+
+static uint8_t screenBuffer[1024];
+static uint8_t planes[2048];
+
+// Runs the sequencer until the time given, returns the times of the sub-frames shown, no bus errors expected
+static std::vector<uint64_t> runUntil(displaylib_grayscale &gray, uint64_t endUs)
+{
+	std::vector<uint64_t> shown;
+	while (host_stub::timeUs < endUs)
+	{
+		const displaylib_flush::flush_state_e state = gray.grayStep(0);
+		HOST_CHECK(state != displaylib_flush::FlushError);
+		if (state == displaylib_flush::FlushDone)
+			shown.push_back(host_stub::timeUs);
+		else
+			host_stub::timeUs += 100; // main loop work
+	}
+	return shown;
+}
+
+// Start line commands sent since the recording started
+static std::vector<uint8_t> startLines(void)
+{
+	std::vector<uint8_t> lines;
+	for (const auto &write : host_stub::i2cWrites)
+		if (write.size() == 2 && write[0] == 0x00 && (write[1] & 0xC0) == 0x40)
+			lines.push_back(static_cast<uint8_t>(write[1] & 0x3F));
+	return lines;
+}
+
+int main()
+{
+	// GrayStream, 128x64, a 1024 byte plane takes about 24 ms at 400 kHz
+	{
+		SSD1306 display(128, 64);
+		HOST_CHECK(display.OLEDbegin(SSD1306::SSD1306_ADDR, i2c1, 400, 18, 19) == DisplayRet::Success);
+		HOST_CHECK(display.OLEDSetBufferPtr(128, 64, screenBuffer) == DisplayRet::Success);
+		while (!display.isReady()) // the power up sequence
+			host_stub::timeUs += 1000;
+		displaylib_grayscale gray(display);
+		HOST_CHECK(gray.grayBegin(planes) == DisplayRet::Success);
+		HOST_CHECK(gray.getGrayMode() == displaylib_grayscale::GrayStream);
+
+		// the bus keeps up, every sub-frame one period after the last, no overruns
+		gray.setSubframePeriod(30000);
+		gray.resetStats();
+		std::vector<uint64_t> shown = runUntil(gray, host_stub::timeUs + 600000);
+		HOST_CHECK(shown.size() >= 19 && shown.size() <= 20);
+		for (size_t index = 1; index < shown.size(); index++)
+			HOST_CHECK(shown[index] - shown[index - 1] >= 29900 && shown[index] - shown[index - 1] <= 30100);
+		const displaylib_grayscale::gray_stats_t &stats = gray.getGrayStats();
+		HOST_CHECK(stats.subframes == shown.size());
+		HOST_CHECK(stats.cycles == stats.subframes / 3);
+		HOST_CHECK(stats.overruns == 0);
+		HOST_CHECK(stats.flushErrors == 0);
+		HOST_CHECK(stats.sendMaxUs > 20000 && stats.sendMaxUs < 30000);
+		const float rate = gray.getSubframeRate();
+		HOST_CHECK(rate > 31.0f && rate < 34.0f);
+
+		// the bus is too slow for the period, every sub-frame after the first is late
+		gray.setSubframePeriod(10000);
+		runUntil(gray, host_stub::timeUs + 50000); // finish the sub-frame in flight
+		gray.resetStats();
+		shown = runUntil(gray, host_stub::timeUs + 300000);
+		HOST_CHECK(shown.size() >= 10);
+		HOST_CHECK(stats.overruns + 1 >= stats.subframes && stats.overruns <= stats.subframes);
+		for (size_t index = 1; index < shown.size(); index++)
+			HOST_CHECK(shown[index] - shown[index - 1] == stats.sendLastUs); // back to back, set by the bus
+
+		// a write that fails once is sent again in the next step, the sub-frame still shows
+		host_stub::i2cFailWrites = 1;
+		uint32_t before = stats.subframes;
+		runUntil(gray, host_stub::timeUs + 60000);
+		HOST_CHECK(host_stub::i2cFailWrites == 0);
+		HOST_CHECK(stats.subframes > before);
+		HOST_CHECK(stats.flushErrors == 0);
+
+		// the display gone, the sub-frame is counted as an error, shown again once it is back
+		host_stub::i2cFailWrites = 1000;
+		bool failed = false;
+		for (uint16_t step = 0; step < 1000 && !failed; step++)
+		{
+			failed = gray.grayStep(0) == displaylib_flush::FlushError;
+			host_stub::timeUs += 100;
+		}
+		HOST_CHECK(failed);
+		HOST_CHECK(stats.flushErrors >= 1);
+		host_stub::i2cFailWrites = 0;
+		host_stub::timeUs += 200000; // breaker backoff
+		before = stats.subframes;
+		for (uint16_t step = 0; step < 2000 && stats.subframes == before; step++)
+		{
+			gray.grayStep(0);
+			host_stub::timeUs += 100;
+		}
+		HOST_CHECK(stats.subframes > before);
+		HOST_CHECK(gray.grayEnd() == DisplayRet::Success);
+
+		// grayDither, level n lights the pixels whose Bayer threshold is under n/3
+		const uint8_t bayer[4][4] = {{0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}};
+		for (uint8_t level = 0; level < displaylib_grayscale::GRAY_LEVELS; level++)
+			gray.grayFillRect(level * 32, 0, 32, 64, level);
+		HOST_CHECK(gray.grayGetPixel(40, 10) == 1 && gray.grayGetPixel(127, 63) == 3);
+		uint8_t frame[1024];
+		HOST_CHECK(gray.grayDither(frame) == DisplayRet::Success);
+		uint16_t lit[displaylib_grayscale::GRAY_LEVELS] = {};
+		bool matches = true;
+		for (int16_t y = 0; y < 64; y++)
+		{
+			for (int16_t x = 0; x < 128; x++)
+			{
+				const uint8_t level = static_cast<uint8_t>(x / 32);
+				const bool on = (frame[(y / 8) * 128 + x] >> (y % 8)) & 1;
+				matches = matches && on == (bayer[y & 3][x & 3] * 3 < level * 16);
+				lit[level] = static_cast<uint16_t>(lit[level] + on);
+			}
+		}
+		HOST_CHECK(matches);
+		HOST_CHECK(lit[0] == 0 && lit[1] == 768 && lit[2] == 1408 && lit[3] == 2048); // 0, 6, 11, 16 of 16
+		HOST_CHECK(gray.grayDither(std::span<uint8_t>(frame, 512)) == DisplayRet::BufferSize);
+	}
+
+	// GrayRamFlip, 128x32, both planes fit the 64 line RAM, a sub-frame is a start line command
+	{
+		host_stub::reset();
+		SSD1306 display(128, 32);
+		HOST_CHECK(display.OLEDbegin(SSD1306::SSD1306_ADDR, i2c1, 400, 18, 19) == DisplayRet::Success);
+		HOST_CHECK(display.OLEDSetBufferPtr(128, 32, std::span<uint8_t>(screenBuffer, 512)) == DisplayRet::Success);
+		while (!display.isReady()) // the power up sequence
+			host_stub::timeUs += 1000;
+		displaylib_grayscale gray(display);
+		HOST_CHECK(gray.grayBegin(std::span<uint8_t>(planes, 1024)) == DisplayRet::Success);
+		HOST_CHECK(gray.getGrayMode() == displaylib_grayscale::GrayRamFlip);
+		HOST_CHECK(gray.getGrayStats().uploadPages == 0); // the begin uploads are before the stats reset
+
+		host_stub::busRecord = true;
+		host_stub::i2cWrites.clear();
+		std::vector<uint64_t> shown = runUntil(gray, host_stub::timeUs + 30000);
+		HOST_CHECK(shown.size() == 6);
+		for (size_t index = 1; index < shown.size(); index++)
+			HOST_CHECK(shown[index] - shown[index - 1] >= 4900 && shown[index] - shown[index - 1] <= 5100);
+		const std::vector<uint8_t> lines = startLines();
+		HOST_CHECK((lines == std::vector<uint8_t>{32, 0, 32, 32, 0, 32}));
+		HOST_CHECK(gray.getGrayStats().overruns == 0);
+
+		// a change to one page writes that page of both planes between flips
+		gray.grayFillRect(0, 9, 10, 4, 3);
+		runUntil(gray, host_stub::timeUs + 20000);
+		HOST_CHECK(gray.getGrayStats().uploadPages == 2);
+		HOST_CHECK(gray.getGrayStats().overruns == 0);
+		HOST_CHECK(gray.grayEnd() == DisplayRet::Success);
+	}
+	return host_check::result();
+}
@@ -0,0 +1,62 @@
+/*!
+	@file host_check.hpp
+	@brief Check macro and helpers shared by the host tests.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <span>
+
+namespace host_check
+{
+	inline int failures = 0; /**< Checks failed so far */
+
+	/*!
+		@brief Writes a buffer in the display page layout as a binary PBM, 1 a lit pixel
+		@param path file to write
+		@param buffer the buffer, x + (y / 8) * width, bit y % 8
+		@param width width in pixels
+		@param height height in pixels
+		@return true if written
+	*/
+	inline bool writePagesPbm(const char *path, std::span<const uint8_t> buffer, int width, int height)
+	{
+		FILE *file = fopen(path, "wb");
+		if (file == nullptr)
+			return false;
+		fprintf(file, "P4\n%d %d\n", width, height);
+		for (int y = 0; y < height; y++)
+		{
+			uint8_t packed = 0;
+			for (int x = 0; x < width; x++)
+			{
+				if ((buffer[(y / 8) * width + x] >> (y % 8)) & 1)
+					packed |= static_cast<uint8_t>(0x80 >> (x % 8));
+				if ((x % 8) == 7 || x == width - 1)
+				{
+					fputc(packed, file);
+					packed = 0;
+				}
+			}
+		}
+		return fclose(file) == 0;
+	}
+
+	/*!
+		@brief Exit status of the test
+		@return 0 if every check passed
+	*/
+	inline int result(void)
+	{
+		if (failures)
+			fprintf(stderr, "%d checks failed\n", failures);
+		return failures ? 1 : 0;
+	}
+}
+
+/*! Counts and reports a failed check, the test carries on */
+#define HOST_CHECK(condition) \
+	do { if (!(condition)) { host_check::failures++; \
+		fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); } } while (0)
@@ -0,0 +1,190 @@
+/*!
+	@file manager_check.cpp
+	@brief Host check of the multi panel manager, fake panels whose data
+		writes use up simulated bus time, for budget sharing, no starvation,
+		merged submits and rectangle submits.
+*/
+
+#include <algorithm>
+#include <vector>
+#include "displaylib/display_manager.hpp"
+#include "host_stubs.hpp"
+#include "host_check.hpp"
+
+/*! A display whose bus is simulated, each data byte takes a set time */
+class fake_panel : public displaylib_flush
+{
+public:
+	/*!
+		@param w width
+		@param h height
+		@param byteUs simulated bus time of one data byte, uS
+	*/
+	fake_panel(int16_t w, int16_t h, uint32_t byteUs) :
+		displaylib_flush(w, h), buffer(static_cast<size_t>(w) * (h / 8)), _byteUs(byteUs) {}
+
+	std::vector<uint8_t> buffer;   /**< Screen buffer */
+	uint32_t bytesWritten = 0;     /**< Data bytes sent */
+	uint32_t addressCalls = 0;     /**< flushSetAddress calls */
+	uint8_t firstPage = 0xFF;      /**< Lowest page addressed */
+	uint8_t lastPage = 0;          /**< Highest page addressed */
+	uint8_t firstColumn = 0xFF;    /**< Lowest column addressed */
+	uint8_t lastColumn = 0;        /**< Highest end column addressed */
+
+	/*! @brief Forgets the counters */
+	void clearCounts(void)
+	{
+		bytesWritten = addressCalls = 0;
+		firstPage = firstColumn = 0xFF;
+		lastPage = lastColumn = 0;
+	}
+
+protected:
+	std::span<const uint8_t> flushBuffer(void) override { return buffer; }
+	DisplayRet::Ret_Codes_e flushSetAddress(uint8_t page, uint8_t column, uint8_t columnEnd) override
+	{
+		addressCalls++;
+		firstPage = std::min(firstPage, page);
+		lastPage = std::max(lastPage, page);
+		firstColumn = std::min(firstColumn, column);
+		lastColumn = std::max(lastColumn, columnEnd);
+		return DisplayRet::Success;
+	}
+	DisplayRet::Ret_Codes_e flushWriteData(std::span<const uint8_t> data) override
+	{
+		host_stub::timeUs += data.size() * _byteUs;
+		bytesWritten += data.size();
+		return DisplayRet::Success;
+	}
+
+private:
+	uint32_t _byteUs;
+};
+
+/*!
+	@brief Runs managerStep until no panel is pending
+	@param manager the manager
+	@return steps taken, stops at 10000
+*/
+static uint32_t runToIdle(displaylib_manager &manager)
+{
+	uint32_t steps = 0;
+	while (manager.managerBusy() && steps < 10000)
+	{
+		manager.managerStep();
+		steps++;
+	}
+	return steps;
+}
+
+int main()
+{
+	host_stub::reset();
+
+	// Round robin, two equal panels share the bus budget about equally
+	{
+		fake_panel first(128, 64, 1), second(128, 64, 1);
+		displaylib_manager manager(displaylib_manager::PolicyRoundRobin);
+		HOST_CHECK(manager.panelAdd(first, 0) == DisplayRet::Success);
+		HOST_CHECK(manager.panelAdd(second, 0) == DisplayRet::Success);
+		manager.setBusBudget(0, 2000);
+		HOST_CHECK(manager.panelSubmit(0) == DisplayRet::Success);
+		HOST_CHECK(manager.panelSubmit(1) == DisplayRet::Success);
+		const uint64_t startUs = host_stub::timeUs;
+		manager.managerStep();
+		const uint32_t usedUs = static_cast<uint32_t>(host_stub::timeUs - startUs);
+		HOST_CHECK(usedUs <= 2000 + 16);
+		HOST_CHECK(first.bytesWritten >= 900 && first.bytesWritten <= 1024);
+		HOST_CHECK(second.bytesWritten >= 900 && second.bytesWritten <= 1024);
+		runToIdle(manager);
+		HOST_CHECK(manager.getPanelStats(0).framesFlushed == 1 && manager.getPanelStats(1).framesFlushed == 1);
+	}
+
+	// Priority, shares in proportion, 3 to 1
+	{
+		fake_panel high(128, 64, 2), low(128, 64, 2);
+		displaylib_manager manager(displaylib_manager::PolicyPriority);
+		manager.panelAdd(low, 0, 1);
+		manager.panelAdd(high, 0, 3);
+		manager.setBusBudget(0, 2000);
+		manager.panelSubmit(0);
+		manager.panelSubmit(1);
+		manager.managerStep();
+		HOST_CHECK(high.bytesWritten >= 700 && high.bytesWritten <= 770);  // 1500 uS
+		HOST_CHECK(low.bytesWritten >= 220 && low.bytesWritten <= 270);    // 500 uS
+		runToIdle(manager);
+	}
+
+	// No starvation, one chunk of the slow panel is longer than the whole budget
+	{
+		fake_panel slow(128, 64, 200), fast(128, 64, 1);
+		displaylib_manager manager(displaylib_manager::PolicyRoundRobin);
+		manager.panelAdd(slow, 0);
+		manager.panelAdd(fast, 0);
+		manager.setBusBudget(0, 2000);
+		manager.panelSubmit(0);
+		manager.panelSubmit(1);
+		uint32_t idleSlow = 0, idleFast = 0, worstSlow = 0, worstFast = 0;
+		while (manager.managerBusy())
+		{
+			const uint32_t slowBefore = slow.bytesWritten, fastBefore = fast.bytesWritten;
+			manager.managerStep();
+			idleSlow = (manager.panelBusy(0) && slow.bytesWritten == slowBefore) ? idleSlow + 1 : 0;
+			idleFast = (manager.panelBusy(1) && fast.bytesWritten == fastBefore) ? idleFast + 1 : 0;
+			worstSlow = std::max(worstSlow, idleSlow);
+			worstFast = std::max(worstFast, idleFast);
+		}
+		HOST_CHECK(worstSlow <= 1 && worstFast <= 1);
+		HOST_CHECK(manager.getPanelStats(1).stepsSkipped > 0);
+		HOST_CHECK(slow.bytesWritten == 1024 && fast.bytesWritten == 1024);
+	}
+
+	// Merged submits, two submits mid frame are one more frame
+	{
+		fake_panel panel(128, 64, 1);
+		displaylib_manager manager;
+		manager.panelAdd(panel, 1);
+		manager.setBusBudget(1, 200);
+		manager.panelSubmit(0);
+		manager.managerStep();
+		HOST_CHECK(manager.panelBusy(0));
+		manager.panelSubmit(0);
+		manager.panelSubmit(0);
+		runToIdle(manager);
+		const displaylib_manager::panel_stats_t &stats = manager.getPanelStats(0);
+		HOST_CHECK(stats.framesMerged == 2);
+		HOST_CHECK(stats.framesSubmitted == 2);
+		HOST_CHECK(stats.framesFlushed == 2);
+		HOST_CHECK(panel.bytesWritten == 2048);
+	}
+
+	// Rectangle submits, only the pages and columns covered, merged ones joined
+	{
+		fake_panel panel(128, 64, 1);
+		displaylib_manager manager;
+		manager.panelAdd(panel, 0);
+		HOST_CHECK(manager.panelSubmit(0, displaylib_flush::flush_rect_t{10, 8, 20, 16}) == DisplayRet::Success);
+		runToIdle(manager);
+		HOST_CHECK(panel.bytesWritten == 40);
+		HOST_CHECK(panel.firstPage == 1 && panel.lastPage == 2);
+		HOST_CHECK(panel.firstColumn == 10 && panel.lastColumn == 29);
+
+		panel.clearCounts();
+		manager.setBusBudget(0, 100);
+		manager.panelSubmit(0);
+		manager.managerStep();
+		manager.panelSubmit(0, displaylib_flush::flush_rect_t{0, 0, 8, 8});
+		manager.panelSubmit(0, displaylib_flush::flush_rect_t{16, 8, 8, 8});
+		manager.panelSubmit(0, displaylib_flush::flush_rect_t{}); // empty, ignored
+		runToIdle(manager);
+		HOST_CHECK(panel.bytesWritten == 1024 + (24 * 2)); // joined, columns 0-23 of pages 0-1
+		HOST_CHECK(manager.getPanelStats(0).framesMerged == 2);
+
+		panel.clearCounts();
+		manager.panelSubmit(0, displaylib_flush::flush_rect_t{200, 0, 8, 8}); // off screen
+		HOST_CHECK(!manager.panelBusy(0));
+		HOST_CHECK(panel.bytesWritten == 0);
+	}
+
+	return host_check::result();
+}
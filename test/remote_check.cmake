@@ -0,0 +1,24 @@
+# Runs displaylib_remote.py against remote_receiver over a pipe, the screen
+# buffer written by the receiver at the end must equal the last frame sent.
+# With CORRUPT set that frame is sent with a bad CRC, it must be rejected and
+# the sender must recover with a full frame.
+# -DRECEIVER= -DPYTHON= -DTOOLS= -DWORK= [-DCORRUPT=N]
+file(MAKE_DIRECTORY ${WORK})
+file(REMOVE ${WORK}/sent.pbm ${WORK}/screen.pbm)
+set(corrupt)
+if(DEFINED CORRUPT)
+  set(corrupt --corrupt ${CORRUPT})
+endif()
+execute_process(COMMAND ${PYTHON} ${TOOLS}/displaylib_remote.py --exec "${RECEIVER} ${WORK}/screen.pbm"
+    --demo --frames 300 --fps 0 --last ${WORK}/sent.pbm ${corrupt}
+  OUTPUT_FILE ${WORK}/sender.log ERROR_FILE ${WORK}/receiver.log RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  file(READ ${WORK}/sender.log sender)
+  file(READ ${WORK}/receiver.log receiver)
+  message(FATAL_ERROR "displaylib_remote.py failed: ${result}\n${sender}${receiver}")
+endif()
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${WORK}/sent.pbm ${WORK}/screen.pbm
+  RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "the receiver screen buffer differs from the last frame sent")
+endif()
@@ -0,0 +1,54 @@
+/*!
+	@file remote_receiver.cpp
+	@brief Host receiver of the remote framebuffer protocol, for the loopback
+		test with displaylib_remote.py --exec. Frames are read from stdin and
+		answered on stdout as on USB CDC, at the end of stdin the screen
+		buffer is written as a PBM.
+	@details remote_receiver <screen.pbm>
+*/
+
+#include "pico/stdlib.h"
+#include "displaylib/ssd1306.hpp"
+#include "displaylib/display_remote.hpp"
+#include "host_stubs.hpp"
+#include "host_check.hpp"
+
+static uint8_t screenBuffer[1024];
+static uint8_t stagingBuffer[1100];
+
+int main(int argc, char *argv[])
+{
+	if (argc != 2)
+	{
+		fprintf(stderr, "usage: remote_receiver screen.pbm\n");
+		return 2;
+	}
+	stdio_init_all();
+	SSD1306 display(128, 64);
+	HOST_CHECK(display.OLEDbegin(SSD1306::SSD1306_ADDR, i2c1, 400, 18, 19) == DisplayRet::Success);
+	HOST_CHECK(display.OLEDSetBufferPtr(128, 64, screenBuffer) == DisplayRet::Success);
+	displaylib_remote remote(display);
+	HOST_CHECK(remote.remoteBegin(stagingBuffer) == DisplayRet::Success);
+
+	while (!host_stub::stdinClosed)
+	{
+		remote.remotePoll(5000);
+		HOST_CHECK(remote.flushDirty(display) == DisplayRet::Success);
+		// wait for the next byte rather than spin, the sender waits on the answers
+		const int value = getchar_timeout_us(10000);
+		if (value >= 0)
+		{
+			const uint8_t byte = static_cast<uint8_t>(value);
+			remote.remoteFeed(std::span<const uint8_t>(&byte, 1));
+		}
+	}
+	HOST_CHECK(remote.flushDirty(display) == DisplayRet::Success);
+
+	const displaylib_remote::remote_stats_t &stats = remote.getRemoteStats();
+	fprintf(stderr, "remote_receiver: %u frames, %u CRC errors, %u length errors, %u format errors\n",
+		static_cast<unsigned>(stats.frames), static_cast<unsigned>(stats.crcErrors),
+		static_cast<unsigned>(stats.lengthErrors), static_cast<unsigned>(stats.formatErrors));
+	HOST_CHECK(stats.lengthErrors == 0 && stats.formatErrors == 0);
+	HOST_CHECK(host_check::writePagesPbm(argv[1], screenBuffer, 128, 64));
+	return host_check::result();
+}
@@ -0,0 +1,20 @@
+# Runs snapshot_check for one display size, the SnapshotPBM must equal the
+# screen buffer, the SnapshotRLE decoded by displaylib_snapshot.py must too.
+# -DPROGRAM= -DSIZE=WxH -DPYTHON= -DTOOLS= -DWORK=
+file(MAKE_DIRECTORY ${WORK})
+execute_process(COMMAND ${PROGRAM} ${SIZE} ${WORK}/expected.pbm ${WORK}/snapshot.pbm
+  OUTPUT_FILE ${WORK}/serial.log RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "snapshot_check ${SIZE} failed: ${result}")
+endif()
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${WORK}/expected.pbm ${WORK}/snapshot.pbm
+  RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "${SIZE}: SnapshotPBM differs from the screen buffer")
+endif()
+execute_process(COMMAND ${PYTHON} ${TOOLS}/displaylib_snapshot.py --compare ${WORK}/expected.pbm
+    ${WORK}/serial.log ${WORK}/snapshot.pgm
+  RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "${SIZE}: SnapshotRLE decoded by displaylib_snapshot.py differs from the screen buffer")
+endif()
@@ -0,0 +1,84 @@
+/*!
+	@file snapshot_check.cpp
+	@brief Host check of displaylib_snapshot. A pattern is drawn, the screen buffer
+		is written as the expected PBM, a SnapshotPBM to a file and a SnapshotRLE,
+		sent in small steps, to stdout. snapshot_check.cmake compares them with
+		displaylib_snapshot.py.
+		snapshot_check <128x64|192x64> <expected.pbm> <snapshot.pbm>
+*/
+
+#include <string_view>
+#include "displaylib/ssd1306.hpp"
+#include "displaylib/erm19264.hpp"
+#include "displaylib/display_snapshot.hpp"
+#include "host_check.hpp"
+
+static uint8_t screenBuffer[192 * 64 / 8];
+
+// Text, shapes and runs of equal bytes, so the RLE has runs and literals
+static void drawPattern(displaylib_graphics &display)
+{
+	const int16_t w = display.width();
+	const int16_t h = display.height();
+	display.fillRect(0, 0, w / 3, 16, display.FG_COLOR);
+	display.drawRect(0, 0, w, h, display.FG_COLOR);
+	display.fillCircle(w / 2, h / 2, h / 3, display.FG_COLOR);
+	display.setFont(pFontDefault);
+	display.setCursor(4, h - 12);
+	display.print("Snapshot 0123456789");
+}
+
+static void snapshotOut(displaylib_flush &display, const char *expected, const char *pbm, int width, int height)
+{
+	HOST_CHECK(host_check::writePagesPbm(expected, std::span<const uint8_t>(screenBuffer, width * height / 8), width, height));
+	displaylib_snapshot snapshot(display);
+	FILE *file = fopen(pbm, "wb");
+	HOST_CHECK(file != nullptr);
+	if (file != nullptr)
+	{
+		HOST_CHECK(snapshot.snapshot(file, displaylib_snapshot::SnapshotPBM) == DisplayRet::Success);
+		fclose(file);
+	}
+	// RLE in steps of 7 bytes, each step resumes where the last stopped
+	HOST_CHECK(snapshot.snapshotBegin(displaylib_snapshot::SnapshotRLE) == DisplayRet::Success);
+	uint32_t steps = 0;
+	while (snapshot.snapshotStep(stdout, 7))
+		steps++;
+	HOST_CHECK(steps > 10);
+	HOST_CHECK(!snapshot.snapshotBusy());
+}
+
+int main(int argc, char **argv)
+{
+	if (argc != 4)
+	{
+		fprintf(stderr, "usage: snapshot_check <128x64|192x64> <expected.pbm> <snapshot.pbm>\n");
+		return 2;
+	}
+	const std::string_view size = argv[1];
+	if (size == "128x64")
+	{
+		SSD1306 display(128, 64);
+		HOST_CHECK(display.OLEDbegin(SSD1306::SSD1306_ADDR, i2c1, 400, 18, 19) == DisplayRet::Success);
+		HOST_CHECK(display.OLEDSetBufferPtr(128, 64, std::span<uint8_t>(screenBuffer, 1024)) == DisplayRet::Success);
+		display.OLEDclearBuffer();
+		drawPattern(display);
+		snapshotOut(display, argv[2], argv[3], 128, 64);
+	}
+	else if (size == "192x64")
+	{
+		ERM19264 display(192, 64);
+		display.LCDSPISetup(spi0, 8000, 3, 2, 5, 6, 7);
+		display.LCDinit();
+		HOST_CHECK(display.LCDSetBufferPtr(192, 64, screenBuffer) == DisplayRet::Success);
+		display.LCDclearBuffer();
+		drawPattern(display);
+		snapshotOut(display, argv[2], argv[3], 192, 64);
+	}
+	else
+	{
+		fprintf(stderr, "snapshot_check: unknown size %s\n", argv[1]);
+		return 2;
+	}
+	return host_check::result();
+}
@@ -0,0 +1,26 @@
+/*!
+	@file gpio.h
+	@brief Host stand in for the pico SDK hardware/gpio.h, used by the host test build only.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+
+/*! GPIO functions used by the library */
+enum gpio_function
+{
+	GPIO_FUNC_SPI = 1,
+	GPIO_FUNC_I2C = 3,
+	GPIO_FUNC_NULL = 0x1f
+};
+
+void gpio_init(unsigned gpio);
+void gpio_deinit(unsigned gpio);
+void gpio_set_dir(unsigned gpio, bool out);
+void gpio_set_function(unsigned gpio, enum gpio_function fn);
+void gpio_pull_up(unsigned gpio);
+void gpio_put(unsigned gpio, bool value);
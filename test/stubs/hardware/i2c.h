@@ -0,0 +1,19 @@
+/*!
+	@file i2c.h
+	@brief Host stand in for the pico SDK hardware/i2c.h, used by the host test build only.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+typedef struct i2c_inst i2c_inst_t;
+extern i2c_inst_t *i2c0;
+extern i2c_inst_t *i2c1;
+
+unsigned i2c_init(i2c_inst_t *i2c, unsigned baudrate);
+void i2c_deinit(i2c_inst_t *i2c);
+unsigned i2c_set_baudrate(i2c_inst_t *i2c, unsigned baudrate);
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, unsigned timeoutUs);
+int i2c_read_timeout_us(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop, unsigned timeoutUs);
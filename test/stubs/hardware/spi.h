@@ -0,0 +1,27 @@
+/*!
+	@file spi.h
+	@brief Host stand in for the pico SDK hardware/spi.h, used by the host test build only.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "pico/stdlib.h"
+
+typedef struct spi_inst spi_inst_t;
+extern spi_inst_t *spi0;
+extern spi_inst_t *spi1;
+
+/*! SPI bit order */
+enum spi_order_t { SPI_LSB_FIRST = 0, SPI_MSB_FIRST = 1 };
+/*! SPI clock phase */
+enum spi_cpha_t { SPI_CPHA_0 = 0, SPI_CPHA_1 = 1 };
+/*! SPI clock polarity */
+enum spi_cpol_t { SPI_CPOL_0 = 0, SPI_CPOL_1 = 1 };
+
+unsigned spi_init(spi_inst_t *spi, unsigned baudrate);
+void spi_deinit(spi_inst_t *spi);
+unsigned spi_set_baudrate(spi_inst_t *spi, unsigned baudrate);
+void spi_set_format(spi_inst_t *spi, unsigned dataBits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order);
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len);
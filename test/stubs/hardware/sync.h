@@ -0,0 +1,11 @@
+/*!
+	@file sync.h
+	@brief Host stand in for the pico SDK hardware/sync.h, used by the host test build only.
+*/
+
+#pragma once
+
+/*! @brief Wait for event, nothing to do on the host */
+static inline void __wfe(void) {}
+/*! @brief Send event, nothing to do on the host */
+static inline void __sev(void) {}
@@ -0,0 +1,168 @@
+/*!
+	@file host_stubs.cpp
+	@brief Host stand in for the pico SDK functions the library uses, for the host tests.
+*/
+
+#include <poll.h>
+#include <unistd.h>
+#include <cstdio>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/i2c.h"
+#include "hardware/spi.h"
+#include "host_stubs.hpp"
+
+struct i2c_inst { int number; };
+struct spi_inst { int number; };
+
+static i2c_inst i2c0Inst{0}, i2c1Inst{1};
+static spi_inst spi0Inst{0}, spi1Inst{1};
+i2c_inst_t *i2c0 = &i2c0Inst;
+i2c_inst_t *i2c1 = &i2c1Inst;
+spi_inst_t *spi0 = &spi0Inst;
+spi_inst_t *spi1 = &spi1Inst;
+
+namespace host_stub
+{
+	std::atomic<uint64_t> timeUs{0};
+	unsigned i2cBaud = 100000;
+	unsigned spiBaud = 1000000;
+	uint32_t i2cFailWrites = 0;
+	unsigned i2cFailAboveBaud = 0;
+	bool busRecord = false;
+	std::vector<std::vector<uint8_t>> i2cWrites;
+	std::vector<uint8_t> spiBytes;
+	bool stdinClosed = false;
+
+	/*! @brief Puts the clock, the bus and the fault injection back to the start */
+	void reset(void)
+	{
+		timeUs = 0;
+		i2cBaud = 100000;
+		spiBaud = 1000000;
+		i2cFailWrites = 0;
+		i2cFailAboveBaud = 0;
+		busRecord = false;
+		i2cWrites.clear();
+		spiBytes.clear();
+	}
+
+	static bool i2cFails(void)
+	{
+		return i2cFailAboveBaud != 0 && i2cBaud > i2cFailAboveBaud;
+	}
+}
+
+// *** time ***
+uint64_t time_us_64(void) { return host_stub::timeUs; }
+uint32_t time_us_32(void) { return static_cast<uint32_t>(host_stub::timeUs); }
+absolute_time_t get_absolute_time(void) { return host_stub::timeUs; }
+uint32_t to_ms_since_boot(absolute_time_t t) { return static_cast<uint32_t>(t / 1000); }
+void busy_wait_us(uint64_t delayUs) { host_stub::timeUs += delayUs; }
+void busy_wait_us_32(uint32_t delayUs) { host_stub::timeUs += delayUs; }
+void busy_wait_ms(uint32_t delayMs) { host_stub::timeUs += static_cast<uint64_t>(delayMs) * 1000; }
+void sleep_us(uint64_t delayUs) { host_stub::timeUs += delayUs; }
+void sleep_ms(uint32_t delayMs) { host_stub::timeUs += static_cast<uint64_t>(delayMs) * 1000; }
+
+// *** stdio, stdin is read as the USB CDC input ***
+bool stdio_init_all(void)
+{
+	setvbuf(stdout, nullptr, _IOLBF, 0); // line at a time, as a terminal on USB CDC sees it
+	return true;
+}
+
+int getchar_timeout_us(uint32_t timeoutUs)
+{
+	pollfd input{STDIN_FILENO, POLLIN, 0};
+	if (host_stub::stdinClosed || poll(&input, 1, static_cast<int>(timeoutUs / 1000)) <= 0)
+		return PICO_ERROR_TIMEOUT;
+	unsigned char value = 0;
+	if (read(STDIN_FILENO, &value, 1) != 1)
+	{
+		host_stub::stdinClosed = true;
+		return PICO_ERROR_TIMEOUT;
+	}
+	return value;
+}
+
+unsigned get_core_num(void) { return 0; }
+
+// *** gpio ***
+void gpio_init(unsigned) {}
+void gpio_deinit(unsigned) {}
+void gpio_set_dir(unsigned, bool) {}
+void gpio_set_function(unsigned, enum gpio_function) {}
+void gpio_pull_up(unsigned) {}
+void gpio_put(unsigned, bool) {}
+
+// *** i2c ***
+unsigned i2c_init(i2c_inst_t *, unsigned baudrate)
+{
+	host_stub::i2cBaud = baudrate;
+	return baudrate;
+}
+
+void i2c_deinit(i2c_inst_t *) {}
+
+unsigned i2c_set_baudrate(i2c_inst_t *, unsigned baudrate)
+{
+	host_stub::i2cBaud = baudrate;
+	return baudrate;
+}
+
+int i2c_write_timeout_us(i2c_inst_t *, uint8_t, const uint8_t *src, size_t len, bool, unsigned timeoutUs)
+{
+	if (host_stub::i2cFailWrites > 0 || host_stub::i2cFails())
+	{
+		if (host_stub::i2cFailWrites > 0)
+			host_stub::i2cFailWrites--;
+		host_stub::timeUs += timeoutUs;
+		return PICO_ERROR_TIMEOUT;
+	}
+	host_stub::timeUs += (static_cast<uint64_t>(len) + 1) * 9 * 1000000 / host_stub::i2cBaud;
+	if (host_stub::busRecord)
+		host_stub::i2cWrites.emplace_back(src, src + len);
+	return static_cast<int>(len);
+}
+
+int i2c_read_timeout_us(i2c_inst_t *, uint8_t, uint8_t *dst, size_t len, bool, unsigned timeoutUs)
+{
+	if (host_stub::i2cFails())
+	{
+		host_stub::timeUs += timeoutUs;
+		return PICO_ERROR_TIMEOUT;
+	}
+	host_stub::timeUs += (static_cast<uint64_t>(len) + 1) * 9 * 1000000 / host_stub::i2cBaud;
+	for (size_t index = 0; index < len; index++)
+		dst[index] = 0x43; // status byte, display on
+	return static_cast<int>(len);
+}
+
+// *** spi ***
+unsigned spi_init(spi_inst_t *, unsigned baudrate)
+{
+	host_stub::spiBaud = baudrate;
+	return baudrate;
+}
+
+void spi_deinit(spi_inst_t *) {}
+
+unsigned spi_set_baudrate(spi_inst_t *, unsigned baudrate)
+{
+	host_stub::spiBaud = baudrate;
+	return baudrate;
+}
+
+void spi_set_format(spi_inst_t *, unsigned, spi_cpol_t, spi_cpha_t, spi_order_t) {}
+
+int spi_write_blocking(spi_inst_t *, const uint8_t *src, size_t len)
+{
+	host_stub::timeUs += static_cast<uint64_t>(len) * 8 * 1000000 / host_stub::spiBaud;
+	if (host_stub::busRecord)
+		host_stub::spiBytes.insert(host_stub::spiBytes.end(), src, src + len);
+	return static_cast<int>(len);
+}
+
+// *** multicore, not used, the host pipeline runs a std::thread ***
+void multicore_reset_core1(void) {}
+void multicore_launch_core1(void (*)(void)) {}
@@ -0,0 +1,29 @@
+/*!
+	@file host_stubs.hpp
+	@brief Controls of the host stand in for the pico SDK, for the host tests.
+	@details Time is simulated: it starts at 0 and moves only when a bus
+		transfer or a wait takes time, so the tests are repeatable. An I2C
+		write takes 9 bits a byte, address included, at the set baud rate,
+		an SPI write 8 bits a byte.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace host_stub
+{
+	extern std::atomic<uint64_t> timeUs;   /**< Simulated time, uS */
+	extern unsigned i2cBaud;               /**< Baud rate of the last i2c_init or i2c_set_baudrate */
+	extern unsigned spiBaud;               /**< Baud rate of the last spi_init or spi_set_baudrate */
+	extern uint32_t i2cFailWrites;         /**< The next n I2C writes time out */
+	extern unsigned i2cFailAboveBaud;      /**< I2C transfers time out above this baud rate, 0 never */
+	extern bool busRecord;                 /**< Record the bytes of each write */
+	extern std::vector<std::vector<uint8_t>> i2cWrites; /**< I2C writes recorded, control byte first */
+	extern std::vector<uint8_t> spiBytes;  /**< SPI bytes recorded */
+	extern bool stdinClosed;               /**< getchar_timeout_us saw the end of stdin */
+
+	void reset(void);
+}
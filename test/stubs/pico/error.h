@@ -0,0 +1,16 @@
+/*!
+	@file error.h
+	@brief Host stand in for the pico SDK pico/error.h, used by the host test build only.
+*/
+
+#pragma once
+
+/*! pico SDK error codes */
+enum pico_error_codes
+{
+	PICO_OK = 0,
+	PICO_ERROR_NONE = 0,
+	PICO_ERROR_GENERIC = -1,
+	PICO_ERROR_TIMEOUT = -2,
+	PICO_ERROR_NO_DATA = -3
+};
@@ -0,0 +1,10 @@
+/*!
+	@file multicore.h
+	@brief Host stand in for the pico SDK pico/multicore.h, used by the host test build only.
+	@note The host build of displaylib_pipeline runs its worker on a std::thread.
+*/
+
+#pragma once
+
+void multicore_reset_core1(void);
+void multicore_launch_core1(void (*entry)(void));
@@ -0,0 +1,23 @@
+/*!
+	@file stdlib.h
+	@brief Host stand in for the pico SDK pico/stdlib.h, used by the host test build only.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include "pico/error.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+
+#ifndef PICO_ON_DEVICE
+#define PICO_ON_DEVICE 0
+#endif
+
+bool stdio_init_all(void);
+int getchar_timeout_us(uint32_t timeoutUs);
+unsigned get_core_num(void);
+/*! @brief Spin loop hint, nothing to do on the host */
+static inline void tight_loop_contents(void) {}
@@ -0,0 +1,21 @@
+/*!
+	@file time.h
+	@brief Host stand in for the pico SDK pico/time.h, used by the host test build only.
+	@details Time is simulated, it only moves on bus transfers and waits, see host_stubs.hpp.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+typedef uint64_t absolute_time_t;
+
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+absolute_time_t get_absolute_time(void);
+uint32_t to_ms_since_boot(absolute_time_t t);
+void busy_wait_us(uint64_t delayUs);
+void busy_wait_us_32(uint32_t delayUs);
+void busy_wait_ms(uint32_t delayMs);
+void sleep_us(uint64_t delayUs);
+void sleep_ms(uint32_t delayMs);
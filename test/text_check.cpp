@@ -0,0 +1,104 @@
+/*!
+	@file text_check.cpp
+	@brief Host check of text decoding, single byte text by default, UTF-8
+		when turned on with overlong and surrogate forms rejected, and the
+		font fallback and font invert kept when a widget swaps fonts.
+*/
+
+#include <algorithm>
+#include <string_view>
+#include "displaylib/ssd1306.hpp"
+#include "displaylib/display_numeric.hpp"
+#include "displaylib/display_list.hpp"
+#include "host_check.hpp"
+
+static uint8_t screenBuffer[1024];
+
+/*!
+	@brief Is any pixel lit in a range of columns of page 0
+	@param first first column
+	@param last last column
+	@return true if a byte is not 0
+*/
+static bool columnsLit(int first, int last)
+{
+	return std::any_of(screenBuffer + first, screenBuffer + last + 1, [](uint8_t value) { return value != 0; });
+}
+
+// List rows "row 0" to "row n"
+static uint8_t listRow(uint16_t row, std::span<char> text, void *)
+{
+	const int length = snprintf(text.data(), text.size(), "row %u", row);
+	return static_cast<uint8_t>(std::min<size_t>(length, text.size()));
+}
+
+int main()
+{
+	SSD1306 display(128, 64);
+	HOST_CHECK(display.OLEDbegin(SSD1306::SSD1306_ADDR, i2c1, 400, 18, 19) == DisplayRet::Success);
+	HOST_CHECK(display.OLEDSetBufferPtr(128, 64, screenBuffer) == DisplayRet::Success);
+	display.setFont(pFontDefault);
+
+	// Off by default, a byte of 0xC2-0xF4 is drawn at once, not held as a UTF-8 lead
+	HOST_CHECK(!display.getTextUTF8());
+	display.OLEDclearBuffer();
+	display.setCursor(0, 0);
+	display.print("\xDB");
+	HOST_CHECK(columnsLit(0, 5));
+	display.print("\xB0");
+	HOST_CHECK(columnsLit(6, 11));
+	HOST_CHECK(display.getWriteError() == 0);
+	HOST_CHECK(display.getTextWidth("\xDB\xB0") == 12);
+
+	// UTF-8 on, valid sequences are one character, broken ones Latin-1 bytes
+	display.setTextUTF8(true);
+	HOST_CHECK(display.getTextWidth("\xC3\xA9") == 6);         // U+00E9
+	HOST_CHECK(display.getTextWidth("\xC0\x80") == 12);        // overlong NUL
+	HOST_CHECK(display.getTextWidth("\xE0\x80\xAF") == 18);    // overlong '/'
+	HOST_CHECK(display.getTextWidth("\xF0\x80\x80\xAF") == 24); // overlong '/'
+	HOST_CHECK(display.getTextWidth("\xED\xA0\x80") == 18);    // surrogate U+D800
+	HOST_CHECK(display.getTextWidth("\xF4\x90\x80\x80") == 24); // above U+10FFFF
+	HOST_CHECK(display.getTextWidth("\xE2\x82\xAC") == 0);     // U+20AC, not in the font
+	display.OLEDclearBuffer();
+	display.setCursor(0, 0);
+	display.print("\xC3");
+	HOST_CHECK(!columnsLit(0, 127)); // lead byte held
+	display.print("\xA9");
+	HOST_CHECK(columnsLit(0, 5) && !columnsLit(6, 127));
+	display.print("\xED\xA0\x80"); // surrogate, drawn as three Latin-1 characters
+	HOST_CHECK(columnsLit(6, 23));
+	display.setTextUTF8(false);
+
+	// The fallback survives a widget drawing in its own font
+	display.setTextUTF8(true);
+	HOST_CHECK(display.setFontFallback('?') == DisplayRet::Success);
+	HOST_CHECK(display.getTextWidth("\xE2\x82\xAC") == 6);
+	display.setInvertFont(true);
+	displaylib_numeric_field field(display, 0, 32, 4, pFontWide);
+	HOST_CHECK(field.setValue(42) == DisplayRet::Success);
+	HOST_CHECK(display.getFont().data() == pFontDefault.data());
+	HOST_CHECK(display.getInvertFont());
+	HOST_CHECK(display.getTextWidth("\xE2\x82\xAC") == 6);
+
+	// and a list view drawing its rows in its own font
+	displaylib_list_view list(display, 64, 0, 64, 32, pFontWide);
+	HOST_CHECK(list.listBegin(listRow, nullptr, 10) == DisplayRet::Success);
+	HOST_CHECK(display.getInvertFont());
+	HOST_CHECK(list.listRedraw() == DisplayRet::Success);
+	HOST_CHECK(list.moveSelection(1) == DisplayRet::Success);
+	HOST_CHECK(display.getFont().data() == pFontDefault.data());
+	HOST_CHECK(display.getInvertFont());
+	HOST_CHECK(display.getTextWidth("\xE2\x82\xAC") == 6);
+	display.setInvertFont(false);
+
+	// Another font has its own fallback, selecting this one again restores it
+	display.setFont(pFontWide);
+	HOST_CHECK(display.getTextWidth("\xE2\x82\xAC") == 0);
+	display.setFont(pFontDefault);
+	HOST_CHECK(display.getTextWidth("\xE2\x82\xAC") == 6);
+	HOST_CHECK(display.setFontFallback(0) == DisplayRet::Success);
+	display.setFont(pFontDefault);
+	HOST_CHECK(display.getTextWidth("\xE2\x82\xAC") == 0);
+
+	return host_check::result();
+}